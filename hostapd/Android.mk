@@ -117,6 +117,7 @@ OBJS += src/utils/eloop.c
 OBJS += src/utils/common.c
 OBJS += src/utils/wpa_debug.c
 OBJS += src/utils/wpabuf.c
+OBJS += src/utils/mempool.c
 OBJS += src/utils/os_$(CONFIG_OS).c
 OBJS += src/utils/ip_addr.c
 
@@ -205,6 +206,7 @@ L_CFLAGS += -DCONFIG_SAE
 OBJS += src/common/sae.c
 NEED_ECC=y
 NEED_DH_GROUPS=y
+NEED_MODEXP=y
 endif
 
 ifdef CONFIG_IEEE80211N
@@ -539,6 +541,7 @@ OBJS += src/tls/tlsv1_cred.c
 OBJS += src/tls/tlsv1_server.c
 OBJS += src/tls/tlsv1_server_write.c
 OBJS += src/tls/tlsv1_server_read.c
+OBJS += src/tls/tlsv1_server_cache.c
 OBJS += src/tls/asn1.c
 OBJS += src/tls/rsa.c
 OBJS += src/tls/x509v3.c
@@ -550,6 +553,8 @@ NEED_BASE64=y
 NEED_TLS_PRF=y
 NEED_MODEXP=y
 NEED_CIPHER=y
+NEED_AES=y
+NEED_AES_CBC=y
 L_CFLAGS += -DCONFIG_TLS_INTERNAL
 L_CFLAGS += -DCONFIG_TLS_INTERNAL_SERVER
 endif
@@ -573,6 +578,9 @@ ifeq ($(CONFIG_CRYPTO), internal)
 OBJS += src/crypto/crypto_internal.c
 NEED_AES_DEC=y
 L_CFLAGS += -DCONFIG_CRYPTO_INTERNAL
+ifdef NEED_ECC
+OBJS += src/crypto/crypto_internal-ec.c
+endif
 ifdef CONFIG_INTERNAL_LIBTOMMATH
 L_CFLAGS += -DCONFIG_INTERNAL_LIBTOMMATH
 ifdef CONFIG_INTERNAL_LIBTOMMATH_FAST
@@ -1229,6 +1229,24 @@ static int hostapd_config_check(struct hostapd_config *conf)
 			return -1;
 	}
 
+	for (i = 0; i < conf->num_bss; i++) {
+		const char *file = conf->bss[i].tls_session_cache_file;
+		size_t j;
+
+		for (j = i + 1; file && j < conf->num_bss; j++) {
+			if (conf->bss[j].tls_session_cache_file &&
+			    os_strcmp(file,
+				      conf->bss[j].tls_session_cache_file) ==
+			    0) {
+				wpa_printf(MSG_ERROR, "BSS %s and %s use the "
+					   "same tls_session_cache_file",
+					   conf->bss[i].iface,
+					   conf->bss[j].iface);
+				return -1;
+			}
+		}
+	}
+
 	return 0;
 }
 
@@ -1826,6 +1844,15 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		} else if (os_strcmp(buf, "dh_file") == 0) {
 			os_free(bss->dh_file);
 			bss->dh_file = os_strdup(pos);
+		} else if (os_strcmp(buf, "tls_session_lifetime") == 0) {
+			bss->tls_session_lifetime = atoi(pos);
+		} else if (os_strcmp(buf, "tls_session_cache_size") == 0) {
+			bss->tls_session_cache_size = atoi(pos);
+		} else if (os_strcmp(buf, "tls_session_tickets") == 0) {
+			bss->tls_session_tickets = atoi(pos);
+		} else if (os_strcmp(buf, "tls_session_cache_file") == 0) {
+			os_free(bss->tls_session_cache_file);
+			bss->tls_session_cache_file = os_strdup(pos);
 		} else if (os_strcmp(buf, "fragment_size") == 0) {
 			bss->fragment_size = atoi(pos);
 #ifdef EAP_SERVER_FAST
@@ -2087,6 +2114,20 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			bss->wpa_strict_rekey = atoi(pos);
 		} else if (os_strcmp(buf, "wpa_gmk_rekey") == 0) {
 			bss->wpa_gmk_rekey = atoi(pos);
+		} else if (os_strcmp(buf, "wpa_group_update_batch") == 0) {
+			bss->wpa_group_update_batch = atoi(pos);
+		} else if (os_strcmp(buf, "wpa_group_update_interval") == 0) {
+			bss->wpa_group_update_interval = atoi(pos);
+			if (bss->wpa_group_update_interval <= 0) {
+				wpa_printf(MSG_ERROR, "Line %d: invalid "
+					   "wpa_group_update_interval %d",
+					   line,
+					   bss->wpa_group_update_interval);
+				errors++;
+			}
+		} else if (os_strcmp(buf, "wpa_group_update_max_inflight") ==
+			   0) {
+			bss->wpa_group_update_max_inflight = atoi(pos);
 		} else if (os_strcmp(buf, "wpa_ptk_rekey") == 0) {
 			bss->wpa_ptk_rekey = atoi(pos);
 		} else if (os_strcmp(buf, "wpa_passphrase") == 0) {
@@ -2501,6 +2542,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			bss->disable_pmksa_caching = atoi(pos);
 		} else if (os_strcmp(buf, "okc") == 0) {
 			bss->okc = atoi(pos);
+		} else if (os_strcmp(buf, "pmksa_cache_file") == 0) {
+			os_free(bss->pmksa_cache_file);
+			bss->pmksa_cache_file = os_strdup(pos);
 #ifdef CONFIG_WPS
 		} else if (os_strcmp(buf, "wps_state") == 0) {
 			bss->wps_state = atoi(pos);
@@ -2978,6 +3022,8 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 	int line = 0;
 	int errors = 0;
 	size_t i;
+	struct wpabuf *static_params = NULL;
+	int static_params_failed = 0;
 
 	f = fopen(fname, "r");
 	if (f == NULL) {
@@ -3029,11 +3075,28 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		}
 		*pos = '\0';
 		pos++;
+
+		/* Record the parameters that need a full reload to change */
+		if (!static_params_failed && !hostapd_config_hot_param(buf)) {
+			if (wpabuf_resize(&static_params, os_strlen(buf) +
+					  os_strlen(pos) + 2) < 0)
+				static_params_failed = 1;
+			else
+				wpabuf_printf(static_params, "%s=%s\n", buf,
+					      pos);
+		}
+
 		errors += hostapd_config_fill(conf, bss, buf, pos, line);
 	}
 
 	fclose(f);
 
+	if (static_params_failed) {
+		wpabuf_free(static_params);
+		static_params = NULL;
+	}
+	conf->static_params = static_params;
+
 	for (i = 0; i < conf->num_bss; i++)
 		hostapd_set_security_params(&conf->bss[i]);
 
@@ -3059,6 +3122,10 @@ int hostapd_set_iface(struct hostapd_config *conf,
 	int errors;
 	size_t i;
 
+	/* The running configuration no longer matches the file */
+	wpabuf_free(conf->static_params);
+	conf->static_params = NULL;
+
 	errors = hostapd_config_fill(conf, bss, field, value, 0);
 	if (errors) {
 		wpa_printf(MSG_INFO, "Failed to set configuration field '%s' "
@@ -3066,8 +3133,12 @@ int hostapd_set_iface(struct hostapd_config *conf,
 		return -1;
 	}
 
-	for (i = 0; i < conf->num_bss; i++)
+	for (i = 0; i < conf->num_bss; i++) {
 		hostapd_set_security_params(&conf->bss[i]);
+		/* wpa_psk list may have been replaced */
+		if (conf->bss[i].ssid.wpa_psk_index)
+			hostapd_wpa_psk_index_build(&conf->bss[i].ssid);
+	}
 
 	if (hostapd_config_check(conf)) {
 		wpa_printf(MSG_ERROR, "Configuration check failed");
@@ -16,8 +16,10 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/mempool.h"
 #include "common/version.h"
 #include "common/ieee802_11_defs.h"
+#include "crypto/tls.h"
 #include "drivers/driver.h"
 #include "radius/radius_client.h"
 #include "ap/hostapd.h"
@@ -770,6 +772,27 @@ static int hostapd_ctrl_iface_reload(struct hostapd_iface *iface)
 }
 
 
+static int hostapd_ctrl_iface_reload_config(struct hostapd_iface *iface,
+					    char *buf, size_t buflen)
+{
+	int ret;
+
+	if (hostapd_reload_config(iface) < 0) {
+		wpa_printf(MSG_ERROR, "Reloading of configuration failed");
+		return -1;
+	}
+
+	ret = os_snprintf(buf, buflen, "reload=%s\nchanges=0x%x\n"
+			  "reload_usec=%u\n",
+			  (iface->reload_changes & HOSTAPD_BSS_CHANGE_OTHER) ?
+			  "full" : "hot",
+			  iface->reload_changes, iface->reload_usec);
+	if (ret < 0 || (size_t) ret >= buflen)
+		return -1;
+	return ret;
+}
+
+
 static int hostapd_ctrl_iface_disable(struct hostapd_iface *iface)
 {
 	if (hostapd_disable_iface(iface) < 0) {
@@ -780,6 +803,64 @@ static int hostapd_ctrl_iface_disable(struct hostapd_iface *iface)
 }
 
 
+static int hostapd_ctrl_iface_log_level(char *cmd, char *buf, size_t buflen)
+{
+	extern int wpa_debug_level;
+	int level, ret;
+
+	/* cmd: "" or "<level>" or "<module>=<level>" */
+	while (*cmd == ' ')
+		cmd++;
+
+	if (*cmd == '\0') {
+		ret = os_snprintf(buf, buflen, "Current level: %s\n",
+				  debug_level_str(wpa_debug_level));
+		if (ret < 0 || (size_t) ret >= buflen)
+			return -1;
+		return ret + wpa_debug_module_levels(buf + ret, buflen - ret);
+	}
+
+	if (os_strchr(cmd, '=')) {
+		if (wpa_debug_set_module_level(cmd) < 0)
+			return -1;
+	} else {
+		level = str_to_debug_level(cmd);
+		if (level < 0)
+			return -1;
+		wpa_debug_level = level;
+	}
+
+	os_memcpy(buf, "OK\n", 3);
+	return 3;
+}
+
+
+static int hostapd_ctrl_iface_debug_ringbuf_dump(char *cmd, char *buf,
+						 size_t buflen)
+{
+	char *pos;
+	int len;
+
+	/* cmd: "" or "<max octets>" or "<offset> <max octets>" */
+	while (*cmd == ' ')
+		cmd++;
+
+	pos = os_strchr(cmd, ' ');
+	if (pos == NULL) {
+		len = atoi(cmd);
+		if (len < 0)
+			return -1;
+		return wpa_debug_ringbuf_get(buf, buflen, len);
+	}
+
+	len = atoi(pos + 1);
+	if (len <= 0)
+		return -1;
+	return wpa_debug_ringbuf_read(strtoull(cmd, NULL, 10), len, buf,
+				      buflen);
+}
+
+
 static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 				       void *sock_ctx)
 {
@@ -820,6 +901,23 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+	} else if (os_strncmp(buf, "LOG_LEVEL", 9) == 0) {
+		reply_len = hostapd_ctrl_iface_log_level(buf + 9, reply,
+							 reply_size);
+	} else if (os_strcmp(buf, "DEBUG_RINGBUF") == 0) {
+		reply_len = wpa_debug_ringbuf_status(reply, reply_size);
+		if (reply_len == 0)
+			reply_len = -1;
+	} else if (os_strncmp(buf, "DEBUG_RINGBUF_DUMP", 18) == 0 &&
+		   (buf[18] == '\0' || buf[18] == ' ')) {
+		reply_len = hostapd_ctrl_iface_debug_ringbuf_dump(
+			buf + 18, reply, reply_size);
+	} else if (os_strcmp(buf, "MEMSTATS") == 0) {
+		reply_len = mempool_memstats(reply, reply_size);
+	} else if (os_strcmp(buf, "TLS_SESSION_CACHE") == 0) {
+		reply_len = hapd->ssl_ctx ?
+			tls_global_session_cache_stats(hapd->ssl_ctx, reply,
+						       reply_size) : 0;
 	} else if (os_strcmp(buf, "MIB") == 0) {
 		reply_len = ieee802_11_get_mib(hapd, reply, reply_size);
 		if (reply_len >= 0) {
@@ -935,6 +1033,10 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 	} else if (os_strncmp(buf, "ENABLE", 6) == 0) {
 		if (hostapd_ctrl_iface_enable(hapd->iface))
 			reply_len = -1;
+	} else if (os_strcmp(buf, "RELOAD_CONFIG") == 0) {
+		reply_len = hostapd_ctrl_iface_reload_config(hapd->iface,
+							     reply,
+							     reply_size);
 	} else if (os_strncmp(buf, "RELOAD", 6) == 0) {
 		if (hostapd_ctrl_iface_reload(hapd->iface))
 			reply_len = -1;
@@ -84,6 +84,12 @@ static const char *commands_help =
 "   help                 show this usage help\n"
 "   interface [ifname]   show interfaces/select interface\n"
 "   level <debug level>  change debug level\n"
+"   log_level [<level> | <module>=<level>]  show/change debug level\n"
+"   debug_ringbuf        show debug ring buffer status\n"
+"   debug_ringbuf_dump [max len]  show debug ring buffer entries\n"
+"   memstats             show memory pool and buffer statistics\n"
+"   tls_session_cache    show TLS session cache statistics\n"
+"   reload_config        re-read the configuration file\n"
 "   license              show full hostapd_cli license\n"
 "   quit                 exit hostapd_cli\n";
 
@@ -210,6 +216,142 @@ static int hostapd_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int hostapd_cli_cmd_log_level(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	char cmd[256];
+	int res;
+
+	if (argc > 1) {
+		printf("Invalid LOG_LEVEL command: needs zero or one "
+		       "argument (<level> or <module>=<level>)\n");
+		return -1;
+	}
+
+	res = os_snprintf(cmd, sizeof(cmd), "LOG_LEVEL%s%s",
+			  argc > 0 ? " " : "", argc > 0 ? argv[0] : "");
+	if (res < 0 || res >= (int) sizeof(cmd) - 1) {
+		printf("Too long LOG_LEVEL command.\n");
+		return -1;
+	}
+	return wpa_ctrl_command(ctrl, cmd);
+}
+
+
+static int hostapd_cli_cmd_reload_config(struct wpa_ctrl *ctrl, int argc,
+					 char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "RELOAD_CONFIG");
+}
+
+
+static int hostapd_cli_cmd_debug_ringbuf(struct wpa_ctrl *ctrl, int argc,
+					  char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "DEBUG_RINGBUF");
+}
+
+
+static int hostapd_cli_cmd_memstats(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "MEMSTATS");
+}
+
+
+static int hostapd_cli_cmd_tls_session_cache(struct wpa_ctrl *ctrl, int argc,
+					      char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "TLS_SESSION_CACHE");
+}
+
+
+static int hostapd_cli_ringbuf_request(struct wpa_ctrl *ctrl, const char *cmd,
+				       char *buf, size_t buflen)
+{
+	size_t len;
+	int ret;
+
+	len = buflen - 1;
+	ret = wpa_ctrl_request(ctrl, cmd, os_strlen(cmd), buf, &len,
+			       hostapd_cli_msg_cb);
+	if (ret == -2) {
+		printf("'%s' command timed out.\n", cmd);
+		return -1;
+	} else if (ret < 0 || (len >= 4 && os_memcmp(buf, "FAIL", 4) == 0)) {
+		printf("'%s' command failed.\n", cmd);
+		return -1;
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+
+static int hostapd_cli_cmd_debug_ringbuf_dump(struct wpa_ctrl *ctrl,
+					       int argc, char *argv[])
+{
+	char cmd[64], buf[4096], *data, *pos, *end;
+	unsigned long long size, head, offset, start, max_len;
+	int len, first = 1;
+
+	if (argc > 1) {
+		printf("Invalid DEBUG_RINGBUF_DUMP command: needs at most one "
+		       "argument (maximum length)\n");
+		return -1;
+	}
+	if (ctrl_conn == NULL) {
+		printf("Not connected to hostapd - command dropped.\n");
+		return -1;
+	}
+
+	/*
+	 * A single reply is limited by the control interface message size, so
+	 * fetch the buffer in chunks. Only the entries present when starting
+	 * are shown since each command adds new debug messages to the buffer.
+	 */
+	if (hostapd_cli_ringbuf_request(ctrl, "DEBUG_RINGBUF", buf,
+					sizeof(buf)) < 0)
+		return -1;
+	pos = os_strstr(buf, "size=");
+	size = pos ? strtoull(pos + 5, NULL, 10) : 0;
+	pos = os_strstr(buf, "written=");
+	head = pos ? strtoull(pos + 8, NULL, 10) : 0;
+	max_len = argc > 0 ? strtoull(argv[0], NULL, 10) : 0;
+	if (max_len > 0 && max_len < size)
+		size = max_len;
+	offset = head > size ? head - size : 0;
+
+	while (offset < head) {
+		os_snprintf(cmd, sizeof(cmd), "DEBUG_RINGBUF_DUMP %llu %d",
+			    offset, (int) sizeof(buf) - 32);
+		len = hostapd_cli_ringbuf_request(ctrl, cmd, buf, sizeof(buf));
+		if (len < 0)
+			return -1;
+		data = os_strchr(buf, '\n');
+		if (data == NULL)
+			return -1;
+		data++;
+		end = buf + len;
+		if (data == end)
+			break;
+		start = strtoull(buf, NULL, 10);
+
+		pos = data;
+		if (first && start > 0) {
+			/* Skip the partial line in the beginning */
+			while (pos < end && *pos++ != '\n')
+				;
+		} else if (start > offset)
+			printf("[%llu octets overwritten]\n", start - offset);
+		first = 0;
+		fwrite(pos, 1, end - pos, stdout);
+		offset = start + (end - data);
+	}
+
+	return 0;
+}
+
+
 static int hostapd_cli_cmd_mib(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	return wpa_ctrl_command(ctrl, "MIB");
@@ -774,6 +916,12 @@ static struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	{ "ping", hostapd_cli_cmd_ping },
 	{ "mib", hostapd_cli_cmd_mib },
 	{ "relog", hostapd_cli_cmd_relog },
+	{ "log_level", hostapd_cli_cmd_log_level },
+	{ "debug_ringbuf", hostapd_cli_cmd_debug_ringbuf },
+	{ "debug_ringbuf_dump", hostapd_cli_cmd_debug_ringbuf_dump },
+	{ "memstats", hostapd_cli_cmd_memstats },
+	{ "tls_session_cache", hostapd_cli_cmd_tls_session_cache },
+	{ "reload_config", hostapd_cli_cmd_reload_config },
 	{ "sta", hostapd_cli_cmd_sta },
 	{ "all_sta", hostapd_cli_cmd_all_sta },
 	{ "new_sta", hostapd_cli_cmd_new_sta },
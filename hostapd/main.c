@@ -480,7 +480,9 @@ static void usage(void)
 		"\n"
 		"usage: hostapd [-hdBKtv] [-P <PID file>] [-e <entropy file>] "
 		"\\\n"
-		"         [-g <global ctrl_iface>] <configuration file(s)>\n"
+		"         [-g <global ctrl_iface>] [-r <ring buffer size>] "
+		"\\\n"
+		"         <configuration file(s)>\n"
 		"\n"
 		"options:\n"
 		"   -h   show this usage\n"
@@ -493,6 +495,10 @@ static void usage(void)
 #ifdef CONFIG_DEBUG_FILE
 		"   -f   log output to debug file instead of stdout\n"
 #endif /* CONFIG_DEBUG_FILE */
+#ifdef CONFIG_DEBUG_RINGBUF
+		"   -r   collect debug messages into a ring buffer of the "
+		"given size (kB)\n"
+#endif /* CONFIG_DEBUG_RINGBUF */
 		"   -t   include timestamps in some debug messages\n"
 		"   -v   show hostapd version\n");
 
@@ -500,6 +506,15 @@ static void usage(void)
 }
 
 
+#if defined(CONFIG_DEBUG_RINGBUF) && defined(CONFIG_DEBUG_FILE)
+static void hostapd_debug_ringbuf_flush(void *eloop_ctx, void *timeout_ctx)
+{
+	wpa_debug_flush_ringbuf();
+	eloop_register_timeout(1, 0, hostapd_debug_ringbuf_flush, NULL, NULL);
+}
+#endif /* CONFIG_DEBUG_RINGBUF && CONFIG_DEBUG_FILE */
+
+
 static const char * hostapd_msg_ifname_cb(void *ctx)
 {
 	struct hostapd_data *hapd = ctx;
@@ -540,6 +555,7 @@ int main(int argc, char *argv[])
 	char *pid_file = NULL;
 	const char *log_file = NULL;
 	const char *entropy_file = NULL;
+	int ringbuf_size = 0;
 
 	if (os_program_init())
 		return -1;
@@ -556,7 +572,7 @@ int main(int argc, char *argv[])
 	interfaces.global_ctrl_sock = -1;
 
 	for (;;) {
-		c = getopt(argc, argv, "Bde:f:hKP:tvg:");
+		c = getopt(argc, argv, "Bde:f:hKP:r:tvg:");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -584,6 +600,9 @@ int main(int argc, char *argv[])
 			os_free(pid_file);
 			pid_file = os_rel2abs_path(optarg);
 			break;
+		case 'r':
+			ringbuf_size = atoi(optarg);
+			break;
 		case 't':
 			wpa_debug_timestamp++;
 			break;
@@ -608,6 +627,9 @@ int main(int argc, char *argv[])
 
 	if (log_file)
 		wpa_debug_open_file(log_file);
+	if (ringbuf_size > 0 &&
+	    wpa_debug_open_ringbuf((size_t) ringbuf_size * 1024) < 0)
+		wpa_printf(MSG_ERROR, "Failed to set up debug ring buffer");
 
 	interfaces.count = argc - optind;
 	if (interfaces.count) {
@@ -622,6 +644,14 @@ int main(int argc, char *argv[])
 	if (hostapd_global_init(&interfaces, entropy_file))
 		return -1;
 
+#if defined(CONFIG_DEBUG_RINGBUF) && defined(CONFIG_DEBUG_FILE)
+	/* Without a debug file, messages stay in the ring buffer until they
+	 * are fetched with DEBUG_RINGBUF_DUMP */
+	if (ringbuf_size > 0 && log_file)
+		eloop_register_timeout(1, 0, hostapd_debug_ringbuf_flush,
+				       NULL, NULL);
+#endif /* CONFIG_DEBUG_RINGBUF && CONFIG_DEBUG_FILE */
+
 	/* Initialize interfaces */
 	for (i = 0; i < interfaces.count; i++) {
 		interfaces.iface[i] = hostapd_interface_init(&interfaces,
@@ -648,6 +678,7 @@ int main(int argc, char *argv[])
 	hostapd_global_deinit(pid_file);
 	os_free(pid_file);
 
+	wpa_debug_close_ringbuf();
 	if (log_file)
 		wpa_debug_close_file();
 
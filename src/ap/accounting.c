@@ -151,9 +151,14 @@ static struct radius_msg * accounting_msg(struct hostapd_data *hapd,
 
 static int accounting_sta_update_stats(struct hostapd_data *hapd,
 				       struct sta_info *sta,
-				       struct hostap_sta_driver_data *data)
+				       struct hostap_sta_driver_data *data,
+				       int snapshot)
 {
-	if (hostapd_drv_read_sta_data(hapd, data, sta->addr))
+	if (snapshot) {
+		/* Interim updates can use the shared statistics snapshot */
+		if (ap_sta_read_drv_data(hapd, sta, data))
+			return -1;
+	} else if (hostapd_drv_read_sta_data(hapd, data, sta->addr))
 		return -1;
 
 	if (sta->last_rx_bytes > data->rx_bytes)
@@ -185,7 +190,7 @@ static void accounting_interim_update(void *eloop_ctx, void *timeout_ctx)
 		interval = sta->acct_interim_interval;
 	} else {
 		struct hostap_sta_driver_data data;
-		accounting_sta_update_stats(hapd, sta, &data);
+		accounting_sta_update_stats(hapd, sta, &data, 1);
 		interval = ACCT_DEFAULT_UPDATE_INTERVAL;
 	}
 
@@ -265,7 +270,7 @@ static void accounting_sta_report(struct hostapd_data *hapd,
 		goto fail;
 	}
 
-	if (accounting_sta_update_stats(hapd, sta, &data) == 0) {
+	if (accounting_sta_update_stats(hapd, sta, &data, !stop) == 0) {
 		if (!radius_msg_add_attr_int32(msg,
 					       RADIUS_ATTR_ACCT_INPUT_PACKETS,
 					       data.rx_packets)) {
@@ -9,6 +9,7 @@
 #include "utils/includes.h"
 
 #include "utils/common.h"
+#include "utils/list.h"
 #include "crypto/sha1.h"
 #include "radius/radius_client.h"
 #include "common/ieee802_11_defs.h"
@@ -53,6 +54,7 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 
 	bss->wpa_group_rekey = 600;
 	bss->wpa_gmk_rekey = 86400;
+	bss->wpa_group_update_interval = 10;
 	bss->wpa_key_mgmt = WPA_KEY_MGMT_PSK;
 	bss->wpa_pairwise = WPA_CIPHER_TKIP;
 	bss->wpa_group = WPA_CIPHER_TKIP;
@@ -81,6 +83,9 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 	bss->pac_key_refresh_time = 1 * 24 * 60 * 60;
 #endif /* EAP_SERVER_FAST */
 
+	bss->tls_session_cache_size = 1000;
+	bss->tls_session_tickets = 1;
+
 	/* Set to -1 as defaults depends on HT in setup */
 	bss->wmm_enabled = -1;
 
@@ -313,6 +318,9 @@ int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf)
 			return -1;
 	}
 
+	if (hostapd_wpa_psk_index_build(ssid) < 0)
+		wpa_printf(MSG_DEBUG, "Could not build WPA PSK index");
+
 	return 0;
 }
 
@@ -393,6 +401,7 @@ static void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	if (conf == NULL)
 		return;
 
+	hostapd_wpa_psk_index_free(&conf->ssid);
 	psk = conf->ssid.wpa_psk;
 	while (psk) {
 		prev = psk;
@@ -402,6 +411,7 @@ static void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 
 	os_free(conf->ssid.wpa_passphrase);
 	os_free(conf->ssid.wpa_psk_file);
+	os_free(conf->pmksa_cache_file);
 	hostapd_config_free_wep(&conf->ssid.wep);
 #ifdef CONFIG_FULL_DYNAMIC_VLAN
 	os_free(conf->ssid.vlan_tagged_interface);
@@ -433,6 +443,7 @@ static void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->private_key);
 	os_free(conf->private_key_passwd);
 	os_free(conf->dh_file);
+	os_free(conf->tls_session_cache_file);
 	os_free(conf->pac_opaque_encr_key);
 	os_free(conf->eap_fast_a_id);
 	os_free(conf->eap_fast_a_id_info);
@@ -542,6 +553,7 @@ void hostapd_config_free(struct hostapd_config *conf)
 	os_free(conf->bss);
 	os_free(conf->supported_rates);
 	os_free(conf->basic_rates);
+	wpabuf_free(conf->static_params);
 
 	os_free(conf);
 }
@@ -610,8 +622,113 @@ const char * hostapd_get_vlan_id_ifname(struct hostapd_vlan *vlan, int vlan_id)
 }
 
 
-const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
-			   const u8 *addr, const u8 *prev_psk)
+/*
+ * Lookup index for ssid->wpa_psk. A wpa_psk_file may list thousands of
+ * per-station PSKs and the 4-way handshake may need to try every candidate
+ * for a station, so the list is split into a hash table of per-station
+ * entries and an array of group (wildcard) entries. In addition, the group
+ * PSK that last resulted in a valid MIC for a station is remembered so that
+ * reconnecting stations are normally matched with the first candidate.
+ */
+#define HOSTAPD_PSK_HASH_MIN 16
+#define HOSTAPD_PSK_LAST_MATCH 64
+
+struct hostapd_wpa_psk_index {
+	struct hostapd_wpa_psk **hash;
+	size_t hash_mask;
+	struct hostapd_wpa_psk **group;
+	size_t num_group;
+	struct {
+		u8 addr[ETH_ALEN];
+		struct hostapd_wpa_psk *psk;
+	} last[HOSTAPD_PSK_LAST_MATCH];
+};
+
+
+static unsigned int hostapd_psk_addr_hash(const u8 *addr)
+{
+	return (addr[3] << 16) ^ (addr[4] << 8) ^ addr[5] ^ (addr[2] << 4);
+}
+
+
+void hostapd_wpa_psk_index_free(struct hostapd_ssid *ssid)
+{
+	struct hostapd_wpa_psk_index *idx = ssid->wpa_psk_index;
+
+	if (idx == NULL)
+		return;
+	os_free(idx->hash);
+	os_free(idx->group);
+	os_free(idx);
+	ssid->wpa_psk_index = NULL;
+}
+
+
+/**
+ * hostapd_wpa_psk_index_build - (Re)build the PSK lookup index
+ * @ssid: SSID configuration
+ * Returns: 0 on success, -1 on failure
+ *
+ * This needs to be called whenever ssid->wpa_psk is modified. If the index
+ * cannot be built, hostapd_get_psk() falls back to walking the list.
+ */
+int hostapd_wpa_psk_index_build(struct hostapd_ssid *ssid)
+{
+	struct hostapd_wpa_psk_index *idx;
+	struct hostapd_wpa_psk *psk, **pos;
+	size_t count = 0, num_group = 0, hash_size = HOSTAPD_PSK_HASH_MIN;
+
+	hostapd_wpa_psk_index_free(ssid);
+
+	for (psk = ssid->wpa_psk; psk; psk = psk->next) {
+		if (psk->group)
+			num_group++;
+		else
+			count++;
+	}
+	while (hash_size < count)
+		hash_size <<= 1;
+
+	idx = os_zalloc(sizeof(*idx));
+	if (idx == NULL)
+		return -1;
+	idx->hash = os_calloc(hash_size, sizeof(struct hostapd_wpa_psk *));
+	if (num_group)
+		idx->group = os_calloc(num_group,
+				       sizeof(struct hostapd_wpa_psk *));
+	if (idx->hash == NULL || (num_group && idx->group == NULL)) {
+		os_free(idx->hash);
+		os_free(idx->group);
+		os_free(idx);
+		return -1;
+	}
+	idx->hash_mask = hash_size - 1;
+
+	for (psk = ssid->wpa_psk; psk; psk = psk->next) {
+		psk->hnext = NULL;
+		if (psk->group) {
+			psk->group_idx = idx->num_group;
+			idx->group[idx->num_group++] = psk;
+			continue;
+		}
+		/* Keep list order within a bucket */
+		pos = &idx->hash[hostapd_psk_addr_hash(psk->addr) &
+				 idx->hash_mask];
+		while (*pos)
+			pos = &(*pos)->hnext;
+		*pos = psk;
+	}
+
+	ssid->wpa_psk_index = idx;
+	wpa_printf(MSG_DEBUG, "WPA PSK index: %lu per-station PSK(s) in %lu "
+		   "buckets, %lu group PSK(s)", (unsigned long) count,
+		   (unsigned long) hash_size, (unsigned long) num_group);
+	return 0;
+}
+
+
+static const u8 * hostapd_get_psk_list(const struct hostapd_bss_config *conf,
+				       const u8 *addr, const u8 *prev_psk)
 {
 	struct hostapd_wpa_psk *psk;
 	int next_ok = prev_psk == NULL;
@@ -627,3 +744,296 @@ const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 
 	return NULL;
 }
+
+
+/**
+ * hostapd_get_psk - Get the next PSK candidate for a station
+ * @conf: BSS configuration
+ * @addr: Station address
+ * @prev_psk: PSK returned by the previous call or %NULL to get the first one
+ * Returns: Pointer to the PSK or %NULL if no more candidates are available
+ *
+ * prev_psk must be a value returned by this function for the same
+ * configuration. The last successfully used group PSK for the station is
+ * returned first, followed by the per-station PSKs and the remaining group
+ * PSKs.
+ */
+const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
+			   const u8 *addr, const u8 *prev_psk)
+{
+	struct hostapd_wpa_psk_index *idx = conf->ssid.wpa_psk_index;
+	struct hostapd_wpa_psk *psk, *prev = NULL, *last;
+	unsigned int hash;
+	size_t i;
+
+	if (idx == NULL)
+		return hostapd_get_psk_list(conf, addr, prev_psk);
+
+	hash = hostapd_psk_addr_hash(addr);
+	last = idx->last[hash % HOSTAPD_PSK_LAST_MATCH].psk;
+	if (last && os_memcmp(idx->last[hash % HOSTAPD_PSK_LAST_MATCH].addr,
+			      addr, ETH_ALEN) != 0)
+		last = NULL;
+
+	if (prev_psk)
+		prev = (struct hostapd_wpa_psk *)
+			(prev_psk - offsetof(struct hostapd_wpa_psk, psk));
+
+	if (prev && prev->group && prev != last) {
+		i = prev->group_idx + 1;
+	} else {
+		if (prev == NULL && last)
+			return last->psk;
+		if (prev && prev != last)
+			psk = prev->hnext;
+		else
+			psk = idx->hash[hash & idx->hash_mask];
+		for (; psk; psk = psk->hnext) {
+			if (os_memcmp(psk->addr, addr, ETH_ALEN) == 0)
+				return psk->psk;
+		}
+		i = 0;
+	}
+
+	for (; i < idx->num_group; i++) {
+		if (idx->group[i] != last)
+			return idx->group[i]->psk;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * hostapd_wpa_psk_matched - Note the PSK that was used successfully
+ * @conf: BSS configuration
+ * @addr: Station address
+ * @psk: PSK returned by hostapd_get_psk() that resulted in a valid MIC
+ */
+void hostapd_wpa_psk_matched(const struct hostapd_bss_config *conf,
+			     const u8 *addr, const u8 *psk)
+{
+	struct hostapd_wpa_psk_index *idx = conf->ssid.wpa_psk_index;
+	struct hostapd_wpa_psk *entry;
+	unsigned int slot;
+
+	if (idx == NULL || psk == NULL)
+		return;
+
+	entry = (struct hostapd_wpa_psk *)
+		(psk - offsetof(struct hostapd_wpa_psk, psk));
+	if (!entry->group)
+		return; /* per-station PSKs are found directly from the hash */
+
+	slot = hostapd_psk_addr_hash(addr) % HOSTAPD_PSK_LAST_MATCH;
+	os_memcpy(idx->last[slot].addr, addr, ETH_ALEN);
+	idx->last[slot].psk = entry;
+}
+
+
+static const char *hostapd_hot_params[] = {
+	"macaddr_acl", "accept_mac_file", "deny_mac_file",
+	"wpa_passphrase", "wpa_psk", "wpa_psk_file",
+	"auth_server_shared_secret", "acct_server_shared_secret",
+	NULL
+};
+
+
+/**
+ * hostapd_config_hot_param - Check whether a parameter can be reloaded
+ * @name: Configuration file parameter name
+ * Returns: 1 if changes to the parameter can be applied to a running BSS
+ * without a full reload, 0 if not
+ */
+int hostapd_config_hot_param(const char *name)
+{
+	int i;
+
+	for (i = 0; hostapd_hot_params[i]; i++) {
+		if (os_strcmp(name, hostapd_hot_params[i]) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+static int hostapd_radius_servers_addr_equal(struct hostapd_radius_server *a,
+					     int num_a,
+					     struct hostapd_radius_server *b,
+					     int num_b)
+{
+	int i;
+
+	if (num_a != num_b)
+		return 0;
+
+	for (i = 0; i < num_a; i++) {
+		if (hostapd_ip_diff(&a[i].addr, &b[i].addr) ||
+		    a[i].port != b[i].port)
+			return 0;
+	}
+
+	return 1;
+}
+
+
+static int hostapd_radius_servers_secret_equal(
+	struct hostapd_radius_server *a, struct hostapd_radius_server *b,
+	int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		if (a[i].shared_secret_len != b[i].shared_secret_len ||
+		    os_memcmp(a[i].shared_secret, b[i].shared_secret,
+			      a[i].shared_secret_len) != 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+
+/**
+ * hostapd_config_need_full_reload - Check whether hot reload is possible
+ * @oldconf: Currently used configuration
+ * @newconf: Newly read configuration
+ * Returns: 1 if the configurations differ in other ways than what
+ * hostapd_bss_config_changes() reports, 0 otherwise
+ */
+int hostapd_config_need_full_reload(struct hostapd_config *oldconf,
+				    struct hostapd_config *newconf)
+{
+	struct hostapd_radius_servers *a, *b;
+	size_t i;
+
+	if (oldconf->static_params == NULL || newconf->static_params == NULL ||
+	    wpabuf_len(oldconf->static_params) !=
+	    wpabuf_len(newconf->static_params) ||
+	    os_memcmp(wpabuf_head(oldconf->static_params),
+		      wpabuf_head(newconf->static_params),
+		      wpabuf_len(oldconf->static_params)) != 0 ||
+	    oldconf->num_bss != newconf->num_bss)
+		return 1;
+
+	/*
+	 * The server lists are built from multiple lines and the secrets are
+	 * matched to servers in order, so make sure the lists still match.
+	 */
+	for (i = 0; i < oldconf->num_bss; i++) {
+		a = oldconf->bss[i].radius;
+		b = newconf->bss[i].radius;
+		if (a == NULL || b == NULL) {
+			if (a != b)
+				return 1;
+			continue;
+		}
+		if (!hostapd_radius_servers_addr_equal(a->auth_servers,
+						       a->num_auth_servers,
+						       b->auth_servers,
+						       b->num_auth_servers) ||
+		    !hostapd_radius_servers_addr_equal(a->acct_servers,
+						       a->num_acct_servers,
+						       b->acct_servers,
+						       b->num_acct_servers))
+			return 1;
+	}
+
+	return 0;
+}
+
+
+static int hostapd_maclist_equal(struct mac_acl_entry *a, int num_a,
+				 struct mac_acl_entry *b, int num_b)
+{
+	int i;
+
+	if (num_a != num_b)
+		return 0;
+
+	for (i = 0; i < num_a; i++) {
+		if (os_memcmp(a[i].addr, b[i].addr, ETH_ALEN) != 0 ||
+		    a[i].vlan_id != b[i].vlan_id)
+			return 0;
+	}
+
+	return 1;
+}
+
+
+static int hostapd_wpa_psk_equal(struct hostapd_wpa_psk *a,
+				 struct hostapd_wpa_psk *b)
+{
+	while (a && b) {
+		if (a->group != b->group ||
+		    os_memcmp(a->addr, b->addr, ETH_ALEN) != 0 ||
+		    os_memcmp(a->psk, b->psk, PMK_LEN) != 0)
+			return 0;
+		a = a->next;
+		b = b->next;
+	}
+
+	return a == NULL && b == NULL;
+}
+
+
+/**
+ * hostapd_bss_config_changes - Compare BSS configurations
+ * @oldbss: Currently used BSS configuration
+ * @newbss: Newly read BSS configuration (after hostapd_setup_wpa_psk())
+ * Returns: Bitfield of HOSTAPD_BSS_CHANGE_* values
+ *
+ * This only covers the parameters accepted by hostapd_config_hot_param();
+ * hostapd_config_need_full_reload() is used to check the rest.
+ */
+unsigned int hostapd_bss_config_changes(struct hostapd_bss_config *oldbss,
+					struct hostapd_bss_config *newbss)
+{
+	unsigned int changes = 0;
+	struct hostapd_radius_servers *a = oldbss->radius, *b = newbss->radius;
+
+	if (oldbss->macaddr_acl != newbss->macaddr_acl ||
+	    !hostapd_maclist_equal(oldbss->accept_mac, oldbss->num_accept_mac,
+				   newbss->accept_mac,
+				   newbss->num_accept_mac) ||
+	    !hostapd_maclist_equal(oldbss->deny_mac, oldbss->num_deny_mac,
+				   newbss->deny_mac, newbss->num_deny_mac))
+		changes |= HOSTAPD_BSS_CHANGE_MAC_ACL;
+
+	if (!hostapd_wpa_psk_equal(oldbss->ssid.wpa_psk,
+				   newbss->ssid.wpa_psk))
+		changes |= HOSTAPD_BSS_CHANGE_PSK;
+
+	if (a && b &&
+	    (!hostapd_radius_servers_secret_equal(a->auth_servers,
+						  b->auth_servers,
+						  a->num_auth_servers) ||
+	     !hostapd_radius_servers_secret_equal(a->acct_servers,
+						  b->acct_servers,
+						  a->num_acct_servers)))
+		changes |= HOSTAPD_BSS_CHANGE_RADIUS_SECRET;
+
+	return changes;
+}
+
+
+/**
+ * hostapd_maclist_denied - Check whether the local MAC ACL denies a station
+ * @conf: BSS configuration
+ * @addr: Station address
+ * Returns: 1 if the station is rejected based on accept_mac/deny_mac, 0 if
+ * not (or if the decision depends on an external RADIUS server)
+ */
+int hostapd_maclist_denied(struct hostapd_bss_config *conf, const u8 *addr)
+{
+	if (hostapd_maclist_found(conf->accept_mac, conf->num_accept_mac,
+				  addr, NULL))
+		return 0;
+
+	if (hostapd_maclist_found(conf->deny_mac, conf->num_deny_mac, addr,
+				  NULL))
+		return 1;
+
+	return conf->macaddr_acl == DENY_UNLESS_ACCEPTED;
+}
@@ -74,6 +74,8 @@ typedef enum hostap_security_policy {
 	SECURITY_WPA = 4
 } secpolicy;
 
+struct hostapd_wpa_psk_index;
+
 struct hostapd_ssid {
 	u8 ssid[HOSTAPD_MAX_SSID_LEN];
 	size_t ssid_len;
@@ -86,6 +88,7 @@ struct hostapd_ssid {
 	struct hostapd_wpa_psk *wpa_psk;
 	char *wpa_passphrase;
 	char *wpa_psk_file;
+	struct hostapd_wpa_psk_index *wpa_psk_index;
 
 	struct hostapd_wep_keys wep;
 
@@ -133,6 +136,8 @@ struct hostapd_wpa_psk {
 	int group;
 	u8 psk[PMK_LEN];
 	u8 addr[ETH_ALEN];
+	struct hostapd_wpa_psk *hnext; /* next entry in wpa_psk_index bucket */
+	size_t group_idx; /* position in wpa_psk_index group PSK array */
 };
 
 struct hostapd_eap_user {
@@ -292,6 +297,9 @@ struct hostapd_bss_config {
 	int wpa_strict_rekey;
 	int wpa_gmk_rekey;
 	int wpa_ptk_rekey;
+	int wpa_group_update_batch;
+	int wpa_group_update_interval;
+	int wpa_group_update_max_inflight;
 	int rsn_pairwise;
 	int rsn_preauth;
 	char *rsn_preauth_interfaces;
@@ -321,6 +329,10 @@ struct hostapd_bss_config {
 	char *private_key_passwd;
 	int check_crl;
 	char *dh_file;
+	unsigned int tls_session_lifetime;
+	unsigned int tls_session_cache_size;
+	int tls_session_tickets;
+	char *tls_session_cache_file;
 	u8 *pac_opaque_encr_key;
 	u8 *eap_fast_a_id;
 	size_t eap_fast_a_id_len;
@@ -363,6 +375,7 @@ struct hostapd_bss_config {
 
 	int disable_pmksa_caching;
 	int okc; /* Opportunistic Key Caching */
+	char *pmksa_cache_file; /* shared PMKSA cache file */
 
 	int wps_state;
 #ifdef CONFIG_WPS
@@ -544,8 +557,22 @@ struct hostapd_config {
 	u8 vht_oper_chwidth;
 	u8 vht_oper_centr_freq_seg0_idx;
 	u8 vht_oper_centr_freq_seg1_idx;
+
+	/*
+	 * Configuration file lines that can only be applied with a full
+	 * reload, i.e., everything except hostapd_config_hot_param() ones.
+	 * NULL if not read from a file or modified at runtime.
+	 */
+	struct wpabuf *static_params;
 };
 
+/* Changes that hostapd_reload_config() can apply to a running BSS */
+#define HOSTAPD_BSS_CHANGE_MAC_ACL BIT(0)
+#define HOSTAPD_BSS_CHANGE_PSK BIT(1)
+#define HOSTAPD_BSS_CHANGE_RADIUS_SECRET BIT(2)
+/* Anything else; requires a full reload */
+#define HOSTAPD_BSS_CHANGE_OTHER BIT(31)
+
 
 int hostapd_mac_comp(const void *a, const void *b);
 int hostapd_mac_comp_empty(const void *a);
@@ -559,7 +586,17 @@ int hostapd_wep_key_cmp(struct hostapd_wep_keys *a,
 			struct hostapd_wep_keys *b);
 const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *prev_psk);
+void hostapd_wpa_psk_matched(const struct hostapd_bss_config *conf,
+			     const u8 *addr, const u8 *psk);
+int hostapd_wpa_psk_index_build(struct hostapd_ssid *ssid);
+void hostapd_wpa_psk_index_free(struct hostapd_ssid *ssid);
 int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf);
+int hostapd_config_hot_param(const char *name);
+int hostapd_config_need_full_reload(struct hostapd_config *oldconf,
+				    struct hostapd_config *newconf);
+unsigned int hostapd_bss_config_changes(struct hostapd_bss_config *oldbss,
+					struct hostapd_bss_config *newbss);
+int hostapd_maclist_denied(struct hostapd_bss_config *conf, const u8 *addr);
 const char * hostapd_get_vlan_id_ifname(struct hostapd_vlan *vlan,
 					int vlan_id);
 struct hostapd_radius_attr *
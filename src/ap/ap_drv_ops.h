@@ -157,6 +157,17 @@ static inline int hostapd_drv_hapd_send_eapol(struct hostapd_data *hapd,
 					     hapd->own_addr, flags);
 }
 
+static inline int hostapd_drv_read_sta_data_all(
+	struct hostapd_data *hapd,
+	void (*cb)(void *ctx, const u8 *addr,
+		   struct hostap_sta_driver_data *data),
+	void *cb_ctx)
+{
+	if (hapd->driver == NULL || hapd->driver->read_sta_data_all == NULL)
+		return -1;
+	return hapd->driver->read_sta_data_all(hapd->drv_priv, cb, cb_ctx);
+}
+
 static inline int hostapd_drv_read_sta_data(
 	struct hostapd_data *hapd, struct hostap_sta_driver_data *data,
 	const u8 *addr)
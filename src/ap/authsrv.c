@@ -127,15 +127,68 @@ static int hostapd_setup_radius_srv(struct hostapd_data *hapd)
 #endif /* RADIUS_SERVER */
 
 
+#ifdef EAP_TLS_FUNCS
+static int authsrv_cache_file_iter(struct hostapd_iface *iface, void *ctx)
+{
+	struct hostapd_data *hapd = ctx;
+	size_t i;
+
+	for (i = 0; i < iface->num_bss; i++) {
+		struct hostapd_data *bss = iface->bss[i];
+		if (bss == hapd || bss->ssl_ctx == NULL ||
+		    bss->conf->tls_session_cache_file == NULL)
+			continue;
+		if (os_strcmp(bss->conf->tls_session_cache_file,
+			      hapd->conf->tls_session_cache_file) == 0) {
+			wpa_printf(MSG_ERROR, "%s: tls_session_cache_file %s is "
+				   "already used by %s", hapd->conf->iface,
+				   hapd->conf->tls_session_cache_file,
+				   bss->conf->iface);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/*
+ * Each BSS has its own session cache and would overwrite the entries of the
+ * other BSSes when saving the cache into a shared file.
+ */
+static int authsrv_cache_file_in_use(struct hostapd_data *hapd)
+{
+	if (hapd->conf->tls_session_cache_file == NULL ||
+	    hapd->iface->interfaces == NULL ||
+	    hapd->iface->interfaces->for_each_interface == NULL)
+		return 0;
+	return hapd->iface->interfaces->for_each_interface(
+		hapd->iface->interfaces, authsrv_cache_file_iter, hapd);
+}
+#endif /* EAP_TLS_FUNCS */
+
+
 int authsrv_init(struct hostapd_data *hapd)
 {
 #ifdef EAP_TLS_FUNCS
 	if (hapd->conf->eap_server &&
 	    (hapd->conf->ca_cert || hapd->conf->server_cert ||
 	     hapd->conf->dh_file)) {
+		struct tls_config conf;
 		struct tls_connection_params params;
 
-		hapd->ssl_ctx = tls_init(NULL);
+		if (authsrv_cache_file_in_use(hapd))
+			return -1;
+
+		os_memset(&conf, 0, sizeof(conf));
+		conf.tls_session_lifetime = hapd->conf->tls_session_lifetime;
+		conf.tls_session_cache_size =
+			hapd->conf->tls_session_cache_size;
+		conf.tls_session_tickets = hapd->conf->tls_session_tickets;
+		conf.tls_session_cache_file =
+			hapd->conf->tls_session_cache_file;
+
+		hapd->ssl_ctx = tls_init(&conf);
 		if (hapd->ssl_ctx == NULL) {
 			wpa_printf(MSG_ERROR, "Failed to initialize TLS");
 			authsrv_deinit(hapd);
@@ -108,19 +108,12 @@ static void hostapd_reload_bss(struct hostapd_data *hapd)
 }
 
 
-int hostapd_reload_config(struct hostapd_iface *iface)
+static void hostapd_reload_config_full(struct hostapd_iface *iface,
+				       struct hostapd_config *newconf)
 {
-	struct hostapd_data *hapd = iface->bss[0];
-	struct hostapd_config *newconf, *oldconf;
+	struct hostapd_data *hapd;
 	size_t j;
 
-	if (iface->interfaces == NULL ||
-	    iface->interfaces->config_read_cb == NULL)
-		return -1;
-	newconf = iface->interfaces->config_read_cb(iface->config_fname);
-	if (newconf == NULL)
-		return -1;
-
 	/*
 	 * Deauthenticate all stations since the new configuration may not
 	 * allow them to use the BSS anymore.
@@ -137,7 +130,6 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 #endif /* CONFIG_NO_RADIUS */
 	}
 
-	oldconf = hapd->iconf;
 	iface->conf = newconf;
 
 	for (j = 0; j < iface->num_bss; j++) {
@@ -146,9 +138,155 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 		hapd->conf = &newconf->bss[j];
 		hostapd_reload_bss(hapd);
 	}
+}
+
+
+static void hostapd_reload_bss_hot(struct hostapd_data *hapd,
+				   struct hostapd_bss_config *oldbss,
+				   unsigned int changes)
+{
+	struct hostapd_bss_config *conf = hapd->conf;
+	struct sta_info *sta, *next;
+	void *tmp;
+	size_t tmp_len;
+
+	/*
+	 * Move the runtime state that is attached to the configuration over
+	 * from the old configuration; it is freed with whatever the new
+	 * configuration had.
+	 */
+	tmp = conf->vlan;
+	conf->vlan = oldbss->vlan;
+	oldbss->vlan = tmp;
+	tmp = conf->vlan_tail;
+	conf->vlan_tail = oldbss->vlan_tail;
+	oldbss->vlan_tail = tmp;
+	tmp = conf->ssid.dyn_vlan_keys;
+	conf->ssid.dyn_vlan_keys = oldbss->ssid.dyn_vlan_keys;
+	oldbss->ssid.dyn_vlan_keys = tmp;
+	tmp_len = conf->ssid.max_dyn_vlan_keys;
+	conf->ssid.max_dyn_vlan_keys = oldbss->ssid.max_dyn_vlan_keys;
+	oldbss->ssid.max_dyn_vlan_keys = tmp_len;
+#ifdef CONFIG_IEEE80211R
+	/* wpa_auth refers to these lists; they did not change */
+	tmp = conf->r0kh_list;
+	conf->r0kh_list = oldbss->r0kh_list;
+	oldbss->r0kh_list = tmp;
+	tmp = conf->r1kh_list;
+	conf->r1kh_list = oldbss->r1kh_list;
+	oldbss->r1kh_list = tmp;
+#endif /* CONFIG_IEEE80211R */
+	if (!(changes & HOSTAPD_BSS_CHANGE_RADIUS_SECRET)) {
+		/* Keep the current server and MIB counters */
+		tmp = conf->radius;
+		conf->radius = oldbss->radius;
+		oldbss->radius = tmp;
+	}
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (sta->ssid == &oldbss->ssid)
+			sta->ssid = &conf->ssid;
+		if (sta->ssid_probe == &oldbss->ssid)
+			sta->ssid_probe = &conf->ssid;
+	}
+
+#ifndef CONFIG_NO_RADIUS
+	/* Pending messages refer to the old shared secrets */
+	if (changes & HOSTAPD_BSS_CHANGE_RADIUS_SECRET)
+		radius_client_flush(hapd->radius, 0);
+	radius_client_reconfig(hapd->radius, conf->radius);
+#endif /* CONFIG_NO_RADIUS */
+
+	if (changes & HOSTAPD_BSS_CHANGE_MAC_ACL) {
+		for (sta = hapd->sta_list; sta; sta = next) {
+			next = sta->next;
+			if (!(sta->flags & WLAN_STA_AUTH) ||
+			    !hostapd_maclist_denied(conf, sta->addr))
+				continue;
+			hostapd_logger(hapd, sta->addr,
+				       HOSTAPD_MODULE_IEEE80211,
+				       HOSTAPD_LEVEL_INFO,
+				       "denied by the new MAC ACL");
+			hostapd_drv_sta_deauth(hapd, sta->addr,
+					       WLAN_REASON_PREV_AUTH_NOT_VALID);
+			ap_sta_deauthenticate(hapd, sta,
+					      WLAN_REASON_PREV_AUTH_NOT_VALID);
+		}
+	}
+
+	/* WPS refers to some of the configuration strings */
+	hostapd_update_wps(hapd);
+
+	wpa_printf(MSG_DEBUG, "Reconfigured interface %s without a full "
+		   "reload (changes 0x%x)", conf->iface, changes);
+}
+
+
+static unsigned int hostapd_reload_config_hot(struct hostapd_iface *iface,
+					      struct hostapd_config *newconf)
+{
+	struct hostapd_data *hapd;
+	struct hostapd_bss_config *oldbss, *newbss;
+	unsigned int changes = 0, bss_changes;
+	size_t j;
+
+	iface->conf = newconf;
+
+	for (j = 0; j < iface->num_bss; j++) {
+		hapd = iface->bss[j];
+		oldbss = hapd->conf;
+		newbss = &newconf->bss[j];
+
+		if (hostapd_setup_wpa_psk(newbss)) {
+			wpa_printf(MSG_ERROR, "Failed to re-configure WPA PSK "
+				   "after reloading configuration");
+		}
+		bss_changes = hostapd_bss_config_changes(oldbss, newbss);
+
+		hapd->iconf = newconf;
+		hapd->conf = newbss;
+		hostapd_reload_bss_hot(hapd, oldbss, bss_changes);
+		changes |= bss_changes;
+	}
+
+	return changes;
+}
+
+
+int hostapd_reload_config(struct hostapd_iface *iface)
+{
+	struct hostapd_data *hapd = iface->bss[0];
+	struct hostapd_config *newconf, *oldconf;
+	struct os_reltime start, end;
+	unsigned int changes;
+
+	if (iface->interfaces == NULL ||
+	    iface->interfaces->config_read_cb == NULL)
+		return -1;
+	os_get_reltime(&start);
+	newconf = iface->interfaces->config_read_cb(iface->config_fname);
+	if (newconf == NULL)
+		return -1;
+
+	oldconf = hapd->iconf;
+
+	if (hostapd_config_need_full_reload(oldconf, newconf)) {
+		hostapd_reload_config_full(iface, newconf);
+		changes = HOSTAPD_BSS_CHANGE_OTHER;
+	} else {
+		changes = hostapd_reload_config_hot(iface, newconf);
+	}
 
 	hostapd_config_free(oldconf);
 
+	os_get_reltime(&end);
+	iface->reload_changes = changes;
+	iface->reload_usec = (end.sec - start.sec) * 1000000 +
+		end.usec - start.usec;
+	wpa_printf(MSG_INFO, "%s: Configuration reloaded (%s, changes 0x%x) "
+		   "in %u usec", hapd->conf->iface,
+		   (changes & HOSTAPD_BSS_CHANGE_OTHER) ? "full" : "hot",
+		   changes, iface->reload_usec);
 
 	return 0;
 }
@@ -534,48 +672,31 @@ static struct sta_info * hostapd_das_find_sta(struct hostapd_data *hapd,
 					      struct radius_das_attrs *attr)
 {
 	struct sta_info *sta = NULL;
-	char buf[128];
 
 	if (attr->sta_addr)
 		sta = ap_get_sta(hapd, attr->sta_addr);
 
-	if (sta == NULL && attr->acct_session_id &&
-	    attr->acct_session_id_len == 17) {
-		for (sta = hapd->sta_list; sta; sta = sta->next) {
-			os_snprintf(buf, sizeof(buf), "%08X-%08X",
-				    sta->acct_session_id_hi,
-				    sta->acct_session_id_lo);
-			if (os_memcmp(attr->acct_session_id, buf, 17) == 0)
-				break;
-		}
-	}
+	if (sta == NULL && attr->acct_session_id)
+		sta = ap_get_sta_acct_session(hapd, attr->acct_session_id,
+					      attr->acct_session_id_len);
 
-	if (sta == NULL && attr->cui) {
-		for (sta = hapd->sta_list; sta; sta = sta->next) {
-			struct wpabuf *cui;
-			cui = ieee802_1x_get_radius_cui(sta->eapol_sm);
-			if (cui && wpabuf_len(cui) == attr->cui_len &&
-			    os_memcmp(wpabuf_head(cui), attr->cui,
-				      attr->cui_len) == 0)
-				break;
-		}
-	}
+	return sta;
+}
 
-	if (sta == NULL && attr->user_name) {
-		for (sta = hapd->sta_list; sta; sta = sta->next) {
-			u8 *identity;
-			size_t identity_len;
-			identity = ieee802_1x_get_identity(sta->eapol_sm,
-							   &identity_len);
-			if (identity &&
-			    identity_len == attr->user_name_len &&
-			    os_memcmp(identity, attr->user_name, identity_len)
-			    == 0)
-				break;
-		}
-	}
 
-	return sta;
+static int hostapd_das_disconnect_sta(struct hostapd_data *hapd,
+				      struct sta_info *sta, void *ctx)
+{
+	unsigned int *count = ctx;
+
+	wpa_printf(MSG_DEBUG, "RADIUS DAS: Disconnect " MACSTR,
+		   MAC2STR(sta->addr));
+	hostapd_drv_sta_deauth(hapd, sta->addr,
+			       WLAN_REASON_PREV_AUTH_NOT_VALID);
+	ap_sta_deauthenticate(hapd, sta, WLAN_REASON_PREV_AUTH_NOT_VALID);
+	(*count)++;
+
+	return 0;
 }
 
 
@@ -583,19 +704,46 @@ static enum radius_das_res
 hostapd_das_disconnect(void *ctx, struct radius_das_attrs *attr)
 {
 	struct hostapd_data *hapd = ctx;
+	struct hostapd_iface *iface = hapd->iface;
 	struct sta_info *sta;
+	unsigned int count = 0;
+	size_t i;
 
 	if (hostapd_das_nas_mismatch(hapd, attr))
 		return RADIUS_DAS_NAS_MISMATCH;
 
 	sta = hostapd_das_find_sta(hapd, attr);
-	if (sta == NULL)
-		return RADIUS_DAS_SESSION_NOT_FOUND;
+	if (sta) {
+		hostapd_das_disconnect_sta(hapd, sta, &count);
+		return RADIUS_DAS_SUCCESS;
+	}
 
-	hostapd_drv_sta_deauth(hapd, sta->addr,
-			       WLAN_REASON_PREV_AUTH_NOT_VALID);
-	ap_sta_deauthenticate(hapd, sta, WLAN_REASON_PREV_AUTH_NOT_VALID);
+	/*
+	 * CUI and User-Name can match multiple sessions; disconnect all of
+	 * them on every BSS of the interface.
+	 */
+	if (attr->cui) {
+		for (i = 0; i < iface->num_bss; i++)
+			ap_sta_for_each_cui(iface->bss[i], attr->cui,
+					    attr->cui_len,
+					    hostapd_das_disconnect_sta,
+					    &count);
+	}
+
+	if (count == 0 && attr->user_name) {
+		for (i = 0; i < iface->num_bss; i++)
+			ap_sta_for_each_identity(iface->bss[i],
+						 attr->user_name,
+						 attr->user_name_len,
+						 hostapd_das_disconnect_sta,
+						 &count);
+	}
+
+	if (count == 0)
+		return RADIUS_DAS_SESSION_NOT_FOUND;
 
+	wpa_printf(MSG_DEBUG, "RADIUS DAS: Disconnected %u session(s)",
+		   count);
 	return RADIUS_DAS_SUCCESS;
 }
 
@@ -1385,7 +1533,7 @@ void hostapd_new_assoc_sta(struct hostapd_data *hapd, struct sta_info *sta,
 	 * IEEE 802.1X/WPA code will start accounting after the station has
 	 * been authorized. */
 	if (!hapd->conf->ieee802_1x && !hapd->conf->wpa) {
-		os_get_time(&sta->connected_time);
+		os_get_reltime(&sta->connected_time);
 		accounting_sta_start(hapd, sta);
 	}
 
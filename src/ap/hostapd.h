@@ -84,6 +84,18 @@ struct hostapd_data {
 #define STA_HASH(sta) (sta[5])
 	struct sta_info *sta_hash[STA_HASH_SIZE];
 
+	/* Snapshot of the driver statistics for all stations, refreshed
+	 * periodically; see ap_sta_read_drv_data() */
+	struct os_reltime sta_stats_time;
+	unsigned int sta_stats_gen;
+
+	/* Indexes for finding stations based on RADIUS session attributes
+	 * (Acct-Session-Id, Chargeable-User-Identity, User-Name) */
+#define STA_SESSION_HASH_SIZE 256
+	struct sta_info *sta_acct_hash[STA_SESSION_HASH_SIZE];
+	struct sta_info *sta_cui_hash[STA_SESSION_HASH_SIZE];
+	struct sta_info *sta_identity_hash[STA_SESSION_HASH_SIZE];
+
 	/*
 	 * Bitfield for indicating which AIDs are allocated. Only AID values
 	 * 1-2007 are used and as such, the bit at index 0 corresponds to AID
@@ -114,7 +126,7 @@ struct hostapd_data {
 	struct eapol_authenticator *eapol_auth;
 
 	struct rsn_preauth_interface *preauth_iface;
-	time_t michael_mic_failure;
+	os_time_t michael_mic_failure;
 	int michael_mic_failures;
 	int tkip_countermeasures;
 
@@ -219,6 +231,10 @@ struct hostapd_iface {
 	struct mesh_conf *mconf;
 #endif
 
+	/* Result of the latest hostapd_reload_config() */
+	unsigned int reload_changes; /* HOSTAPD_BSS_CHANGE_* of all BSSes */
+	unsigned int reload_usec;
+
 	size_t num_bss;
 	struct hostapd_data **bss;
 
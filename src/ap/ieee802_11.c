@@ -411,9 +411,9 @@ static struct wpabuf * auth_build_token_req(struct hostapd_data *hapd,
 {
 	struct wpabuf *buf;
 	u8 *token;
-	struct os_time t;
+	struct os_reltime t;
 
-	os_get_time(&t);
+	os_get_reltime(&t);
 	if (hapd->last_sae_token_key_update == 0 ||
 	    t.sec > hapd->last_sae_token_key_update + 60) {
 		if (random_get_bytes(hapd->sae_token_key,
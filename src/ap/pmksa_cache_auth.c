@@ -15,26 +15,126 @@
 #include "sta_info.h"
 #include "ap_config.h"
 #include "pmksa_cache_auth.h"
+#include "pmksa_cache_shared.h"
 
 
 static const int pmksa_cache_max_entries = 1024;
 static const int dot11RSNAConfigPMKLifetime = 43200;
 
 struct rsn_pmksa_cache {
-#define PMKID_HASH_SIZE 128
-#define PMKID_HASH(pmkid) (unsigned int) ((pmkid)[0] & 0x7f)
+#define PMKID_HASH_SIZE 1024
+#define SPA_HASH_SIZE 256
 	struct rsn_pmksa_cache_entry *pmkid[PMKID_HASH_SIZE];
-	struct rsn_pmksa_cache_entry *pmksa;
+	struct rsn_pmksa_cache_entry *spa[SPA_HASH_SIZE];
+	/* Binary min-heap of the entries ordered by expiration time */
+	struct rsn_pmksa_cache_entry **heap;
+	int heap_size;
 	int pmksa_count;
 
 	void (*free_cb)(struct rsn_pmksa_cache_entry *entry, void *ctx);
 	void *ctx;
+
+	struct pmksa_cache_shared *shared;
+	u8 aa[ETH_ALEN];
 };
 
 
 static void pmksa_cache_set_expiration(struct rsn_pmksa_cache *pmksa);
 
 
+static unsigned int pmkid_hash(const u8 *pmkid)
+{
+	/* PMKID is a truncated HMAC output, so folding it is enough */
+	u32 h = WPA_GET_LE32(pmkid) ^ WPA_GET_LE32(pmkid + 4) ^
+		WPA_GET_LE32(pmkid + 8) ^ WPA_GET_LE32(pmkid + 12);
+	return (h ^ (h >> 16)) & (PMKID_HASH_SIZE - 1);
+}
+
+
+static unsigned int spa_hash(const u8 *spa)
+{
+	return (spa[0] ^ spa[1] ^ spa[2] ^ spa[3] ^ spa[4] ^ spa[5]) &
+		(SPA_HASH_SIZE - 1);
+}
+
+
+static void pmksa_heap_set(struct rsn_pmksa_cache *pmksa, int i,
+			   struct rsn_pmksa_cache_entry *entry)
+{
+	pmksa->heap[i] = entry;
+	entry->heap_idx = i;
+}
+
+
+static void pmksa_heap_up(struct rsn_pmksa_cache *pmksa, int i)
+{
+	struct rsn_pmksa_cache_entry *entry = pmksa->heap[i];
+
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (pmksa->heap[parent]->expiration <= entry->expiration)
+			break;
+		pmksa_heap_set(pmksa, i, pmksa->heap[parent]);
+		i = parent;
+	}
+	pmksa_heap_set(pmksa, i, entry);
+}
+
+
+static void pmksa_heap_down(struct rsn_pmksa_cache *pmksa, int i)
+{
+	struct rsn_pmksa_cache_entry *entry = pmksa->heap[i];
+
+	for (;;) {
+		int child = 2 * i + 1;
+		if (child >= pmksa->pmksa_count)
+			break;
+		if (child + 1 < pmksa->pmksa_count &&
+		    pmksa->heap[child + 1]->expiration <
+		    pmksa->heap[child]->expiration)
+			child++;
+		if (entry->expiration <= pmksa->heap[child]->expiration)
+			break;
+		pmksa_heap_set(pmksa, i, pmksa->heap[child]);
+		i = child;
+	}
+	pmksa_heap_set(pmksa, i, entry);
+}
+
+
+static int pmksa_heap_add(struct rsn_pmksa_cache *pmksa,
+			  struct rsn_pmksa_cache_entry *entry)
+{
+	if (pmksa->pmksa_count == pmksa->heap_size) {
+		struct rsn_pmksa_cache_entry **heap;
+		int size = pmksa->heap_size ? pmksa->heap_size * 2 : 16;
+		heap = os_realloc_array(pmksa->heap, size, sizeof(*heap));
+		if (heap == NULL)
+			return -1;
+		pmksa->heap = heap;
+		pmksa->heap_size = size;
+	}
+
+	pmksa_heap_set(pmksa, pmksa->pmksa_count++, entry);
+	pmksa_heap_up(pmksa, entry->heap_idx);
+	return 0;
+}
+
+
+static void pmksa_heap_del(struct rsn_pmksa_cache *pmksa,
+			   struct rsn_pmksa_cache_entry *entry)
+{
+	int i = entry->heap_idx;
+
+	pmksa->pmksa_count--;
+	if (i == pmksa->pmksa_count)
+		return;
+	pmksa_heap_set(pmksa, i, pmksa->heap[pmksa->pmksa_count]);
+	pmksa_heap_up(pmksa, i);
+	pmksa_heap_down(pmksa, pmksa->heap[i]->heap_idx);
+}
+
+
 static void _pmksa_cache_free_entry(struct rsn_pmksa_cache_entry *entry)
 {
 	if (entry == NULL)
@@ -51,39 +151,27 @@ static void _pmksa_cache_free_entry(struct rsn_pmksa_cache_entry *entry)
 static void pmksa_cache_free_entry(struct rsn_pmksa_cache *pmksa,
 				   struct rsn_pmksa_cache_entry *entry)
 {
-	struct rsn_pmksa_cache_entry *pos, *prev;
+	struct rsn_pmksa_cache_entry **pos;
 
-	pmksa->pmksa_count--;
 	pmksa->free_cb(entry, pmksa->ctx);
-	pos = pmksa->pmkid[PMKID_HASH(entry->pmkid)];
-	prev = NULL;
-	while (pos) {
-		if (pos == entry) {
-			if (prev != NULL) {
-				prev->hnext = pos->hnext;
-			} else {
-				pmksa->pmkid[PMKID_HASH(entry->pmkid)] =
-					pos->hnext;
-			}
+
+	for (pos = &pmksa->pmkid[pmkid_hash(entry->pmkid)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == entry) {
+			*pos = entry->hnext;
 			break;
 		}
-		prev = pos;
-		pos = pos->hnext;
 	}
 
-	pos = pmksa->pmksa;
-	prev = NULL;
-	while (pos) {
-		if (pos == entry) {
-			if (prev != NULL)
-				prev->next = pos->next;
-			else
-				pmksa->pmksa = pos->next;
+	for (pos = &pmksa->spa[spa_hash(entry->spa)]; *pos;
+	     pos = &(*pos)->shnext) {
+		if (*pos == entry) {
+			*pos = entry->shnext;
 			break;
 		}
-		prev = pos;
-		pos = pos->next;
 	}
+
+	pmksa_heap_del(pmksa, entry);
 	_pmksa_cache_free_entry(entry);
 }
 
@@ -91,13 +179,13 @@ static void pmksa_cache_free_entry(struct rsn_pmksa_cache *pmksa,
 static void pmksa_cache_expire(void *eloop_ctx, void *timeout_ctx)
 {
 	struct rsn_pmksa_cache *pmksa = eloop_ctx;
-	struct os_time now;
+	struct os_reltime now;
 
-	os_get_time(&now);
-	while (pmksa->pmksa && pmksa->pmksa->expiration <= now.sec) {
+	os_get_reltime(&now);
+	while (pmksa->pmksa_count && pmksa->heap[0]->expiration <= now.sec) {
 		wpa_printf(MSG_DEBUG, "RSN: expired PMKSA cache entry for "
-			   MACSTR, MAC2STR(pmksa->pmksa->spa));
-		pmksa_cache_free_entry(pmksa, pmksa->pmksa);
+			   MACSTR, MAC2STR(pmksa->heap[0]->spa));
+		pmksa_cache_free_entry(pmksa, pmksa->heap[0]);
 	}
 
 	pmksa_cache_set_expiration(pmksa);
@@ -107,13 +195,13 @@ static void pmksa_cache_expire(void *eloop_ctx, void *timeout_ctx)
 static void pmksa_cache_set_expiration(struct rsn_pmksa_cache *pmksa)
 {
 	int sec;
-	struct os_time now;
+	struct os_reltime now;
 
 	eloop_cancel_timeout(pmksa_cache_expire, pmksa, NULL);
-	if (pmksa->pmksa == NULL)
+	if (pmksa->pmksa_count == 0)
 		return;
-	os_get_time(&now);
-	sec = pmksa->pmksa->expiration - now.sec;
+	os_get_reltime(&now);
+	sec = pmksa->heap[0]->expiration - now.sec;
 	if (sec < 0)
 		sec = 0;
 	eloop_register_timeout(sec + 1, 0, pmksa_cache_expire, pmksa, NULL);
@@ -184,36 +272,27 @@ void pmksa_cache_to_eapol_data(struct rsn_pmksa_cache_entry *entry,
 }
 
 
-static void pmksa_cache_link_entry(struct rsn_pmksa_cache *pmksa,
-				   struct rsn_pmksa_cache_entry *entry)
+static int pmksa_cache_link_entry(struct rsn_pmksa_cache *pmksa,
+				  struct rsn_pmksa_cache_entry *entry)
 {
-	struct rsn_pmksa_cache_entry *pos, *prev;
+	unsigned int hash;
 
-	/* Add the new entry; order by expiration time */
-	pos = pmksa->pmksa;
-	prev = NULL;
-	while (pos) {
-		if (pos->expiration > entry->expiration)
-			break;
-		prev = pos;
-		pos = pos->next;
-	}
-	if (prev == NULL) {
-		entry->next = pmksa->pmksa;
-		pmksa->pmksa = entry;
-	} else {
-		entry->next = prev->next;
-		prev->next = entry;
-	}
-	entry->hnext = pmksa->pmkid[PMKID_HASH(entry->pmkid)];
-	pmksa->pmkid[PMKID_HASH(entry->pmkid)] = entry;
+	if (pmksa_heap_add(pmksa, entry) < 0)
+		return -1;
+
+	hash = pmkid_hash(entry->pmkid);
+	entry->hnext = pmksa->pmkid[hash];
+	pmksa->pmkid[hash] = entry;
+	hash = spa_hash(entry->spa);
+	entry->shnext = pmksa->spa[hash];
+	pmksa->spa[hash] = entry;
 
-	pmksa->pmksa_count++;
-	if (prev == NULL)
+	if (entry->heap_idx == 0)
 		pmksa_cache_set_expiration(pmksa);
 	wpa_printf(MSG_DEBUG, "RSN: added PMKSA cache entry for " MACSTR,
 		   MAC2STR(entry->spa));
 	wpa_hexdump(MSG_DEBUG, "RSN: added PMKID", entry->pmkid, PMKID_LEN);
+	return 0;
 }
 
 
@@ -241,7 +320,7 @@ pmksa_cache_auth_add(struct rsn_pmksa_cache *pmksa,
 		struct eapol_state_machine *eapol, int akmp)
 {
 	struct rsn_pmksa_cache_entry *entry, *pos;
-	struct os_time now;
+	struct os_reltime now;
 
 	if (pmk_len > PMK_LEN)
 		return NULL;
@@ -253,7 +332,7 @@ pmksa_cache_auth_add(struct rsn_pmksa_cache *pmksa,
 	entry->pmk_len = pmk_len;
 	rsn_pmkid(pmk, pmk_len, aa, spa, entry->pmkid,
 		  wpa_key_mgmt_sha256(akmp));
-	os_get_time(&now);
+	os_get_reltime(&now);
 	entry->expiration = now.sec;
 	if (session_timeout > 0)
 		entry->expiration += session_timeout;
@@ -269,15 +348,19 @@ pmksa_cache_auth_add(struct rsn_pmksa_cache *pmksa,
 	if (pos)
 		pmksa_cache_free_entry(pmksa, pos);
 
-	if (pmksa->pmksa_count >= pmksa_cache_max_entries && pmksa->pmksa) {
+	if (pmksa->pmksa_count >= pmksa_cache_max_entries) {
 		/* Remove the oldest entry to make room for the new entry */
 		wpa_printf(MSG_DEBUG, "RSN: removed the oldest PMKSA cache "
 			   "entry (for " MACSTR ") to make room for new one",
-			   MAC2STR(pmksa->pmksa->spa));
-		pmksa_cache_free_entry(pmksa, pmksa->pmksa);
+			   MAC2STR(pmksa->heap[0]->spa));
+		pmksa_cache_free_entry(pmksa, pmksa->heap[0]);
 	}
 
-	pmksa_cache_link_entry(pmksa, entry);
+	if (pmksa_cache_link_entry(pmksa, entry) < 0) {
+		_pmksa_cache_free_entry(entry);
+		return NULL;
+	}
+	pmksa_cache_shared_store(pmksa->shared, entry, aa);
 
 	return entry;
 }
@@ -317,7 +400,11 @@ pmksa_cache_add_okc(struct rsn_pmksa_cache *pmksa,
 	entry->vlan_id = old_entry->vlan_id;
 	entry->opportunistic = 1;
 
-	pmksa_cache_link_entry(pmksa, entry);
+	if (pmksa_cache_link_entry(pmksa, entry) < 0) {
+		_pmksa_cache_free_entry(entry);
+		return NULL;
+	}
+	pmksa_cache_shared_store(pmksa->shared, entry, aa);
 
 	return entry;
 }
@@ -329,25 +416,60 @@ pmksa_cache_add_okc(struct rsn_pmksa_cache *pmksa,
  */
 void pmksa_cache_auth_deinit(struct rsn_pmksa_cache *pmksa)
 {
-	struct rsn_pmksa_cache_entry *entry, *prev;
 	int i;
 
 	if (pmksa == NULL)
 		return;
 
-	entry = pmksa->pmksa;
-	while (entry) {
-		prev = entry;
-		entry = entry->next;
-		_pmksa_cache_free_entry(prev);
-	}
+	for (i = 0; i < pmksa->pmksa_count; i++)
+		_pmksa_cache_free_entry(pmksa->heap[i]);
+	os_free(pmksa->heap);
 	eloop_cancel_timeout(pmksa_cache_expire, pmksa, NULL);
-	for (i = 0; i < PMKID_HASH_SIZE; i++)
-		pmksa->pmkid[i] = NULL;
+	pmksa_cache_shared_close(pmksa->shared);
 	os_free(pmksa);
 }
 
 
+/*
+ * Import an entry for the Supplicant from the shared PMKSA cache if the PMK
+ * matches the PMKID the Supplicant uses with Authenticator aa. Unless okc is
+ * set, the entry must have been stored for the same Authenticator.
+ */
+static struct rsn_pmksa_cache_entry *
+pmksa_cache_import(struct rsn_pmksa_cache *pmksa, const u8 *spa,
+		   const u8 *aa, const u8 *pmkid, int okc)
+{
+	struct rsn_pmksa_cache_entry *entry;
+	u8 shared_aa[ETH_ALEN], new_pmkid[PMKID_LEN];
+
+	entry = pmksa_cache_shared_fetch(pmksa->shared, spa, shared_aa);
+	if (entry == NULL)
+		return NULL;
+
+	if (!okc && os_memcmp(shared_aa, aa, ETH_ALEN) != 0)
+		goto fail;
+	rsn_pmkid(entry->pmk, entry->pmk_len, aa, spa, new_pmkid,
+		  wpa_key_mgmt_sha256(entry->akmp));
+	if (os_memcmp(new_pmkid, pmkid, PMKID_LEN) != 0)
+		goto fail;
+
+	rsn_pmkid(entry->pmk, entry->pmk_len, shared_aa, spa, entry->pmkid,
+		  wpa_key_mgmt_sha256(entry->akmp));
+	if (pmksa_cache_auth_get(pmksa, NULL, entry->pmkid) ||
+	    pmksa_cache_link_entry(pmksa, entry) < 0)
+		goto fail;
+
+	wpa_printf(MSG_DEBUG, "RSN: imported PMKSA cache entry for " MACSTR
+		   " (AA " MACSTR ") from shared cache",
+		   MAC2STR(spa), MAC2STR(shared_aa));
+	return entry;
+
+fail:
+	_pmksa_cache_free_entry(entry);
+	return NULL;
+}
+
+
 /**
  * pmksa_cache_auth_get - Fetch a PMKSA cache entry
  * @pmksa: Pointer to PMKSA cache data from pmksa_cache_auth_init()
@@ -361,19 +483,28 @@ pmksa_cache_auth_get(struct rsn_pmksa_cache *pmksa,
 {
 	struct rsn_pmksa_cache_entry *entry;
 
-	if (pmkid)
-		entry = pmksa->pmkid[PMKID_HASH(pmkid)];
-	else
-		entry = pmksa->pmksa;
-	while (entry) {
-		if ((spa == NULL ||
-		     os_memcmp(entry->spa, spa, ETH_ALEN) == 0) &&
-		    (pmkid == NULL ||
-		     os_memcmp(entry->pmkid, pmkid, PMKID_LEN) == 0))
-			return entry;
-		entry = pmkid ? entry->hnext : entry->next;
-	}
-	return NULL;
+	if (pmkid) {
+		for (entry = pmksa->pmkid[pmkid_hash(pmkid)]; entry;
+		     entry = entry->hnext) {
+			if ((spa == NULL ||
+			     os_memcmp(entry->spa, spa, ETH_ALEN) == 0) &&
+			    os_memcmp(entry->pmkid, pmkid, PMKID_LEN) == 0)
+				return entry;
+		}
+	} else if (spa) {
+		for (entry = pmksa->spa[spa_hash(spa)]; entry;
+		     entry = entry->shnext) {
+			if (os_memcmp(entry->spa, spa, ETH_ALEN) == 0)
+				return entry;
+		}
+	} else
+		return pmksa->pmksa_count ? pmksa->heap[0] : NULL;
+
+	if (spa == NULL || pmkid == NULL || pmksa->shared == NULL)
+		return NULL;
+
+	/* Entry may have been added by another process or before a restart */
+	return pmksa_cache_import(pmksa, spa, pmksa->aa, pmkid, 0);
 }
 
 
@@ -394,17 +525,44 @@ struct rsn_pmksa_cache_entry * pmksa_cache_get_okc(
 	struct rsn_pmksa_cache_entry *entry;
 	u8 new_pmkid[PMKID_LEN];
 
-	entry = pmksa->pmksa;
-	while (entry) {
+	for (entry = pmksa->spa[spa_hash(spa)]; entry; entry = entry->shnext) {
 		if (os_memcmp(entry->spa, spa, ETH_ALEN) != 0)
 			continue;
 		rsn_pmkid(entry->pmk, entry->pmk_len, aa, spa, new_pmkid,
 			  wpa_key_mgmt_sha256(entry->akmp));
 		if (os_memcmp(new_pmkid, pmkid, PMKID_LEN) == 0)
 			return entry;
-		entry = entry->next;
 	}
-	return NULL;
+
+	if (pmksa->shared == NULL)
+		return NULL;
+
+	/* PMK from another BSS sharing the cache (e.g., the other radio) */
+	return pmksa_cache_import(pmksa, spa, aa, pmkid, 1);
+}
+
+
+/**
+ * pmksa_cache_auth_attach_shared - Use a shared PMKSA cache file
+ * @pmksa: Pointer to PMKSA cache data from pmksa_cache_auth_init()
+ * @fname: Path to the cache file; created if it does not exist
+ * @aa: Authenticator address
+ * Returns: 0 on success, -1 on failure
+ *
+ * New PMKSA cache entries are also written to the shared file and entries
+ * that are not found locally are looked up from it. This allows PMKSA
+ * caching to work across hostapd restarts and between BSSes in different
+ * hostapd processes that use the same file.
+ */
+int pmksa_cache_auth_attach_shared(struct rsn_pmksa_cache *pmksa,
+				   const char *fname, const u8 *aa)
+{
+	pmksa_cache_shared_close(pmksa->shared);
+	pmksa->shared = pmksa_cache_shared_open(fname);
+	if (pmksa->shared == NULL)
+		return -1;
+	os_memcpy(pmksa->aa, aa, ETH_ALEN);
+	return 0;
 }
 
 
@@ -15,7 +15,9 @@
  * struct rsn_pmksa_cache_entry - PMKSA cache entry
  */
 struct rsn_pmksa_cache_entry {
-	struct rsn_pmksa_cache_entry *next, *hnext;
+	struct rsn_pmksa_cache_entry *hnext; /* PMKID hash */
+	struct rsn_pmksa_cache_entry *shnext; /* Supplicant address hash */
+	int heap_idx; /* position in the expiration heap */
 	u8 pmkid[PMKID_LEN];
 	u8 pmk[PMK_LEN];
 	size_t pmk_len;
@@ -53,6 +55,8 @@ struct rsn_pmksa_cache_entry *
 pmksa_cache_add_okc(struct rsn_pmksa_cache *pmksa,
 		    const struct rsn_pmksa_cache_entry *old_entry,
 		    const u8 *aa, const u8 *pmkid);
+int pmksa_cache_auth_attach_shared(struct rsn_pmksa_cache *pmksa,
+				   const char *fname, const u8 *aa);
 void pmksa_cache_to_eapol_data(struct rsn_pmksa_cache_entry *entry,
 			       struct eapol_state_machine *eapol);
 
@@ -0,0 +1,368 @@
+/*
+ * hostapd - Shared PMKSA cache file
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * PMKSA cache entries are stored in a file that is mapped into memory with
+ * MAP_SHARED. Multiple hostapd processes (e.g., one per radio) can use the
+ * same file and the entries survive a restart of hostapd when the file is
+ * on a persistent (or tmpfs) file system. There is one slot per Supplicant
+ * address found with a short linear probe from a hash of the address.
+ *
+ * Writers serialize with flock() on the file. Readers do not take any lock;
+ * each slot has a sequence counter that is odd while the slot is being
+ * written and readers retry if the counter changed while they were copying
+ * the slot.
+ */
+
+#include "utils/includes.h"
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "utils/common.h"
+#include "common/wpa_common.h"
+#include "eapol_auth/eapol_auth_sm.h"
+#include "pmksa_cache_auth.h"
+#include "pmksa_cache_shared.h"
+
+
+#define PMKSA_SHARED_MAGIC 0x504d4b53 /* "PMKS" */
+#define PMKSA_SHARED_VERSION 1
+#define PMKSA_SHARED_ENTRIES 1024
+#define PMKSA_SHARED_PROBE 8
+#define PMKSA_SHARED_MAX_ID 128
+#define PMKSA_SHARED_READ_RETRIES 10
+
+struct pmksa_shared_hdr {
+	u32 magic;
+	u32 version;
+	u32 num_entries;
+	u32 entry_len;
+};
+
+struct pmksa_shared_entry {
+	u32 seq; /* odd while the entry is being updated */
+	u32 in_use;
+	u64 expiration;
+	u8 spa[ETH_ALEN];
+	u8 aa[ETH_ALEN];
+	u8 pmk[PMK_LEN];
+	u8 pmk_len;
+	u8 eap_type_authsrv;
+	u8 identity_len;
+	u8 cui_len;
+	u32 akmp;
+	s32 vlan_id;
+	u8 identity[PMKSA_SHARED_MAX_ID];
+	u8 cui[PMKSA_SHARED_MAX_ID];
+};
+
+struct pmksa_cache_shared {
+	int fd;
+	void *map;
+	size_t map_len;
+	struct pmksa_shared_entry *entries;
+	unsigned int num_entries;
+};
+
+
+static unsigned int pmksa_shared_slot(struct pmksa_cache_shared *shared,
+				      const u8 *spa)
+{
+	u32 h = 2166136261U;
+	int i;
+
+	for (i = 0; i < ETH_ALEN; i++) {
+		h ^= spa[i];
+		h *= 16777619;
+	}
+	return h % shared->num_entries;
+}
+
+
+static int pmksa_shared_read(struct pmksa_shared_entry *slot,
+			     struct pmksa_shared_entry *copy)
+{
+	volatile u32 *seq = &slot->seq;
+	int i;
+	u32 val;
+
+	for (i = 0; i < PMKSA_SHARED_READ_RETRIES; i++) {
+		val = *seq;
+		if (val & 1)
+			continue;
+		__sync_synchronize();
+		os_memcpy(copy, slot, sizeof(*copy));
+		__sync_synchronize();
+		if (*seq == val)
+			return 0;
+	}
+
+	return -1;
+}
+
+
+static void pmksa_shared_write(struct pmksa_shared_entry *slot,
+			       const struct pmksa_shared_entry *data)
+{
+	volatile u32 *seq = &slot->seq;
+	u32 val = *seq;
+
+	*seq = val + 1;
+	__sync_synchronize();
+	os_memcpy((u8 *) slot + sizeof(slot->seq),
+		  (const u8 *) data + sizeof(data->seq),
+		  sizeof(*slot) - sizeof(slot->seq));
+	__sync_synchronize();
+	*seq = val + 2;
+}
+
+
+/**
+ * pmksa_cache_shared_open - Open or create a shared PMKSA cache file
+ * @fname: Path to the file
+ * Returns: Pointer to the shared cache or %NULL on failure
+ */
+struct pmksa_cache_shared * pmksa_cache_shared_open(const char *fname)
+{
+	struct pmksa_cache_shared *shared;
+	struct pmksa_shared_hdr hdr;
+	struct stat st;
+	size_t len;
+
+	shared = os_zalloc(sizeof(*shared));
+	if (shared == NULL)
+		return NULL;
+
+	shared->fd = open(fname, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (shared->fd < 0) {
+		wpa_printf(MSG_ERROR, "RSN: Could not open shared PMKSA cache "
+			   "'%s': %s", fname, strerror(errno));
+		os_free(shared);
+		return NULL;
+	}
+
+	if (flock(shared->fd, LOCK_EX) < 0 || fstat(shared->fd, &st) < 0) {
+		wpa_printf(MSG_ERROR, "RSN: Shared PMKSA cache '%s': %s",
+			   fname, strerror(errno));
+		goto fail;
+	}
+
+	if (st.st_size == 0) {
+		hdr.magic = PMKSA_SHARED_MAGIC;
+		hdr.version = PMKSA_SHARED_VERSION;
+		hdr.num_entries = PMKSA_SHARED_ENTRIES;
+		hdr.entry_len = sizeof(struct pmksa_shared_entry);
+		len = sizeof(hdr) + hdr.num_entries * hdr.entry_len;
+		if (write(shared->fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+		    ftruncate(shared->fd, len) < 0) {
+			wpa_printf(MSG_ERROR, "RSN: Could not initialize "
+				   "shared PMKSA cache '%s': %s",
+				   fname, strerror(errno));
+			goto fail;
+		}
+	} else {
+		if (read(shared->fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+		    hdr.magic != PMKSA_SHARED_MAGIC ||
+		    hdr.version != PMKSA_SHARED_VERSION ||
+		    hdr.entry_len != sizeof(struct pmksa_shared_entry) ||
+		    hdr.num_entries == 0 ||
+		    (size_t) st.st_size !=
+		    sizeof(hdr) + hdr.num_entries * hdr.entry_len) {
+			wpa_printf(MSG_ERROR, "RSN: Invalid shared PMKSA "
+				   "cache file '%s'", fname);
+			goto fail;
+		}
+		len = st.st_size;
+	}
+
+	shared->map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED,
+			   shared->fd, 0);
+	if (shared->map == MAP_FAILED) {
+		wpa_printf(MSG_ERROR, "RSN: mmap of shared PMKSA cache "
+			   "failed: %s", strerror(errno));
+		goto fail;
+	}
+	flock(shared->fd, LOCK_UN);
+
+	shared->map_len = len;
+	shared->entries = (struct pmksa_shared_entry *)
+		((u8 *) shared->map + sizeof(hdr));
+	shared->num_entries = hdr.num_entries;
+	wpa_printf(MSG_DEBUG, "RSN: Using shared PMKSA cache '%s' (%u "
+		   "entries)", fname, shared->num_entries);
+
+	return shared;
+
+fail:
+	close(shared->fd);
+	os_free(shared);
+	return NULL;
+}
+
+
+/**
+ * pmksa_cache_shared_close - Unmap a shared PMKSA cache file
+ * @shared: Pointer to the shared cache from pmksa_cache_shared_open()
+ */
+void pmksa_cache_shared_close(struct pmksa_cache_shared *shared)
+{
+	if (shared == NULL)
+		return;
+	munmap(shared->map, shared->map_len);
+	close(shared->fd);
+	os_free(shared);
+}
+
+
+/**
+ * pmksa_cache_shared_store - Store a PMKSA cache entry into the shared cache
+ * @shared: Pointer to the shared cache from pmksa_cache_shared_open()
+ * @entry: PMKSA cache entry
+ * @aa: Authenticator address that was used to derive the PMKID
+ * Returns: 0 on success, -1 on failure
+ *
+ * An existing entry for the same Supplicant is replaced. Otherwise, a free
+ * or expired slot is used and if none is available, the slot that expires
+ * first is overwritten.
+ */
+int pmksa_cache_shared_store(struct pmksa_cache_shared *shared,
+			     const struct rsn_pmksa_cache_entry *entry,
+			     const u8 *aa)
+{
+	struct pmksa_shared_entry data, *slot, *use = NULL;
+	struct os_time now;
+	struct os_reltime rel;
+	unsigned int start, i;
+	int free_slot, use_free = 0;
+
+	if (shared == NULL)
+		return -1;
+
+	/*
+	 * Entries use the monotonic clock locally, but the shared file is
+	 * shared between processes and may outlive a reboot, so it uses wall
+	 * clock time.
+	 */
+	os_get_time(&now);
+	os_get_reltime(&rel);
+
+	os_memset(&data, 0, sizeof(data));
+	data.in_use = 1;
+	data.expiration = entry->expiration - rel.sec + now.sec;
+	os_memcpy(data.spa, entry->spa, ETH_ALEN);
+	os_memcpy(data.aa, aa, ETH_ALEN);
+	os_memcpy(data.pmk, entry->pmk, entry->pmk_len);
+	data.pmk_len = entry->pmk_len;
+	data.eap_type_authsrv = entry->eap_type_authsrv;
+	data.akmp = entry->akmp;
+	data.vlan_id = entry->vlan_id;
+	if (entry->identity && entry->identity_len <= PMKSA_SHARED_MAX_ID) {
+		os_memcpy(data.identity, entry->identity,
+			  entry->identity_len);
+		data.identity_len = entry->identity_len;
+	}
+	if (entry->cui && wpabuf_len(entry->cui) <= PMKSA_SHARED_MAX_ID) {
+		os_memcpy(data.cui, wpabuf_head(entry->cui),
+			  wpabuf_len(entry->cui));
+		data.cui_len = wpabuf_len(entry->cui);
+	}
+
+	if (flock(shared->fd, LOCK_EX) < 0)
+		return -1;
+
+	start = pmksa_shared_slot(shared, entry->spa);
+	for (i = 0; i < PMKSA_SHARED_PROBE; i++) {
+		slot = &shared->entries[(start + i) % shared->num_entries];
+		if (slot->in_use &&
+		    os_memcmp(slot->spa, entry->spa, ETH_ALEN) == 0) {
+			use = slot;
+			break;
+		}
+		free_slot = !slot->in_use ||
+			slot->expiration <= (u64) now.sec;
+		if (use == NULL || (free_slot && !use_free) ||
+		    (!free_slot && !use_free &&
+		     slot->expiration < use->expiration)) {
+			use = slot;
+			use_free = free_slot;
+		}
+	}
+	pmksa_shared_write(use, &data);
+
+	flock(shared->fd, LOCK_UN);
+	os_memset(&data, 0, sizeof(data));
+
+	return 0;
+}
+
+
+/**
+ * pmksa_cache_shared_fetch - Fetch a PMKSA cache entry from the shared cache
+ * @shared: Pointer to the shared cache from pmksa_cache_shared_open()
+ * @spa: Supplicant address
+ * @aa: Buffer for returning the Authenticator address of the entry
+ * Returns: Newly allocated PMKSA cache entry (without PMKID) or %NULL if no
+ * valid entry was found for the Supplicant
+ */
+struct rsn_pmksa_cache_entry *
+pmksa_cache_shared_fetch(struct pmksa_cache_shared *shared, const u8 *spa,
+			 u8 *aa)
+{
+	struct pmksa_shared_entry data;
+	struct rsn_pmksa_cache_entry *entry = NULL;
+	struct os_time now;
+	struct os_reltime rel;
+	unsigned int start, i;
+
+	if (shared == NULL)
+		return NULL;
+
+	os_get_time(&now);
+	os_get_reltime(&rel);
+	start = pmksa_shared_slot(shared, spa);
+	for (i = 0; i < PMKSA_SHARED_PROBE; i++) {
+		if (pmksa_shared_read(
+			    &shared->entries[(start + i) % shared->num_entries],
+			    &data) < 0)
+			continue;
+		if (data.in_use && os_memcmp(data.spa, spa, ETH_ALEN) == 0)
+			break;
+	}
+	/* The file may be modified by other processes; do not trust the
+	 * lengths in it */
+	if (i == PMKSA_SHARED_PROBE || data.expiration <= (u64) now.sec ||
+	    data.pmk_len > PMK_LEN ||
+	    data.identity_len > PMKSA_SHARED_MAX_ID ||
+	    data.cui_len > PMKSA_SHARED_MAX_ID)
+		goto out;
+
+	entry = os_zalloc(sizeof(*entry));
+	if (entry == NULL)
+		goto out;
+	os_memcpy(entry->pmk, data.pmk, data.pmk_len);
+	entry->pmk_len = data.pmk_len;
+	entry->expiration = data.expiration - now.sec + rel.sec;
+	entry->akmp = data.akmp;
+	os_memcpy(entry->spa, spa, ETH_ALEN);
+	entry->eap_type_authsrv = data.eap_type_authsrv;
+	entry->vlan_id = data.vlan_id;
+	if (data.identity_len) {
+		entry->identity = os_malloc(data.identity_len);
+		if (entry->identity) {
+			os_memcpy(entry->identity, data.identity,
+				  data.identity_len);
+			entry->identity_len = data.identity_len;
+		}
+	}
+	if (data.cui_len)
+		entry->cui = wpabuf_alloc_copy(data.cui, data.cui_len);
+	os_memcpy(aa, data.aa, ETH_ALEN);
+
+out:
+	os_memset(&data, 0, sizeof(data));
+	return entry;
+}
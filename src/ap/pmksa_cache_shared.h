@@ -0,0 +1,57 @@
+/*
+ * hostapd - Shared PMKSA cache file
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef PMKSA_CACHE_SHARED_H
+#define PMKSA_CACHE_SHARED_H
+
+struct rsn_pmksa_cache_entry;
+struct pmksa_cache_shared;
+
+#ifdef CONFIG_SHARED_PMKSA_CACHE
+
+struct pmksa_cache_shared * pmksa_cache_shared_open(const char *fname);
+void pmksa_cache_shared_close(struct pmksa_cache_shared *shared);
+int pmksa_cache_shared_store(struct pmksa_cache_shared *shared,
+			     const struct rsn_pmksa_cache_entry *entry,
+			     const u8 *aa);
+struct rsn_pmksa_cache_entry *
+pmksa_cache_shared_fetch(struct pmksa_cache_shared *shared, const u8 *spa,
+			 u8 *aa);
+
+#else /* CONFIG_SHARED_PMKSA_CACHE */
+
+static inline struct pmksa_cache_shared *
+pmksa_cache_shared_open(const char *fname)
+{
+	wpa_printf(MSG_ERROR, "Shared PMKSA cache not supported in this "
+		   "build (CONFIG_SHARED_PMKSA_CACHE)");
+	return NULL;
+}
+
+static inline void pmksa_cache_shared_close(struct pmksa_cache_shared *shared)
+{
+}
+
+static inline int
+pmksa_cache_shared_store(struct pmksa_cache_shared *shared,
+			 const struct rsn_pmksa_cache_entry *entry,
+			 const u8 *aa)
+{
+	return -1;
+}
+
+static inline struct rsn_pmksa_cache_entry *
+pmksa_cache_shared_fetch(struct pmksa_cache_shared *shared, const u8 *spa,
+			 u8 *aa)
+{
+	return NULL;
+}
+
+#endif /* CONFIG_SHARED_PMKSA_CACHE */
+
+#endif /* PMKSA_CACHE_SHARED_H */
@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/mempool.h"
 #include "common/ieee802_11_defs.h"
 #include "common/wpa_ctrl.h"
 #include "common/sae.h"
@@ -37,9 +38,13 @@
 #include "../wpa_supplicant/mesh_rsn.h"
 #endif
 
+/* Interval (in seconds) for refreshing the station statistics snapshot */
+#define AP_STA_STATS_INTERVAL 5
+
 static void ap_sta_remove_in_other_bss(struct hostapd_data *hapd,
 				       struct sta_info *sta);
 static void ap_handle_session_timer(void *eloop_ctx, void *timeout_ctx);
+static void ap_sta_stats_timer(void *eloop_ctx, void *timeout_ctx);
 static void ap_sta_deauth_cb_timeout(void *eloop_ctx, void *timeout_ctx);
 static void ap_sta_disassoc_cb_timeout(void *eloop_ctx, void *timeout_ctx);
 #ifdef CONFIG_IEEE80211W
@@ -47,6 +52,9 @@ static void ap_sa_query_timer(void *eloop_ctx, void *timeout_ctx);
 #endif /* CONFIG_IEEE80211W */
 static int ap_sta_remove(struct hostapd_data *hapd, struct sta_info *sta);
 
+static struct mempool sta_info_pool =
+	MEMPOOL_INIT("sta_info", sizeof(struct sta_info));
+
 int ap_for_each_sta(struct hostapd_data *hapd,
 		    int (*cb)(struct hostapd_data *hapd, struct sta_info *sta,
 			      void *ctx),
@@ -123,6 +131,254 @@ static void ap_sta_hash_del(struct hostapd_data *hapd, struct sta_info *sta)
 }
 
 
+enum ap_sta_session_idx {
+	AP_STA_SESSION_ACCT, AP_STA_SESSION_CUI, AP_STA_SESSION_IDENTITY
+};
+
+
+static struct sta_info ** ap_sta_session_bucket(struct hostapd_data *hapd,
+						enum ap_sta_session_idx idx,
+						unsigned int hash)
+{
+	switch (idx) {
+	case AP_STA_SESSION_ACCT:
+		return &hapd->sta_acct_hash[hash];
+	case AP_STA_SESSION_CUI:
+		return &hapd->sta_cui_hash[hash];
+	case AP_STA_SESSION_IDENTITY:
+		break;
+	}
+	return &hapd->sta_identity_hash[hash];
+}
+
+
+static struct sta_info ** ap_sta_session_hnext(struct sta_info *sta,
+					       enum ap_sta_session_idx idx)
+{
+	switch (idx) {
+	case AP_STA_SESSION_ACCT:
+		return &sta->acct_hnext;
+	case AP_STA_SESSION_CUI:
+		return &sta->cui_hnext;
+	case AP_STA_SESSION_IDENTITY:
+		break;
+	}
+	return &sta->identity_hnext;
+}
+
+
+static void ap_sta_session_link(struct hostapd_data *hapd,
+				struct sta_info *sta,
+				enum ap_sta_session_idx idx, unsigned int hash)
+{
+	struct sta_info **bucket = ap_sta_session_bucket(hapd, idx, hash);
+
+	*ap_sta_session_hnext(sta, idx) = *bucket;
+	*bucket = sta;
+}
+
+
+static void ap_sta_session_unlink(struct hostapd_data *hapd,
+				  struct sta_info *sta,
+				  enum ap_sta_session_idx idx, unsigned int hash)
+{
+	struct sta_info **s;
+
+	for (s = ap_sta_session_bucket(hapd, idx, hash); *s;
+	     s = ap_sta_session_hnext(*s, idx)) {
+		if (*s == sta) {
+			*s = *ap_sta_session_hnext(sta, idx);
+			break;
+		}
+	}
+	*ap_sta_session_hnext(sta, idx) = NULL;
+}
+
+
+static unsigned int ap_sta_session_hash(const u8 *data, size_t len)
+{
+	u32 hash = 2166136261U; /* FNV-1a */
+
+	while (len--) {
+		hash ^= *data++;
+		hash *= 16777619;
+	}
+
+	return hash & (STA_SESSION_HASH_SIZE - 1);
+}
+
+
+#define AP_STA_ACCT_HASH(lo) ((lo) & (STA_SESSION_HASH_SIZE - 1))
+
+/**
+ * ap_get_sta_acct_session - Find a station based on Acct-Session-Id
+ * @hapd: hostapd BSS data
+ * @id: Acct-Session-Id as used in RADIUS messages ("XXXXXXXX-XXXXXXXX")
+ * @id_len: Length of id in octets
+ * Returns: Pointer to the station or %NULL if not found
+ */
+struct sta_info * ap_get_sta_acct_session(struct hostapd_data *hapd,
+					  const u8 *id, size_t id_len)
+{
+	struct sta_info *sta;
+	char buf[20];
+	u8 lo[4];
+
+	if (id_len != 17)
+		return NULL;
+	os_memcpy(buf, id + 9, 8);
+	buf[8] = '\0';
+	if (hexstr2bin(buf, lo, sizeof(lo)) < 0)
+		return NULL;
+
+	for (sta = hapd->sta_acct_hash[AP_STA_ACCT_HASH(WPA_GET_BE32(lo))];
+	     sta; sta = sta->acct_hnext) {
+		os_snprintf(buf, sizeof(buf), "%08X-%08X",
+			    sta->acct_session_id_hi, sta->acct_session_id_lo);
+		if (os_memcmp(id, buf, 17) == 0)
+			return sta;
+	}
+
+	return NULL;
+}
+
+
+static int ap_sta_for_each_session(struct hostapd_data *hapd,
+				   enum ap_sta_session_idx idx,
+				   const u8 *val, size_t len,
+				   int (*cb)(struct hostapd_data *hapd,
+					     struct sta_info *sta, void *ctx),
+				   void *ctx)
+{
+	struct sta_info *sta, *next;
+	const u8 *cur;
+	size_t cur_len;
+	struct wpabuf *cui;
+
+	sta = *ap_sta_session_bucket(hapd, idx, ap_sta_session_hash(val, len));
+	for (; sta; sta = next) {
+		/* cb may remove the station from the index */
+		next = *ap_sta_session_hnext(sta, idx);
+
+		if (idx == AP_STA_SESSION_CUI) {
+			cui = ieee802_1x_get_radius_cui(sta->eapol_sm);
+			cur = cui ? wpabuf_head(cui) : NULL;
+			cur_len = cui ? wpabuf_len(cui) : 0;
+		} else {
+			cur = ieee802_1x_get_identity(sta->eapol_sm, &cur_len);
+		}
+		if (cur == NULL || cur_len != len ||
+		    os_memcmp(cur, val, len) != 0)
+			continue;
+
+		if (cb(hapd, sta, ctx))
+			return 1;
+	}
+
+	return 0;
+}
+
+
+/**
+ * ap_sta_for_each_cui - Iterate over stations with the given CUI
+ * @hapd: hostapd BSS data
+ * @cui: Chargeable-User-Identity
+ * @cui_len: Length of cui in octets
+ * @cb: Callback function; returning non-zero stops the iteration
+ * @ctx: Context pointer for cb
+ * Returns: 1 if the iteration was stopped by cb, 0 otherwise
+ *
+ * Only authorized stations (see ap_sta_session_index_update()) are included.
+ */
+int ap_sta_for_each_cui(struct hostapd_data *hapd, const u8 *cui,
+			size_t cui_len,
+			int (*cb)(struct hostapd_data *hapd,
+				  struct sta_info *sta, void *ctx),
+			void *ctx)
+{
+	return ap_sta_for_each_session(hapd, AP_STA_SESSION_CUI, cui, cui_len,
+				       cb, ctx);
+}
+
+
+/**
+ * ap_sta_for_each_identity - Iterate over stations with the given identity
+ * @hapd: hostapd BSS data
+ * @identity: IEEE 802.1X identity (User-Name)
+ * @identity_len: Length of identity in octets
+ * @cb: Callback function; returning non-zero stops the iteration
+ * @ctx: Context pointer for cb
+ * Returns: 1 if the iteration was stopped by cb, 0 otherwise
+ */
+int ap_sta_for_each_identity(struct hostapd_data *hapd, const u8 *identity,
+			     size_t identity_len,
+			     int (*cb)(struct hostapd_data *hapd,
+				       struct sta_info *sta, void *ctx),
+			     void *ctx)
+{
+	return ap_sta_for_each_session(hapd, AP_STA_SESSION_IDENTITY,
+				       identity, identity_len, cb, ctx);
+}
+
+
+/**
+ * ap_sta_session_index_update - Index the station by its CUI and identity
+ * @hapd: hostapd BSS data
+ * @sta: The station
+ *
+ * This is called when the station gets authorized, i.e., once the IEEE 802.1X
+ * identity and the CUI from the authentication server are known.
+ */
+void ap_sta_session_index_update(struct hostapd_data *hapd,
+				 struct sta_info *sta)
+{
+	struct wpabuf *cui;
+	u8 *identity;
+	size_t identity_len;
+
+	ap_sta_session_index_clear(hapd, sta);
+
+	cui = ieee802_1x_get_radius_cui(sta->eapol_sm);
+	if (cui) {
+		sta->cui_hash = ap_sta_session_hash(wpabuf_head(cui),
+						    wpabuf_len(cui));
+		ap_sta_session_link(hapd, sta, AP_STA_SESSION_CUI,
+				    sta->cui_hash);
+		sta->cui_indexed = 1;
+	}
+
+	identity = ieee802_1x_get_identity(sta->eapol_sm, &identity_len);
+	if (identity) {
+		sta->identity_hash = ap_sta_session_hash(identity,
+							 identity_len);
+		ap_sta_session_link(hapd, sta, AP_STA_SESSION_IDENTITY,
+				    sta->identity_hash);
+		sta->identity_indexed = 1;
+	}
+}
+
+
+/**
+ * ap_sta_session_index_clear - Remove the station from CUI/identity indexes
+ * @hapd: hostapd BSS data
+ * @sta: The station
+ */
+void ap_sta_session_index_clear(struct hostapd_data *hapd,
+				struct sta_info *sta)
+{
+	if (sta->cui_indexed) {
+		ap_sta_session_unlink(hapd, sta, AP_STA_SESSION_CUI,
+				      sta->cui_hash);
+		sta->cui_indexed = 0;
+	}
+	if (sta->identity_indexed) {
+		ap_sta_session_unlink(hapd, sta, AP_STA_SESSION_IDENTITY,
+				      sta->identity_hash);
+		sta->identity_indexed = 0;
+	}
+}
+
+
 void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	int set_beacon = 0;
@@ -141,12 +397,17 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 
 	ap_sta_hash_del(hapd, sta);
 	ap_sta_list_del(hapd, sta);
+	ap_sta_session_unlink(hapd, sta, AP_STA_SESSION_ACCT,
+			      AP_STA_ACCT_HASH(sta->acct_session_id_lo));
+	ap_sta_session_index_clear(hapd, sta);
 
 	if (sta->aid > 0)
 		hapd->sta_aid[(sta->aid - 1) / 32] &=
 			~BIT((sta->aid - 1) % 32);
 
 	hapd->num_sta--;
+	if (hapd->num_sta == 0)
+		eloop_cancel_timeout(ap_sta_stats_timer, hapd, NULL);
 	if (sta->nonerp_set) {
 		sta->nonerp_set = 0;
 		hapd->iface->num_sta_non_erp--;
@@ -249,13 +510,14 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	hostapd_free_psk_list(sta->psk);
 	os_free(sta->identity);
 	os_free(sta->radius_cui);
+	os_free(sta->drv_stats);
 
 #ifdef CONFIG_SAE
 	sae_clear_data(sta->sae);
 	os_free(sta->sae);
 #endif /* CONFIG_SAE */
 
-	os_free(sta);
+	mempool_free(&sta_info_pool, sta);
 }
 
 
@@ -279,6 +541,127 @@ void hostapd_free_stas(struct hostapd_data *hapd)
 }
 
 
+static void ap_sta_stats_cb(void *ctx, const u8 *addr,
+			    struct hostap_sta_driver_data *data)
+{
+	struct hostapd_data *hapd = ctx;
+	struct sta_info *sta;
+
+	sta = ap_get_sta(hapd, addr);
+	if (sta == NULL)
+		return;
+	if (sta->drv_stats == NULL) {
+		sta->drv_stats = os_malloc(sizeof(*sta->drv_stats));
+		if (sta->drv_stats == NULL)
+			return;
+	}
+	os_memcpy(sta->drv_stats, data, sizeof(*data));
+	sta->drv_stats_gen = hapd->sta_stats_gen;
+}
+
+
+/*
+ * BSS-wide timer for refreshing the station statistics snapshot. The timer is
+ * running while there are stations and the driver supports
+ * read_sta_data_all(), so that a large BSS needs a single netlink dump per
+ * AP_STA_STATS_INTERVAL instead of a request per station timer.
+ */
+static void ap_sta_stats_timer(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+
+	hapd->sta_stats_gen++;
+	if (hapd->sta_stats_gen == 0)
+		hapd->sta_stats_gen++;
+	eloop_get_reltime(&hapd->sta_stats_time);
+
+	if (hostapd_drv_read_sta_data_all(hapd, ap_sta_stats_cb, hapd) < 0) {
+		/* Invalidate partial results; stations are queried separately
+		 * until the next refresh */
+		wpa_printf(MSG_DEBUG, "Could not fetch station statistics "
+			   "snapshot from the driver");
+		hapd->sta_stats_gen++;
+		if (hapd->sta_stats_gen == 0)
+			hapd->sta_stats_gen++;
+	}
+
+	if (hapd->num_sta)
+		eloop_register_timeout(AP_STA_STATS_INTERVAL, 0,
+				       ap_sta_stats_timer, hapd, NULL);
+}
+
+
+static struct hostap_sta_driver_data *
+ap_sta_stats_get(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	if (sta->drv_stats == NULL ||
+	    sta->drv_stats_gen != hapd->sta_stats_gen)
+		return NULL;
+	return sta->drv_stats;
+}
+
+
+/**
+ * ap_sta_read_drv_data - Fetch driver statistics for a station
+ * @hapd: hostapd BSS data
+ * @sta: The station
+ * @data: Buffer for returning the station statistics
+ * Returns: 0 on success, -1 on failure
+ *
+ * If the driver supports read_sta_data_all(), the statistics from the latest
+ * snapshot are returned; these are at most AP_STA_STATS_INTERVAL seconds old.
+ * Stations that are not in the snapshot (e.g., ones added after the last
+ * refresh) are queried separately.
+ */
+int ap_sta_read_drv_data(struct hostapd_data *hapd, struct sta_info *sta,
+			 struct hostap_sta_driver_data *data)
+{
+	struct hostap_sta_driver_data *stats;
+
+	stats = ap_sta_stats_get(hapd, sta);
+	if (stats) {
+		os_memcpy(data, stats, sizeof(*data));
+		return 0;
+	}
+
+	return hostapd_drv_read_sta_data(hapd, data, sta->addr);
+}
+
+
+/**
+ * ap_sta_get_inact_sec - Get station inactivity duration
+ * @hapd: hostapd BSS data
+ * @sta: The station
+ * Returns: Number of seconds station has been inactive, -1 on failure
+ */
+int ap_sta_get_inact_sec(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	struct hostap_sta_driver_data *stats;
+	struct os_reltime now, age;
+	int inactive_sec;
+
+	stats = ap_sta_stats_get(hapd, sta);
+	if (stats == NULL)
+		return hostapd_drv_get_inact_sec(hapd, sta->addr);
+
+	eloop_get_reltime(&now);
+	os_reltime_sub(&now, &hapd->sta_stats_time, &age);
+	inactive_sec = stats->inactive_msec / 1000 + age.sec;
+
+	/*
+	 * The snapshot may overestimate inactivity by up to
+	 * AP_STA_STATS_INTERVAL. That is fine when an idle station is polled
+	 * before it is disconnected, but without the poll the driver is
+	 * queried directly before the station is considered idle.
+	 */
+	if (inactive_sec >= hapd->conf->ap_max_inactivity &&
+	    hapd->conf->skip_inactivity_poll)
+		return hostapd_drv_get_inact_sec(hapd, sta->addr);
+
+	return inactive_sec;
+}
+
+
 /**
  * ap_handle_timer - Per STA timer handler
  * @eloop_ctx: struct hostapd_data *
@@ -314,7 +697,7 @@ void ap_handle_timer(void *eloop_ctx, void *timeout_ctx)
 		 * stations that are idle (but keep re-associating).
 		 */
 		int fuzz = os_random() % 20;
-		inactive_sec = hostapd_drv_get_inact_sec(hapd, sta->addr);
+		inactive_sec = ap_sta_get_inact_sec(hapd, sta);
 		if (inactive_sec == -1) {
 			wpa_msg(hapd->msg_ctx, MSG_DEBUG,
 				"Check inactivity: Could not "
@@ -511,7 +894,7 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 		return NULL;
 	}
 
-	sta = os_zalloc(sizeof(struct sta_info));
+	sta = mempool_zalloc(&sta_info_pool);
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
 		return NULL;
@@ -530,7 +913,13 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 	sta->next = hapd->sta_list;
 	hapd->sta_list = sta;
 	hapd->num_sta++;
+	if (hapd->num_sta == 1 && hapd->driver &&
+	    hapd->driver->read_sta_data_all)
+		eloop_register_timeout(AP_STA_STATS_INTERVAL, 0,
+				       ap_sta_stats_timer, hapd, NULL);
 	ap_sta_hash_add(hapd, sta);
+	ap_sta_session_link(hapd, sta, AP_STA_SESSION_ACCT,
+			    AP_STA_ACCT_HASH(sta->acct_session_id_lo));
 	sta->ssid = &hapd->conf->ssid;
 	ap_sta_remove_in_other_bss(hapd, sta);
 
@@ -792,9 +1181,9 @@ int ap_sta_bind_vlan(struct hostapd_data *hapd, struct sta_info *sta,
 int ap_check_sa_query_timeout(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	u32 tu;
-	struct os_time now, passed;
-	os_get_time(&now);
-	os_time_sub(&now, &sta->sa_query_start, &passed);
+	struct os_reltime now, passed;
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &sta->sa_query_start, &passed);
 	tu = (passed.sec * 1000000 + passed.usec) / 1024;
 	if (hapd->conf->assoc_sa_query_max_timeout < tu) {
 		hostapd_logger(hapd, sta->addr,
@@ -831,7 +1220,7 @@ static void ap_sa_query_timer(void *eloop_ctx, void *timeout_ctx)
 		return;
 	if (sta->sa_query_count == 0) {
 		/* Starting a new SA Query procedure */
-		os_get_time(&sta->sa_query_start);
+		os_get_reltime(&sta->sa_query_start);
 	}
 	trans_id = nbuf + sta->sa_query_count * WLAN_SA_QUERY_TR_ID_LEN;
 	sta->sa_query_trans_id = nbuf;
@@ -877,6 +1266,15 @@ void ap_sta_set_authorized(struct hostapd_data *hapd, struct sta_info *sta,
 	u8 addr[ETH_ALEN];
 #endif /* CONFIG_P2P */
 
+	/*
+	 * Identity and CUI are known once the port gets authorized. This is
+	 * done before the flag check to cover reauthentication, too.
+	 */
+	if (authorized)
+		ap_sta_session_index_update(hapd, sta);
+	else
+		ap_sta_session_index_clear(hapd, sta);
+
 	if (!!authorized == !!(sta->flags & WLAN_STA_AUTHORIZED))
 		return;
 
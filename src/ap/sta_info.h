@@ -96,6 +96,13 @@ struct sta_info {
 
 	u32 acct_session_id_hi;
 	u32 acct_session_id_lo;
+	struct sta_info *acct_hnext; /* next entry in Acct-Session-Id hash */
+	struct sta_info *cui_hnext; /* next entry in CUI hash */
+	struct sta_info *identity_hnext; /* next entry in identity hash */
+	unsigned int cui_hash; /* valid if cui_indexed is set */
+	unsigned int identity_hash; /* valid if identity_indexed is set */
+	unsigned int cui_indexed:1;
+	unsigned int identity_indexed:1;
 	time_t acct_session_start;
 	int acct_session_started;
 	int acct_terminate_cause; /* Acct-Terminate-Cause */
@@ -106,6 +113,11 @@ struct sta_info {
 	u32 acct_input_gigawords; /* Acct-Input-Gigawords */
 	u32 acct_output_gigawords; /* Acct-Output-Gigawords */
 
+	/* Driver statistics from the bulk snapshot; valid only if
+	 * drv_stats_gen matches hapd->sta_stats_gen */
+	struct hostap_sta_driver_data *drv_stats;
+	unsigned int drv_stats_gen;
+
 	u8 *challenge; /* IEEE 802.11 Shared Key Authentication Challenge */
 
 	struct wpa_state_machine *wpa_sm;
@@ -131,7 +143,7 @@ struct sta_info {
 	u8 *sa_query_trans_id; /* buffer of WLAN_SA_QUERY_TR_ID_LEN *
 				* sa_query_count octets of pending SA Query
 				* transaction identifiers */
-	struct os_time sa_query_start;
+	struct os_reltime sa_query_start;
 #endif /* CONFIG_IEEE80211W */
 
 #ifdef CONFIG_INTERWORKING
@@ -144,7 +156,7 @@ struct sta_info {
 	struct wpabuf *p2p_ie; /* P2P IE from (Re)Association Request */
 	struct wpabuf *hs20_ie; /* HS 2.0 IE from (Re)Association Request */
 
-	struct os_time connected_time;
+	struct os_reltime connected_time;
 
 #ifdef CONFIG_SAE
 	struct sae_data *sae;
@@ -169,6 +181,7 @@ struct sta_info {
 
 
 struct hostapd_data;
+struct hostap_sta_driver_data;
 
 int ap_for_each_sta(struct hostapd_data *hapd,
 		    int (*cb)(struct hostapd_data *hapd, struct sta_info *sta,
@@ -176,9 +189,28 @@ int ap_for_each_sta(struct hostapd_data *hapd,
 		    void *ctx);
 struct sta_info * ap_get_sta(struct hostapd_data *hapd, const u8 *sta);
 void ap_sta_hash_add(struct hostapd_data *hapd, struct sta_info *sta);
+struct sta_info * ap_get_sta_acct_session(struct hostapd_data *hapd,
+					  const u8 *id, size_t id_len);
+int ap_sta_for_each_cui(struct hostapd_data *hapd, const u8 *cui,
+			size_t cui_len,
+			int (*cb)(struct hostapd_data *hapd,
+				  struct sta_info *sta, void *ctx),
+			void *ctx);
+int ap_sta_for_each_identity(struct hostapd_data *hapd, const u8 *identity,
+			     size_t identity_len,
+			     int (*cb)(struct hostapd_data *hapd,
+				       struct sta_info *sta, void *ctx),
+			     void *ctx);
+void ap_sta_session_index_update(struct hostapd_data *hapd,
+				 struct sta_info *sta);
+void ap_sta_session_index_clear(struct hostapd_data *hapd,
+				struct sta_info *sta);
 void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta);
 void hostapd_free_stas(struct hostapd_data *hapd);
 void ap_handle_timer(void *eloop_ctx, void *timeout_ctx);
+int ap_sta_read_drv_data(struct hostapd_data *hapd, struct sta_info *sta,
+			 struct hostap_sta_driver_data *data);
+int ap_sta_get_inact_sec(struct hostapd_data *hapd, struct sta_info *sta);
 void ap_sta_session_timeout(struct hostapd_data *hapd, struct sta_info *sta,
 			    u32 session_timeout);
 void ap_sta_no_session_timeout(struct hostapd_data *hapd,
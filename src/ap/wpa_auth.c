@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/mempool.h"
 #include "utils/state_machine.h"
 #include "common/ieee802_11_defs.h"
 #include "crypto/aes_wrap.h"
@@ -34,6 +35,7 @@ static void wpa_send_eapol_timeout(void *eloop_ctx, void *timeout_ctx);
 static int wpa_sm_step(struct wpa_state_machine *sm);
 static int wpa_verify_key_mic(struct wpa_ptk *PTK, u8 *data, size_t data_len);
 static void wpa_sm_call_step(void *eloop_ctx, void *timeout_ctx);
+static void wpa_group_update_pace(void *eloop_ctx, void *timeout_ctx);
 static void wpa_group_sm_step(struct wpa_authenticator *wpa_auth,
 			      struct wpa_group *group);
 static void wpa_request_new_ptk(struct wpa_state_machine *sm);
@@ -53,6 +55,9 @@ static const int dot11RSNAConfigPMKLifetime = 43200;
 static const int dot11RSNAConfigPMKReauthThreshold = 70;
 static const int dot11RSNAConfigSATimeout = 60;
 
+static struct mempool wpa_sm_pool =
+	MEMPOOL_INIT("wpa_state_machine", sizeof(struct wpa_state_machine));
+
 
 static inline int wpa_auth_mic_failure_report(
 	struct wpa_authenticator *wpa_auth, const u8 *addr)
@@ -90,6 +95,14 @@ static inline const u8 * wpa_auth_get_psk(struct wpa_authenticator *wpa_auth,
 }
 
 
+static inline void wpa_auth_psk_matched(struct wpa_authenticator *wpa_auth,
+					const u8 *addr, const u8 *psk)
+{
+	if (wpa_auth->cb.psk_matched)
+		wpa_auth->cb.psk_matched(wpa_auth->cb.ctx, addr, psk);
+}
+
+
 static inline int wpa_auth_get_msk(struct wpa_authenticator *wpa_auth,
 				   const u8 *addr, u8 *msk, size_t *len)
 {
@@ -455,6 +468,7 @@ void wpa_deinit(struct wpa_authenticator *wpa_auth)
 
 	eloop_cancel_timeout(wpa_rekey_gmk, wpa_auth, NULL);
 	eloop_cancel_timeout(wpa_rekey_gtk, wpa_auth, NULL);
+	eloop_cancel_timeout(wpa_group_update_pace, wpa_auth, ELOOP_ALL_CTX);
 
 #ifdef CONFIG_PEERKEY
 	while (wpa_auth->stsl_negotiations)
@@ -519,7 +533,7 @@ wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr)
 {
 	struct wpa_state_machine *sm;
 
-	sm = os_zalloc(sizeof(struct wpa_state_machine));
+	sm = mempool_zalloc(&wpa_sm_pool);
 	if (sm == NULL)
 		return NULL;
 	os_memcpy(sm->addr, addr, ETH_ALEN);
@@ -588,7 +602,7 @@ static void wpa_free_sta_sm(struct wpa_state_machine *sm)
 #endif /* CONFIG_IEEE80211R */
 	os_free(sm->last_rx_eapol_key);
 	os_free(sm->wpa_ie);
-	os_free(sm);
+	mempool_free(&wpa_sm_pool, sm);
 }
 
 
@@ -1263,7 +1277,7 @@ void __wpa_send_eapol(struct wpa_authenticator *wpa_auth,
 
 	len += key_data_len;
 
-	hdr = os_zalloc(len);
+	hdr = msg_arena_zalloc(len);
 	if (hdr == NULL)
 		return;
 	hdr->version = wpa_auth->conf.eapol_version;
@@ -1307,9 +1321,9 @@ void __wpa_send_eapol(struct wpa_authenticator *wpa_auth,
 		os_memcpy(key + 1, kde, kde_len);
 		WPA_PUT_BE16(key->key_data_length, kde_len);
 	} else if (encr && kde) {
-		buf = os_zalloc(key_data_len);
+		buf = msg_arena_zalloc(key_data_len);
 		if (buf == NULL) {
-			os_free(hdr);
+			msg_arena_free(hdr);
 			return;
 		}
 		pos = buf;
@@ -1325,8 +1339,8 @@ void __wpa_send_eapol(struct wpa_authenticator *wpa_auth,
 		    version == WPA_KEY_INFO_TYPE_AES_128_CMAC) {
 			if (aes_wrap(sm->PTK.kek, (key_data_len - 8) / 8, buf,
 				     (u8 *) (key + 1))) {
-				os_free(hdr);
-				os_free(buf);
+				msg_arena_free(hdr);
+				msg_arena_free(buf);
 				return;
 			}
 			WPA_PUT_BE16(key->key_data_length, key_data_len);
@@ -1341,7 +1355,7 @@ void __wpa_send_eapol(struct wpa_authenticator *wpa_auth,
 			rc4_skip(ek, 32, 256, (u8 *) (key + 1), key_data_len);
 			WPA_PUT_BE16(key->key_data_length, key_data_len);
 		}
-		os_free(buf);
+		msg_arena_free(buf);
 	}
 
 	if (key_info & WPA_KEY_INFO_MIC) {
@@ -1349,7 +1363,7 @@ void __wpa_send_eapol(struct wpa_authenticator *wpa_auth,
 			wpa_auth_logger(wpa_auth, sm->addr, LOGGER_DEBUG,
 					"PTK not valid when sending EAPOL-Key "
 					"frame");
-			os_free(hdr);
+			msg_arena_free(hdr);
 			return;
 		}
 		wpa_eapol_key_mic(sm->PTK.kck, version, (u8 *) hdr, len,
@@ -1360,7 +1374,7 @@ void __wpa_send_eapol(struct wpa_authenticator *wpa_auth,
 			   1);
 	wpa_auth_send_eapol(wpa_auth, sm->addr, (u8 *) hdr, len,
 			    sm->pairwise_set);
-	os_free(hdr);
+	msg_arena_free(hdr);
 }
 
 
@@ -1764,10 +1778,31 @@ static int wpa_derive_ptk(struct wpa_state_machine *sm, const u8 *pmk,
 }
 
 
+/*
+ * Derive only the KCK for checking the MIC with another PSK candidate. This
+ * is possible when the PRF output does not depend on the requested length
+ * (SHA-1 based PRF) and saves most of the per-candidate PRF work when a
+ * large number of group PSKs need to be tried.
+ */
+static int wpa_derive_ptk_kck(struct wpa_state_machine *sm, const u8 *pmk,
+			      struct wpa_ptk *ptk)
+{
+	if (wpa_key_mgmt_ft(sm->wpa_key_mgmt) ||
+	    wpa_key_mgmt_sha256(sm->wpa_key_mgmt))
+		return -1;
+
+	wpa_pmk_to_ptk(pmk, PMK_LEN, "Pairwise key expansion",
+		       sm->wpa_auth->addr, sm->addr, sm->ANonce, sm->SNonce,
+		       (u8 *) ptk, sizeof(ptk->kck), 0);
+
+	return 0;
+}
+
+
 SM_STATE(WPA_PTK, PTKCALCNEGOTIATING)
 {
 	struct wpa_ptk PTK;
-	int ok = 0;
+	int ok = 0, full = 1;
 	const u8 *pmk = NULL;
 
 	SM_ENTRY_MA(WPA_PTK, PTKCALCNEGOTIATING, wpa_ptk);
@@ -1785,16 +1820,24 @@ SM_STATE(WPA_PTK, PTKCALCNEGOTIATING)
 		} else
 			pmk = sm->PMK;
 
-		wpa_derive_ptk(sm, pmk, &PTK);
+		/* The first candidate normally matches; for the rest, only
+		 * derive the full PTK once the MIC has been verified. */
+		if (full || wpa_derive_ptk_kck(sm, pmk, &PTK) < 0) {
+			wpa_derive_ptk(sm, pmk, &PTK);
+			full = 1;
+		}
 
 		if (wpa_verify_key_mic(&PTK, sm->last_rx_eapol_key,
 				       sm->last_rx_eapol_key_len) == 0) {
+			if (!full)
+				wpa_derive_ptk(sm, pmk, &PTK);
 			ok = 1;
 			break;
 		}
 
 		if (!wpa_key_mgmt_wpa_psk(sm->wpa_key_mgmt))
 			break;
+		full = 0;
 	}
 
 	if (!ok) {
@@ -1832,6 +1875,7 @@ SM_STATE(WPA_PTK, PTKCALCNEGOTIATING)
 		 * state machine data based on whatever PSK was selected here.
 		 */
 		os_memcpy(sm->PMK, pmk, PMK_LEN);
+		wpa_auth_psk_matched(sm->wpa_auth, sm->addr, pmk);
 	}
 
 	sm->MICVerified = TRUE;
@@ -2334,7 +2378,8 @@ SM_STEP(WPA_PTK_GROUP)
 		sm->PtkGroupInit = FALSE;
 	} else switch (sm->wpa_ptk_group_state) {
 	case WPA_PTK_GROUP_IDLE:
-		if (sm->GUpdateStationKeys ||
+		if ((sm->GUpdateStationKeys &&
+		     !sm->group_update_deferred) ||
 		    (sm->wpa == WPA_VERSION_WPA && sm->PInitAKeys))
 			SM_ENTER(WPA_PTK_GROUP, REKEYNEGOTIATING);
 		break;
@@ -2440,11 +2485,98 @@ static int wpa_group_update_sta(struct wpa_state_machine *sm, void *ctx)
 	sm->group->GKeyDoneStations++;
 	sm->GUpdateStationKeys = TRUE;
 
+	if (ctx && sm->wpa_auth->conf.wpa_group_update_batch > 0) {
+		/* Group Key handshake is started by wpa_group_update_pace() */
+		sm->group_update_deferred = 1;
+		return 0;
+	}
+	sm->group_update_deferred = 0;
+
+	wpa_sm_step(sm);
+	return 0;
+}
+
+
+struct wpa_group_pace_data {
+	struct wpa_group *group;
+	int inflight;
+	int deferred;
+	int release;
+	int max_inflight;
+};
+
+
+static int wpa_group_pace_count(struct wpa_state_machine *sm, void *ctx)
+{
+	struct wpa_group_pace_data *data = ctx;
+
+	if (sm->group != data->group)
+		return 0;
+	if (!sm->GUpdateStationKeys) {
+		sm->group_update_deferred = 0;
+		return 0;
+	}
+	if (sm->group_update_deferred)
+		data->deferred++;
+	else
+		data->inflight++;
+	return 0;
+}
+
+
+static int wpa_group_pace_release(struct wpa_state_machine *sm, void *ctx)
+{
+	struct wpa_group_pace_data *data = ctx;
+
+	if (sm->group != data->group || !sm->group_update_deferred)
+		return 0;
+	if (data->release <= 0 ||
+	    (data->max_inflight > 0 && data->inflight >= data->max_inflight))
+		return 1;
+
+	sm->group_update_deferred = 0;
+	data->release--;
+	data->deferred--;
+	data->inflight++;
 	wpa_sm_step(sm);
 	return 0;
 }
 
 
+static void wpa_group_update_pace(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpa_authenticator *wpa_auth = eloop_ctx;
+	struct wpa_group_pace_data data;
+
+	os_memset(&data, 0, sizeof(data));
+	data.group = timeout_ctx;
+	data.release = wpa_auth->conf.wpa_group_update_batch;
+	data.max_inflight = wpa_auth->conf.wpa_group_update_max_inflight;
+
+	wpa_auth_for_each_sta(wpa_auth, wpa_group_pace_count, &data);
+	if (data.deferred && data.release <= 0) {
+		/* Pacing was disabled with reconfiguration; release all */
+		data.release = data.deferred;
+		data.max_inflight = 0;
+	}
+	wpa_auth_for_each_sta(wpa_auth, wpa_group_pace_release, &data);
+
+	wpa_printf(MSG_MSGDUMP, "WPA: Group key update pacing (VLAN-ID %d): "
+		   "in-flight=%d deferred=%d", data.group->vlan_id,
+		   data.inflight, data.deferred);
+
+	if (data.deferred > 0) {
+		int interval = wpa_auth->conf.wpa_group_update_interval;
+		if (interval <= 0)
+			interval = 10;
+		eloop_register_timeout(interval / 1000,
+				       (interval % 1000) * 1000,
+				       wpa_group_update_pace, wpa_auth,
+				       data.group);
+	}
+}
+
+
 #ifdef CONFIG_WNM
 /* update GTK when exiting WNM-Sleep Mode */
 void wpa_wnmsleep_rekey_gtk(struct wpa_state_machine *sm)
@@ -2547,6 +2679,7 @@ static void wpa_group_setkeys(struct wpa_authenticator *wpa_auth,
 	 * counting the STAs that are marked with GUpdateStationKeys instead of
 	 * including all STAs that could be in not-yet-completed state. */
 	wpa_gtk_update(wpa_auth, group);
+	os_get_reltime(&group->rekey_start);
 
 	if (group->GKeyDoneStations) {
 		wpa_printf(MSG_DEBUG, "wpa_group_setkeys: Unexpected "
@@ -2557,6 +2690,11 @@ static void wpa_group_setkeys(struct wpa_authenticator *wpa_auth,
 	wpa_auth_for_each_sta(wpa_auth, wpa_group_update_sta, group);
 	wpa_printf(MSG_DEBUG, "wpa_group_setkeys: GKeyDoneStations=%d",
 		   group->GKeyDoneStations);
+
+	eloop_cancel_timeout(wpa_group_update_pace, wpa_auth, group);
+	if (wpa_auth->conf.wpa_group_update_batch > 0 &&
+	    group->GKeyDoneStations > 0)
+		wpa_group_update_pace(wpa_auth, group);
 }
 
 
@@ -2592,6 +2730,16 @@ static int wpa_group_setkeysdone(struct wpa_authenticator *wpa_auth,
 	group->changed = TRUE;
 	group->wpa_group_state = WPA_GROUP_SETKEYSDONE;
 
+	if (group->rekey_start.sec || group->rekey_start.usec) {
+		struct os_reltime now, diff;
+		os_get_reltime(&now);
+		os_reltime_sub(&now, &group->rekey_start, &diff);
+		wpa_printf(MSG_DEBUG, "WPA: GTK rekey (VLAN-ID %d) completed "
+			   "in %ld.%06ld seconds", group->vlan_id,
+			   (long) diff.sec, (long) diff.usec);
+		os_memset(&group->rekey_start, 0, sizeof(group->rekey_start));
+	}
+
 	if (wpa_group_config_group_keys(wpa_auth, group) < 0)
 		return -1;
 
@@ -2952,6 +3100,17 @@ int wpa_auth_pmksa_add_preauth(struct wpa_authenticator *wpa_auth,
 }
 
 
+int wpa_auth_pmksa_attach_shared(struct wpa_authenticator *wpa_auth,
+				 const char *fname)
+{
+	if (wpa_auth == NULL || wpa_auth->pmksa == NULL)
+		return -1;
+
+	return pmksa_cache_auth_attach_shared(wpa_auth->pmksa, fname,
+					      wpa_auth->addr);
+}
+
+
 static struct wpa_group *
 wpa_auth_add_group(struct wpa_authenticator *wpa_auth, int vlan_id)
 {
@@ -38,6 +38,10 @@ static void hostapd_wpa_auth_conf(struct hostapd_bss_config *conf,
 	wconf->wpa_group_rekey = conf->wpa_group_rekey;
 	wconf->wpa_strict_rekey = conf->wpa_strict_rekey;
 	wconf->wpa_gmk_rekey = conf->wpa_gmk_rekey;
+	wconf->wpa_group_update_batch = conf->wpa_group_update_batch;
+	wconf->wpa_group_update_interval = conf->wpa_group_update_interval;
+	wconf->wpa_group_update_max_inflight =
+		conf->wpa_group_update_max_inflight;
 	wconf->wpa_ptk_rekey = conf->wpa_ptk_rekey;
 	wconf->rsn_pairwise = conf->rsn_pairwise;
 	wconf->rsn_preauth = conf->rsn_preauth;
@@ -195,26 +199,49 @@ static const u8 * hostapd_wpa_auth_get_psk(void *ctx, const u8 *addr,
 	}
 #endif /* CONFIG_SAE */
 
-	psk = hostapd_get_psk(hapd->conf, addr, prev_psk);
 	/*
 	 * This is about to iterate over all psks, prev_psk gives the last
 	 * returned psk which should not be returned again.
 	 * logic list (all hostapd_get_psk; all sta->psk)
+	 * hostapd_get_psk() must only be given its own entries as prev_psk.
 	 */
-	if (sta && sta->psk && !psk) {
+	if (sta && sta->psk && prev_psk) {
 		struct hostapd_sta_wpa_psk_short *pos;
-		psk = sta->psk->psk;
 		for (pos = sta->psk; pos; pos = pos->next) {
-			if (pos->psk == prev_psk) {
-				psk = pos->next ? pos->next->psk : NULL;
-				break;
-			}
+			if (pos->psk == prev_psk)
+				return pos->next ? pos->next->psk : NULL;
 		}
 	}
+
+	psk = hostapd_get_psk(hapd->conf, addr, prev_psk);
+	if (sta && sta->psk && !psk)
+		psk = sta->psk->psk;
 	return psk;
 }
 
 
+static void hostapd_wpa_auth_psk_matched(void *ctx, const u8 *addr,
+					 const u8 *psk)
+{
+	struct hostapd_data *hapd = ctx;
+	struct sta_info *sta = ap_get_sta(hapd, addr);
+	struct hostapd_sta_wpa_psk_short *pos;
+
+	if (sta) {
+#ifdef CONFIG_SAE
+		if (sta->auth_alg == WLAN_AUTH_SAE)
+			return;
+#endif /* CONFIG_SAE */
+		for (pos = sta->psk; pos; pos = pos->next) {
+			if (pos->psk == psk)
+				return;
+		}
+	}
+
+	hostapd_wpa_psk_matched(hapd->conf, addr, psk);
+}
+
+
 static int hostapd_wpa_auth_get_msk(void *ctx, const u8 *addr, u8 *msk,
 				    size_t *len)
 {
@@ -410,8 +437,9 @@ static int hostapd_wpa_auth_send_ether(void *ctx, const u8 *dst, u16 proto,
 	os_memcpy(buf->h_source, hapd->own_addr, ETH_ALEN);
 	buf->h_proto = host_to_be16(proto);
 	os_memcpy(buf + 1, data, data_len);
-	ret = l2_packet_send(hapd->l2, dst, proto, (u8 *) buf,
-			     sizeof(*buf) + data_len);
+	/* RRB frames are often sent in bursts; batch them per eloop iteration */
+	ret = l2_packet_send_queued(hapd->l2, dst, proto, (u8 *) buf,
+				    sizeof(*buf) + data_len);
 	os_free(buf);
 	return ret;
 }
@@ -522,6 +550,7 @@ int hostapd_setup_wpa(struct hostapd_data *hapd)
 	cb.set_eapol = hostapd_wpa_auth_set_eapol;
 	cb.get_eapol = hostapd_wpa_auth_get_eapol;
 	cb.get_psk = hostapd_wpa_auth_get_psk;
+	cb.psk_matched = hostapd_wpa_auth_psk_matched;
 	cb.get_msk = hostapd_wpa_auth_get_msk;
 	cb.set_key = hostapd_wpa_auth_set_key;
 	cb.get_seqnum = hostapd_wpa_auth_get_seqnum;
@@ -540,6 +569,12 @@ int hostapd_setup_wpa(struct hostapd_data *hapd)
 		return -1;
 	}
 
+	if (hapd->conf->pmksa_cache_file &&
+	    wpa_auth_pmksa_attach_shared(hapd->wpa_auth,
+					 hapd->conf->pmksa_cache_file) < 0)
+		wpa_printf(MSG_ERROR, "Could not use shared PMKSA cache '%s'",
+			   hapd->conf->pmksa_cache_file);
+
 	if (hostapd_set_privacy(hapd, 1)) {
 		wpa_printf(MSG_ERROR, "Could not set PrivacyInvoked "
 			   "for interface %s", hapd->conf->iface);
@@ -108,6 +108,7 @@ static int hostapd_wps_new_psk_cb(void *ctx, const u8 *mac_addr, const u8 *psk,
 
 	p->next = ssid->wpa_psk;
 	ssid->wpa_psk = p;
+	hostapd_wpa_psk_index_build(ssid);
 
 	if (ssid->wpa_psk_file) {
 		FILE *f;
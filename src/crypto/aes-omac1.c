@@ -64,7 +64,7 @@ int omac1_aes_128_vector(const u8 *key, size_t num_elem,
 	while (left >= AES_BLOCK_SIZE) {
 		for (i = 0; i < AES_BLOCK_SIZE; i++) {
 			cbc[i] ^= *pos++;
-			if (pos >= end) {
+			if (pos >= end && e + 1 < num_elem) {
 				e++;
 				pos = addr[e];
 				end = pos + len[e];
@@ -82,7 +82,7 @@ int omac1_aes_128_vector(const u8 *key, size_t num_elem,
 	if (left || total_len == 0) {
 		for (i = 0; i < left; i++) {
 			cbc[i] ^= *pos++;
-			if (pos >= end) {
+			if (pos >= end && e + 1 < num_elem) {
 				e++;
 				pos = addr[e];
 				end = pos + len[e];
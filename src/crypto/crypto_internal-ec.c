@@ -0,0 +1,856 @@
+/*
+ * Crypto wrapper for internal crypto implementation - elliptic curves
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This implements the crypto_ec_*() functions for the NIST P-256 and P-384
+ * curves (IKE groups 19 and 20) without an external library. Field elements
+ * are stored as fixed size arrays of limbs in Montgomery form and points in
+ * Jacobian coordinates. Field arithmetic and point multiplication do not
+ * branch on secret data or use it for memory addressing: point multiplication
+ * uses a fixed 4-bit window with a table of multiples of the point that is
+ * scanned completely for each window and the scalar is reduced modulo the
+ * group order with a conditional subtraction. The only exception is reading
+ * the scalar from the bignum (libtommath) representation, the time of which
+ * depends on the number of leading zero bits in the scalar.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "tls/bignum.h"
+#include "crypto.h"
+
+#if defined(__SIZEOF_INT128__) && !defined(EC_LIMB_32BIT)
+typedef u64 ec_limb;
+typedef unsigned __int128 ec_dlimb;
+#define EC_LIMB_BITS 64
+#else
+typedef u32 ec_limb;
+typedef u64 ec_dlimb;
+#define EC_LIMB_BITS 32
+#endif
+
+#define EC_LIMB_BYTES (EC_LIMB_BITS / 8)
+#define EC_MAX_PRIME_LEN 48
+#define EC_MAX_LIMBS (EC_MAX_PRIME_LEN / EC_LIMB_BYTES)
+#define EC_WINDOW_BITS 4
+#define EC_WINDOW_SIZE (1 << EC_WINDOW_BITS)
+
+struct ec_curve {
+	int group;
+	size_t len;
+	const u8 *prime;
+	const u8 *b;
+	const u8 *order;
+};
+
+/* Curve parameters from FIPS 186-3, D.1.2; a = -3 for both curves */
+
+static const u8 ec_p256_prime[32] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static const u8 ec_p256_b[32] = {
+	0x5a, 0xc6, 0x35, 0xd8, 0xaa, 0x3a, 0x93, 0xe7,
+	0xb3, 0xeb, 0xbd, 0x55, 0x76, 0x98, 0x86, 0xbc,
+	0x65, 0x1d, 0x06, 0xb0, 0xcc, 0x53, 0xb0, 0xf6,
+	0x3b, 0xce, 0x3c, 0x3e, 0x27, 0xd2, 0x60, 0x4b
+};
+
+static const u8 ec_p256_order[32] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84,
+	0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51
+};
+
+static const u8 ec_p384_prime[48] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff
+};
+
+static const u8 ec_p384_b[48] = {
+	0xb3, 0x31, 0x2f, 0xa7, 0xe2, 0x3e, 0xe7, 0xe4,
+	0x98, 0x8e, 0x05, 0x6b, 0xe3, 0xf8, 0x2d, 0x19,
+	0x18, 0x1d, 0x9c, 0x6e, 0xfe, 0x81, 0x41, 0x12,
+	0x03, 0x14, 0x08, 0x8f, 0x50, 0x13, 0x87, 0x5a,
+	0xc6, 0x56, 0x39, 0x8d, 0x8a, 0x2e, 0xd1, 0x9d,
+	0x2a, 0x85, 0xc8, 0xed, 0xd3, 0xec, 0x2a, 0xef
+};
+
+static const u8 ec_p384_order[48] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xc7, 0x63, 0x4d, 0x81, 0xf4, 0x37, 0x2d, 0xdf,
+	0x58, 0x1a, 0x0d, 0xb2, 0x48, 0xb0, 0xa7, 0x7a,
+	0xec, 0xec, 0x19, 0x6a, 0xcc, 0xc5, 0x29, 0x73
+};
+
+static const struct ec_curve ec_curves[] = {
+	{ 19, sizeof(ec_p256_prime), ec_p256_prime, ec_p256_b, ec_p256_order },
+	{ 20, sizeof(ec_p384_prime), ec_p384_prime, ec_p384_b, ec_p384_order },
+	{ 0, 0, NULL, NULL, NULL }
+};
+
+struct crypto_ec {
+	size_t len; /* length of the prime in octets */
+	size_t limbs;
+	ec_limb p[EC_MAX_LIMBS];
+	ec_limb mu; /* -1 / p (mod 2^EC_LIMB_BITS) */
+	ec_limb one[EC_MAX_LIMBS]; /* R (mod p), i.e., 1 in Montgomery form */
+	ec_limb rr[EC_MAX_LIMBS]; /* R^2 (mod p) */
+	ec_limb b[EC_MAX_LIMBS]; /* curve coefficient b in Montgomery form */
+	ec_limb p_minus_2[EC_MAX_LIMBS]; /* exponent for inversion */
+	ec_limb sqrt_exp[EC_MAX_LIMBS]; /* (p + 1) / 4 for square roots */
+	ec_limb n[EC_MAX_LIMBS]; /* group order */
+	struct bignum *prime;
+	struct bignum *order;
+};
+
+/* Point in Jacobian coordinates (x = X / Z^2, y = Y / Z^3); Z = 0 is the
+ * point at infinity */
+struct crypto_ec_point {
+	ec_limb x[EC_MAX_LIMBS];
+	ec_limb y[EC_MAX_LIMBS];
+	ec_limb z[EC_MAX_LIMBS];
+};
+
+
+static void ec_bin_to_limbs(ec_limb *r, size_t limbs, const u8 *buf,
+			    size_t len)
+{
+	size_t i;
+
+	os_memset(r, 0, limbs * sizeof(ec_limb));
+	for (i = 0; i < len; i++)
+		r[i / EC_LIMB_BYTES] |=
+			((ec_limb) buf[len - 1 - i]) << (8 * (i % EC_LIMB_BYTES));
+}
+
+
+static void ec_limbs_to_bin(u8 *buf, size_t len, const ec_limb *a)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		buf[len - 1 - i] = a[i / EC_LIMB_BYTES] >>
+			(8 * (i % EC_LIMB_BYTES));
+}
+
+
+/* Returns all ones if a == 0, otherwise zero */
+static ec_limb ec_mask_is_zero(ec_limb a)
+{
+	ec_limb nz = (a | (0 - a)) >> (EC_LIMB_BITS - 1);
+	return nz - 1;
+}
+
+
+static ec_limb ec_fe_mask_is_zero(const struct crypto_ec *e, const ec_limb *a)
+{
+	ec_limb acc = 0;
+	size_t i;
+
+	for (i = 0; i < e->limbs; i++)
+		acc |= a[i];
+	return ec_mask_is_zero(acc);
+}
+
+
+static ec_limb ec_fe_mask_eq(const struct crypto_ec *e, const ec_limb *a,
+			     const ec_limb *b)
+{
+	ec_limb acc = 0;
+	size_t i;
+
+	for (i = 0; i < e->limbs; i++)
+		acc |= a[i] ^ b[i];
+	return ec_mask_is_zero(acc);
+}
+
+
+/* r = mask ? a : r */
+static void ec_fe_cmov(const struct crypto_ec *e, ec_limb *r,
+		       const ec_limb *a, ec_limb mask)
+{
+	size_t i;
+
+	for (i = 0; i < e->limbs; i++)
+		r[i] ^= mask & (r[i] ^ a[i]);
+}
+
+
+/* r = a - b; returns the borrow (0 or 1) */
+static ec_limb ec_limbs_sub(ec_limb *r, const ec_limb *a, const ec_limb *b,
+			    size_t limbs)
+{
+	ec_limb borrow = 0;
+	size_t i;
+
+	for (i = 0; i < limbs; i++) {
+		ec_dlimb d = (ec_dlimb) a[i] - b[i] - borrow;
+		r[i] = (ec_limb) d;
+		borrow = (ec_limb) (d >> EC_LIMB_BITS) & 1;
+	}
+	return borrow;
+}
+
+
+/* r = a + b (mod p) */
+static void ec_fe_add(const struct crypto_ec *e, ec_limb *r, const ec_limb *a,
+		      const ec_limb *b)
+{
+	ec_limb t[EC_MAX_LIMBS], carry = 0, borrow;
+	size_t i;
+
+	for (i = 0; i < e->limbs; i++) {
+		ec_dlimb s = (ec_dlimb) a[i] + b[i] + carry;
+		r[i] = (ec_limb) s;
+		carry = (ec_limb) (s >> EC_LIMB_BITS);
+	}
+	borrow = ec_limbs_sub(t, r, e->p, e->limbs);
+	/* Use the reduced value unless the subtraction of p underflowed */
+	ec_fe_cmov(e, r, t, ec_mask_is_zero(borrow & (carry ^ 1)));
+}
+
+
+/* r = a - b (mod p) */
+static void ec_fe_sub(const struct crypto_ec *e, ec_limb *r, const ec_limb *a,
+		      const ec_limb *b)
+{
+	ec_limb mask, carry = 0;
+	size_t i;
+
+	mask = 0 - ec_limbs_sub(r, a, b, e->limbs);
+	for (i = 0; i < e->limbs; i++) {
+		ec_dlimb s = (ec_dlimb) r[i] + (e->p[i] & mask) + carry;
+		r[i] = (ec_limb) s;
+		carry = (ec_limb) (s >> EC_LIMB_BITS);
+	}
+}
+
+
+/* r = a * b / R (mod p); Montgomery multiplication (CIOS) */
+static void ec_fe_mul(const struct crypto_ec *e, ec_limb *r, const ec_limb *a,
+		      const ec_limb *b)
+{
+	ec_limb t[EC_MAX_LIMBS + 2], u[EC_MAX_LIMBS], m, borrow;
+	ec_dlimb c;
+	size_t i, j, n = e->limbs;
+
+	os_memset(t, 0, sizeof(t));
+	for (i = 0; i < n; i++) {
+		c = 0;
+		for (j = 0; j < n; j++) {
+			c = (ec_dlimb) t[j] + (ec_dlimb) a[j] * b[i] +
+				(c >> EC_LIMB_BITS);
+			t[j] = (ec_limb) c;
+		}
+		c = (ec_dlimb) t[n] + (c >> EC_LIMB_BITS);
+		t[n] = (ec_limb) c;
+		t[n + 1] = (ec_limb) (c >> EC_LIMB_BITS);
+
+		m = t[0] * e->mu;
+		c = (ec_dlimb) t[0] + (ec_dlimb) m * e->p[0];
+		for (j = 1; j < n; j++) {
+			c = (ec_dlimb) t[j] + (ec_dlimb) m * e->p[j] +
+				(c >> EC_LIMB_BITS);
+			t[j - 1] = (ec_limb) c;
+		}
+		c = (ec_dlimb) t[n] + (c >> EC_LIMB_BITS);
+		t[n - 1] = (ec_limb) c;
+		t[n] = t[n + 1] + (ec_limb) (c >> EC_LIMB_BITS);
+	}
+
+	/* t < 2p; subtract p unless that underflows */
+	borrow = ec_limbs_sub(u, t, e->p, n);
+	os_memcpy(r, t, n * sizeof(ec_limb));
+	ec_fe_cmov(e, r, u, ec_mask_is_zero(borrow & (t[n] ^ 1)));
+}
+
+
+static void ec_fe_sqr(const struct crypto_ec *e, ec_limb *r, const ec_limb *a)
+{
+	ec_fe_mul(e, r, a, a);
+}
+
+
+/* r = a^exp (mod p); exp is public, a is in Montgomery form */
+static void ec_fe_pow(const struct crypto_ec *e, ec_limb *r, const ec_limb *a,
+		      const ec_limb *exp)
+{
+	ec_limb t[EC_MAX_LIMBS];
+	int i;
+
+	os_memcpy(t, e->one, sizeof(t));
+	for (i = e->limbs * EC_LIMB_BITS - 1; i >= 0; i--) {
+		ec_fe_sqr(e, t, t);
+		if ((exp[i / EC_LIMB_BITS] >> (i % EC_LIMB_BITS)) & 1)
+			ec_fe_mul(e, t, t, a);
+	}
+	os_memcpy(r, t, e->limbs * sizeof(ec_limb));
+}
+
+
+static void ec_fe_inv(const struct crypto_ec *e, ec_limb *r, const ec_limb *a)
+{
+	ec_fe_pow(e, r, a, e->p_minus_2);
+}
+
+
+static void ec_fe_to_mont(const struct crypto_ec *e, ec_limb *r,
+			  const ec_limb *a)
+{
+	ec_fe_mul(e, r, a, e->rr);
+}
+
+
+static void ec_fe_from_mont(const struct crypto_ec *e, ec_limb *r,
+			    const ec_limb *a)
+{
+	ec_limb one[EC_MAX_LIMBS];
+
+	os_memset(one, 0, sizeof(one));
+	one[0] = 1;
+	ec_fe_mul(e, r, a, one);
+}
+
+
+/* Read a field element from binary; returns -1 if the value is not < p */
+static int ec_fe_from_bin(const struct crypto_ec *e, ec_limb *r,
+			  const u8 *buf, size_t len)
+{
+	ec_limb t[EC_MAX_LIMBS];
+
+	if (len > e->len)
+		return -1;
+	ec_bin_to_limbs(t, e->limbs, buf, len);
+	if (!ec_limbs_sub(r, t, e->p, e->limbs))
+		return -1;
+	ec_fe_to_mont(e, r, t);
+	return 0;
+}
+
+
+static int ec_fe_from_bignum(const struct crypto_ec *e, ec_limb *r,
+			     const struct bignum *a)
+{
+	u8 buf[EC_MAX_PRIME_LEN];
+	size_t len = sizeof(buf);
+	int ret;
+
+	if (bignum_cmp_d(a, 0) < 0 ||
+	    bignum_get_unsigned_bin(a, buf, &len) < 0)
+		return -1;
+	ret = ec_fe_from_bin(e, r, buf, len);
+	os_memset(buf, 0, sizeof(buf));
+	return ret;
+}
+
+
+/* r = 2 * a; dbl-2001-b for a = -3 */
+static void ec_point_double(const struct crypto_ec *e,
+			    struct crypto_ec_point *r,
+			    const struct crypto_ec_point *a)
+{
+	ec_limb delta[EC_MAX_LIMBS], gamma[EC_MAX_LIMBS], beta[EC_MAX_LIMBS];
+	ec_limb alpha[EC_MAX_LIMBS], t1[EC_MAX_LIMBS], t2[EC_MAX_LIMBS];
+
+	ec_fe_sqr(e, delta, a->z);
+	ec_fe_sqr(e, gamma, a->y);
+	ec_fe_mul(e, beta, a->x, gamma);
+
+	/* alpha = 3 * (X1 - delta) * (X1 + delta) */
+	ec_fe_sub(e, t1, a->x, delta);
+	ec_fe_add(e, t2, a->x, delta);
+	ec_fe_mul(e, t1, t1, t2);
+	ec_fe_add(e, alpha, t1, t1);
+	ec_fe_add(e, alpha, alpha, t1);
+
+	/* Z3 = (Y1 + Z1)^2 - gamma - delta */
+	ec_fe_add(e, t1, a->y, a->z);
+	ec_fe_sqr(e, t1, t1);
+	ec_fe_sub(e, t1, t1, gamma);
+	ec_fe_sub(e, r->z, t1, delta);
+
+	/* X3 = alpha^2 - 8 * beta */
+	ec_fe_add(e, beta, beta, beta);
+	ec_fe_add(e, beta, beta, beta); /* 4 * beta */
+	ec_fe_add(e, t2, beta, beta);
+	ec_fe_sqr(e, t1, alpha);
+	ec_fe_sub(e, r->x, t1, t2);
+
+	/* Y3 = alpha * (4 * beta - X3) - 8 * gamma^2 */
+	ec_fe_sub(e, t1, beta, r->x);
+	ec_fe_mul(e, t1, alpha, t1);
+	ec_fe_sqr(e, gamma, gamma);
+	ec_fe_add(e, gamma, gamma, gamma);
+	ec_fe_add(e, gamma, gamma, gamma);
+	ec_fe_add(e, gamma, gamma, gamma);
+	ec_fe_sub(e, r->y, t1, gamma);
+}
+
+
+/*
+ * r = a + b; add-2007-bl. The result is the point at infinity if a = -b, but
+ * the other special cases (a = b or either input being the point at infinity)
+ * are not handled here. Returns all ones in *same if a = b.
+ */
+static void ec_point_add_generic(const struct crypto_ec *e,
+				 struct crypto_ec_point *r,
+				 const struct crypto_ec_point *a,
+				 const struct crypto_ec_point *b,
+				 ec_limb *same)
+{
+	ec_limb z1z1[EC_MAX_LIMBS], z2z2[EC_MAX_LIMBS], u1[EC_MAX_LIMBS];
+	ec_limb u2[EC_MAX_LIMBS], s1[EC_MAX_LIMBS], s2[EC_MAX_LIMBS];
+	ec_limb h[EC_MAX_LIMBS], i[EC_MAX_LIMBS], j[EC_MAX_LIMBS];
+	ec_limb rr[EC_MAX_LIMBS], v[EC_MAX_LIMBS];
+
+	ec_fe_sqr(e, z1z1, a->z);
+	ec_fe_sqr(e, z2z2, b->z);
+	ec_fe_mul(e, u1, a->x, z2z2);
+	ec_fe_mul(e, u2, b->x, z1z1);
+	ec_fe_mul(e, s1, a->y, b->z);
+	ec_fe_mul(e, s1, s1, z2z2);
+	ec_fe_mul(e, s2, b->y, a->z);
+	ec_fe_mul(e, s2, s2, z1z1);
+	ec_fe_sub(e, h, u2, u1);
+	ec_fe_sub(e, rr, s2, s1);
+	if (same)
+		*same = ec_fe_mask_is_zero(e, h) & ec_fe_mask_is_zero(e, rr);
+
+	/* I = (2 * H)^2, J = H * I, r = 2 * (S2 - S1), V = U1 * I */
+	ec_fe_add(e, i, h, h);
+	ec_fe_sqr(e, i, i);
+	ec_fe_mul(e, j, h, i);
+	ec_fe_add(e, rr, rr, rr);
+	ec_fe_mul(e, v, u1, i);
+
+	/* Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) * H */
+	ec_fe_add(e, u2, a->z, b->z);
+	ec_fe_sqr(e, u2, u2);
+	ec_fe_sub(e, u2, u2, z1z1);
+	ec_fe_sub(e, u2, u2, z2z2);
+	ec_fe_mul(e, r->z, u2, h);
+
+	/* X3 = r^2 - J - 2 * V */
+	ec_fe_sqr(e, u2, rr);
+	ec_fe_sub(e, u2, u2, j);
+	ec_fe_sub(e, u2, u2, v);
+	ec_fe_sub(e, r->x, u2, v);
+
+	/* Y3 = r * (V - X3) - 2 * S1 * J */
+	ec_fe_sub(e, v, v, r->x);
+	ec_fe_mul(e, v, rr, v);
+	ec_fe_mul(e, s1, s1, j);
+	ec_fe_add(e, s1, s1, s1);
+	ec_fe_sub(e, r->y, v, s1);
+}
+
+
+static void ec_point_cmov(const struct crypto_ec *e,
+			  struct crypto_ec_point *r,
+			  const struct crypto_ec_point *a, ec_limb mask)
+{
+	ec_fe_cmov(e, r->x, a->x, mask);
+	ec_fe_cmov(e, r->y, a->y, mask);
+	ec_fe_cmov(e, r->z, a->z, mask);
+}
+
+
+/* r = a + b for all inputs; r may point to a or b */
+static void ec_point_add(const struct crypto_ec *e, struct crypto_ec_point *r,
+			 const struct crypto_ec_point *a,
+			 const struct crypto_ec_point *b)
+{
+	struct crypto_ec_point sum, dbl;
+	ec_limb same, a_inf, b_inf;
+
+	a_inf = ec_fe_mask_is_zero(e, a->z);
+	b_inf = ec_fe_mask_is_zero(e, b->z);
+	ec_point_add_generic(e, &sum, a, b, &same);
+	ec_point_double(e, &dbl, a);
+	ec_point_cmov(e, &sum, &dbl, same & ~a_inf & ~b_inf);
+	ec_point_cmov(e, &sum, b, a_inf);
+	ec_point_cmov(e, &sum, a, b_inf);
+	os_memcpy(r, &sum, sizeof(sum));
+}
+
+
+/*
+ * r = k * a with a fixed window. The scalar k (big endian, e->len octets) must
+ * be smaller than the group order. Since the curves have cofactor 1, the
+ * accumulator is then never equal to the table entry being added (or its
+ * inverse) and only the point at infinity needs special handling.
+ */
+static void ec_point_mul(const struct crypto_ec *e, struct crypto_ec_point *r,
+			 const struct crypto_ec_point *a, const u8 *k)
+{
+	struct crypto_ec_point table[EC_WINDOW_SIZE], acc, sel, sum;
+	ec_limb sel_inf, acc_inf;
+	size_t i, j;
+	unsigned int digit;
+
+	os_memset(&table[0], 0, sizeof(table[0]));
+	os_memcpy(&table[1], a, sizeof(*a));
+	ec_point_double(e, &table[2], a);
+	for (i = 3; i < EC_WINDOW_SIZE; i++)
+		ec_point_add_generic(e, &table[i], &table[i - 1], a, NULL);
+
+	os_memset(&acc, 0, sizeof(acc));
+	for (i = 0; i < 2 * e->len; i++) {
+		for (j = 0; j < EC_WINDOW_BITS; j++)
+			ec_point_double(e, &acc, &acc);
+
+		digit = (k[i / 2] >> (i & 1 ? 0 : 4)) & 0x0f;
+		os_memset(&sel, 0, sizeof(sel));
+		for (j = 0; j < EC_WINDOW_SIZE; j++)
+			ec_point_cmov(e, &sel, &table[j],
+				      ec_mask_is_zero(j ^ digit));
+
+		/* a may be the point at infinity and then all entries are */
+		acc_inf = ec_fe_mask_is_zero(e, acc.z);
+		sel_inf = ec_fe_mask_is_zero(e, sel.z);
+		ec_point_add_generic(e, &sum, &acc, &sel, NULL);
+		ec_point_cmov(e, &sum, &sel, acc_inf);
+		ec_point_cmov(e, &sum, &acc, sel_inf);
+		os_memcpy(&acc, &sum, sizeof(acc));
+	}
+
+	os_memcpy(r, &acc, sizeof(acc));
+	os_memset(table, 0, sizeof(table));
+	os_memset(&acc, 0, sizeof(acc));
+	os_memset(&sel, 0, sizeof(sel));
+	os_memset(&sum, 0, sizeof(sum));
+}
+
+
+/* Affine coordinates (not in Montgomery form) of a point */
+static int ec_point_to_affine(const struct crypto_ec *e,
+			      const struct crypto_ec_point *a, ec_limb *x,
+			      ec_limb *y)
+{
+	ec_limb zinv[EC_MAX_LIMBS], t[EC_MAX_LIMBS];
+
+	if (ec_fe_mask_is_zero(e, a->z))
+		return -1;
+
+	ec_fe_inv(e, zinv, a->z);
+	ec_fe_sqr(e, t, zinv);
+	ec_fe_mul(e, x, a->x, t);
+	ec_fe_from_mont(e, x, x);
+	ec_fe_mul(e, t, t, zinv);
+	ec_fe_mul(e, y, a->y, t);
+	ec_fe_from_mont(e, y, y);
+	return 0;
+}
+
+
+/* r = x^3 - 3 * x + b */
+static void ec_curve_rhs(const struct crypto_ec *e, ec_limb *r,
+			 const ec_limb *x)
+{
+	ec_limb t[EC_MAX_LIMBS];
+
+	ec_fe_sqr(e, t, x);
+	ec_fe_mul(e, t, t, x);
+	ec_fe_sub(e, t, t, x);
+	ec_fe_sub(e, t, t, x);
+	ec_fe_sub(e, t, t, x);
+	ec_fe_add(e, r, t, e->b);
+}
+
+
+struct crypto_ec * crypto_ec_init(int group)
+{
+	const struct ec_curve *curve;
+	struct crypto_ec *e;
+	ec_limb tmp[EC_MAX_LIMBS], inv;
+	size_t i;
+
+	for (curve = ec_curves; curve->group; curve++) {
+		if (curve->group == group)
+			break;
+	}
+	if (curve->group == 0)
+		return NULL;
+
+	e = os_zalloc(sizeof(*e));
+	if (e == NULL)
+		return NULL;
+
+	e->len = curve->len;
+	e->limbs = curve->len / EC_LIMB_BYTES;
+	ec_bin_to_limbs(e->p, e->limbs, curve->prime, curve->len);
+
+	/* mu = -1 / p (mod 2^EC_LIMB_BITS) with Newton's method; each round
+	 * doubles the number of correct bits (starting from three) */
+	inv = e->p[0];
+	for (i = 0; i < 5; i++)
+		inv *= 2 - e->p[0] * inv;
+	e->mu = 0 - inv;
+
+	/* R = 2^(EC_LIMB_BITS * limbs) = -p (mod 2^(EC_LIMB_BITS * limbs)) is
+	 * smaller than p since the most significant bit of p is set */
+	os_memset(tmp, 0, sizeof(tmp));
+	ec_limbs_sub(e->one, tmp, e->p, e->limbs);
+	os_memcpy(e->rr, e->one, sizeof(e->rr));
+	for (i = 0; i < e->limbs * EC_LIMB_BITS; i++)
+		ec_fe_add(e, e->rr, e->rr, e->rr);
+
+	ec_bin_to_limbs(tmp, e->limbs, curve->b, curve->len);
+	ec_fe_to_mont(e, e->b, tmp);
+	ec_bin_to_limbs(e->n, e->limbs, curve->order, curve->len);
+
+	/* p - 2 and (p + 1) / 4 = (p >> 2) + 1 (p = 3 mod 4 for both curves) */
+	os_memset(tmp, 0, sizeof(tmp));
+	tmp[0] = 2;
+	ec_limbs_sub(e->p_minus_2, e->p, tmp, e->limbs);
+	for (i = 0; i < e->limbs; i++) {
+		e->sqrt_exp[i] = e->p[i] >> 2;
+		if (i + 1 < e->limbs)
+			e->sqrt_exp[i] |= e->p[i + 1] << (EC_LIMB_BITS - 2);
+	}
+	for (i = 0; i < e->limbs; i++) {
+		e->sqrt_exp[i]++;
+		if (e->sqrt_exp[i])
+			break;
+	}
+
+	e->prime = bignum_init();
+	e->order = bignum_init();
+	if (e->prime == NULL || e->order == NULL ||
+	    bignum_set_unsigned_bin(e->prime, curve->prime, curve->len) < 0 ||
+	    bignum_set_unsigned_bin(e->order, curve->order, curve->len) < 0) {
+		crypto_ec_deinit(e);
+		return NULL;
+	}
+
+	return e;
+}
+
+
+void crypto_ec_deinit(struct crypto_ec *e)
+{
+	if (e == NULL)
+		return;
+	bignum_deinit(e->prime);
+	bignum_deinit(e->order);
+	os_free(e);
+}
+
+
+struct crypto_ec_point * crypto_ec_point_init(struct crypto_ec *e)
+{
+	if (e == NULL)
+		return NULL;
+	/* All zero coordinates represent the point at infinity */
+	return os_zalloc(sizeof(struct crypto_ec_point));
+}
+
+
+size_t crypto_ec_prime_len(struct crypto_ec *e)
+{
+	return e->len;
+}
+
+
+size_t crypto_ec_prime_len_bits(struct crypto_ec *e)
+{
+	return bignum_get_bits(e->prime);
+}
+
+
+const struct crypto_bignum * crypto_ec_get_prime(struct crypto_ec *e)
+{
+	return (const struct crypto_bignum *) e->prime;
+}
+
+
+const struct crypto_bignum * crypto_ec_get_order(struct crypto_ec *e)
+{
+	return (const struct crypto_bignum *) e->order;
+}
+
+
+void crypto_ec_point_deinit(struct crypto_ec_point *p, int clear)
+{
+	if (p == NULL)
+		return;
+	if (clear)
+		os_memset(p, 0, sizeof(*p));
+	os_free(p);
+}
+
+
+int crypto_ec_point_to_bin(struct crypto_ec *e,
+			   const struct crypto_ec_point *point, u8 *x, u8 *y)
+{
+	ec_limb ax[EC_MAX_LIMBS], ay[EC_MAX_LIMBS];
+
+	if (ec_point_to_affine(e, point, ax, ay) < 0)
+		return -1;
+	if (x)
+		ec_limbs_to_bin(x, e->len, ax);
+	if (y)
+		ec_limbs_to_bin(y, e->len, ay);
+	return 0;
+}
+
+
+struct crypto_ec_point * crypto_ec_point_from_bin(struct crypto_ec *e,
+						  const u8 *val)
+{
+	struct crypto_ec_point *p;
+
+	p = crypto_ec_point_init(e);
+	if (p == NULL)
+		return NULL;
+
+	if (ec_fe_from_bin(e, p->x, val, e->len) < 0 ||
+	    ec_fe_from_bin(e, p->y, val + e->len, e->len) < 0) {
+		os_free(p);
+		return NULL;
+	}
+	os_memcpy(p->z, e->one, sizeof(p->z));
+
+	return p;
+}
+
+
+int crypto_ec_point_add(struct crypto_ec *e, const struct crypto_ec_point *a,
+			const struct crypto_ec_point *b,
+			struct crypto_ec_point *c)
+{
+	ec_point_add(e, c, a, b);
+	return 0;
+}
+
+
+int crypto_ec_point_mul(struct crypto_ec *e, const struct crypto_ec_point *p,
+			const struct crypto_bignum *b,
+			struct crypto_ec_point *res)
+{
+	const struct bignum *kb = (const struct bignum *) b;
+	struct bignum *tmp = NULL;
+	ec_limb k[EC_MAX_LIMBS], t[EC_MAX_LIMBS], borrow;
+	u8 buf[EC_MAX_PRIME_LEN];
+	size_t len = e->len;
+	int ret = -1;
+
+	if (bignum_cmp_d(kb, 0) < 0)
+		return -1;
+	if (bignum_get_unsigned_bin_len((struct bignum *) kb) > e->len) {
+		/* Longer scalars are not used with SAE; reduce them with the
+		 * generic (variable time) bignum operation */
+		tmp = bignum_init();
+		if (tmp == NULL || bignum_mod(kb, e->order, tmp) < 0)
+			goto fail;
+		kb = tmp;
+	}
+	if (bignum_get_unsigned_bin(kb, buf, &len) < 0)
+		goto fail;
+
+	/* The order has the same bit length as the prime, so k < 2 * order and
+	 * a single conditional subtraction reduces it */
+	ec_bin_to_limbs(k, e->limbs, buf, len);
+	borrow = ec_limbs_sub(t, k, e->n, e->limbs);
+	ec_fe_cmov(e, k, t, ec_mask_is_zero(borrow));
+	ec_limbs_to_bin(buf, e->len, k);
+
+	ec_point_mul(e, res, p, buf);
+	ret = 0;
+fail:
+	os_memset(buf, 0, sizeof(buf));
+	os_memset(k, 0, sizeof(k));
+	os_memset(t, 0, sizeof(t));
+	bignum_deinit(tmp);
+	return ret;
+}
+
+
+int crypto_ec_point_invert(struct crypto_ec *e, struct crypto_ec_point *p)
+{
+	ec_limb zero[EC_MAX_LIMBS];
+
+	os_memset(zero, 0, sizeof(zero));
+	ec_fe_sub(e, p->y, zero, p->y);
+	return 0;
+}
+
+
+int crypto_ec_point_solve_y_coord(struct crypto_ec *e,
+				  struct crypto_ec_point *p,
+				  const struct crypto_bignum *x, int y_bit)
+{
+	ec_limb fx[EC_MAX_LIMBS], rhs[EC_MAX_LIMBS], y[EC_MAX_LIMBS];
+	ec_limb t[EC_MAX_LIMBS], ok, odd;
+
+	if (ec_fe_from_bignum(e, fx, (const struct bignum *) x) < 0)
+		return -1;
+
+	/* y = rhs^((p + 1) / 4) is a square root of rhs if one exists */
+	ec_curve_rhs(e, rhs, fx);
+	ec_fe_pow(e, y, rhs, e->sqrt_exp);
+	ec_fe_sqr(e, t, y);
+	ok = ec_fe_mask_eq(e, t, rhs);
+
+	/* Select the root with the requested parity */
+	ec_fe_from_mont(e, t, y);
+	odd = (t[0] & 1) ^ (y_bit & 1);
+	os_memset(t, 0, sizeof(t));
+	ec_fe_sub(e, t, t, y);
+	ec_fe_cmov(e, y, t, 0 - odd);
+
+	os_memcpy(p->x, fx, sizeof(p->x));
+	os_memcpy(p->y, y, sizeof(p->y));
+	os_memcpy(p->z, e->one, sizeof(p->z));
+
+	return ok ? 0 : -1;
+}
+
+
+int crypto_ec_point_is_at_infinity(struct crypto_ec *e,
+				   const struct crypto_ec_point *p)
+{
+	return ec_fe_mask_is_zero(e, p->z) ? 1 : 0;
+}
+
+
+int crypto_ec_point_is_on_curve(struct crypto_ec *e,
+				const struct crypto_ec_point *p)
+{
+	ec_limb z2[EC_MAX_LIMBS], z4[EC_MAX_LIMBS], lhs[EC_MAX_LIMBS];
+	ec_limb rhs[EC_MAX_LIMBS], t[EC_MAX_LIMBS];
+
+	if (crypto_ec_point_is_at_infinity(e, p))
+		return 1;
+
+	/* Y^2 = X^3 - 3 * X * Z^4 + b * Z^6 */
+	ec_fe_sqr(e, lhs, p->y);
+	ec_fe_sqr(e, z2, p->z);
+	ec_fe_sqr(e, z4, z2);
+	ec_fe_sqr(e, rhs, p->x);
+	ec_fe_mul(e, rhs, rhs, p->x);
+	ec_fe_mul(e, t, p->x, z4);
+	ec_fe_sub(e, rhs, rhs, t);
+	ec_fe_sub(e, rhs, rhs, t);
+	ec_fe_sub(e, rhs, rhs, t);
+	ec_fe_mul(e, t, z4, z2);
+	ec_fe_mul(e, t, t, e->b);
+	ec_fe_add(e, rhs, rhs, t);
+
+	return ec_fe_mask_eq(e, lhs, rhs) ? 1 : 0;
+}
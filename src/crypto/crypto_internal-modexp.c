@@ -47,3 +47,153 @@ error:
 	bignum_deinit(bn_result);
 	return ret;
 }
+
+
+struct crypto_bignum * crypto_bignum_init(void)
+{
+	return (struct crypto_bignum *) bignum_init();
+}
+
+
+struct crypto_bignum * crypto_bignum_init_set(const u8 *buf, size_t len)
+{
+	struct bignum *bn = bignum_init();
+
+	if (bn && bignum_set_unsigned_bin(bn, buf, len) < 0) {
+		bignum_deinit(bn);
+		bn = NULL;
+	}
+	return (struct crypto_bignum *) bn;
+}
+
+
+void crypto_bignum_deinit(struct crypto_bignum *n, int clear)
+{
+	/* bignum_deinit() clears the value before freeing memory */
+	bignum_deinit((struct bignum *) n);
+}
+
+
+int crypto_bignum_to_bin(const struct crypto_bignum *a,
+			 u8 *buf, size_t buflen, size_t padlen)
+{
+	size_t num_bytes, offset;
+
+	if (padlen > buflen)
+		return -1;
+
+	num_bytes = bignum_get_unsigned_bin_len((struct bignum *) a);
+	if (num_bytes > buflen)
+		return -1;
+	if (padlen > num_bytes)
+		offset = padlen - num_bytes;
+	else
+		offset = 0;
+
+	os_memset(buf, 0, offset);
+	if (bignum_get_unsigned_bin((const struct bignum *) a, buf + offset,
+				    NULL) < 0)
+		return -1;
+
+	return num_bytes + offset;
+}
+
+
+int crypto_bignum_add(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	return bignum_add((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_mod(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	return bignum_mod((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_exptmod(const struct crypto_bignum *a,
+			  const struct crypto_bignum *b,
+			  const struct crypto_bignum *c,
+			  struct crypto_bignum *d)
+{
+	return bignum_exptmod((const struct bignum *) a,
+			      (const struct bignum *) b,
+			      (const struct bignum *) c, (struct bignum *) d);
+}
+
+
+int crypto_bignum_rshift(const struct crypto_bignum *a, int n,
+			 struct crypto_bignum *b)
+{
+	return bignum_rshift((const struct bignum *) a, n,
+			     (struct bignum *) b);
+}
+
+
+int crypto_bignum_inverse(const struct crypto_bignum *a,
+			  const struct crypto_bignum *b,
+			  struct crypto_bignum *c)
+{
+	return bignum_inverse((const struct bignum *) a,
+			      (const struct bignum *) b, (struct bignum *) c);
+}
+
+
+int crypto_bignum_sub(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	return bignum_sub((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_div(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	return bignum_div((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_mulmod(const struct crypto_bignum *a,
+			 const struct crypto_bignum *b,
+			 const struct crypto_bignum *c,
+			 struct crypto_bignum *d)
+{
+	return bignum_mulmod((const struct bignum *) a,
+			     (const struct bignum *) b,
+			     (const struct bignum *) c, (struct bignum *) d);
+}
+
+
+int crypto_bignum_cmp(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b)
+{
+	return bignum_cmp((const struct bignum *) a, (const struct bignum *) b);
+}
+
+
+int crypto_bignum_bits(const struct crypto_bignum *a)
+{
+	return bignum_get_bits((const struct bignum *) a);
+}
+
+
+int crypto_bignum_is_zero(const struct crypto_bignum *a)
+{
+	return bignum_cmp_d((const struct bignum *) a, 0) == 0;
+}
+
+
+int crypto_bignum_is_one(const struct crypto_bignum *a)
+{
+	return bignum_cmp_d((const struct bignum *) a, 1) == 0;
+}
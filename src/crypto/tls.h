@@ -77,6 +77,12 @@ struct tls_config {
 	void (*event_cb)(void *ctx, enum tls_event ev,
 			 union tls_event_data *data);
 	void *cb_ctx;
+
+	/* Server session cache; disabled if tls_session_lifetime is 0 */
+	unsigned int tls_session_lifetime;
+	unsigned int tls_session_cache_size;
+	int tls_session_tickets;
+	const char *tls_session_cache_file;
 };
 
 #define TLS_CONN_ALLOW_SIGN_RSA_MD5 BIT(0)
@@ -526,4 +532,33 @@ int __must_check  tls_connection_set_session_ticket_cb(
 	void *tls_ctx, struct tls_connection *conn,
 	tls_session_ticket_cb cb, void *ctx);
 
+/**
+ * tls_connection_set_session_context - Allow server side session resumption
+ * @tls_ctx: TLS context data from tls_init()
+ * @conn: Connection context data from tls_connection_init()
+ * @context: Session context; a session can only be resumed by a connection
+ * that uses the same context
+ * @context_len: Length of context in octets
+ * Returns: 0 on success, -1 on failure
+ *
+ * Server connections do not allow session resumption unless this function is
+ * called and the session cache has been enabled with tls_session_lifetime in
+ * struct tls_config. This is only suitable for EAP methods that do not need
+ * any state in addition to the TLS session to complete authentication after
+ * an abbreviated handshake, i.e., EAP-TLS; tunneled methods must not call
+ * this since resumption would skip their inner authentication.
+ */
+int __must_check tls_connection_set_session_context(
+	void *tls_ctx, struct tls_connection *conn, const u8 *context,
+	size_t context_len);
+
+/**
+ * tls_global_session_cache_stats - Get server session cache statistics
+ * @tls_ctx: TLS context data from tls_init()
+ * @buf: Buffer for the statistics in text format
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written into buf
+ */
+int tls_global_session_cache_stats(void *tls_ctx, char *buf, size_t buflen);
+
 #endif /* TLS_H */
@@ -15,6 +15,7 @@
 #include "tls.h"
 #include "tls/tlsv1_client.h"
 #include "tls/tlsv1_server.h"
+#include "tls/x509v3.h"
 
 
 static int tls_ref_count = 0;
@@ -23,6 +24,9 @@ struct tls_global {
 	int server;
 	struct tlsv1_credentials *server_cred;
 	int check_crl;
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	struct tlsv1_server_cache *session_cache;
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
 };
 
 struct tls_connection {
@@ -51,12 +55,28 @@ void * tls_init(const struct tls_config *conf)
 	if (global == NULL)
 		return NULL;
 
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	if (conf && conf->tls_session_lifetime) {
+		global->session_cache = tlsv1_server_cache_init(
+			conf->tls_session_cache_size,
+			conf->tls_session_lifetime, conf->tls_session_tickets,
+			conf->tls_session_cache_file);
+		if (global->session_cache == NULL) {
+			tls_deinit(global);
+			return NULL;
+		}
+	}
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
+
 	return global;
 }
 
 void tls_deinit(void *ssl_ctx)
 {
 	struct tls_global *global = ssl_ctx;
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	tlsv1_server_cache_deinit(global->session_cache);
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
 	tls_ref_count--;
 	if (tls_ref_count == 0) {
 #ifdef CONFIG_TLS_INTERNAL_CLIENT
@@ -66,6 +86,7 @@ void tls_deinit(void *ssl_ctx)
 		tlsv1_cred_free(global->server_cred);
 		tlsv1_server_global_deinit();
 #endif /* CONFIG_TLS_INTERNAL_SERVER */
+		x509_certificate_cache_flush();
 	}
 	os_free(global);
 }
@@ -102,6 +123,8 @@ struct tls_connection * tls_connection_init(void *tls_ctx)
 			os_free(conn);
 			return NULL;
 		}
+		tlsv1_server_set_session_cache(conn->server,
+					       global->session_cache);
 	}
 #endif /* CONFIG_TLS_INTERNAL_SERVER */
 
@@ -628,3 +651,27 @@ int tls_connection_set_session_ticket_cb(void *tls_ctx,
 #endif /* CONFIG_TLS_INTERNAL_SERVER */
 	return -1;
 }
+
+
+int tls_connection_set_session_context(void *tls_ctx,
+				       struct tls_connection *conn,
+				       const u8 *context, size_t context_len)
+{
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	if (conn->server)
+		return tlsv1_server_set_session_context(conn->server, context,
+							context_len);
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
+	return -1;
+}
+
+
+int tls_global_session_cache_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+#ifdef CONFIG_TLS_INTERNAL_SERVER
+	struct tls_global *global = tls_ctx;
+	return tlsv1_server_cache_stats(global->session_cache, buf, buflen);
+#else /* CONFIG_TLS_INTERNAL_SERVER */
+	return 0;
+#endif /* CONFIG_TLS_INTERNAL_SERVER */
+}
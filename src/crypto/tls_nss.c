@@ -643,3 +643,18 @@ int tls_connection_set_session_ticket_cb(void *tls_ctx,
 {
 	return -1;
 }
+
+
+int tls_connection_set_session_context(void *tls_ctx,
+				       struct tls_connection *conn,
+				       const u8 *context, size_t context_len)
+{
+	/* Server session cache is not supported */
+	return 0;
+}
+
+
+int tls_global_session_cache_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+	return 0;
+}
@@ -54,6 +54,9 @@ struct tls_global {
 			 union tls_event_data *data);
 	void *cb_ctx;
 	int cert_in_cb;
+	/* SSL_CTX ex_data index for marking contexts that have the server
+	 * session cache enabled */
+	int session_cache_idx;
 };
 
 static struct tls_global *tls_global = NULL;
@@ -700,6 +703,7 @@ void * tls_init(const struct tls_config *conf)
 			tls_global->cb_ctx = conf->cb_ctx;
 			tls_global->cert_in_cb = conf->cert_in_cb;
 		}
+		tls_global->session_cache_idx = -1;
 
 #ifdef CONFIG_FIPS
 #ifdef OPENSSL_FIPS
@@ -749,12 +753,48 @@ void * tls_init(const struct tls_config *conf)
 	}
 	tls_openssl_ref_count++;
 
+	if (tls_global->session_cache_idx < 0)
+		tls_global->session_cache_idx =
+			SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+
 	ssl = SSL_CTX_new(TLSv1_method());
 	if (ssl == NULL)
 		return NULL;
 
 	SSL_CTX_set_info_callback(ssl, ssl_info_cb);
 
+	if (conf && conf->tls_session_lifetime) {
+		if (conf->tls_session_cache_size) {
+			SSL_CTX_set_session_cache_mode(ssl,
+						       SSL_SESS_CACHE_SERVER);
+			SSL_CTX_sess_set_cache_size(
+				ssl, conf->tls_session_cache_size);
+		} else {
+			SSL_CTX_set_session_cache_mode(
+				ssl, SSL_SESS_CACHE_SERVER |
+				SSL_SESS_CACHE_NO_INTERNAL);
+		}
+		SSL_CTX_set_timeout(ssl, conf->tls_session_lifetime);
+#ifdef SSL_OP_NO_TICKET
+		if (!conf->tls_session_tickets)
+			SSL_CTX_set_options(ssl, SSL_OP_NO_TICKET);
+#endif /* SSL_OP_NO_TICKET */
+		/*
+		 * Mark that tls_connection_set_session_context() is allowed to
+		 * enable session resumption on server connections. No session
+		 * id context is set for the SSL_CTX since it would be copied
+		 * into all connections, including ones for tunneled methods.
+		 */
+		if (tls_global->session_cache_idx < 0 ||
+		    SSL_CTX_set_ex_data(ssl, tls_global->session_cache_idx,
+					ssl) != 1)
+			wpa_printf(MSG_INFO, "OpenSSL: Could not enable TLS "
+				   "session resumption");
+		if (conf->tls_session_cache_file)
+			wpa_printf(MSG_INFO, "OpenSSL: Saving TLS sessions "
+				   "into a file is not supported");
+	}
+
 #ifndef OPENSSL_NO_ENGINE
 	if (conf &&
 	    (conf->opensc_engine_path || conf->pkcs11_engine_path ||
@@ -3033,3 +3073,61 @@ int tls_connection_set_session_ticket_cb(void *tls_ctx,
 	return -1;
 #endif /* EAP_FAST || EAP_FAST_DYNAMIC || EAP_SERVER_FAST */
 }
+
+
+static int tls_session_cache_enabled(SSL_CTX *ssl)
+{
+	return tls_global && tls_global->session_cache_idx >= 0 &&
+		SSL_CTX_get_ex_data(ssl, tls_global->session_cache_idx) !=
+		NULL;
+}
+
+
+int tls_connection_set_session_context(void *tls_ctx,
+				       struct tls_connection *conn,
+				       const u8 *context, size_t context_len)
+{
+	SSL_CTX *ssl = tls_ctx;
+
+	if (conn == NULL)
+		return -1;
+	if (!tls_session_cache_enabled(ssl))
+		return 0; /* session cache not enabled */
+
+	if (SSL_set_session_id_context(conn->ssl, context,
+				       context_len) != 1) {
+		tls_show_errors(MSG_INFO, __func__,
+				"Failed to set session id context");
+		return -1;
+	}
+
+	return 0;
+}
+
+
+int tls_global_session_cache_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+	SSL_CTX *ssl = tls_ctx;
+	int ret;
+
+	if (!tls_session_cache_enabled(ssl))
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "entries=%ld\n"
+			  "size=%ld\n"
+			  "lifetime=%ld\n"
+			  "hits=%ld\n"
+			  "misses=%ld\n"
+			  "expired=%ld\n"
+			  "evicted=%ld\n",
+			  SSL_CTX_sess_number(ssl),
+			  SSL_CTX_sess_get_cache_size(ssl),
+			  SSL_CTX_get_timeout(ssl),
+			  SSL_CTX_sess_hits(ssl), SSL_CTX_sess_misses(ssl),
+			  SSL_CTX_sess_timeouts(ssl),
+			  SSL_CTX_sess_cache_full(ssl));
+	if (ret < 0 || (size_t) ret >= buflen)
+		return 0;
+	return ret;
+}
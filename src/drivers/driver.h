@@ -1693,6 +1693,22 @@ struct wpa_driver_ops {
 	int (*read_sta_data)(void *priv, struct hostap_sta_driver_data *data,
 			     const u8 *addr);
 
+	/**
+	 * read_sta_data_all - Fetch data for all stations (AP only)
+	 * @priv: Private driver interface data
+	 * @cb: Callback function to be called for each station
+	 * @cb_ctx: Context pointer for cb
+	 * Returns: 0 on success, -1 on failure
+	 *
+	 * This is an optional bulk version of read_sta_data() that fetches
+	 * the data for all stations of the BSS with a single driver request.
+	 * cb is called once for each station in the response.
+	 */
+	int (*read_sta_data_all)(void *priv,
+				 void (*cb)(void *ctx, const u8 *addr,
+					    struct hostap_sta_driver_data *data),
+				 void *cb_ctx);
+
 	/**
 	 * hapd_send_eapol - Send an EAPOL packet (AP only)
 	 * @priv: private driver interface data
@@ -10,6 +10,8 @@
  * See README for more details.
  */
 
+#define WPA_DEBUG_MODULE WPA_DEBUG_MODULE_DRIVER
+
 #include "includes.h"
 #include <sys/ioctl.h>
 #include <sys/types.h>
@@ -33,6 +35,7 @@
 #include "l2_packet/l2_packet.h"
 #include "netlink.h"
 #include "linux_ioctl.h"
+#include "linux_packet_ring.h"
 #include "radiotap.h"
 #include "radiotap_iter.h"
 #include "rfkill.h"
@@ -239,6 +242,7 @@ struct wpa_driver_nl80211_data {
 	unsigned int assoc_freq;
 
 	int monitor_sock;
+	struct linux_packet_ring *monitor_ring;
 	int monitor_ifidx;
 	int monitor_refcount;
 
@@ -3391,23 +3395,30 @@ nla_put_failure:
 }
 
 
-static int nl80211_mgmt_subscribe_ap(struct i802_bss *bss)
-{
-	static const int stypes[] = {
-		WLAN_FC_STYPE_AUTH,
-		WLAN_FC_STYPE_ASSOC_REQ,
-		WLAN_FC_STYPE_REASSOC_REQ,
-		WLAN_FC_STYPE_DISASSOC,
-		WLAN_FC_STYPE_DEAUTH,
-		WLAN_FC_STYPE_ACTION,
-		WLAN_FC_STYPE_PROBE_REQ,
+/*
+ * Management frame subtypes processed by hostapd in AP mode. These are
+ * registered for with nl80211_mgmt_subscribe_ap() and are the subtypes passed
+ * by the monitor socket filter when a monitor interface is used instead.
+ */
+static const u16 nl80211_ap_mgmt_stypes[] = {
+	WLAN_FC_STYPE_AUTH,
+	WLAN_FC_STYPE_ASSOC_REQ,
+	WLAN_FC_STYPE_REASSOC_REQ,
+	WLAN_FC_STYPE_DISASSOC,
+	WLAN_FC_STYPE_DEAUTH,
+	WLAN_FC_STYPE_ACTION,
+	WLAN_FC_STYPE_PROBE_REQ,
 /* Beacon doesn't work as mac80211 doesn't currently allow
  * it, but it wouldn't really be the right thing anyway as
  * it isn't per interface ... maybe just dump the scan
  * results periodically for OLBC?
  */
-//		WLAN_FC_STYPE_BEACON,
-	};
+//	WLAN_FC_STYPE_BEACON,
+};
+
+
+static int nl80211_mgmt_subscribe_ap(struct i802_bss *bss)
+{
 	unsigned int i;
 
 	if (nl80211_alloc_mgmt_handle(bss))
@@ -3415,10 +3426,11 @@ static int nl80211_mgmt_subscribe_ap(struct i802_bss *bss)
 	wpa_printf(MSG_DEBUG, "nl80211: Subscribe to mgmt frames with AP "
 		   "handle %p", bss->nl_mgmt);
 
-	for (i = 0; i < sizeof(stypes) / sizeof(stypes[0]); i++) {
+	for (i = 0; i < sizeof(nl80211_ap_mgmt_stypes) /
+		     sizeof(nl80211_ap_mgmt_stypes[0]); i++) {
 		if (nl80211_register_frame(bss, bss->nl_mgmt,
 					   (WLAN_FC_TYPE_MGMT << 2) |
-					   (stypes[i] << 4),
+					   (nl80211_ap_mgmt_stypes[i] << 4),
 					   NULL, 0) < 0) {
 			goto out_err;
 		}
@@ -6213,22 +6225,15 @@ static void handle_frame(struct wpa_driver_nl80211_data *drv,
 }
 
 
-static void handle_monitor_read(int sock, void *eloop_ctx, void *sock_ctx)
+static void handle_monitor_frame(void *ctx, u8 *buf, size_t buf_len)
 {
-	struct wpa_driver_nl80211_data *drv = eloop_ctx;
-	int len;
-	unsigned char buf[3000];
+	struct wpa_driver_nl80211_data *drv = ctx;
+	int len = buf_len;
 	struct ieee80211_radiotap_iterator iter;
 	int ret;
 	int datarate = 0, ssi_signal = 0;
 	int injected = 0, failed = 0, rxflags = 0;
 
-	len = recv(sock, buf, sizeof(buf), 0);
-	if (len < 0) {
-		perror("recv");
-		return;
-	}
-
 	if (ieee80211_radiotap_iterator_init(&iter, (void*)buf, len)) {
 		printf("received invalid radiotap frame\n");
 		return;
@@ -6281,6 +6286,28 @@ static void handle_monitor_read(int sock, void *eloop_ctx, void *sock_ctx)
 }
 
 
+static void handle_monitor_read(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct wpa_driver_nl80211_data *drv = eloop_ctx;
+	int len;
+	unsigned char buf[3000];
+
+	if (drv->monitor_ring) {
+		linux_packet_ring_read(drv->monitor_ring, handle_monitor_frame,
+				       drv);
+		return;
+	}
+
+	len = recv(sock, buf, sizeof(buf), 0);
+	if (len < 0) {
+		perror("recv");
+		return;
+	}
+
+	handle_monitor_frame(drv, buf, len);
+}
+
+
 /*
  * we post-process the filter code later and rewrite
  * this to the offset to the last instruction
@@ -6288,7 +6315,7 @@ static void handle_monitor_read(int sock, void *eloop_ctx, void *sock_ctx)
 #define PASS	0xFF
 #define FAIL	0xFE
 
-static struct sock_filter msock_filter_insns[] = {
+static const struct sock_filter msock_filter_head[] = {
 	/*
 	 * do a little-endian load of the radiotap length field
 	 */
@@ -6306,16 +6333,20 @@ static struct sock_filter msock_filter_insns[] = {
 	BPF_STMT(BPF_MISC| BPF_TAX, 0),
 
 	/*
-	 * Allow management frames through, this also gives us those
-	 * management frames that we sent ourselves with status
+	 * Allow all frames that we sent ourselves with status through, i.e.,
+	 * frames with the TX flags (bit 15) set in the radiotap present word
 	 */
-	/* load the lower byte of the IEEE 802.11 frame control field */
-	BPF_STMT(BPF_LD  | BPF_B | BPF_IND, 0),
-	/* mask off frame type and version */
-	BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xF),
-	/* accept frame if it's both 0, fall through otherwise */
-	BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, PASS, 0),
+	/* load the second byte of the radiotap it_present field */
+	BPF_STMT(BPF_LD  | BPF_B | BPF_ABS, 5),
+	/* accept frame if IEEE80211_RADIOTAP_TX_FLAGS is present */
+	BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, PASS, 0),
+};
 
+/*
+ * The management frame rules between these two parts are generated from
+ * nl80211_ap_mgmt_stypes[] in add_monitor_filter()
+ */
+static const struct sock_filter msock_filter_tail[] = {
 	/*
 	 * TODO: add a bit to radiotap RX flags that indicates
 	 * that the sending station is not associated, then
@@ -6388,19 +6419,62 @@ static struct sock_filter msock_filter_insns[] = {
 	BPF_STMT(BPF_RET | BPF_K, ~0),
 };
 
-static struct sock_fprog msock_filter = {
-	.len = sizeof(msock_filter_insns)/sizeof(msock_filter_insns[0]),
-	.filter = msock_filter_insns,
-};
+#define MSOCK_FILTER_HEAD_LEN \
+	(sizeof(msock_filter_head) / sizeof(msock_filter_head[0]))
+#define MSOCK_FILTER_TAIL_LEN \
+	(sizeof(msock_filter_tail) / sizeof(msock_filter_tail[0]))
+#define NUM_AP_MGMT_STYPES \
+	(sizeof(nl80211_ap_mgmt_stypes) / sizeof(nl80211_ap_mgmt_stypes[0]))
 
 
 static int add_monitor_filter(int s)
 {
+	struct sock_filter insns[MSOCK_FILTER_HEAD_LEN + 5 +
+				 NUM_AP_MGMT_STYPES + MSOCK_FILTER_TAIL_LEN];
+	struct sock_filter *insn = insns;
+	struct sock_fprog msock_filter;
+	unsigned int i;
 	int idx;
 
+	os_memcpy(insn, msock_filter_head, sizeof(msock_filter_head));
+	insn += MSOCK_FILTER_HEAD_LEN;
+
+	/*
+	 * Allow management frames through, but only the subtypes that are
+	 * registered for with nl80211_mgmt_subscribe_ap() without a monitor
+	 * interface and Beacon frames (OLBC detection)
+	 */
+	/* load the lower byte of the IEEE 802.11 frame control field */
+	*insn++ = (struct sock_filter)
+		BPF_STMT(BPF_LD  | BPF_B | BPF_IND, 0);
+	/* mask off frame type and version */
+	*insn++ = (struct sock_filter)
+		BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xF);
+	/* skip the management frame rules if not both 0 */
+	*insn++ = (struct sock_filter)
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 0,
+			 NUM_AP_MGMT_STYPES + 2);
+	/* reload the lower byte of the frame control field (subtype) */
+	*insn++ = (struct sock_filter)
+		BPF_STMT(BPF_LD  | BPF_B | BPF_IND, 0);
+	/* accept the listed subtypes */
+	for (i = 0; i < NUM_AP_MGMT_STYPES; i++)
+		*insn++ = (struct sock_filter)
+			BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+				 nl80211_ap_mgmt_stypes[i] << 4, PASS, 0);
+	/* accept Beacon frames, drop other subtypes */
+	*insn++ = (struct sock_filter)
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, WLAN_FC_STYPE_BEACON << 4,
+			 PASS, FAIL);
+
+	os_memcpy(insn, msock_filter_tail, sizeof(msock_filter_tail));
+
+	msock_filter.len = sizeof(insns) / sizeof(insns[0]);
+	msock_filter.filter = insns;
+
 	/* rewrite all PASS/FAIL jump offsets */
 	for (idx = 0; idx < msock_filter.len; idx++) {
-		struct sock_filter *insn = &msock_filter_insns[idx];
+		insn = &insns[idx];
 
 		if (BPF_CLASS(insn->code) == BPF_JMP) {
 			if (insn->code == (BPF_JMP|BPF_JA)) {
@@ -6445,6 +6519,8 @@ static void nl80211_remove_monitor_interface(
 	}
 	if (drv->monitor_sock >= 0) {
 		eloop_unregister_read_sock(drv->monitor_sock);
+		linux_packet_ring_deinit(drv->monitor_ring);
+		drv->monitor_ring = NULL;
 		close(drv->monitor_sock);
 		drv->monitor_sock = -1;
 	}
@@ -6529,6 +6605,11 @@ nl80211_create_monitor_interface(struct wpa_driver_nl80211_data *drv)
 		goto error;
 	}
 
+	drv->monitor_ring = linux_packet_ring_init(drv->monitor_sock);
+	if (drv->monitor_ring == NULL)
+		wpa_printf(MSG_DEBUG, "nl80211: Could not set up RX ring for "
+			   "monitor interface; use recv() for each frame");
+
 	if (eloop_register_read_sock(drv->monitor_sock, handle_monitor_read,
 				     drv, NULL)) {
 		printf("Could not register monitor read socket\n");
@@ -7750,11 +7831,9 @@ static int i802_flush(void *priv)
 #endif /* HOSTAPD || CONFIG_AP */
 
 
-static int get_sta_handler(struct nl_msg *msg, void *arg)
+static int nl80211_parse_sta_info(struct nlattr *tb[],
+				  struct hostap_sta_driver_data *data)
 {
-	struct nlattr *tb[NL80211_ATTR_MAX + 1];
-	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
-	struct hostap_sta_driver_data *data = arg;
 	struct nlattr *stats[NL80211_STA_INFO_MAX + 1];
 	static struct nla_policy stats_policy[NL80211_STA_INFO_MAX + 1] = {
 		[NL80211_STA_INFO_INACTIVE_TIME] = { .type = NLA_U32 },
@@ -7765,24 +7844,15 @@ static int get_sta_handler(struct nl_msg *msg, void *arg)
 		[NL80211_STA_INFO_TX_FAILED] = { .type = NLA_U32 },
 	};
 
-	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
-		  genlmsg_attrlen(gnlh, 0), NULL);
-
-	/*
-	 * TODO: validate the interface and mac address!
-	 * Otherwise, there's a race condition as soon as
-	 * the kernel starts sending station notifications.
-	 */
-
 	if (!tb[NL80211_ATTR_STA_INFO]) {
 		wpa_printf(MSG_DEBUG, "sta stats missing!");
-		return NL_SKIP;
+		return -1;
 	}
 	if (nla_parse_nested(stats, NL80211_STA_INFO_MAX,
 			     tb[NL80211_ATTR_STA_INFO],
 			     stats_policy)) {
 		wpa_printf(MSG_DEBUG, "failed to parse nested attributes!");
-		return NL_SKIP;
+		return -1;
 	}
 
 	if (stats[NL80211_STA_INFO_INACTIVE_TIME])
@@ -7802,6 +7872,27 @@ static int get_sta_handler(struct nl_msg *msg, void *arg)
 		data->tx_retry_failed =
 			nla_get_u32(stats[NL80211_STA_INFO_TX_FAILED]);
 
+	return 0;
+}
+
+
+static int get_sta_handler(struct nl_msg *msg, void *arg)
+{
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct hostap_sta_driver_data *data = arg;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+
+	/*
+	 * TODO: validate the interface and mac address!
+	 * Otherwise, there's a race condition as soon as
+	 * the kernel starts sending station notifications.
+	 */
+
+	nl80211_parse_sta_info(tb, data);
+
 	return NL_SKIP;
 }
 
@@ -7829,6 +7920,82 @@ static int i802_read_sta_data(void *priv, struct hostap_sta_driver_data *data,
 }
 
 
+struct nl80211_sta_dump_arg {
+	int ifindex;
+	void (*cb)(void *ctx, const u8 *addr,
+		   struct hostap_sta_driver_data *data);
+	void *cb_ctx;
+	unsigned int count;
+};
+
+
+static int get_sta_dump_handler(struct nl_msg *msg, void *arg)
+{
+	struct nl80211_sta_dump_arg *dump = arg;
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct hostap_sta_driver_data data;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+
+	if (!tb[NL80211_ATTR_MAC] ||
+	    nla_len(tb[NL80211_ATTR_MAC]) != ETH_ALEN)
+		return NL_SKIP;
+	if (tb[NL80211_ATTR_IFINDEX] &&
+	    (int) nla_get_u32(tb[NL80211_ATTR_IFINDEX]) != dump->ifindex)
+		return NL_SKIP;
+
+	os_memset(&data, 0, sizeof(data));
+	if (nl80211_parse_sta_info(tb, &data) < 0)
+		return NL_SKIP;
+
+	dump->count++;
+	dump->cb(dump->cb_ctx, nla_data(tb[NL80211_ATTR_MAC]), &data);
+
+	return NL_SKIP;
+}
+
+
+static int i802_read_sta_data_all(void *priv,
+				  void (*cb)(void *ctx, const u8 *addr,
+					     struct hostap_sta_driver_data *data),
+				  void *cb_ctx)
+{
+	struct i802_bss *bss = priv;
+	struct wpa_driver_nl80211_data *drv = bss->drv;
+	struct nl80211_sta_dump_arg dump;
+	struct nl_msg *msg;
+	int ret;
+
+	os_memset(&dump, 0, sizeof(dump));
+	dump.ifindex = if_nametoindex(bss->ifname);
+	dump.cb = cb;
+	dump.cb_ctx = cb_ctx;
+
+	msg = nlmsg_alloc();
+	if (!msg)
+		return -ENOMEM;
+
+	nl80211_cmd(drv, msg, NLM_F_DUMP, NL80211_CMD_GET_STATION);
+
+	NLA_PUT_U32(msg, NL80211_ATTR_IFINDEX, dump.ifindex);
+
+	ret = send_and_recv_msgs(drv, msg, get_sta_dump_handler, &dump);
+	if (ret < 0) {
+		wpa_printf(MSG_DEBUG, "nl80211: Station dump failed: %d (%s)",
+			   ret, strerror(-ret));
+		return ret;
+	}
+	wpa_printf(MSG_EXCESSIVE, "nl80211: Station dump for %s: %u entries",
+		   bss->ifname, dump.count);
+	return 0;
+ nla_put_failure:
+	nlmsg_free(msg);
+	return -ENOBUFS;
+}
+
+
 #if defined(HOSTAPD) || defined(CONFIG_AP)
 
 static int i802_set_tx_queue_params(void *priv, int queue, int aifs,
@@ -9581,6 +9748,7 @@ const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.sta_disassoc = i802_sta_disassoc,
 #endif /* HOSTAPD || CONFIG_AP */
 	.read_sta_data = i802_read_sta_data,
+	.read_sta_data_all = i802_read_sta_data_all,
 	.set_freq = i802_set_freq,
 	.send_action = wpa_driver_nl80211_send_action,
 	.send_action_cancel_wait = wpa_driver_nl80211_send_action_cancel_wait,
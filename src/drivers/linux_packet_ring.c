@@ -0,0 +1,187 @@
+/*
+ * Linux packet socket RX ring (PACKET_MMAP / TPACKET_V3)
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * The kernel fills in frames directly into a memory area that is shared with
+ * user space and wakes up the reader only once a block of frames has been
+ * completed (or the block retire timeout expires). This allows a busy monitor
+ * interface to be processed without a recv() system call per frame.
+ */
+
+#include "includes.h"
+#include <sys/mman.h>
+#include <linux/if_packet.h>
+
+#include "common.h"
+#include "linux_packet_ring.h"
+
+#ifdef TPACKET3_HDRLEN
+
+#define PACKET_RING_BLOCK_SIZE (1 << 16)
+#define PACKET_RING_BLOCK_NR 16
+#define PACKET_RING_FRAME_SIZE 4096
+/* Maximum latency (in ms) added to frame delivery with low traffic load */
+#define PACKET_RING_BLOCK_TIMEOUT 1
+
+struct linux_packet_ring {
+	u8 *map;
+	size_t map_len;
+	unsigned int block_size;
+	unsigned int block_nr;
+	unsigned int block_idx;
+	unsigned int in_read:1;
+	unsigned int pending_deinit:1;
+};
+
+
+struct linux_packet_ring * linux_packet_ring_init(int sock)
+{
+	struct linux_packet_ring *ring;
+	struct tpacket_req3 req;
+	int val = TPACKET_V3;
+
+	if (setsockopt(sock, SOL_PACKET, PACKET_VERSION, &val, sizeof(val)) <
+	    0) {
+		wpa_printf(MSG_DEBUG, "packet_ring: PACKET_VERSION: %s",
+			   strerror(errno));
+		return NULL;
+	}
+
+	os_memset(&req, 0, sizeof(req));
+	req.tp_block_size = PACKET_RING_BLOCK_SIZE;
+	req.tp_block_nr = PACKET_RING_BLOCK_NR;
+	req.tp_frame_size = PACKET_RING_FRAME_SIZE;
+	req.tp_frame_nr = PACKET_RING_BLOCK_SIZE / PACKET_RING_FRAME_SIZE *
+		PACKET_RING_BLOCK_NR;
+	req.tp_retire_blk_tov = PACKET_RING_BLOCK_TIMEOUT;
+	if (setsockopt(sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) <
+	    0) {
+		wpa_printf(MSG_DEBUG, "packet_ring: PACKET_RX_RING: %s",
+			   strerror(errno));
+		goto fail_version;
+	}
+
+	ring = os_zalloc(sizeof(*ring));
+	if (ring == NULL)
+		goto fail_ring;
+	ring->block_size = req.tp_block_size;
+	ring->block_nr = req.tp_block_nr;
+	ring->map_len = (size_t) req.tp_block_size * req.tp_block_nr;
+	ring->map = mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+			 MAP_SHARED, sock, 0);
+	if (ring->map == MAP_FAILED) {
+		wpa_printf(MSG_DEBUG, "packet_ring: mmap: %s",
+			   strerror(errno));
+		os_free(ring);
+		goto fail_ring;
+	}
+
+	wpa_printf(MSG_DEBUG, "packet_ring: Using %u x %u octet RX ring",
+		   ring->block_nr, ring->block_size);
+	return ring;
+
+fail_ring:
+	os_memset(&req, 0, sizeof(req));
+	setsockopt(sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+fail_version:
+	val = TPACKET_V1;
+	setsockopt(sock, SOL_PACKET, PACKET_VERSION, &val, sizeof(val));
+	return NULL;
+}
+
+
+static void linux_packet_ring_free(struct linux_packet_ring *ring)
+{
+	munmap(ring->map, ring->map_len);
+	os_free(ring);
+}
+
+
+void linux_packet_ring_deinit(struct linux_packet_ring *ring)
+{
+	if (ring == NULL)
+		return;
+	if (ring->in_read) {
+		/* Complete freeing in the end of linux_packet_ring_read() */
+		ring->pending_deinit = 1;
+		return;
+	}
+	linux_packet_ring_free(ring);
+}
+
+
+/**
+ * linux_packet_ring_read - Process all completed blocks from the RX ring
+ * @ring: RX ring from linux_packet_ring_init()
+ * @cb: Callback function to call for each received frame
+ * @ctx: Context data for cb
+ * Returns: Number of processed frames
+ *
+ * The callback function is allowed to call linux_packet_ring_deinit() for
+ * the ring. In that case, no more frames are delivered and the ring is freed
+ * before this function returns.
+ */
+int linux_packet_ring_read(struct linux_packet_ring *ring,
+			   void (*cb)(void *ctx, u8 *buf, size_t len),
+			   void *ctx)
+{
+	int count = 0;
+
+	ring->in_read = 1;
+	while (!ring->pending_deinit) {
+		struct tpacket_block_desc *bd;
+		struct tpacket3_hdr *hdr;
+		unsigned int i, num;
+
+		bd = (struct tpacket_block_desc *)
+			(ring->map + ring->block_idx * ring->block_size);
+		if (!(bd->hdr.bh1.block_status & TP_STATUS_USER))
+			break;
+		__sync_synchronize();
+
+		num = bd->hdr.bh1.num_pkts;
+		hdr = (struct tpacket3_hdr *)
+			((u8 *) bd + bd->hdr.bh1.offset_to_first_pkt);
+		for (i = 0; i < num && !ring->pending_deinit; i++) {
+			cb(ctx, (u8 *) hdr + hdr->tp_mac, hdr->tp_snaplen);
+			count++;
+			hdr = (struct tpacket3_hdr *)
+				((u8 *) hdr + hdr->tp_next_offset);
+		}
+
+		__sync_synchronize();
+		bd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+		ring->block_idx = (ring->block_idx + 1) % ring->block_nr;
+	}
+	ring->in_read = 0;
+
+	if (ring->pending_deinit)
+		linux_packet_ring_free(ring);
+
+	return count;
+}
+
+#else /* TPACKET3_HDRLEN */
+
+struct linux_packet_ring * linux_packet_ring_init(int sock)
+{
+	return NULL;
+}
+
+
+void linux_packet_ring_deinit(struct linux_packet_ring *ring)
+{
+}
+
+
+int linux_packet_ring_read(struct linux_packet_ring *ring,
+			   void (*cb)(void *ctx, u8 *buf, size_t len),
+			   void *ctx)
+{
+	return 0;
+}
+
+#endif /* TPACKET3_HDRLEN */
@@ -0,0 +1,20 @@
+/*
+ * Linux packet socket RX ring (PACKET_MMAP / TPACKET_V3)
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef LINUX_PACKET_RING_H
+#define LINUX_PACKET_RING_H
+
+struct linux_packet_ring;
+
+struct linux_packet_ring * linux_packet_ring_init(int sock);
+void linux_packet_ring_deinit(struct linux_packet_ring *ring);
+int linux_packet_ring_read(struct linux_packet_ring *ring,
+			   void (*cb)(void *ctx, u8 *buf, size_t len),
+			   void *ctx);
+
+#endif /* LINUX_PACKET_RING_H */
@@ -1144,6 +1144,7 @@ static int eap_fast_process_decrypted(struct eap_sm *sm,
 				      struct wpabuf **out_data)
 {
 	struct wpabuf *resp = NULL, *tmp;
+	struct wpabuf_chain chain;
 	struct eap_fast_tlv_parse tlv;
 	int failed = 0;
 
@@ -1165,6 +1166,8 @@ static int eap_fast_process_decrypted(struct eap_sm *sm,
 						 req->identifier, out_data);
 	}
 
+	wpabuf_chain_init(&chain);
+
 	if (tlv.crypto_binding) {
 		tmp = eap_fast_process_crypto_binding(sm, data, ret,
 						      tlv.crypto_binding,
@@ -1172,20 +1175,20 @@ static int eap_fast_process_decrypted(struct eap_sm *sm,
 		if (tmp == NULL)
 			failed = 1;
 		else
-			resp = wpabuf_concat(resp, tmp);
+			wpabuf_chain_add(&chain, tmp);
 	}
 
 	if (tlv.iresult == EAP_TLV_RESULT_SUCCESS) {
 		tmp = eap_fast_tlv_result(failed ? EAP_TLV_RESULT_FAILURE :
 					  EAP_TLV_RESULT_SUCCESS, 1);
-		resp = wpabuf_concat(resp, tmp);
+		wpabuf_chain_add(&chain, tmp);
 	}
 
 	if (tlv.eap_payload_tlv) {
 		tmp = eap_fast_process_eap_payload_tlv(
 			sm, data, ret, tlv.eap_payload_tlv,
 			tlv.eap_payload_tlv_len);
-		resp = wpabuf_concat(resp, tmp);
+		wpabuf_chain_add(&chain, tmp);
 	}
 
 	if (tlv.pac && tlv.result != EAP_TLV_RESULT_SUCCESS) {
@@ -1195,7 +1198,7 @@ static int eap_fast_process_decrypted(struct eap_sm *sm,
 	} else if (tlv.pac && tlv.result == EAP_TLV_RESULT_SUCCESS) {
 		tmp = eap_fast_process_pac(sm, data, ret, tlv.pac,
 					   tlv.pac_len);
-		resp = wpabuf_concat(resp, tmp);
+		wpabuf_chain_add(&chain, tmp);
 	}
 
 	if (data->current_pac == NULL && data->provisioning &&
@@ -1208,17 +1211,20 @@ static int eap_fast_process_decrypted(struct eap_sm *sm,
 		 */
 		wpa_printf(MSG_DEBUG, "EAP-FAST: Request Tunnel PAC");
 		tmp = eap_fast_pac_request();
-		resp = wpabuf_concat(resp, tmp);
+		wpabuf_chain_add(&chain, tmp);
 	}
 
 	if (tlv.result == EAP_TLV_RESULT_SUCCESS && !failed) {
 		tmp = eap_fast_tlv_result(EAP_TLV_RESULT_SUCCESS, 0);
-		resp = wpabuf_concat(tmp, resp);
+		wpabuf_chain_add_head(&chain, tmp);
 	} else if (failed) {
 		tmp = eap_fast_tlv_result(EAP_TLV_RESULT_FAILURE, 0);
-		resp = wpabuf_concat(tmp, resp);
+		wpabuf_chain_add_head(&chain, tmp);
 	}
 
+	/* Copy all TLVs into the response only once */
+	resp = wpabuf_chain_flatten(&chain);
+
 	if (resp && tlv.result == EAP_TLV_RESULT_SUCCESS && !failed &&
 	    tlv.crypto_binding && data->phase2_success) {
 		if (data->anon_provisioning) {
@@ -54,6 +54,7 @@ static void eap_tls_state(struct eap_tls_data *data, int state)
 static void * eap_tls_init(struct eap_sm *sm)
 {
 	struct eap_tls_data *data;
+	u8 context = EAP_TYPE_TLS;
 
 	data = os_zalloc(sizeof(*data));
 	if (data == NULL)
@@ -66,6 +67,16 @@ static void * eap_tls_init(struct eap_sm *sm)
 		return NULL;
 	}
 
+	/* EAP-TLS does not need any state in addition to the TLS session, so
+	 * an abbreviated handshake is enough for reauthentication */
+	if (tls_connection_set_session_context(sm->ssl_ctx, data->ssl.conn,
+					       &context, 1)) {
+		wpa_printf(MSG_INFO, "EAP-TLS: Failed to enable session "
+			   "resumption");
+		eap_tls_reset(sm, data);
+		return NULL;
+	}
+
 	data->eap_type = EAP_TYPE_TLS;
 
 	return data;
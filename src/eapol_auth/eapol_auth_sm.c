@@ -6,6 +6,8 @@
  * See README for more details.
  */
 
+#define WPA_DEBUG_MODULE WPA_DEBUG_MODULE_EAPOL
+
 #include "includes.h"
 
 #include "common.h"
@@ -42,6 +44,7 @@ sm->eapol->cb.set_port_authorized(sm->eapol->conf.ctx, sm->sta, 0)
 
 static void eapol_sm_step_run(struct eapol_state_machine *sm);
 static void eapol_sm_step_cb(void *eloop_ctx, void *timeout_ctx);
+static void eapol_port_timers_tick(void *eloop_ctx, void *timeout_ctx);
 static void eapol_auth_initialize(struct eapol_state_machine *sm);
 
 
@@ -136,57 +139,116 @@ static void eapol_auth_tx_req(struct eapol_state_machine *sm)
 }
 
 
+static int eapol_port_timers_running(struct eapol_state_machine *sm)
+{
+	return sm->aWhile > 0 || sm->quietWhile > 0 || sm->reAuthWhen > 0 ||
+		(sm->eap_if && sm->eap_if->retransWhile > 0);
+}
+
+
+/**
+ * eapol_port_timers_update - Update port timer tick registration
+ * @sm: EAPOL state machine
+ *
+ * This function adds the state machine to the list of state machines that are
+ * processed on the shared one second tick if any of its timers is running and
+ * removes it from the list once all timers have expired.
+ */
+static void eapol_port_timers_update(struct eapol_state_machine *sm)
+{
+	struct eapol_authenticator *eapol = sm->eapol;
+
+	if (!eapol_port_timers_running(sm)) {
+		if (sm->timer_list.next)
+			dl_list_del(&sm->timer_list);
+		return;
+	}
+
+	if (sm->timer_list.next == NULL)
+		dl_list_add_tail(&eapol->timer_list, &sm->timer_list);
+
+	if (!eapol->timer_tick_enabled) {
+		eapol->timer_tick_enabled = 1;
+		eloop_register_timeout(1, 0, eapol_port_timers_tick, eapol,
+				       NULL);
+	}
+}
+
+
 /**
  * eapol_port_timers_tick - Port Timers state machine
- * @eloop_ctx: struct eapol_state_machine *
+ * @eloop_ctx: struct eapol_authenticator *
  * @timeout_ctx: Not used
  *
  * This statemachine is implemented as a function that will be called
- * once a second as a registered event loop timeout.
+ * once a second as a registered event loop timeout. Only the state machines
+ * that have a running timer are processed; the tick is stopped when there are
+ * none.
  */
 static void eapol_port_timers_tick(void *eloop_ctx, void *timeout_ctx)
 {
-	struct eapol_state_machine *state = timeout_ctx;
-
-	if (state->aWhile > 0) {
-		state->aWhile--;
-		if (state->aWhile == 0) {
-			wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
-				   " - aWhile --> 0",
-				   MAC2STR(state->addr));
-		}
+	struct eapol_authenticator *eapol = eloop_ctx;
+	struct eapol_state_machine *state;
+	struct dl_list tick;
+
+	eapol->timer_tick_enabled = 0;
+
+	/*
+	 * Process the state machines from a separate list since stepping a
+	 * state machine can add or remove entries (including other stations)
+	 * in eapol->timer_list.
+	 */
+	dl_list_init(&tick);
+	while ((state = dl_list_first(&eapol->timer_list,
+				      struct eapol_state_machine,
+				      timer_list))) {
+		dl_list_del(&state->timer_list);
+		dl_list_add_tail(&tick, &state->timer_list);
 	}
 
-	if (state->quietWhile > 0) {
-		state->quietWhile--;
-		if (state->quietWhile == 0) {
-			wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
-				   " - quietWhile --> 0",
-				   MAC2STR(state->addr));
+	while ((state = dl_list_first(&tick, struct eapol_state_machine,
+				      timer_list))) {
+		dl_list_del(&state->timer_list);
+
+		if (state->aWhile > 0) {
+			state->aWhile--;
+			if (state->aWhile == 0) {
+				wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
+					   " - aWhile --> 0",
+					   MAC2STR(state->addr));
+			}
 		}
-	}
 
-	if (state->reAuthWhen > 0) {
-		state->reAuthWhen--;
-		if (state->reAuthWhen == 0) {
-			wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
-				   " - reAuthWhen --> 0",
-				   MAC2STR(state->addr));
+		if (state->quietWhile > 0) {
+			state->quietWhile--;
+			if (state->quietWhile == 0) {
+				wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
+					   " - quietWhile --> 0",
+					   MAC2STR(state->addr));
+			}
 		}
-	}
 
-	if (state->eap_if->retransWhile > 0) {
-		state->eap_if->retransWhile--;
-		if (state->eap_if->retransWhile == 0) {
-			wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
-				   " - (EAP) retransWhile --> 0",
-				   MAC2STR(state->addr));
+		if (state->reAuthWhen > 0) {
+			state->reAuthWhen--;
+			if (state->reAuthWhen == 0) {
+				wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
+					   " - reAuthWhen --> 0",
+					   MAC2STR(state->addr));
+			}
 		}
-	}
 
-	eapol_sm_step_run(state);
+		if (state->eap_if->retransWhile > 0) {
+			state->eap_if->retransWhile--;
+			if (state->eap_if->retransWhile == 0) {
+				wpa_printf(MSG_DEBUG, "IEEE 802.1X: " MACSTR
+					   " - (EAP) retransWhile --> 0",
+					   MAC2STR(state->addr));
+			}
+		}
 
-	eloop_register_timeout(1, 0, eapol_port_timers_tick, eloop_ctx, state);
+		eapol_port_timers_update(state);
+		eapol_sm_step_run(state);
+	}
 }
 
 
@@ -857,7 +919,8 @@ void eapol_auth_free(struct eapol_state_machine *sm)
 	if (sm == NULL)
 		return;
 
-	eloop_cancel_timeout(eapol_port_timers_tick, NULL, sm);
+	if (sm->timer_list.next)
+		dl_list_del(&sm->timer_list);
 	eloop_cancel_timeout(eapol_sm_step_cb, sm, NULL);
 	if (sm->eap)
 		eap_server_sm_deinit(sm->eap);
@@ -936,6 +999,7 @@ restart:
 			if (sm->eap_if->aaaEapRespData == NULL) {
 				wpa_printf(MSG_DEBUG, "EAPOL: aaaEapResp set, "
 					   "but no aaaEapRespData available");
+				eapol_port_timers_update(sm);
 				return;
 			}
 			sm->eapol->cb.aaa_send(
@@ -945,9 +1009,11 @@ restart:
 		}
 	}
 
-	if (eapol_sm_sta_entry_alive(eapol, addr))
+	if (eapol_sm_sta_entry_alive(eapol, addr)) {
+		eapol_port_timers_update(sm);
 		sm->eapol->cb.eapol_event(sm->eapol->conf.ctx, sm->sta,
 					  EAPOL_AUTH_SM_CHANGE);
+	}
 }
 
 
@@ -989,8 +1055,7 @@ static void eapol_auth_initialize(struct eapol_state_machine *sm)
 	sm->initializing = FALSE;
 
 	/* Start one second tick for port timers state machine */
-	eloop_cancel_timeout(eapol_port_timers_tick, NULL, sm);
-	eloop_register_timeout(1, 0, eapol_port_timers_tick, NULL, sm);
+	eapol_port_timers_update(sm);
 }
 
 
@@ -1125,6 +1190,8 @@ struct eapol_authenticator * eapol_auth_init(struct eapol_auth_config *conf,
 		eapol->default_wep_key_idx = 1;
 	}
 
+	dl_list_init(&eapol->timer_list);
+
 	eapol->cb.eapol_send = cb->eapol_send;
 	eapol->cb.aaa_send = cb->aaa_send;
 	eapol->cb.finished = cb->finished;
@@ -1145,6 +1212,7 @@ void eapol_auth_deinit(struct eapol_authenticator *eapol)
 	if (eapol == NULL)
 		return;
 
+	eloop_cancel_timeout(eapol_port_timers_tick, eapol, NULL);
 	eapol_auth_conf_free(&eapol->conf);
 	os_free(eapol->default_wep_key);
 	os_free(eapol);
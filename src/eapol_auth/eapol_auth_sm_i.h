@@ -9,6 +9,7 @@
 #ifndef EAPOL_AUTH_SM_I_H
 #define EAPOL_AUTH_SM_I_H
 
+#include "utils/list.h"
 #include "common/defs.h"
 #include "radius/radius.h"
 
@@ -30,6 +31,10 @@ struct eapol_authenticator {
 
 	u8 *default_wep_key;
 	u8 default_wep_key_idx;
+
+	/* State machines with at least one running port timer */
+	struct dl_list timer_list;
+	int timer_tick_enabled;
 };
 
 
@@ -41,6 +46,7 @@ struct eapol_state_machine {
 	int aWhile;
 	int quietWhile;
 	int reAuthWhen;
+	struct dl_list timer_list; /* in eapol->timer_list if timers run */
 
 	/* global variables */
 	Boolean authAbort;
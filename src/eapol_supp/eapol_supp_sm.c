@@ -6,6 +6,8 @@
  * See README for more details.
  */
 
+#define WPA_DEBUG_MODULE WPA_DEBUG_MODULE_EAPOL
+
 #include "includes.h"
 
 #include "common.h"
@@ -91,6 +91,27 @@ int l2_packet_get_own_addr(struct l2_packet_data *l2, u8 *addr);
 int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 		   const u8 *buf, size_t len);
 
+/**
+ * l2_packet_send_queued - Queue a packet for sending
+ * @l2: Pointer to internal l2_packet data from l2_packet_init()
+ * @dst_addr: Destination address for the packet (only used if l2_hdr == 0)
+ * @proto: Protocol/ethertype for the packet in host byte order (only used if
+ * l2_hdr == 0)
+ * @buf: Packet contents to be sent (see l2_packet_send())
+ * @len: Length of the buffer (including l2 header only if l2_hdr == 1)
+ * Returns: >=0 on success, <0 on failure
+ *
+ * This function can be used instead of l2_packet_send() when a number of
+ * packets may be sent from the same eloop iteration and the caller does not
+ * need to know whether the transmission succeeded. The packet contents are
+ * copied and the queued packets are sent at the end of the eloop iteration,
+ * in the order they were queued, with as few system calls as possible.
+ * l2_packet implementations that do not support this send the packet
+ * immediately.
+ */
+int l2_packet_send_queued(struct l2_packet_data *l2, const u8 *dst_addr,
+			  u16 proto, const u8 *buf, size_t len);
+
 /**
  * l2_packet_get_ip_addr - Get the current IP address from the interface
  * @l2: Pointer to internal l2_packet data from l2_packet_init()
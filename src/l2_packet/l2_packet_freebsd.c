@@ -72,6 +72,13 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
+int l2_packet_send_queued(struct l2_packet_data *l2, const u8 *dst_addr,
+			  u16 proto, const u8 *buf, size_t len)
+{
+	return l2_packet_send(l2, dst_addr, proto, buf, len);
+}
+
+
 static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 {
 	struct l2_packet_data *l2 = eloop_ctx;
@@ -6,6 +6,9 @@
  * See README for more details.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* recvmmsg(), sendmmsg() */
+#endif /* _GNU_SOURCE */
 #include "includes.h"
 #include <sys/ioctl.h>
 #include <netpacket/packet.h>
@@ -15,6 +18,28 @@
 #include "eloop.h"
 #include "l2_packet.h"
 
+#ifdef MSG_WAITFORONE
+/* Maximum number of frames to receive with a single recvmmsg() call */
+#define L2_PACKET_RX_BATCH 16
+#endif /* MSG_WAITFORONE */
+
+/* sendmmsg() was added in glibc 2.14 */
+#if defined(L2_PACKET_RX_BATCH) && \
+	(!defined(__GLIBC__) || __GLIBC__ > 2 || __GLIBC_MINOR__ >= 14)
+/* Maximum number of frames to queue for a single sendmmsg() call */
+#define L2_PACKET_TX_BATCH 16
+#endif
+
+#define L2_PACKET_RX_BUF_LEN 2300
+#define L2_PACKET_TX_BUF_LEN 2300
+
+#ifdef L2_PACKET_TX_BATCH
+struct l2_packet_tx {
+	struct sockaddr_ll ll;
+	size_t len;
+};
+#endif /* L2_PACKET_TX_BATCH */
+
 
 struct l2_packet_data {
 	int fd; /* packet socket for EAPOL frames */
@@ -26,6 +51,31 @@ struct l2_packet_data {
 	void *rx_callback_ctx;
 	int l2_hdr; /* whether to include layer 2 (Ethernet) header data
 		     * buffers */
+
+	/* RX batching statistics */
+	unsigned int rx_wakeups;
+	unsigned int rx_frames;
+	unsigned int rx_batch_max;
+
+	unsigned int in_rx:1; /* rx_callback() is being called */
+	unsigned int pending_free:1; /* deinit requested from rx_callback() */
+#ifdef L2_PACKET_RX_BATCH
+	unsigned int no_mmsg:1; /* recvmmsg() not supported by the kernel */
+	u8 *rx_bufs; /* L2_PACKET_RX_BATCH * L2_PACKET_RX_BUF_LEN octets */
+#endif /* L2_PACKET_RX_BATCH */
+
+#ifdef L2_PACKET_TX_BATCH
+	/* Frames queued with l2_packet_send_queued() */
+	unsigned int no_sendmmsg:1; /* sendmmsg() not supported by the kernel */
+	unsigned int tx_queued;
+	struct l2_packet_tx tx[L2_PACKET_TX_BATCH];
+	u8 *tx_bufs; /* L2_PACKET_TX_BATCH * L2_PACKET_TX_BUF_LEN octets */
+
+	/* TX batching statistics */
+	unsigned int tx_flushes;
+	unsigned int tx_frames;
+	unsigned int tx_batch_max;
+#endif /* L2_PACKET_TX_BATCH */
 };
 
 
@@ -66,14 +116,181 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
+#ifdef L2_PACKET_TX_BATCH
+
+static void l2_packet_tx_flush(struct l2_packet_data *l2)
+{
+	struct mmsghdr msgs[L2_PACKET_TX_BATCH];
+	struct iovec iov[L2_PACKET_TX_BATCH];
+	unsigned int i, sent = 0;
+	int res;
+
+	if (l2->tx_queued == 0)
+		return;
+
+	os_memset(msgs, 0, sizeof(msgs));
+	for (i = 0; i < l2->tx_queued; i++) {
+		iov[i].iov_base = l2->tx_bufs + i * L2_PACKET_TX_BUF_LEN;
+		iov[i].iov_len = l2->tx[i].len;
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		if (!l2->l2_hdr) {
+			msgs[i].msg_hdr.msg_name = &l2->tx[i].ll;
+			msgs[i].msg_hdr.msg_namelen = sizeof(l2->tx[i].ll);
+		}
+	}
+
+	while (sent < l2->tx_queued && !l2->no_sendmmsg) {
+		res = sendmmsg(l2->fd, &msgs[sent], l2->tx_queued - sent, 0);
+		if (res < 0 && errno == ENOSYS) {
+			wpa_printf(MSG_DEBUG, "l2_packet_send: sendmmsg() "
+				   "not supported - use sendto()");
+			l2->no_sendmmsg = 1;
+			break;
+		}
+		if (res <= 0) {
+			/* Drop the frame that could not be sent */
+			wpa_printf(MSG_ERROR, "l2_packet_send - sendmmsg: %s",
+				   strerror(errno));
+			res = 1;
+		}
+		sent += res;
+	}
+
+	for (i = sent; i < l2->tx_queued; i++) {
+		if (sendmsg(l2->fd, &msgs[i].msg_hdr, 0) < 0)
+			wpa_printf(MSG_ERROR, "l2_packet_send - sendmsg: %s",
+				   strerror(errno));
+	}
+
+	l2->tx_flushes++;
+	l2->tx_frames += l2->tx_queued;
+	if (l2->tx_queued > l2->tx_batch_max)
+		l2->tx_batch_max = l2->tx_queued;
+	l2->tx_queued = 0;
+}
+
+
+static void l2_packet_tx_flush_cb(void *eloop_ctx, void *user_ctx)
+{
+	l2_packet_tx_flush(eloop_ctx);
+}
+
+#endif /* L2_PACKET_TX_BATCH */
+
+
+int l2_packet_send_queued(struct l2_packet_data *l2, const u8 *dst_addr,
+			  u16 proto, const u8 *buf, size_t len)
+{
+#ifdef L2_PACKET_TX_BATCH
+	struct l2_packet_tx *tx;
+
+	if (l2 == NULL)
+		return -1;
+
+	if (l2->tx_bufs == NULL && !l2->no_sendmmsg)
+		l2->tx_bufs = os_malloc(L2_PACKET_TX_BATCH *
+					L2_PACKET_TX_BUF_LEN);
+	if (l2->tx_bufs == NULL || l2->no_sendmmsg ||
+	    len > L2_PACKET_TX_BUF_LEN ||
+	    (l2->tx_queued == 0 &&
+	     eloop_register_iteration_end(l2_packet_tx_flush_cb, l2,
+					  NULL) < 0)) {
+		/* Maintain the order with frames that were queued earlier */
+		l2_packet_tx_flush(l2);
+		return l2_packet_send(l2, dst_addr, proto, buf, len);
+	}
+
+	tx = &l2->tx[l2->tx_queued];
+	os_memcpy(l2->tx_bufs + l2->tx_queued * L2_PACKET_TX_BUF_LEN, buf,
+		  len);
+	tx->len = len;
+	if (!l2->l2_hdr) {
+		os_memset(&tx->ll, 0, sizeof(tx->ll));
+		tx->ll.sll_family = AF_PACKET;
+		tx->ll.sll_ifindex = l2->ifindex;
+		tx->ll.sll_protocol = htons(proto);
+		tx->ll.sll_halen = ETH_ALEN;
+		os_memcpy(tx->ll.sll_addr, dst_addr, ETH_ALEN);
+	}
+	l2->tx_queued++;
+	if (l2->tx_queued == L2_PACKET_TX_BATCH)
+		l2_packet_tx_flush(l2);
+
+	return 0;
+#else /* L2_PACKET_TX_BATCH */
+	return l2_packet_send(l2, dst_addr, proto, buf, len);
+#endif /* L2_PACKET_TX_BATCH */
+}
+
+
+static void l2_packet_rx_stats(struct l2_packet_data *l2, unsigned int frames)
+{
+	l2->rx_wakeups++;
+	l2->rx_frames += frames;
+	if (frames > l2->rx_batch_max)
+		l2->rx_batch_max = frames;
+}
+
+
+#ifdef L2_PACKET_RX_BATCH
+static int l2_packet_receive_batch(int sock, struct l2_packet_data *l2)
+{
+	struct mmsghdr msgs[L2_PACKET_RX_BATCH];
+	struct iovec iov[L2_PACKET_RX_BATCH];
+	struct sockaddr_ll ll[L2_PACKET_RX_BATCH];
+	int i, res;
+
+	os_memset(msgs, 0, sizeof(msgs));
+	os_memset(ll, 0, sizeof(ll));
+	for (i = 0; i < L2_PACKET_RX_BATCH; i++) {
+		iov[i].iov_base = l2->rx_bufs + i * L2_PACKET_RX_BUF_LEN;
+		iov[i].iov_len = L2_PACKET_RX_BUF_LEN;
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &ll[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(ll[i]);
+	}
+
+	res = recvmmsg(sock, msgs, L2_PACKET_RX_BATCH, MSG_DONTWAIT, NULL);
+	if (res < 0) {
+		if (errno == ENOSYS) {
+			wpa_printf(MSG_DEBUG, "l2_packet_receive: recvmmsg() "
+				   "not supported - use recvfrom()");
+			l2->no_mmsg = 1;
+			return -1;
+		}
+		wpa_printf(MSG_DEBUG, "l2_packet_receive - recvmmsg: %s",
+			   strerror(errno));
+		return 0;
+	}
+
+	l2_packet_rx_stats(l2, res);
+	l2->in_rx = 1;
+	for (i = 0; i < res && !l2->pending_free; i++) {
+		l2->rx_callback(l2->rx_callback_ctx, ll[i].sll_addr,
+				iov[i].iov_base, msgs[i].msg_len);
+	}
+	l2->in_rx = 0;
+
+	return 0;
+}
+#endif /* L2_PACKET_RX_BATCH */
+
+
 static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 {
 	struct l2_packet_data *l2 = eloop_ctx;
-	u8 buf[2300];
+	u8 buf[L2_PACKET_RX_BUF_LEN];
 	int res;
 	struct sockaddr_ll ll;
 	socklen_t fromlen;
 
+#ifdef L2_PACKET_RX_BATCH
+	if (!l2->no_mmsg && l2_packet_receive_batch(sock, l2) == 0)
+		goto done;
+#endif /* L2_PACKET_RX_BATCH */
+
 	os_memset(&ll, 0, sizeof(ll));
 	fromlen = sizeof(ll);
 	res = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *) &ll,
@@ -84,7 +301,28 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		return;
 	}
 
+	l2_packet_rx_stats(l2, 1);
+	l2->in_rx = 1;
 	l2->rx_callback(l2->rx_callback_ctx, ll.sll_addr, buf, res);
+	l2->in_rx = 0;
+
+#ifdef L2_PACKET_RX_BATCH
+done:
+#endif /* L2_PACKET_RX_BATCH */
+	if (l2->pending_free)
+		l2_packet_deinit(l2);
+}
+
+
+static void l2_packet_free(struct l2_packet_data *l2)
+{
+#ifdef L2_PACKET_RX_BATCH
+	os_free(l2->rx_bufs);
+#endif /* L2_PACKET_RX_BATCH */
+#ifdef L2_PACKET_TX_BATCH
+	os_free(l2->tx_bufs);
+#endif /* L2_PACKET_TX_BATCH */
+	os_free(l2);
 }
 
 
@@ -105,13 +343,18 @@ struct l2_packet_data * l2_packet_init(
 	l2->rx_callback = rx_callback;
 	l2->rx_callback_ctx = rx_callback_ctx;
 	l2->l2_hdr = l2_hdr;
+#ifdef L2_PACKET_RX_BATCH
+	l2->rx_bufs = os_malloc(L2_PACKET_RX_BATCH * L2_PACKET_RX_BUF_LEN);
+	if (l2->rx_bufs == NULL)
+		l2->no_mmsg = 1;
+#endif /* L2_PACKET_RX_BATCH */
 
 	l2->fd = socket(PF_PACKET, l2_hdr ? SOCK_RAW : SOCK_DGRAM,
 			htons(protocol));
 	if (l2->fd < 0) {
 		wpa_printf(MSG_ERROR, "%s: socket(PF_PACKET): %s",
 			   __func__, strerror(errno));
-		os_free(l2);
+		l2_packet_free(l2);
 		return NULL;
 	}
 	os_memset(&ifr, 0, sizeof(ifr));
@@ -120,7 +363,7 @@ struct l2_packet_data * l2_packet_init(
 		wpa_printf(MSG_ERROR, "%s: ioctl[SIOCGIFINDEX]: %s",
 			   __func__, strerror(errno));
 		close(l2->fd);
-		os_free(l2);
+		l2_packet_free(l2);
 		return NULL;
 	}
 	l2->ifindex = ifr.ifr_ifindex;
@@ -133,7 +376,7 @@ struct l2_packet_data * l2_packet_init(
 		wpa_printf(MSG_ERROR, "%s: bind[PF_PACKET]: %s",
 			   __func__, strerror(errno));
 		close(l2->fd);
-		os_free(l2);
+		l2_packet_free(l2);
 		return NULL;
 	}
 
@@ -141,7 +384,7 @@ struct l2_packet_data * l2_packet_init(
 		wpa_printf(MSG_ERROR, "%s: ioctl[SIOCGIFHWADDR]: %s",
 			   __func__, strerror(errno));
 		close(l2->fd);
-		os_free(l2);
+		l2_packet_free(l2);
 		return NULL;
 	}
 	os_memcpy(l2->own_addr, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
@@ -157,12 +400,44 @@ void l2_packet_deinit(struct l2_packet_data *l2)
 	if (l2 == NULL)
 		return;
 
+#ifdef L2_PACKET_TX_BATCH
+	eloop_cancel_iteration_end(l2_packet_tx_flush_cb, l2, NULL);
+	if (l2->fd >= 0)
+		l2_packet_tx_flush(l2);
+#endif /* L2_PACKET_TX_BATCH */
+
 	if (l2->fd >= 0) {
 		eloop_unregister_read_sock(l2->fd);
 		close(l2->fd);
+		l2->fd = -1;
 	}
-		
-	os_free(l2);
+
+	if (l2->in_rx) {
+		/* Complete freeing in the end of l2_packet_receive() */
+		l2->pending_free = 1;
+		return;
+	}
+
+	if (l2->rx_wakeups) {
+		wpa_printf(MSG_DEBUG, "l2_packet(%s): RX %u frames in %u "
+			   "wakeups (average batch %u.%02u, max %u)",
+			   l2->ifname, l2->rx_frames, l2->rx_wakeups,
+			   l2->rx_frames / l2->rx_wakeups,
+			   (l2->rx_frames % l2->rx_wakeups) * 100 /
+			   l2->rx_wakeups, l2->rx_batch_max);
+	}
+#ifdef L2_PACKET_TX_BATCH
+	if (l2->tx_flushes) {
+		wpa_printf(MSG_DEBUG, "l2_packet(%s): TX %u queued frames in "
+			   "%u flushes (average batch %u.%02u, max %u)",
+			   l2->ifname, l2->tx_frames, l2->tx_flushes,
+			   l2->tx_frames / l2->tx_flushes,
+			   (l2->tx_frames % l2->tx_flushes) * 100 /
+			   l2->tx_flushes, l2->tx_batch_max);
+	}
+#endif /* L2_PACKET_TX_BATCH */
+
+	l2_packet_free(l2);
 }
 
 
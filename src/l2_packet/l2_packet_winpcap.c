@@ -98,6 +98,13 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
+int l2_packet_send_queued(struct l2_packet_data *l2, const u8 *dst_addr,
+			  u16 proto, const u8 *buf, size_t len)
+{
+	return l2_packet_send(l2, dst_addr, proto, buf, len);
+}
+
+
 /* pcap_dispatch() callback for the RX thread */
 static void l2_packet_receive_cb(u_char *user, const struct pcap_pkthdr *hdr,
 				 const u_char *pkt_data)
@@ -46,45 +46,169 @@ static void p2p_scan_timeout(void *eloop_ctx, void *timeout_ctx);
 
 #define P2P_PEER_EXPIRATION_INTERVAL (P2P_PEER_EXPIRATION_AGE / 2)
 
-static void p2p_expire_peers(struct p2p_data *p2p)
+static unsigned int p2p_dev_hash(const u8 *addr)
 {
-	struct p2p_device *dev, *n;
-	struct os_time now;
-	size_t i;
+	return (addr[0] ^ addr[1] ^ addr[2] ^ addr[3] ^ addr[4] ^ addr[5]) &
+		(P2P_DEV_HASH_SIZE - 1);
+}
 
-	os_get_time(&now);
-	dl_list_for_each_safe(dev, n, &p2p->devices, struct p2p_device, list) {
-		if (dev->last_seen.sec + P2P_PEER_EXPIRATION_AGE >= now.sec)
-			continue;
 
-		if (p2p->cfg->go_connected &&
-		    p2p->cfg->go_connected(p2p->cfg->cb_ctx,
-					   dev->info.p2p_device_addr)) {
-			/*
-			 * We are connected as a client to a group in which the
-			 * peer is the GO, so do not expire the peer entry.
-			 */
-			os_get_time(&dev->last_seen);
-			continue;
-		}
+static void p2p_dev_heap_set(struct p2p_data *p2p, size_t i,
+			     struct p2p_device *dev)
+{
+	p2p->dev_heap[i] = dev;
+	dev->heap_idx = i;
+}
 
-		for (i = 0; i < p2p->num_groups; i++) {
-			if (p2p_group_is_client_connected(
-				    p2p->groups[i], dev->info.p2p_device_addr))
-				break;
+
+static void p2p_dev_heap_up(struct p2p_data *p2p, size_t i)
+{
+	struct p2p_device *dev = p2p->dev_heap[i];
+
+	while (i > 0) {
+		size_t parent = (i - 1) / 2;
+		if (!os_reltime_before(&dev->last_seen,
+				       &p2p->dev_heap[parent]->last_seen))
+			break;
+		p2p_dev_heap_set(p2p, i, p2p->dev_heap[parent]);
+		i = parent;
+	}
+	p2p_dev_heap_set(p2p, i, dev);
+}
+
+
+static void p2p_dev_heap_down(struct p2p_data *p2p, size_t i)
+{
+	struct p2p_device *dev = p2p->dev_heap[i];
+	size_t child;
+
+	while ((child = 2 * i + 1) < p2p->num_devices) {
+		if (child + 1 < p2p->num_devices &&
+		    os_reltime_before(&p2p->dev_heap[child + 1]->last_seen,
+				      &p2p->dev_heap[child]->last_seen))
+			child++;
+		if (!os_reltime_before(&p2p->dev_heap[child]->last_seen,
+				       &dev->last_seen))
+			break;
+		p2p_dev_heap_set(p2p, i, p2p->dev_heap[child]);
+		i = child;
+	}
+	p2p_dev_heap_set(p2p, i, dev);
+}
+
+
+static void p2p_dev_heap_del(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	size_t i = dev->heap_idx;
+
+	p2p->num_devices--;
+	if (i == p2p->num_devices)
+		return;
+	p2p_dev_heap_set(p2p, i, p2p->dev_heap[p2p->num_devices]);
+	p2p_dev_heap_up(p2p, i);
+	p2p_dev_heap_down(p2p, p2p->dev_heap[i]->heap_idx);
+}
+
+
+/**
+ * p2p_device_seen - Update the last_seen time of a peer entry
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ * @ts: Time when the peer was seen or %NULL to use the current time
+ */
+static void p2p_device_seen(struct p2p_data *p2p, struct p2p_device *dev,
+			    const struct os_reltime *ts)
+{
+	if (ts)
+		dev->last_seen = *ts;
+	else
+		os_get_reltime(&dev->last_seen);
+	p2p_dev_heap_up(p2p, dev->heap_idx);
+	p2p_dev_heap_down(p2p, dev->heap_idx);
+}
+
+
+static void p2p_iface_hash_del(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	struct p2p_device **pos;
+
+	if (is_zero_ether_addr(dev->interface_addr))
+		return;
+	for (pos = &p2p->iface_hash[p2p_dev_hash(dev->interface_addr)]; *pos;
+	     pos = &(*pos)->iface_hnext) {
+		if (*pos == dev) {
+			*pos = dev->iface_hnext;
+			break;
 		}
-		if (i < p2p->num_groups) {
+	}
+}
+
+
+static void p2p_device_set_interface_addr(struct p2p_data *p2p,
+					  struct p2p_device *dev,
+					  const u8 *addr)
+{
+	unsigned int hash;
+
+	if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
+		return;
+	p2p_iface_hash_del(p2p, dev);
+	os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+	if (is_zero_ether_addr(addr))
+		return;
+	hash = p2p_dev_hash(addr);
+	dev->iface_hnext = p2p->iface_hash[hash];
+	p2p->iface_hash[hash] = dev;
+}
+
+
+static int p2p_peer_in_use(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	size_t i;
+
+	if (p2p->cfg->go_connected &&
+	    p2p->cfg->go_connected(p2p->cfg->cb_ctx,
+				   dev->info.p2p_device_addr)) {
+		/*
+		 * We are connected as a client to a group in which the peer is
+		 * the GO, so do not expire the peer entry.
+		 */
+		return 1;
+	}
+
+	for (i = 0; i < p2p->num_groups; i++) {
+		if (p2p_group_is_client_connected(p2p->groups[i],
+						  dev->info.p2p_device_addr)) {
 			/*
 			 * The peer is connected as a client in a group where
 			 * we are the GO, so do not expire the peer entry.
 			 */
-			os_get_time(&dev->last_seen);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+static void p2p_expire_peers(struct p2p_data *p2p)
+{
+	struct p2p_device *dev;
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	while (p2p->num_devices > 0) {
+		dev = p2p->dev_heap[0];
+		if (dev->last_seen.sec + P2P_PEER_EXPIRATION_AGE >= now.sec)
+			break;
+
+		if (p2p_peer_in_use(p2p, dev)) {
+			p2p_device_seen(p2p, dev, &now);
 			continue;
 		}
 
 		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: Expiring old peer "
 			"entry " MACSTR, MAC2STR(dev->info.p2p_device_addr));
-		dl_list_del(&dev->list);
 		p2p_device_free(p2p, dev);
 	}
 }
@@ -93,9 +217,22 @@ static void p2p_expire_peers(struct p2p_data *p2p)
 static void p2p_expiration_timeout(void *eloop_ctx, void *timeout_ctx)
 {
 	struct p2p_data *p2p = eloop_ctx;
+	struct os_reltime now;
+	os_time_t next = P2P_PEER_EXPIRATION_INTERVAL;
+
 	p2p_expire_peers(p2p);
-	eloop_register_timeout(P2P_PEER_EXPIRATION_INTERVAL, 0,
-			       p2p_expiration_timeout, p2p, NULL);
+
+	/* Wake up when the least recently seen peer is due to expire */
+	if (p2p->num_devices > 0) {
+		os_get_reltime(&now);
+		next = p2p->dev_heap[0]->last_seen.sec +
+			P2P_PEER_EXPIRATION_AGE + 1 - now.sec;
+		if (next < 1)
+			next = 1;
+		else if (next > P2P_PEER_EXPIRATION_INTERVAL)
+			next = P2P_PEER_EXPIRATION_INTERVAL;
+	}
+	eloop_register_timeout(next, 0, p2p_expiration_timeout, p2p, NULL);
 }
 
 
@@ -336,7 +473,8 @@ static void p2p_device_clear_reported(struct p2p_data *p2p)
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->dev_hash[p2p_dev_hash(addr)]; dev; dev = dev->hnext) {
 		if (os_memcmp(dev->info.p2p_device_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -354,7 +492,9 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->iface_hash[p2p_dev_hash(addr)]; dev;
+	     dev = dev->iface_hnext) {
 		if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -369,30 +509,35 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
  * Returns: Pointer to the device entry or %NULL on failure
  *
  * If there is already an entry for the peer, it will be returned instead of
- * creating a new one.
+ * creating a new one. If the peer table is full, the least recently seen
+ * peer is removed to make room for the new entry.
  */
 static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 					     const u8 *addr)
 {
-	struct p2p_device *dev, *oldest = NULL;
-	size_t count = 0;
+	struct p2p_device *dev;
+	unsigned int hash;
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev)
 		return dev;
 
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
-		count++;
-		if (oldest == NULL ||
-		    os_time_before(&dev->last_seen, &oldest->last_seen))
-			oldest = dev;
-	}
-	if (count + 1 > p2p->cfg->max_peers && oldest) {
+	if (p2p->num_devices > 0 &&
+	    p2p->num_devices + 1 > p2p->cfg->max_peers) {
 		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG,
 			"P2P: Remove oldest peer entry to make room for a new "
 			"peer");
-		dl_list_del(&oldest->list);
-		p2p_device_free(p2p, oldest);
+		p2p_device_free(p2p, p2p->dev_heap[0]);
+	}
+
+	if (p2p->num_devices == p2p->dev_heap_size) {
+		struct p2p_device **heap;
+		size_t size = p2p->dev_heap_size ? p2p->dev_heap_size * 2 : 16;
+		heap = os_realloc_array(p2p->dev_heap, size, sizeof(*heap));
+		if (heap == NULL)
+			return NULL;
+		p2p->dev_heap = heap;
+		p2p->dev_heap_size = size;
 	}
 
 	dev = os_zalloc(sizeof(*dev));
@@ -400,6 +545,12 @@ static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 		return NULL;
 	dl_list_add(&p2p->devices, &dev->list);
 	os_memcpy(dev->info.p2p_device_addr, addr, ETH_ALEN);
+	hash = p2p_dev_hash(addr);
+	dev->hnext = p2p->dev_hash[hash];
+	p2p->dev_hash[hash] = dev;
+	/* last_seen is zero, so the new entry starts at the top of the heap */
+	p2p_dev_heap_set(p2p, p2p->num_devices++, dev);
+	p2p_dev_heap_up(p2p, dev->heap_idx);
 
 	return dev;
 }
@@ -487,9 +638,9 @@ static int p2p_add_group_clients(struct p2p_data *p2p, const u8 *go_dev_addr,
 			dev->flags |= P2P_DEV_REPORTED | P2P_DEV_REPORTED_ONCE;
 		}
 
-		os_memcpy(dev->interface_addr, cli->p2p_interface_addr,
-			  ETH_ALEN);
-		os_get_time(&dev->last_seen);
+		p2p_device_set_interface_addr(p2p, dev,
+					      cli->p2p_interface_addr);
+		p2p_device_seen(p2p, dev, NULL);
 		os_memcpy(dev->member_in_go_dev, go_dev_addr, ETH_ALEN);
 		os_memcpy(dev->member_in_go_iface, go_interface_addr,
 			  ETH_ALEN);
@@ -602,7 +753,7 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 	struct p2p_message msg;
 	const u8 *p2p_dev_addr;
 	int i;
-	struct os_time time_now, time_tmp_age, entry_ts;
+	struct os_reltime time_now, time_tmp_age, entry_ts;
 
 	os_memset(&msg, 0, sizeof(msg));
 	if (p2p_parse_ies(ies, ies_len, &msg)) {
@@ -639,27 +790,27 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 		return -1;
 	}
 
-	os_get_time(&time_now);
+	os_get_reltime(&time_now);
 	time_tmp_age.sec = age_ms / 1000;
 	time_tmp_age.usec = (age_ms % 1000) * 1000;
-	os_time_sub(&time_now, &time_tmp_age, &entry_ts);
+	os_reltime_sub(&time_now, &time_tmp_age, &entry_ts);
 
 	/*
 	 * Update the device entry only if the new peer
 	 * entry is newer than the one previously stored.
 	 */
 	if (dev->last_seen.usec > 0 &&
-	    os_time_before(&entry_ts, &dev->last_seen)) {
+	    os_reltime_before(&entry_ts, &dev->last_seen)) {
 		p2p_parse_free(&msg);
 		return -1;
 	}
 
-	os_memcpy(&dev->last_seen, &entry_ts, sizeof(struct os_time));
+	p2p_device_seen(p2p, dev, &entry_ts);
 
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY);
 
 	if (os_memcmp(addr, p2p_dev_addr, ETH_ALEN) != 0)
-		os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev, addr);
 	if (msg.ssid &&
 	    (msg.ssid[1] != P2P_WILDCARD_SSID_LEN ||
 	     os_memcmp(msg.ssid + 2, P2P_WILDCARD_SSID, P2P_WILDCARD_SSID_LEN)
@@ -750,8 +901,20 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 
 static void p2p_device_free(struct p2p_data *p2p, struct p2p_device *dev)
 {
+	struct p2p_device **pos;
 	int i;
 
+	for (pos = &p2p->dev_hash[p2p_dev_hash(dev->info.p2p_device_addr)];
+	     *pos; pos = &(*pos)->hnext) {
+		if (*pos == dev) {
+			*pos = dev->hnext;
+			break;
+		}
+	}
+	p2p_iface_hash_del(p2p, dev);
+	p2p_dev_heap_del(p2p, dev);
+	dl_list_del(&dev->list);
+
 	if (p2p->go_neg_peer == dev) {
 		/*
 		 * If GO Negotiation is in progress, report that it has failed.
@@ -1424,7 +1587,7 @@ int p2p_authorize(struct p2p_data *p2p, const u8 *peer_addr,
 void p2p_add_dev_info(struct p2p_data *p2p, const u8 *addr,
 		      struct p2p_device *dev, struct p2p_message *msg)
 {
-	os_get_time(&dev->last_seen);
+	p2p_device_seen(p2p, dev, NULL);
 
 	p2p_copy_wps_info(dev, 0, msg);
 
@@ -1770,7 +1933,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 	if (dev) {
 		if (dev->country[0] == 0 && msg.listen_channel)
 			os_memcpy(dev->country, msg.listen_channel, 3);
-		os_get_time(&dev->last_seen);
+		p2p_device_seen(p2p, dev, NULL);
 		p2p_parse_free(&msg);
 		return; /* already known */
 	}
@@ -1781,7 +1944,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 		return;
 	}
 
-	os_get_time(&dev->last_seen);
+	p2p_device_seen(p2p, dev, NULL);
 	dev->flags |= P2P_DEV_PROBE_REQ_ONLY;
 
 	if (msg.listen_channel) {
@@ -1817,7 +1980,7 @@ struct p2p_device * p2p_add_dev_from_go_neg_req(struct p2p_data *p2p,
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev) {
-		os_get_time(&dev->last_seen);
+		p2p_device_seen(p2p, dev, NULL);
 		return dev; /* already known */
 	}
 
@@ -2438,6 +2601,7 @@ void p2p_deinit(struct p2p_data *p2p)
 	os_free(p2p->cfg->serial_number);
 	os_free(p2p->cfg->pref_chan);
 	os_free(p2p->groups);
+	os_free(p2p->dev_heap);
 	wpabuf_free(p2p->sd_resp);
 	os_free(p2p->after_scan_tx);
 	p2p_remove_wps_vendor_extensions(p2p);
@@ -2450,10 +2614,8 @@ void p2p_flush(struct p2p_data *p2p)
 	struct p2p_device *dev, *prev;
 	p2p_stop_find(p2p);
 	dl_list_for_each_safe(dev, prev, &p2p->devices, struct p2p_device,
-			      list) {
-		dl_list_del(&dev->list);
+			      list)
 		p2p_device_free(p2p, dev);
-	}
 	p2p_free_sd_queries(p2p);
 	os_free(p2p->after_scan_tx);
 	p2p->after_scan_tx = NULL;
@@ -3448,7 +3610,7 @@ int p2p_get_peer_info_txt(const struct p2p_peer_info *info,
 	struct p2p_device *dev;
 	int res;
 	char *pos, *end;
-	struct os_time now;
+	struct os_reltime now;
 
 	if (info == NULL)
 		return -1;
@@ -3459,7 +3621,7 @@ int p2p_get_peer_info_txt(const struct p2p_peer_info *info,
 	pos = buf;
 	end = buf + buflen;
 
-	os_get_time(&now);
+	os_get_reltime(&now);
 	res = os_snprintf(pos, end - pos,
 			  "age=%d\n"
 			  "listen_freq=%d\n"
@@ -3576,6 +3738,14 @@ int p2p_peer_known(struct p2p_data *p2p, const u8 *addr)
 }
 
 
+size_t p2p_get_peer_count(struct p2p_data *p2p, size_t *max_peers)
+{
+	if (max_peers)
+		*max_peers = p2p->cfg->max_peers;
+	return p2p->num_devices;
+}
+
+
 void p2p_set_client_discoverability(struct p2p_data *p2p, int enabled)
 {
 	if (enabled) {
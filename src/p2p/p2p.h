@@ -1569,6 +1569,14 @@ int p2p_get_peer_info_txt(const struct p2p_peer_info *info,
  */
 int p2p_peer_known(struct p2p_data *p2p, const u8 *addr);
 
+/**
+ * p2p_get_peer_count - Get the number of entries in the P2P peer table
+ * @p2p: P2P module context from p2p_init()
+ * @max_peers: Buffer for the maximum size of the peer table or %NULL
+ * Returns: Number of peers currently in the table
+ */
+size_t p2p_get_peer_count(struct p2p_data *p2p, size_t *max_peers);
+
 /**
  * p2p_set_client_discoverability - Set client discoverability capability
  * @p2p: P2P module context from p2p_init()
@@ -23,7 +23,10 @@ enum p2p_go_state {
  */
 struct p2p_device {
 	struct dl_list list;
-	struct os_time last_seen;
+	struct p2p_device *hnext; /* next entry in P2P Device Address hash */
+	struct p2p_device *iface_hnext; /* next entry in interface addr hash */
+	int heap_idx; /* index in the expiration heap */
+	struct os_reltime last_seen;
 	int listen_freq;
 	enum p2p_wps_method wps_method;
 
@@ -235,6 +238,38 @@ struct p2p_data {
 	 */
 	struct dl_list devices;
 
+#define P2P_DEV_HASH_SIZE 256
+	/**
+	 * dev_hash - Peers hashed by P2P Device Address
+	 */
+	struct p2p_device *dev_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * iface_hash - Peers hashed by P2P Interface Address
+	 *
+	 * Only peers with a known (non-zero) interface address are included.
+	 */
+	struct p2p_device *iface_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * dev_heap - Binary min-heap of the peers ordered by last_seen
+	 *
+	 * The first entry is the least recently seen peer. This is used both
+	 * for peer expiration and for selecting the peer to remove when the
+	 * table is full.
+	 */
+	struct p2p_device **dev_heap;
+
+	/**
+	 * num_devices - Number of entries in devices (and dev_heap)
+	 */
+	size_t num_devices;
+
+	/**
+	 * dev_heap_size - Number of allocated entries in dev_heap
+	 */
+	size_t dev_heap_size;
+
 	/**
 	 * go_neg_peer - Pointer to GO Negotiation peer
 	 */
@@ -6,10 +6,13 @@
  * See README for more details.
  */
 
+#define WPA_DEBUG_MODULE WPA_DEBUG_MODULE_RADIUS
+
 #include "utils/includes.h"
 
 #include "utils/common.h"
 #include "utils/wpabuf.h"
+#include "utils/mempool.h"
 #include "crypto/md5.h"
 #include "crypto/crypto.h"
 #include "radius.h"
@@ -46,8 +49,29 @@ struct radius_msg {
 	 * attr_used - Total number of attributes in the array
 	 */
 	size_t attr_used;
+
+	/**
+	 * attr_next - Index + 1 of the next attribute with the same type
+	 *
+	 * This array has attr_size entries like attr_pos. 0 marks the last
+	 * attribute of the type.
+	 */
+	u16 *attr_next;
+
+	/**
+	 * attr_first - Index + 1 of the first attribute of each type or 0
+	 */
+	u16 attr_first[256];
+
+	/**
+	 * attr_last - Index + 1 of the last attribute of each type or 0
+	 */
+	u16 attr_last[256];
 };
 
+static struct mempool radius_msg_pool =
+	MEMPOOL_INIT("radius_msg", sizeof(struct radius_msg));
+
 
 struct radius_hdr * radius_msg_get_hdr(struct radius_msg *msg)
 {
@@ -69,6 +93,20 @@ radius_get_attr_hdr(struct radius_msg *msg, int idx)
 }
 
 
+/* Index of the first attribute of the given type or -1 if there is none */
+static int radius_msg_first_attr(struct radius_msg *msg, u8 type)
+{
+	return (int) msg->attr_first[type] - 1;
+}
+
+
+/* Index of the next attribute with the same type as idx or -1 */
+static int radius_msg_next_attr(struct radius_msg *msg, int idx)
+{
+	return (int) msg->attr_next[idx] - 1;
+}
+
+
 static void radius_msg_set_hdr(struct radius_msg *msg, u8 code, u8 identifier)
 {
 	msg->hdr->code = code;
@@ -80,7 +118,9 @@ static int radius_msg_initialize(struct radius_msg *msg)
 {
 	msg->attr_pos = os_calloc(RADIUS_DEFAULT_ATTR_COUNT,
 				  sizeof(*msg->attr_pos));
-	if (msg->attr_pos == NULL)
+	msg->attr_next = os_calloc(RADIUS_DEFAULT_ATTR_COUNT,
+				   sizeof(*msg->attr_next));
+	if (msg->attr_pos == NULL || msg->attr_next == NULL)
 		return -1;
 
 	msg->attr_size = RADIUS_DEFAULT_ATTR_COUNT;
@@ -103,7 +143,7 @@ struct radius_msg * radius_msg_new(u8 code, u8 identifier)
 {
 	struct radius_msg *msg;
 
-	msg = os_zalloc(sizeof(*msg));
+	msg = mempool_zalloc(&radius_msg_pool);
 	if (msg == NULL)
 		return NULL;
 
@@ -131,7 +171,8 @@ void radius_msg_free(struct radius_msg *msg)
 
 	wpabuf_free(msg->buf);
 	os_free(msg->attr_pos);
-	os_free(msg);
+	os_free(msg->attr_next);
+	mempool_free(&radius_msg_pool, msg);
 }
 
 
@@ -505,8 +546,8 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 	u8 auth[MD5_MAC_LEN], orig[MD5_MAC_LEN];
 	u8 orig_authenticator[16];
 
-	struct radius_attr_hdr *attr = NULL, *tmp;
-	size_t i;
+	struct radius_attr_hdr *attr = NULL;
+	int idx;
 
 	os_memset(zero, 0, sizeof(zero));
 	addr[0] = (u8 *) msg->hdr;
@@ -521,17 +562,15 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 	if (os_memcmp(msg->hdr->authenticator, hash, MD5_MAC_LEN) != 0)
 		return 1;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == RADIUS_ATTR_MESSAGE_AUTHENTICATOR) {
-			if (attr != NULL) {
-				wpa_printf(MSG_WARNING, "Multiple "
-					   "Message-Authenticator attributes "
-					   "in RADIUS message");
-				return 1;
-			}
-			attr = tmp;
+	idx = radius_msg_first_attr(msg, RADIUS_ATTR_MESSAGE_AUTHENTICATOR);
+	if (idx >= 0) {
+		if (radius_msg_next_attr(msg, idx) >= 0) {
+			wpa_printf(MSG_WARNING, "Multiple "
+				   "Message-Authenticator attributes "
+				   "in RADIUS message");
+			return 1;
 		}
+		attr = radius_get_attr_hdr(msg, idx);
 	}
 
 	if (attr == NULL) {
@@ -558,21 +597,44 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 static int radius_msg_add_attr_to_array(struct radius_msg *msg,
 					struct radius_attr_hdr *attr)
 {
+	u16 idx;
+
+	/* The per-type index uses 16-bit entries; a RADIUS message cannot
+	 * have more attributes than this anyway */
+	if (msg->attr_used >= 0xffff)
+		return -1;
+
 	if (msg->attr_used >= msg->attr_size) {
 		size_t *nattr_pos;
+		u16 *nattr_next;
 		int nlen = msg->attr_size * 2;
 
 		nattr_pos = os_realloc_array(msg->attr_pos, nlen,
 					     sizeof(*msg->attr_pos));
 		if (nattr_pos == NULL)
 			return -1;
-
 		msg->attr_pos = nattr_pos;
+
+		nattr_next = os_realloc_array(msg->attr_next, nlen,
+					      sizeof(*msg->attr_next));
+		if (nattr_next == NULL)
+			return -1;
+		msg->attr_next = nattr_next;
+
 		msg->attr_size = nlen;
 	}
 
-	msg->attr_pos[msg->attr_used++] =
+	msg->attr_pos[msg->attr_used] =
 		(unsigned char *) attr - wpabuf_head_u8(msg->buf);
+	msg->attr_next[msg->attr_used] = 0;
+	idx = ++msg->attr_used;
+
+	/* Append to the list of attributes of this type */
+	if (msg->attr_last[attr->type])
+		msg->attr_next[msg->attr_last[attr->type] - 1] = idx;
+	else
+		msg->attr_first[attr->type] = idx;
+	msg->attr_last[attr->type] = idx;
 
 	return 0;
 }
@@ -644,7 +706,7 @@ struct radius_msg * radius_msg_parse(const u8 *data, size_t len)
 			   "RADIUS message", (unsigned long) len - msg_len);
 	}
 
-	msg = os_zalloc(sizeof(*msg));
+	msg = mempool_zalloc(&radius_msg_pool);
 	if (msg == NULL)
 		return NULL;
 
@@ -687,6 +749,16 @@ int radius_msg_add_eap(struct radius_msg *msg, const u8 *data, size_t data_len)
 {
 	const u8 *pos = data;
 	size_t left = data_len;
+	size_t attrs, needed;
+
+	/* Reserve room for all EAP-Message attributes at once */
+	attrs = (data_len + RADIUS_MAX_ATTR_LEN - 1) / RADIUS_MAX_ATTR_LEN;
+	needed = data_len + attrs * sizeof(struct radius_attr_hdr);
+	if (wpabuf_tailroom(msg->buf) < needed) {
+		if (wpabuf_resize(&msg->buf, needed) < 0)
+			return 0;
+		msg->hdr = wpabuf_mhead(msg->buf);
+	}
 
 	while (left > 0) {
 		int len;
@@ -710,31 +782,47 @@ int radius_msg_add_eap(struct radius_msg *msg, const u8 *data, size_t data_len)
 struct wpabuf * radius_msg_get_eap(struct radius_msg *msg)
 {
 	struct wpabuf *eap;
-	size_t len, i;
-	struct radius_attr_hdr *attr;
+	size_t len, count;
+	struct radius_attr_hdr *attr, *first = NULL;
+	int i;
 
 	if (msg == NULL)
 		return NULL;
 
 	len = 0;
-	for (i = 0; i < msg->attr_used; i++) {
+	count = 0;
+	for (i = radius_msg_first_attr(msg, RADIUS_ATTR_EAP_MESSAGE); i >= 0;
+	     i = radius_msg_next_attr(msg, i)) {
 		attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == RADIUS_ATTR_EAP_MESSAGE &&
-		    attr->length > sizeof(struct radius_attr_hdr))
+		if (attr->length > sizeof(struct radius_attr_hdr)) {
 			len += attr->length - sizeof(struct radius_attr_hdr);
+			if (first == NULL)
+				first = attr;
+			count++;
+		}
 	}
 
 	if (len == 0)
 		return NULL;
 
+	if (count == 1) {
+		/* Refer to the attribute data in the message without copying
+		 * it; the slice keeps the message buffer in memory. */
+		return wpabuf_slice(msg->buf,
+				    (u8 *) (first + 1) -
+				    wpabuf_head_u8(msg->buf), len);
+	}
+
+	/* Fragments are separated by attribute headers in the message, so
+	 * they need to be copied into a buffer that fits all of them */
 	eap = wpabuf_alloc(len);
 	if (eap == NULL)
 		return NULL;
 
-	for (i = 0; i < msg->attr_used; i++) {
+	for (i = radius_msg_first_attr(msg, RADIUS_ATTR_EAP_MESSAGE); i >= 0;
+	     i = radius_msg_next_attr(msg, i)) {
 		attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == RADIUS_ATTR_EAP_MESSAGE &&
-		    attr->length > sizeof(struct radius_attr_hdr)) {
+		if (attr->length > sizeof(struct radius_attr_hdr)) {
 			int flen = attr->length - sizeof(*attr);
 			wpabuf_put_data(eap, attr + 1, flen);
 		}
@@ -749,19 +837,17 @@ int radius_msg_verify_msg_auth(struct radius_msg *msg, const u8 *secret,
 {
 	u8 auth[MD5_MAC_LEN], orig[MD5_MAC_LEN];
 	u8 orig_authenticator[16];
-	struct radius_attr_hdr *attr = NULL, *tmp;
-	size_t i;
-
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == RADIUS_ATTR_MESSAGE_AUTHENTICATOR) {
-			if (attr != NULL) {
-				printf("Multiple Message-Authenticator "
-				       "attributes in RADIUS message\n");
-				return 1;
-			}
-			attr = tmp;
+	struct radius_attr_hdr *attr = NULL;
+	int idx;
+
+	idx = radius_msg_first_attr(msg, RADIUS_ATTR_MESSAGE_AUTHENTICATOR);
+	if (idx >= 0) {
+		if (radius_msg_next_attr(msg, idx) >= 0) {
+			printf("Multiple Message-Authenticator "
+			       "attributes in RADIUS message\n");
+			return 1;
 		}
+		attr = radius_get_attr_hdr(msg, idx);
 	}
 
 	if (attr == NULL) {
@@ -835,12 +921,12 @@ int radius_msg_copy_attr(struct radius_msg *dst, struct radius_msg *src,
 			 u8 type)
 {
 	struct radius_attr_hdr *attr;
-	size_t i;
-	int count = 0;
+	int i, count = 0;
 
-	for (i = 0; i < src->attr_used; i++) {
+	for (i = radius_msg_first_attr(src, type); i >= 0;
+	     i = radius_msg_next_attr(src, i)) {
 		attr = radius_get_attr_hdr(src, i);
-		if (attr->type == type && attr->length >= sizeof(*attr)) {
+		if (attr->length >= sizeof(*attr)) {
 			if (!radius_msg_add_attr(dst, type, (u8 *) (attr + 1),
 						 attr->length - sizeof(*attr)))
 				return -1;
@@ -886,19 +972,20 @@ static u8 *radius_msg_get_vendor_attr(struct radius_msg *msg, u32 vendor,
 				      u8 subtype, size_t *alen)
 {
 	u8 *data, *pos;
-	size_t i, len;
+	size_t len;
+	int i;
 
 	if (msg == NULL)
 		return NULL;
 
-	for (i = 0; i < msg->attr_used; i++) {
+	for (i = radius_msg_first_attr(msg, RADIUS_ATTR_VENDOR_SPECIFIC);
+	     i >= 0; i = radius_msg_next_attr(msg, i)) {
 		struct radius_attr_hdr *attr = radius_get_attr_hdr(msg, i);
 		size_t left;
 		u32 vendor_id;
 		struct radius_attr_vendor *vhdr;
 
-		if (attr->type != RADIUS_ATTR_VENDOR_SPECIFIC ||
-		    attr->length < sizeof(*attr))
+		if (attr->length < sizeof(*attr))
 			continue;
 
 		left = attr->length - sizeof(*attr);
@@ -1260,18 +1347,16 @@ radius_msg_add_attr_user_password(struct radius_msg *msg,
 
 int radius_msg_get_attr(struct radius_msg *msg, u8 type, u8 *buf, size_t len)
 {
-	struct radius_attr_hdr *attr = NULL, *tmp;
-	size_t i, dlen;
+	struct radius_attr_hdr *attr;
+	size_t dlen;
+	int idx;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == type) {
-			attr = tmp;
-			break;
-		}
-	}
+	idx = radius_msg_first_attr(msg, type);
+	if (idx < 0)
+		return -1;
+	attr = radius_get_attr_hdr(msg, idx);
 
-	if (!attr || attr->length < sizeof(*attr))
+	if (attr->length < sizeof(*attr))
 		return -1;
 
 	dlen = attr->length - sizeof(*attr);
@@ -1284,13 +1369,14 @@ int radius_msg_get_attr(struct radius_msg *msg, u8 type, u8 *buf, size_t len)
 int radius_msg_get_attr_ptr(struct radius_msg *msg, u8 type, u8 **buf,
 			    size_t *len, const u8 *start)
 {
-	size_t i;
+	int i;
 	struct radius_attr_hdr *attr = NULL, *tmp;
 
-	for (i = 0; i < msg->attr_used; i++) {
+	/* Attributes of a type are listed in the order of the message */
+	for (i = radius_msg_first_attr(msg, type); i >= 0;
+	     i = radius_msg_next_attr(msg, i)) {
 		tmp = radius_get_attr_hdr(msg, i);
-		if (tmp->type == type &&
-		    (start == NULL || (u8 *) tmp > start)) {
+		if (start == NULL || (u8 *) tmp > start) {
 			attr = tmp;
 			break;
 		}
@@ -1307,13 +1393,12 @@ int radius_msg_get_attr_ptr(struct radius_msg *msg, u8 type, u8 **buf,
 
 int radius_msg_count_attr(struct radius_msg *msg, u8 type, int min_len)
 {
-	size_t i;
-	int count;
+	int i, count = 0;
 
-	for (count = 0, i = 0; i < msg->attr_used; i++) {
+	for (i = radius_msg_first_attr(msg, type); i >= 0;
+	     i = radius_msg_next_attr(msg, i)) {
 		struct radius_attr_hdr *attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == type &&
-		    attr->length >= sizeof(struct radius_attr_hdr) + min_len)
+		if (attr->length >= sizeof(struct radius_attr_hdr) + min_len)
 			count++;
 	}
 
@@ -1329,6 +1414,52 @@ struct radius_tunnel_attrs {
 };
 
 
+static void radius_parse_tunnel_attr(struct radius_tunnel_attrs *tunnel,
+				     struct radius_attr_hdr *attr)
+{
+	struct radius_tunnel_attrs *tun;
+	const u8 *data;
+	char buf[10];
+	size_t dlen;
+
+	data = (const u8 *) (attr + 1);
+	dlen = attr->length - sizeof(*attr);
+	if (attr->length < 3)
+		return;
+	if (data[0] >= RADIUS_TUNNEL_TAGS)
+		tun = &tunnel[0];
+	else
+		tun = &tunnel[data[0]];
+
+	switch (attr->type) {
+	case RADIUS_ATTR_TUNNEL_TYPE:
+		if (attr->length != 6)
+			break;
+		tun->tag_used++;
+		tun->type = WPA_GET_BE24(data + 1);
+		break;
+	case RADIUS_ATTR_TUNNEL_MEDIUM_TYPE:
+		if (attr->length != 6)
+			break;
+		tun->tag_used++;
+		tun->medium_type = WPA_GET_BE24(data + 1);
+		break;
+	case RADIUS_ATTR_TUNNEL_PRIVATE_GROUP_ID:
+		if (data[0] < RADIUS_TUNNEL_TAGS) {
+			data++;
+			dlen--;
+		}
+		if (dlen >= sizeof(buf))
+			break;
+		os_memcpy(buf, data, dlen);
+		buf[dlen] = '\0';
+		tun->tag_used++;
+		tun->vlanid = atoi(buf);
+		break;
+	}
+}
+
+
 /**
  * radius_msg_get_vlanid - Parse RADIUS attributes for VLAN tunnel information
  * @msg: RADIUS message
@@ -1336,54 +1467,22 @@ struct radius_tunnel_attrs {
  */
 int radius_msg_get_vlanid(struct radius_msg *msg)
 {
+	static const u8 types[] = {
+		RADIUS_ATTR_TUNNEL_TYPE,
+		RADIUS_ATTR_TUNNEL_MEDIUM_TYPE,
+		RADIUS_ATTR_TUNNEL_PRIVATE_GROUP_ID
+	};
 	struct radius_tunnel_attrs tunnel[RADIUS_TUNNEL_TAGS], *tun;
 	size_t i;
-	struct radius_attr_hdr *attr = NULL;
-	const u8 *data;
-	char buf[10];
-	size_t dlen;
+	int idx;
 
 	os_memset(&tunnel, 0, sizeof(tunnel));
 
-	for (i = 0; i < msg->attr_used; i++) {
-		attr = radius_get_attr_hdr(msg, i);
-		if (attr->length < sizeof(*attr))
-			return -1;
-		data = (const u8 *) (attr + 1);
-		dlen = attr->length - sizeof(*attr);
-		if (attr->length < 3)
-			continue;
-		if (data[0] >= RADIUS_TUNNEL_TAGS)
-			tun = &tunnel[0];
-		else
-			tun = &tunnel[data[0]];
-
-		switch (attr->type) {
-		case RADIUS_ATTR_TUNNEL_TYPE:
-			if (attr->length != 6)
-				break;
-			tun->tag_used++;
-			tun->type = WPA_GET_BE24(data + 1);
-			break;
-		case RADIUS_ATTR_TUNNEL_MEDIUM_TYPE:
-			if (attr->length != 6)
-				break;
-			tun->tag_used++;
-			tun->medium_type = WPA_GET_BE24(data + 1);
-			break;
-		case RADIUS_ATTR_TUNNEL_PRIVATE_GROUP_ID:
-			if (data[0] < RADIUS_TUNNEL_TAGS) {
-				data++;
-				dlen--;
-			}
-			if (dlen >= sizeof(buf))
-				break;
-			os_memcpy(buf, data, dlen);
-			buf[dlen] = '\0';
-			tun->tag_used++;
-			tun->vlanid = atoi(buf);
-			break;
-		}
+	for (i = 0; i < sizeof(types); i++) {
+		for (idx = radius_msg_first_attr(msg, types[i]); idx >= 0;
+		     idx = radius_msg_next_attr(msg, idx))
+			radius_parse_tunnel_attr(tunnel,
+						 radius_get_attr_hdr(msg, idx));
 	}
 
 	for (i = 0; i < RADIUS_TUNNEL_TAGS; i++) {
@@ -1422,6 +1521,7 @@ char * radius_msg_get_tunnel_password(struct radius_msg *msg, int *keylen,
 	u8 hash[16];
 	u8 *pos;
 	size_t i, j = 0;
+	int idx;
 	struct radius_attr_hdr *attr;
 	const u8 *data;
 	size_t dlen;
@@ -1430,12 +1530,9 @@ char * radius_msg_get_tunnel_password(struct radius_msg *msg, int *keylen,
 	char *ret = NULL;
 
 	/* find n-th valid Tunnel-Password attribute */
-	for (i = 0; i < msg->attr_used; i++) {
-		attr = radius_get_attr_hdr(msg, i);
-		if (attr == NULL ||
-		    attr->type != RADIUS_ATTR_TUNNEL_PASSWORD) {
-			continue;
-		}
+	for (idx = radius_msg_first_attr(msg, RADIUS_ATTR_TUNNEL_PASSWORD);
+	     idx >= 0; idx = radius_msg_next_attr(msg, idx)) {
+		attr = radius_get_attr_hdr(msg, idx);
 		if (attr->length <= 5)
 			continue;
 		data = (const u8 *) (attr + 1);
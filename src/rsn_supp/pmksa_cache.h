@@ -58,6 +58,12 @@ int pmksa_cache_list(struct rsn_pmksa_cache *pmksa, char *buf, size_t len);
 struct rsn_pmksa_cache_entry *
 pmksa_cache_add(struct rsn_pmksa_cache *pmksa, const u8 *pmk, size_t pmk_len,
 		const u8 *aa, const u8 *spa, void *network_ctx, int akmp);
+struct rsn_pmksa_cache_entry *
+pmksa_cache_restore(struct rsn_pmksa_cache *pmksa, const u8 *pmk,
+		    size_t pmk_len, const u8 *aa, const u8 *spa,
+		    void *network_ctx, int akmp, os_time_t expiration,
+		    os_time_t reauth_time);
+struct rsn_pmksa_cache_entry * pmksa_cache_head(struct rsn_pmksa_cache *pmksa);
 struct rsn_pmksa_cache_entry * pmksa_cache_get_current(struct wpa_sm *sm);
 void pmksa_cache_clear_current(struct wpa_sm *sm);
 int pmksa_cache_set_current(struct wpa_sm *sm, const u8 *pmkid,
@@ -108,6 +114,21 @@ pmksa_cache_add(struct rsn_pmksa_cache *pmksa, const u8 *pmk, size_t pmk_len,
 	return NULL;
 }
 
+static inline struct rsn_pmksa_cache_entry *
+pmksa_cache_restore(struct rsn_pmksa_cache *pmksa, const u8 *pmk,
+		    size_t pmk_len, const u8 *aa, const u8 *spa,
+		    void *network_ctx, int akmp, os_time_t expiration,
+		    os_time_t reauth_time)
+{
+	return NULL;
+}
+
+static inline struct rsn_pmksa_cache_entry *
+pmksa_cache_head(struct rsn_pmksa_cache *pmksa)
+{
+	return NULL;
+}
+
 static inline void pmksa_cache_clear_current(struct wpa_sm *sm)
 {
 }
@@ -9,6 +9,7 @@
 #include "includes.h"
 
 #include "common.h"
+#include "utils/mempool.h"
 #include "crypto/aes_wrap.h"
 #include "crypto/crypto.h"
 #include "crypto/random.h"
@@ -1573,7 +1574,7 @@ int wpa_sm_rx_eapol(struct wpa_sm *sm, const u8 *src_addr,
 		return 0;
 	}
 
-	tmp = os_malloc(len);
+	tmp = msg_arena_zalloc(len);
 	if (tmp == NULL)
 		return -1;
 	os_memcpy(tmp, buf, len);
@@ -1807,7 +1808,7 @@ int wpa_sm_rx_eapol(struct wpa_sm *sm, const u8 *src_addr,
 	ret = 1;
 
 out:
-	os_free(tmp);
+	msg_arena_free(tmp);
 	return ret;
 }
 
@@ -2627,6 +2628,60 @@ void wpa_sm_pmksa_cache_flush(struct wpa_sm *sm, void *network_ctx)
 }
 
 
+struct rsn_pmksa_cache_entry *
+wpa_sm_pmksa_cache_get(struct wpa_sm *sm, const u8 *aa, const u8 *pmkid,
+		       const void *network_ctx)
+{
+#ifndef CONFIG_NO_WPA2
+	if (sm == NULL || sm->pmksa == NULL)
+		return NULL;
+	return pmksa_cache_get(sm->pmksa, aa, pmkid, network_ctx);
+#else /* CONFIG_NO_WPA2 */
+	return NULL;
+#endif /* CONFIG_NO_WPA2 */
+}
+
+
+struct rsn_pmksa_cache_entry * wpa_sm_pmksa_cache_head(struct wpa_sm *sm)
+{
+#ifndef CONFIG_NO_WPA2
+	if (sm == NULL || sm->pmksa == NULL)
+		return NULL;
+	return pmksa_cache_head(sm->pmksa);
+#else /* CONFIG_NO_WPA2 */
+	return NULL;
+#endif /* CONFIG_NO_WPA2 */
+}
+
+
+/**
+ * wpa_sm_pmksa_cache_restore - Restore a saved PMKSA cache entry
+ * @sm: Pointer to WPA state machine data from wpa_sm_init()
+ * @pmk: The pairwise master key
+ * @pmk_len: PMK length in bytes
+ * @aa: Authenticator address
+ * @network_ctx: Network configuration context for this PMK
+ * @akmp: WPA_KEY_MGMT_* used in key derivation
+ * @expiration: Expiration time of the entry (os_get_reltime() seconds)
+ * @reauth_time: Reauthentication time of the entry
+ * Returns: 0 on success, -1 on failure
+ */
+int wpa_sm_pmksa_cache_restore(struct wpa_sm *sm, const u8 *pmk,
+			       size_t pmk_len, const u8 *aa,
+			       void *network_ctx, int akmp,
+			       os_time_t expiration, os_time_t reauth_time)
+{
+#ifndef CONFIG_NO_WPA2
+	if (sm == NULL || sm->pmksa == NULL)
+		return -1;
+	if (pmksa_cache_restore(sm->pmksa, pmk, pmk_len, aa, sm->own_addr,
+				network_ctx, akmp, expiration, reauth_time))
+		return 0;
+#endif /* CONFIG_NO_WPA2 */
+	return -1;
+}
+
+
 #ifdef CONFIG_WNM
 int wpa_wnmsleep_install_key(struct wpa_sm *sm, u8 subelem_id, u8 *buf)
 {
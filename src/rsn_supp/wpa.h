@@ -135,6 +135,14 @@ int wpa_sm_has_ptk(struct wpa_sm *sm);
 void wpa_sm_update_replay_ctr(struct wpa_sm *sm, const u8 *replay_ctr);
 
 void wpa_sm_pmksa_cache_flush(struct wpa_sm *sm, void *network_ctx);
+struct rsn_pmksa_cache_entry *
+wpa_sm_pmksa_cache_get(struct wpa_sm *sm, const u8 *aa, const u8 *pmkid,
+		       const void *network_ctx);
+struct rsn_pmksa_cache_entry * wpa_sm_pmksa_cache_head(struct wpa_sm *sm);
+int wpa_sm_pmksa_cache_restore(struct wpa_sm *sm, const u8 *pmk,
+			       size_t pmk_len, const u8 *aa,
+			       void *network_ctx, int akmp,
+			       os_time_t expiration, os_time_t reauth_time);
 
 #else /* CONFIG_NO_WPA */
 
@@ -291,6 +299,28 @@ static inline void wpa_sm_pmksa_cache_flush(struct wpa_sm *sm,
 {
 }
 
+static inline struct rsn_pmksa_cache_entry *
+wpa_sm_pmksa_cache_get(struct wpa_sm *sm, const u8 *aa, const u8 *pmkid,
+		       const void *network_ctx)
+{
+	return NULL;
+}
+
+static inline struct rsn_pmksa_cache_entry *
+wpa_sm_pmksa_cache_head(struct wpa_sm *sm)
+{
+	return NULL;
+}
+
+static inline int wpa_sm_pmksa_cache_restore(struct wpa_sm *sm, const u8 *pmk,
+					     size_t pmk_len, const u8 *aa,
+					     void *network_ctx, int akmp,
+					     os_time_t expiration,
+					     os_time_t reauth_time)
+{
+	return -1;
+}
+
 #endif /* CONFIG_NO_WPA */
 
 #ifdef CONFIG_PEERKEY
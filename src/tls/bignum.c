@@ -106,6 +106,17 @@ int bignum_set_unsigned_bin(struct bignum *n, const u8 *buf, size_t len)
 }
 
 
+/**
+ * bignum_get_bits - Get size of bignum in bits
+ * @n: Bignum from bignum_init()
+ * Returns: Number of bits in n
+ */
+int bignum_get_bits(const struct bignum *n)
+{
+	return mp_count_bits((mp_int *) n);
+}
+
+
 /**
  * bignum_cmp - Signed comparison
  * @a: Bignum from bignum_init()
@@ -184,6 +195,77 @@ int bignum_mul(const struct bignum *a, const struct bignum *b,
 }
 
 
+/**
+ * bignum_div - c = a / b
+ * @a: Bignum from bignum_init()
+ * @b: Bignum from bignum_init()
+ * @c: Bignum from bignum_init(); used to store the quotient of a / b
+ * Returns: 0 on success, -1 on failure
+ */
+int bignum_div(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c)
+{
+	if (mp_div((mp_int *) a, (mp_int *) b, (mp_int *) c, NULL) != MP_OKAY) {
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+
+/**
+ * bignum_mod - c = a (mod b)
+ * @a: Bignum from bignum_init()
+ * @b: Bignum from bignum_init(); modulus
+ * @c: Bignum from bignum_init(); used to store the result of a (mod b)
+ * Returns: 0 on success, -1 on failure
+ */
+int bignum_mod(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c)
+{
+	if (mp_mod((mp_int *) a, (mp_int *) b, (mp_int *) c) != MP_OKAY) {
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+
+/**
+ * bignum_rshift - b = a >> n
+ * @a: Bignum from bignum_init()
+ * @n: Number of bits to shift
+ * @b: Bignum from bignum_init(); used to store the result of a >> n
+ * Returns: 0 on success, -1 on failure
+ */
+int bignum_rshift(const struct bignum *a, int n, struct bignum *b)
+{
+	if (mp_div_2d((mp_int *) a, n, (mp_int *) b, NULL) != MP_OKAY) {
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+
+/**
+ * bignum_inverse - Modular inverse: c = 1 / a (mod b)
+ * @a: Bignum from bignum_init()
+ * @b: Bignum from bignum_init(); modulus
+ * @c: Bignum from bignum_init(); used to store the result
+ * Returns: 0 on success, -1 on failure (e.g., no inverse exists)
+ */
+int bignum_inverse(const struct bignum *a, const struct bignum *b,
+		   struct bignum *c)
+{
+	if (mp_invmod((mp_int *) a, (mp_int *) b, (mp_int *) c) != MP_OKAY) {
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+
 /**
  * bignum_mulmod - d = a * b (mod c)
  * @a: Bignum from bignum_init()
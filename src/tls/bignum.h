@@ -16,6 +16,7 @@ void bignum_deinit(struct bignum *n);
 size_t bignum_get_unsigned_bin_len(struct bignum *n);
 int bignum_get_unsigned_bin(const struct bignum *n, u8 *buf, size_t *len);
 int bignum_set_unsigned_bin(struct bignum *n, const u8 *buf, size_t len);
+int bignum_get_bits(const struct bignum *n);
 int bignum_cmp(const struct bignum *a, const struct bignum *b);
 int bignum_cmp_d(const struct bignum *a, unsigned long b);
 int bignum_add(const struct bignum *a, const struct bignum *b,
@@ -24,6 +25,13 @@ int bignum_sub(const struct bignum *a, const struct bignum *b,
 	       struct bignum *c);
 int bignum_mul(const struct bignum *a, const struct bignum *b,
 	       struct bignum *c);
+int bignum_div(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c);
+int bignum_mod(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c);
+int bignum_rshift(const struct bignum *a, int n, struct bignum *b);
+int bignum_inverse(const struct bignum *a, const struct bignum *b,
+		   struct bignum *c);
 int bignum_mulmod(const struct bignum *a, const struct bignum *b,
 		  const struct bignum *c, struct bignum *d);
 int bignum_exptmod(const struct bignum *a, const struct bignum *b,
@@ -18,7 +18,9 @@
 #define CHAR_BIT 8
 #endif
 
-#define BN_MP_INVMOD_C
+#define BN_MP_INVMOD_C /* needed for bignum_inverse() */
+#define BN_MP_INIT_MULTI_C
+#define BN_MP_CLEAR_MULTI_C
 #define BN_S_MP_EXPTMOD_C /* Note: #undef in tommath_superclass.h; this would
 			   * require BN_MP_EXPTMOD_FAST_C instead */
 #define BN_S_MP_MUL_DIGS_C
@@ -42,16 +44,22 @@
 /* Include faster sqr at the cost of about 0.5 kB in code */
 #define BN_FAST_S_MP_SQR_C
 
+/* Use the comba multiplier directly from mp_mul() */
+#define BN_FAST_S_MP_MUL_DIGS_C
+
+/* Allow one bit larger exptmod window (32 instead of 16 precomputed values);
+ * this saves multiplications with the 1024-1536 bit exponents used in RSA CRT
+ * and DH operations */
+#define MP_MAX_WINSIZE 6
+
 #else /* LTM_FAST */
 
 #define BN_MP_DIV_SMALL
-#define BN_MP_INIT_MULTI_C
-#define BN_MP_CLEAR_MULTI_C
 #define BN_MP_ABS_C
 #endif /* LTM_FAST */
 
 /* Current uses do not require support for negative exponent in exptmod, so we
- * can save about 1.5 kB in leaving out invmod. */
+ * can leave that out. */
 #define LTM_NO_NEG_EXP
 
 /* from tommath.h */
@@ -157,11 +165,11 @@ static int mp_mod_2d(mp_int * a, int b, mp_int * c);
 static int mp_div_2d(mp_int * a, int b, mp_int * c, mp_int * d);
 static int mp_init_copy(mp_int * a, mp_int * b);
 static int mp_mul_2d(mp_int * a, int b, mp_int * c);
-#ifndef LTM_NO_NEG_EXP
+#ifdef BN_MP_INVMOD_C
 static int mp_div_2(mp_int * a, mp_int * b);
 static int mp_invmod(mp_int * a, mp_int * b, mp_int * c);
 static int mp_invmod_slow(mp_int * a, mp_int * b, mp_int * c);
-#endif /* LTM_NO_NEG_EXP */
+#endif /* BN_MP_INVMOD_C */
 static int mp_copy(mp_int * a, mp_int * b);
 static int mp_count_bits(mp_int * a);
 static int mp_div(mp_int * a, mp_int * b, mp_int * c, mp_int * d);
@@ -720,7 +728,7 @@ static int mp_cmp_d(mp_int * a, mp_digit b)
 }
 
 
-#ifndef LTM_NO_NEG_EXP
+#ifdef BN_MP_INVMOD_C
 /* hac 14.61, pp608 */
 static int mp_invmod (mp_int * a, mp_int * b, mp_int * c)
 {
@@ -747,7 +755,7 @@ static int mp_invmod (mp_int * a, mp_int * b, mp_int * c)
 #endif
   return MP_VAL;
 }
-#endif /* LTM_NO_NEG_EXP */
+#endif /* BN_MP_INVMOD_C */
 
 
 /* get the size for an unsigned equivalent */
@@ -758,7 +766,7 @@ static int mp_unsigned_bin_size (mp_int * a)
 }
 
 
-#ifndef LTM_NO_NEG_EXP
+#ifdef BN_MP_INVMOD_C
 /* hac 14.61, pp608 */
 static int mp_invmod_slow (mp_int * a, mp_int * b, mp_int * c)
 {
@@ -912,7 +920,7 @@ top:
 LBL_ERR:mp_clear_multi (&x, &y, &u, &v, &A, &B, &C, &D, NULL);
   return res;
 }
-#endif /* LTM_NO_NEG_EXP */
+#endif /* BN_MP_INVMOD_C */
 
 
 /* compare maginitude of two ints (unsigned) */
@@ -1322,7 +1330,7 @@ static void mp_set (mp_int * a, mp_digit b)
 }
 
 
-#ifndef LTM_NO_NEG_EXP
+#ifdef BN_MP_INVMOD_C
 /* b = a/2 */
 static int mp_div_2(mp_int * a, mp_int * b)
 {
@@ -1369,7 +1377,7 @@ static int mp_div_2(mp_int * a, mp_int * b)
   mp_clamp (b);
   return MP_OKAY;
 }
-#endif /* LTM_NO_NEG_EXP */
+#endif /* BN_MP_INVMOD_C */
 
 
 /* shift left by a certain bit count */
@@ -1868,7 +1876,10 @@ LBL_Q:mp_clear (&q);
 
 
 #ifdef MP_LOW_MEM
-   #define TAB_SIZE 32
+   #ifndef MP_MAX_WINSIZE
+      #define MP_MAX_WINSIZE 5
+   #endif
+   #define TAB_SIZE (1 << MP_MAX_WINSIZE)
 #else
    #define TAB_SIZE 256
 #endif
@@ -1899,8 +1910,8 @@ static int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int red
   }
 
 #ifdef MP_LOW_MEM
-    if (winsize > 5) {
-       winsize = 5;
+    if (winsize > MP_MAX_WINSIZE) {
+       winsize = MP_MAX_WINSIZE;
     }
 #endif
 
@@ -2976,8 +2987,8 @@ static int mp_exptmod_fast (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int
   }
 
 #ifdef MP_LOW_MEM
-  if (winsize > 5) {
-     winsize = 5;
+  if (winsize > MP_MAX_WINSIZE) {
+     winsize = MP_MAX_WINSIZE;
   }
 #endif
 
@@ -175,6 +175,9 @@ failed:
 			return NULL;
 		}
 		conn->state = FAILED;
+		/* Sessions terminated with a fatal alert must not be resumed */
+		tlsv1_server_cache_remove(conn->cache, conn->session_id,
+					  conn->session_id_len);
 		os_free(msg);
 		msg = tlsv1_server_send_alert(conn, conn->alert_level,
 					      conn->alert_description,
@@ -386,6 +389,9 @@ static void tlsv1_server_clear_data(struct tlsv1_server *conn)
 	conn->session_ticket = NULL;
 	conn->session_ticket_len = 0;
 	conn->use_session_ticket = 0;
+	conn->session_ticket_ext = 0;
+	conn->session_resumed = 0;
+	conn->issue_ticket = 0;
 
 	os_free(conn->dh_secret);
 	conn->dh_secret = NULL;
@@ -523,7 +529,7 @@ int tlsv1_server_shutdown(struct tlsv1_server *conn)
  */
 int tlsv1_server_resumed(struct tlsv1_server *conn)
 {
-	return 0;
+	return conn->session_resumed;
 }
 
 
@@ -609,6 +615,59 @@ int tlsv1_server_set_verify(struct tlsv1_server *conn, int verify_peer)
 }
 
 
+/**
+ * tlsv1_server_set_session_cache - Configure session cache
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ * @cache: Session cache from tlsv1_server_cache_init() or %NULL
+ *
+ * The cache is used only after a session context has been configured with
+ * tlsv1_server_set_session_context().
+ */
+void tlsv1_server_set_session_cache(struct tlsv1_server *conn,
+				    struct tlsv1_server_cache *cache)
+{
+	conn->cache = cache;
+}
+
+
+/**
+ * tlsv1_server_set_session_context - Allow session resumption
+ * @conn: TLSv1 server connection data from tlsv1_server_init()
+ * @context: Session context
+ * @context_len: Length of context (at most TLS_SESSION_CONTEXT_MAX_LEN)
+ * Returns: 0 on success, -1 on failure
+ *
+ * Sessions of this connection are stored into the session cache and the
+ * connection can resume sessions that were established with the same
+ * context.
+ */
+int tlsv1_server_set_session_context(struct tlsv1_server *conn,
+				     const u8 *context, size_t context_len)
+{
+	if (context_len > TLS_SESSION_CONTEXT_MAX_LEN)
+		return -1;
+	os_memcpy(conn->session_context, context, context_len);
+	conn->session_context_len = context_len;
+	return 0;
+}
+
+
+void tlsv1_server_get_session(struct tlsv1_server *conn,
+			      struct tlsv1_server_session *sess)
+{
+	os_memset(sess, 0, sizeof(*sess));
+	os_memcpy(sess->session_id, conn->session_id, conn->session_id_len);
+	sess->session_id_len = conn->session_id_len;
+	os_memcpy(sess->master_secret, conn->master_secret,
+		  TLS_MASTER_SECRET_LEN);
+	sess->tls_version = conn->rl.tls_version;
+	sess->cipher_suite = conn->cipher_suite;
+	os_memcpy(sess->context, conn->session_context,
+		  conn->session_context_len);
+	sess->context_len = conn->session_context_len;
+}
+
+
 void tlsv1_server_set_session_ticket_cb(struct tlsv1_server *conn,
 					tlsv1_server_session_ticket_cb cb,
 					void *ctx)
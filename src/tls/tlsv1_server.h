@@ -10,6 +10,7 @@
 #define TLSV1_SERVER_H
 
 #include "tlsv1_cred.h"
+#include "tlsv1_server_cache.h"
 
 struct tlsv1_server;
 
@@ -36,6 +37,10 @@ int tlsv1_server_get_keys(struct tlsv1_server *conn, struct tls_keys *keys);
 int tlsv1_server_get_keyblock_size(struct tlsv1_server *conn);
 int tlsv1_server_set_cipher_list(struct tlsv1_server *conn, u8 *ciphers);
 int tlsv1_server_set_verify(struct tlsv1_server *conn, int verify_peer);
+void tlsv1_server_set_session_cache(struct tlsv1_server *conn,
+				    struct tlsv1_server_cache *cache);
+int tlsv1_server_set_session_context(struct tlsv1_server *conn,
+				     const u8 *context, size_t context_len);
 
 typedef int (*tlsv1_server_session_ticket_cb)
 (void *ctx, const u8 *ticket, size_t len, const u8 *client_random,
@@ -0,0 +1,871 @@
+/*
+ * TLSv1 server - session cache
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Sessions from completed full handshakes are stored by session ID and, if
+ * the client supports it, handed out as RFC 5077 session tickets that are
+ * protected with a server key. The entries are kept in expiration order and
+ * removed from an eloop timeout. When a file is configured, the entries and
+ * the ticket keys are saved periodically and when the cache is deinitialized,
+ * so that clients can resume their sessions after the server has been
+ * restarted. The file contains TLS master secrets and is created readable
+ * only by the owner.
+ */
+
+#include "includes.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "eloop.h"
+#include "list.h"
+#include "crypto/aes_wrap.h"
+#include "crypto/sha256.h"
+#include "crypto/random.h"
+#include "tlsv1_server_cache.h"
+
+
+#define TLSV1_CACHE_HASH_SIZE 256
+#define TLSV1_CACHE_SAVE_INTERVAL 60
+
+#define TLSV1_TICKET_KEYS 2
+#define TLSV1_TICKET_KEY_NAME_LEN 16
+#define TLSV1_TICKET_AES_KEY_LEN 16
+#define TLSV1_TICKET_HMAC_KEY_LEN 32
+#define TLSV1_TICKET_IV_LEN 16
+/* tls_version, cipher_suite, master_secret, expiration, context_len, context
+ * padded to the AES block size */
+#define TLSV1_TICKET_STATE_LEN ((2 + 2 + TLS_MASTER_SECRET_LEN + 8 + 1 + \
+				 TLS_SESSION_CONTEXT_MAX_LEN + 15) & ~15)
+/* key_name, iv, encrypted_state, mac; RFC 5077, 4 */
+#define TLSV1_TICKET_LEN (TLSV1_TICKET_KEY_NAME_LEN + TLSV1_TICKET_IV_LEN + \
+			  TLSV1_TICKET_STATE_LEN + SHA256_MAC_LEN)
+
+#define TLSV1_CACHE_MAGIC "TLSVSESS"
+#define TLSV1_CACHE_VERSION 1
+#define TLSV1_CACHE_HDR_LEN 16
+
+#define TLSV1_CACHE_REC_KEY 1
+#define TLSV1_CACHE_REC_SESSION 2
+
+/* type, name, aes_key, hmac_key, created */
+#define TLSV1_CACHE_KEY_REC_LEN (1 + TLSV1_TICKET_KEY_NAME_LEN + \
+				 TLSV1_TICKET_AES_KEY_LEN + \
+				 TLSV1_TICKET_HMAC_KEY_LEN + 8)
+/* type, session_id_len, session_id, master_secret, tls_version,
+ * cipher_suite, context_len, context, expiration */
+#define TLSV1_CACHE_SESSION_REC_LEN (1 + 1 + TLS_SESSION_ID_MAX_LEN + \
+				     TLS_MASTER_SECRET_LEN + 2 + 2 + 1 + \
+				     TLS_SESSION_CONTEXT_MAX_LEN + 8)
+
+struct tlsv1_ticket_key {
+	u8 name[TLSV1_TICKET_KEY_NAME_LEN];
+	u8 aes_key[TLSV1_TICKET_AES_KEY_LEN];
+	u8 hmac_key[TLSV1_TICKET_HMAC_KEY_LEN];
+	os_time_t created; /* os_get_reltime() seconds */
+	int valid;
+};
+
+struct tlsv1_cache_entry {
+	struct dl_list list; /* tlsv1_server_cache::entries */
+	struct dl_list hash; /* tlsv1_server_cache::hash[] */
+	os_time_t expiration; /* os_get_reltime() seconds */
+	struct tlsv1_server_session sess;
+};
+
+struct tlsv1_server_cache {
+	struct dl_list entries; /* ordered by expiration */
+	struct dl_list hash[TLSV1_CACHE_HASH_SIZE];
+	unsigned int num_entries;
+	unsigned int size;
+	unsigned int lifetime;
+	int tickets;
+	char *fname;
+	int dirty;
+
+	/* Tickets are issued with keys[0]; keys[1] is the previous key that
+	 * is still accepted until the tickets issued with it have expired */
+	struct tlsv1_ticket_key keys[TLSV1_TICKET_KEYS];
+
+	unsigned long hits;
+	unsigned long ticket_hits;
+	unsigned long misses;
+	unsigned long tickets_issued;
+	unsigned long expired;
+	unsigned long evicted;
+};
+
+
+static void tlsv1_cache_expire(void *eloop_ctx, void *timeout_ctx);
+
+
+static os_time_t tlsv1_cache_now(void)
+{
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	return now.sec;
+}
+
+
+/*
+ * Relative time starts again from zero on each boot, so the tickets and the
+ * file use wall clock time instead.
+ */
+static os_time_t tlsv1_cache_wall_offset(void)
+{
+	struct os_time now;
+	struct os_reltime rel;
+
+	os_get_time(&now);
+	os_get_reltime(&rel);
+	return now.sec - rel.sec;
+}
+
+
+static void tlsv1_cache_put_time(u8 *pos, os_time_t t)
+{
+	WPA_PUT_BE32(pos, (u32) ((u64) t >> 32));
+	WPA_PUT_BE32(pos + 4, (u32) t);
+}
+
+
+static os_time_t tlsv1_cache_get_time(const u8 *pos)
+{
+	return (os_time_t) (((u64) WPA_GET_BE32(pos) << 32) |
+			    WPA_GET_BE32(pos + 4));
+}
+
+
+static struct dl_list * tlsv1_cache_bucket(struct tlsv1_server_cache *cache,
+					   const u8 *session_id)
+{
+	/* Session IDs are generated randomly by the server */
+	return &cache->hash[session_id[0] % TLSV1_CACHE_HASH_SIZE];
+}
+
+
+static void tlsv1_cache_set_expiration(struct tlsv1_server_cache *cache)
+{
+	struct tlsv1_cache_entry *entry;
+	os_time_t now;
+
+	eloop_cancel_timeout(tlsv1_cache_expire, cache, NULL);
+	entry = dl_list_first(&cache->entries, struct tlsv1_cache_entry, list);
+	if (entry == NULL)
+		return;
+	now = tlsv1_cache_now();
+	eloop_register_timeout(entry->expiration > now ?
+			       entry->expiration - now : 0, 0,
+			       tlsv1_cache_expire, cache, NULL);
+}
+
+
+static void tlsv1_cache_entry_free(struct tlsv1_server_cache *cache,
+				   struct tlsv1_cache_entry *entry)
+{
+	dl_list_del(&entry->list);
+	dl_list_del(&entry->hash);
+	cache->num_entries--;
+	cache->dirty = 1;
+	os_memset(entry, 0, sizeof(*entry));
+	os_free(entry);
+}
+
+
+static void tlsv1_cache_expire(void *eloop_ctx, void *timeout_ctx)
+{
+	struct tlsv1_server_cache *cache = eloop_ctx;
+	struct tlsv1_cache_entry *entry, *n;
+	os_time_t now = tlsv1_cache_now();
+
+	dl_list_for_each_safe(entry, n, &cache->entries,
+			      struct tlsv1_cache_entry, list) {
+		if (entry->expiration > now)
+			break;
+		tlsv1_cache_entry_free(cache, entry);
+		cache->expired++;
+	}
+	tlsv1_cache_set_expiration(cache);
+}
+
+
+static struct tlsv1_cache_entry *
+tlsv1_cache_find(struct tlsv1_server_cache *cache, const u8 *session_id,
+		 size_t session_id_len)
+{
+	struct tlsv1_cache_entry *entry;
+
+	if (session_id_len == 0)
+		return NULL;
+
+	dl_list_for_each(entry, tlsv1_cache_bucket(cache, session_id),
+			 struct tlsv1_cache_entry, hash) {
+		if (entry->sess.session_id_len == session_id_len &&
+		    os_memcmp(entry->sess.session_id, session_id,
+			      session_id_len) == 0)
+			return entry;
+	}
+
+	return NULL;
+}
+
+
+static void tlsv1_cache_insert(struct tlsv1_server_cache *cache,
+			       const struct tlsv1_server_session *sess,
+			       os_time_t expiration)
+{
+	struct tlsv1_cache_entry *entry, *pos;
+	int update = 0;
+
+	if (cache->size == 0 || sess->session_id_len == 0 ||
+	    sess->session_id_len > TLS_SESSION_ID_MAX_LEN)
+		return;
+
+	entry = tlsv1_cache_find(cache, sess->session_id,
+				 sess->session_id_len);
+	if (entry) {
+		tlsv1_cache_entry_free(cache, entry);
+		update = 1;
+	}
+
+	if (cache->num_entries >= cache->size) {
+		/* Drop the entry that would expire first */
+		entry = dl_list_first(&cache->entries,
+				      struct tlsv1_cache_entry, list);
+		tlsv1_cache_entry_free(cache, entry);
+		cache->evicted++;
+		update = 1;
+	}
+
+	entry = os_zalloc(sizeof(*entry));
+	if (entry == NULL)
+		return;
+	entry->sess = *sess;
+	entry->expiration = expiration;
+
+	/* New entries normally expire last, so search from the end */
+	dl_list_for_each_reverse(pos, &cache->entries,
+				 struct tlsv1_cache_entry, list) {
+		if (pos->expiration <= expiration)
+			break;
+	}
+	dl_list_add(&pos->list, &entry->list);
+	dl_list_add(tlsv1_cache_bucket(cache, sess->session_id),
+		    &entry->hash);
+	cache->num_entries++;
+	cache->dirty = 1;
+
+	if (update ||
+	    dl_list_first(&cache->entries, struct tlsv1_cache_entry, list) ==
+	    entry)
+		tlsv1_cache_set_expiration(cache);
+}
+
+
+/**
+ * tlsv1_server_cache_add - Add a session into the cache
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * @sess: Session from a completed full handshake
+ */
+void tlsv1_server_cache_add(struct tlsv1_server_cache *cache,
+			    const struct tlsv1_server_session *sess)
+{
+	if (cache == NULL)
+		return;
+	tlsv1_cache_insert(cache, sess, tlsv1_cache_now() + cache->lifetime);
+	wpa_hexdump(MSG_DEBUG, "TLSv1: Added session to cache",
+		    sess->session_id, sess->session_id_len);
+}
+
+
+/**
+ * tlsv1_server_cache_get - Find a session for resumption
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * @session_id: Session ID from ClientHello
+ * @session_id_len: Length of session_id
+ * @sess: Buffer for the cached session
+ * Returns: 0 if the session was found, -1 if not
+ */
+int tlsv1_server_cache_get(struct tlsv1_server_cache *cache,
+			   const u8 *session_id, size_t session_id_len,
+			   struct tlsv1_server_session *sess)
+{
+	struct tlsv1_cache_entry *entry;
+
+	if (cache == NULL)
+		return -1;
+
+	entry = tlsv1_cache_find(cache, session_id, session_id_len);
+	if (entry == NULL || entry->expiration <= tlsv1_cache_now()) {
+		cache->misses++;
+		return -1;
+	}
+
+	cache->hits++;
+	*sess = entry->sess;
+	return 0;
+}
+
+
+/**
+ * tlsv1_server_cache_remove - Remove a session from the cache
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * @session_id: Session ID
+ * @session_id_len: Length of session_id
+ *
+ * This is used to prevent resumption of a session that was terminated with a
+ * fatal alert.
+ */
+void tlsv1_server_cache_remove(struct tlsv1_server_cache *cache,
+			       const u8 *session_id, size_t session_id_len)
+{
+	struct tlsv1_cache_entry *entry;
+
+	if (cache == NULL)
+		return;
+
+	entry = tlsv1_cache_find(cache, session_id, session_id_len);
+	if (entry == NULL)
+		return;
+	wpa_hexdump(MSG_DEBUG, "TLSv1: Removed session from cache",
+		    session_id, session_id_len);
+	tlsv1_cache_entry_free(cache, entry);
+	tlsv1_cache_set_expiration(cache);
+}
+
+
+/**
+ * tlsv1_server_cache_tickets - Check whether session tickets are enabled
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * Returns: 1 if RFC 5077 session tickets are issued, 0 if not
+ */
+int tlsv1_server_cache_tickets(struct tlsv1_server_cache *cache)
+{
+	return cache && cache->tickets;
+}
+
+
+static int tlsv1_ticket_key_gen(struct tlsv1_ticket_key *key)
+{
+	if (random_get_bytes(key->name, sizeof(key->name)) ||
+	    random_get_bytes(key->aes_key, sizeof(key->aes_key)) ||
+	    random_get_bytes(key->hmac_key, sizeof(key->hmac_key))) {
+		os_memset(key, 0, sizeof(*key));
+		return -1;
+	}
+	key->created = tlsv1_cache_now();
+	key->valid = 1;
+	return 0;
+}
+
+
+static struct tlsv1_ticket_key *
+tlsv1_ticket_key_current(struct tlsv1_server_cache *cache)
+{
+	struct tlsv1_ticket_key *key = &cache->keys[0];
+
+	if (key->valid &&
+	    tlsv1_cache_now() - key->created < (os_time_t) cache->lifetime)
+		return key;
+
+	/* Rotate the key once per lifetime so that a compromised key exposes
+	 * only a limited number of sessions */
+	cache->keys[1] = *key;
+	if (tlsv1_ticket_key_gen(key) < 0) {
+		wpa_printf(MSG_INFO, "TLSv1: Failed to generate session "
+			   "ticket key");
+		return NULL;
+	}
+	cache->dirty = 1;
+	wpa_printf(MSG_DEBUG, "TLSv1: Generated a new session ticket key");
+	return key;
+}
+
+
+/**
+ * tlsv1_server_cache_ticket_encrypt - Build an RFC 5077 session ticket
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * @sess: Session to be resumed with the ticket
+ * @ticket_len: Buffer for returning the ticket length
+ * @lifetime_hint: Buffer for returning the ticket lifetime in seconds
+ * Returns: Allocated ticket (caller is responsible for freeing it) or %NULL
+ * on failure
+ */
+u8 * tlsv1_server_cache_ticket_encrypt(struct tlsv1_server_cache *cache,
+				       const struct tlsv1_server_session *sess,
+				       size_t *ticket_len, u32 *lifetime_hint)
+{
+	struct tlsv1_ticket_key *key;
+	u8 *ticket, *pos, *iv, *state;
+	os_time_t expiration;
+
+	if (!tlsv1_server_cache_tickets(cache) ||
+	    sess->context_len > TLS_SESSION_CONTEXT_MAX_LEN)
+		return NULL;
+	key = tlsv1_ticket_key_current(cache);
+	if (key == NULL)
+		return NULL;
+
+	ticket = os_zalloc(TLSV1_TICKET_LEN);
+	if (ticket == NULL)
+		return NULL;
+
+	pos = ticket;
+	os_memcpy(pos, key->name, TLSV1_TICKET_KEY_NAME_LEN);
+	pos += TLSV1_TICKET_KEY_NAME_LEN;
+	iv = pos;
+	pos += TLSV1_TICKET_IV_LEN;
+
+	state = pos;
+	WPA_PUT_BE16(pos, sess->tls_version);
+	pos += 2;
+	WPA_PUT_BE16(pos, sess->cipher_suite);
+	pos += 2;
+	os_memcpy(pos, sess->master_secret, TLS_MASTER_SECRET_LEN);
+	pos += TLS_MASTER_SECRET_LEN;
+	expiration = tlsv1_cache_now() + cache->lifetime +
+		tlsv1_cache_wall_offset();
+	tlsv1_cache_put_time(pos, expiration);
+	pos += 8;
+	*pos++ = sess->context_len;
+	os_memcpy(pos, sess->context, sess->context_len);
+	pos = state + TLSV1_TICKET_STATE_LEN;
+
+	if (random_get_bytes(iv, TLSV1_TICKET_IV_LEN) ||
+	    aes_128_cbc_encrypt(key->aes_key, iv, state,
+				TLSV1_TICKET_STATE_LEN) < 0 ||
+	    hmac_sha256(key->hmac_key, TLSV1_TICKET_HMAC_KEY_LEN,
+			ticket, pos - ticket, pos) < 0) {
+		os_memset(ticket, 0, TLSV1_TICKET_LEN);
+		os_free(ticket);
+		return NULL;
+	}
+
+	cache->tickets_issued++;
+	*ticket_len = TLSV1_TICKET_LEN;
+	*lifetime_hint = cache->lifetime;
+	return ticket;
+}
+
+
+/**
+ * tlsv1_server_cache_ticket_decrypt - Get the session from a session ticket
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * @ticket: Ticket from the ClientHello SessionTicket extension
+ * @ticket_len: Length of ticket
+ * @sess: Buffer for the session (session_id is not set)
+ * Returns: 0 if the ticket is valid, -1 if not
+ */
+int tlsv1_server_cache_ticket_decrypt(struct tlsv1_server_cache *cache,
+				      const u8 *ticket, size_t ticket_len,
+				      struct tlsv1_server_session *sess)
+{
+	struct tlsv1_ticket_key *key = NULL;
+	u8 mac[SHA256_MAC_LEN], state[TLSV1_TICKET_STATE_LEN], diff = 0;
+	const u8 *pos;
+	os_time_t expiration;
+	size_t i;
+
+	if (!tlsv1_server_cache_tickets(cache))
+		return -1;
+
+	if (ticket_len == TLSV1_TICKET_LEN) {
+		for (i = 0; i < TLSV1_TICKET_KEYS; i++) {
+			if (cache->keys[i].valid &&
+			    os_memcmp(cache->keys[i].name, ticket,
+				      TLSV1_TICKET_KEY_NAME_LEN) == 0)
+				key = &cache->keys[i];
+		}
+	}
+	if (key == NULL) {
+		wpa_printf(MSG_DEBUG, "TLSv1: Unknown session ticket");
+		cache->misses++;
+		return -1;
+	}
+
+	pos = ticket + ticket_len - SHA256_MAC_LEN;
+	if (hmac_sha256(key->hmac_key, TLSV1_TICKET_HMAC_KEY_LEN, ticket,
+			pos - ticket, mac) < 0)
+		return -1;
+	for (i = 0; i < SHA256_MAC_LEN; i++)
+		diff |= mac[i] ^ pos[i];
+	if (diff) {
+		wpa_printf(MSG_DEBUG, "TLSv1: Invalid session ticket MAC");
+		cache->misses++;
+		return -1;
+	}
+
+	pos = ticket + TLSV1_TICKET_KEY_NAME_LEN;
+	os_memcpy(state, pos + TLSV1_TICKET_IV_LEN, TLSV1_TICKET_STATE_LEN);
+	if (aes_128_cbc_decrypt(key->aes_key, pos, state,
+				TLSV1_TICKET_STATE_LEN) < 0)
+		return -1;
+
+	os_memset(sess, 0, sizeof(*sess));
+	pos = state;
+	sess->tls_version = WPA_GET_BE16(pos);
+	pos += 2;
+	sess->cipher_suite = WPA_GET_BE16(pos);
+	pos += 2;
+	os_memcpy(sess->master_secret, pos, TLS_MASTER_SECRET_LEN);
+	pos += TLS_MASTER_SECRET_LEN;
+	expiration = tlsv1_cache_get_time(pos) - tlsv1_cache_wall_offset();
+	pos += 8;
+	sess->context_len = *pos++;
+	if (sess->context_len <= TLS_SESSION_CONTEXT_MAX_LEN)
+		os_memcpy(sess->context, pos, sess->context_len);
+	os_memset(state, 0, sizeof(state));
+
+	if (sess->context_len > TLS_SESSION_CONTEXT_MAX_LEN ||
+	    expiration <= tlsv1_cache_now()) {
+		wpa_printf(MSG_DEBUG, "TLSv1: Expired session ticket");
+		os_memset(sess, 0, sizeof(*sess));
+		cache->misses++;
+		return -1;
+	}
+
+	cache->ticket_hits++;
+	return 0;
+}
+
+
+/**
+ * tlsv1_server_cache_stats - Get session cache statistics in text format
+ * @cache: Session cache from tlsv1_server_cache_init()
+ * @buf: Buffer for the statistics
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written into buf
+ */
+int tlsv1_server_cache_stats(struct tlsv1_server_cache *cache, char *buf,
+			     size_t buflen)
+{
+	int ret;
+
+	if (cache == NULL)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "entries=%u\n"
+			  "size=%u\n"
+			  "lifetime=%u\n"
+			  "tickets=%d\n"
+			  "hits=%lu\n"
+			  "ticket_hits=%lu\n"
+			  "misses=%lu\n"
+			  "tickets_issued=%lu\n"
+			  "expired=%lu\n"
+			  "evicted=%lu\n",
+			  cache->num_entries, cache->size, cache->lifetime,
+			  cache->tickets, cache->hits, cache->ticket_hits,
+			  cache->misses, cache->tickets_issued, cache->expired,
+			  cache->evicted);
+	if (ret < 0 || (size_t) ret >= buflen)
+		return 0;
+	return ret;
+}
+
+
+static void tlsv1_cache_hdr(u8 *hdr)
+{
+	os_memset(hdr, 0, TLSV1_CACHE_HDR_LEN);
+	os_memcpy(hdr, TLSV1_CACHE_MAGIC, 8);
+	hdr[8] = TLSV1_CACHE_VERSION;
+}
+
+
+static FILE * tlsv1_cache_fopen(const char *fname)
+{
+	int fd;
+	FILE *f;
+
+	fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return NULL;
+	f = fdopen(fd, "wb");
+	if (f == NULL)
+		close(fd);
+	return f;
+}
+
+
+static int tlsv1_cache_write_rec(FILE *f, u8 *rec, size_t len)
+{
+	u8 hdr[2];
+	int ret = 0;
+
+	WPA_PUT_BE16(hdr, len);
+	if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr) ||
+	    fwrite(rec, 1, len, f) != len)
+		ret = -1;
+	os_memset(rec, 0, len);
+	return ret;
+}
+
+
+static void tlsv1_cache_save(struct tlsv1_server_cache *cache)
+{
+	struct tlsv1_cache_entry *entry;
+	u8 hdr[TLSV1_CACHE_HDR_LEN], rec[TLSV1_CACHE_SESSION_REC_LEN], *pos;
+	os_time_t offset = tlsv1_cache_wall_offset();
+	char *tmp;
+	size_t len, i;
+	FILE *f;
+	int err = 0;
+
+	len = os_strlen(cache->fname) + 5;
+	tmp = os_malloc(len);
+	if (tmp == NULL)
+		return;
+	os_snprintf(tmp, len, "%s.tmp", cache->fname);
+
+	f = tlsv1_cache_fopen(tmp);
+	if (f == NULL) {
+		wpa_printf(MSG_INFO, "TLSv1: Could not open '%s'", tmp);
+		os_free(tmp);
+		return;
+	}
+
+	tlsv1_cache_hdr(hdr);
+	if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr))
+		err = 1;
+
+	for (i = 0; i < TLSV1_TICKET_KEYS && !err; i++) {
+		struct tlsv1_ticket_key *key = &cache->keys[i];
+		if (!key->valid)
+			continue;
+		pos = rec;
+		*pos++ = TLSV1_CACHE_REC_KEY;
+		os_memcpy(pos, key->name, sizeof(key->name));
+		pos += sizeof(key->name);
+		os_memcpy(pos, key->aes_key, sizeof(key->aes_key));
+		pos += sizeof(key->aes_key);
+		os_memcpy(pos, key->hmac_key, sizeof(key->hmac_key));
+		pos += sizeof(key->hmac_key);
+		tlsv1_cache_put_time(pos, key->created + offset);
+		if (tlsv1_cache_write_rec(f, rec, TLSV1_CACHE_KEY_REC_LEN) < 0)
+			err = 1;
+	}
+
+	dl_list_for_each(entry, &cache->entries, struct tlsv1_cache_entry,
+			 list) {
+		if (err)
+			break;
+		os_memset(rec, 0, sizeof(rec));
+		pos = rec;
+		*pos++ = TLSV1_CACHE_REC_SESSION;
+		*pos++ = entry->sess.session_id_len;
+		os_memcpy(pos, entry->sess.session_id,
+			  entry->sess.session_id_len);
+		pos += TLS_SESSION_ID_MAX_LEN;
+		os_memcpy(pos, entry->sess.master_secret,
+			  TLS_MASTER_SECRET_LEN);
+		pos += TLS_MASTER_SECRET_LEN;
+		WPA_PUT_BE16(pos, entry->sess.tls_version);
+		pos += 2;
+		WPA_PUT_BE16(pos, entry->sess.cipher_suite);
+		pos += 2;
+		*pos++ = entry->sess.context_len;
+		os_memcpy(pos, entry->sess.context, entry->sess.context_len);
+		pos += TLS_SESSION_CONTEXT_MAX_LEN;
+		tlsv1_cache_put_time(pos, entry->expiration + offset);
+		if (tlsv1_cache_write_rec(f, rec, sizeof(rec)) < 0)
+			err = 1;
+	}
+
+	if (fclose(f) != 0 || err || rename(tmp, cache->fname) < 0) {
+		wpa_printf(MSG_INFO, "TLSv1: Failed to write session cache "
+			   "into '%s'", cache->fname);
+		unlink(tmp);
+	} else {
+		cache->dirty = 0;
+		wpa_printf(MSG_DEBUG, "TLSv1: Wrote %u cached sessions to "
+			   "'%s'", cache->num_entries, cache->fname);
+	}
+	os_free(tmp);
+}
+
+
+static void tlsv1_cache_load(struct tlsv1_server_cache *cache)
+{
+	struct tlsv1_server_session sess;
+	struct tlsv1_ticket_key *key;
+	u8 hdr[TLSV1_CACHE_HDR_LEN];
+	const u8 *pos, *end, *rec;
+	os_time_t offset, now, expiration;
+	size_t len, rlen, num_keys = 0;
+	unsigned int restored = 0;
+	char *buf;
+
+	buf = os_readfile(cache->fname, &len);
+	if (buf == NULL) {
+		wpa_printf(MSG_DEBUG, "TLSv1: No saved sessions in '%s'",
+			   cache->fname);
+		return;
+	}
+
+	tlsv1_cache_hdr(hdr);
+	if (len < sizeof(hdr) || os_memcmp(buf, hdr, sizeof(hdr)) != 0) {
+		wpa_printf(MSG_INFO, "TLSv1: Unsupported session cache file "
+			   "format in '%s'", cache->fname);
+		os_free(buf);
+		return;
+	}
+
+	offset = tlsv1_cache_wall_offset();
+	now = tlsv1_cache_now();
+	pos = (const u8 *) buf + sizeof(hdr);
+	end = (const u8 *) buf + len;
+	while (end - pos >= 2) {
+		rlen = WPA_GET_BE16(pos);
+		pos += 2;
+		if ((size_t) (end - pos) < rlen || rlen < 1)
+			break;
+		rec = pos;
+		pos += rlen;
+
+		if (rec[0] == TLSV1_CACHE_REC_KEY &&
+		    rlen == TLSV1_CACHE_KEY_REC_LEN &&
+		    num_keys < TLSV1_TICKET_KEYS) {
+			key = &cache->keys[num_keys++];
+			rec++;
+			os_memcpy(key->name, rec, sizeof(key->name));
+			rec += sizeof(key->name);
+			os_memcpy(key->aes_key, rec, sizeof(key->aes_key));
+			rec += sizeof(key->aes_key);
+			os_memcpy(key->hmac_key, rec, sizeof(key->hmac_key));
+			rec += sizeof(key->hmac_key);
+			key->created = tlsv1_cache_get_time(rec) - offset;
+			key->valid = 1;
+			continue;
+		}
+
+		if (rec[0] != TLSV1_CACHE_REC_SESSION ||
+		    rlen != TLSV1_CACHE_SESSION_REC_LEN)
+			continue;
+		os_memset(&sess, 0, sizeof(sess));
+		rec++;
+		sess.session_id_len = *rec++;
+		if (sess.session_id_len > TLS_SESSION_ID_MAX_LEN)
+			continue;
+		os_memcpy(sess.session_id, rec, sess.session_id_len);
+		rec += TLS_SESSION_ID_MAX_LEN;
+		os_memcpy(sess.master_secret, rec, TLS_MASTER_SECRET_LEN);
+		rec += TLS_MASTER_SECRET_LEN;
+		sess.tls_version = WPA_GET_BE16(rec);
+		rec += 2;
+		sess.cipher_suite = WPA_GET_BE16(rec);
+		rec += 2;
+		sess.context_len = *rec++;
+		if (sess.context_len > TLS_SESSION_CONTEXT_MAX_LEN)
+			continue;
+		os_memcpy(sess.context, rec, sess.context_len);
+		rec += TLS_SESSION_CONTEXT_MAX_LEN;
+		expiration = tlsv1_cache_get_time(rec) - offset;
+		if (expiration <= now)
+			continue;
+		/* The configured lifetime may have been reduced */
+		if (expiration > now + (os_time_t) cache->lifetime)
+			expiration = now + cache->lifetime;
+		tlsv1_cache_insert(cache, &sess, expiration);
+		restored++;
+	}
+	if (pos != end)
+		wpa_printf(MSG_INFO, "TLSv1: Ignored invalid data in '%s'",
+			   cache->fname);
+	os_memset(&sess, 0, sizeof(sess));
+	os_memset(buf, 0, len);
+	os_free(buf);
+
+	cache->dirty = 0;
+	wpa_printf(MSG_DEBUG, "TLSv1: Restored %u cached sessions and %u "
+		   "ticket keys from '%s'", restored, (unsigned int) num_keys,
+		   cache->fname);
+}
+
+
+static void tlsv1_cache_save_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct tlsv1_server_cache *cache = eloop_ctx;
+
+	if (cache->dirty)
+		tlsv1_cache_save(cache);
+	eloop_register_timeout(TLSV1_CACHE_SAVE_INTERVAL, 0,
+			       tlsv1_cache_save_timeout, cache, NULL);
+}
+
+
+/**
+ * tlsv1_server_cache_init - Initialize TLS server session cache
+ * @size: Maximum number of sessions stored by session ID
+ * @lifetime: Session lifetime in seconds
+ * @tickets: Whether to issue RFC 5077 session tickets
+ * @fname: File for saving the sessions over restarts or %NULL
+ * Returns: Pointer to the session cache or %NULL on failure
+ */
+struct tlsv1_server_cache *
+tlsv1_server_cache_init(unsigned int size, unsigned int lifetime,
+			int tickets, const char *fname)
+{
+	struct tlsv1_server_cache *cache;
+	size_t i;
+
+	if (lifetime == 0)
+		return NULL;
+
+	cache = os_zalloc(sizeof(*cache));
+	if (cache == NULL)
+		return NULL;
+	dl_list_init(&cache->entries);
+	for (i = 0; i < TLSV1_CACHE_HASH_SIZE; i++)
+		dl_list_init(&cache->hash[i]);
+	cache->size = size;
+	cache->lifetime = lifetime;
+	cache->tickets = tickets;
+
+	if (fname) {
+		cache->fname = os_strdup(fname);
+		if (cache->fname == NULL) {
+			os_free(cache);
+			return NULL;
+		}
+		tlsv1_cache_load(cache);
+		eloop_register_timeout(TLSV1_CACHE_SAVE_INTERVAL, 0,
+				       tlsv1_cache_save_timeout, cache, NULL);
+	}
+
+	wpa_printf(MSG_DEBUG, "TLSv1: Session cache enabled (size=%u "
+		   "lifetime=%u tickets=%d)", size, lifetime, tickets);
+	return cache;
+}
+
+
+/**
+ * tlsv1_server_cache_deinit - Deinitialize TLS server session cache
+ * @cache: Session cache from tlsv1_server_cache_init()
+ *
+ * The sessions are saved into the file, if one was configured, before they
+ * are freed.
+ */
+void tlsv1_server_cache_deinit(struct tlsv1_server_cache *cache)
+{
+	struct tlsv1_cache_entry *entry, *n;
+
+	if (cache == NULL)
+		return;
+
+	eloop_cancel_timeout(tlsv1_cache_expire, cache, NULL);
+	eloop_cancel_timeout(tlsv1_cache_save_timeout, cache, NULL);
+	if (cache->fname && cache->dirty)
+		tlsv1_cache_save(cache);
+
+	dl_list_for_each_safe(entry, n, &cache->entries,
+			      struct tlsv1_cache_entry, list)
+		tlsv1_cache_entry_free(cache, entry);
+	os_free(cache->fname);
+	os_memset(cache, 0, sizeof(*cache));
+	os_free(cache);
+}
@@ -0,0 +1,60 @@
+/*
+ * TLSv1 server - session cache
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef TLSV1_SERVER_CACHE_H
+#define TLSV1_SERVER_CACHE_H
+
+#include "tlsv1_common.h"
+
+#define TLS_SESSION_CONTEXT_MAX_LEN 32
+
+/**
+ * struct tlsv1_server_session - Resumable TLS session
+ * @session_id: Session ID assigned by the server
+ * @session_id_len: Length of session_id
+ * @master_secret: Master secret of the session
+ * @tls_version: Negotiated protocol version
+ * @cipher_suite: Negotiated cipher suite
+ * @context: Session context from tlsv1_server_set_session_context(); a
+ * session can only be resumed by a connection with the same context
+ * @context_len: Length of context
+ */
+struct tlsv1_server_session {
+	u8 session_id[TLS_SESSION_ID_MAX_LEN];
+	size_t session_id_len;
+	u8 master_secret[TLS_MASTER_SECRET_LEN];
+	u16 tls_version;
+	u16 cipher_suite;
+	u8 context[TLS_SESSION_CONTEXT_MAX_LEN];
+	size_t context_len;
+};
+
+struct tlsv1_server_cache;
+
+struct tlsv1_server_cache *
+tlsv1_server_cache_init(unsigned int size, unsigned int lifetime,
+			int tickets, const char *fname);
+void tlsv1_server_cache_deinit(struct tlsv1_server_cache *cache);
+void tlsv1_server_cache_add(struct tlsv1_server_cache *cache,
+			    const struct tlsv1_server_session *sess);
+int tlsv1_server_cache_get(struct tlsv1_server_cache *cache,
+			   const u8 *session_id, size_t session_id_len,
+			   struct tlsv1_server_session *sess);
+void tlsv1_server_cache_remove(struct tlsv1_server_cache *cache,
+			       const u8 *session_id, size_t session_id_len);
+int tlsv1_server_cache_tickets(struct tlsv1_server_cache *cache);
+u8 * tlsv1_server_cache_ticket_encrypt(struct tlsv1_server_cache *cache,
+				       const struct tlsv1_server_session *sess,
+				       size_t *ticket_len, u32 *lifetime_hint);
+int tlsv1_server_cache_ticket_decrypt(struct tlsv1_server_cache *cache,
+				      const u8 *ticket, size_t ticket_len,
+				      struct tlsv1_server_session *sess);
+int tlsv1_server_cache_stats(struct tlsv1_server_cache *cache, char *buf,
+			     size_t buflen);
+
+#endif /* TLSV1_SERVER_CACHE_H */
@@ -52,6 +52,13 @@ struct tlsv1_server {
 	void *session_ticket_cb_ctx;
 
 	int use_session_ticket;
+	int session_ticket_ext; /* SessionTicket extension in ClientHello */
+
+	struct tlsv1_server_cache *cache;
+	u8 session_context[TLS_SESSION_CONTEXT_MAX_LEN];
+	size_t session_context_len;
+	int session_resumed;
+	int issue_ticket; /* send NewSessionTicket; RFC 5077 */
 
 	u8 *dh_secret;
 	size_t dh_secret_len;
@@ -65,6 +72,8 @@ int tlsv1_server_derive_keys(struct tlsv1_server *conn,
 u8 * tlsv1_server_handshake_write(struct tlsv1_server *conn, size_t *out_len);
 u8 * tlsv1_server_send_alert(struct tlsv1_server *conn, u8 level,
 			     u8 description, size_t *out_len);
+void tlsv1_server_get_session(struct tlsv1_server *conn,
+			      struct tlsv1_server_session *sess);
 int tlsv1_server_process_handshake(struct tlsv1_server *conn, u8 ct,
 				   const u8 *buf, size_t *len);
 
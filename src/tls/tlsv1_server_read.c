@@ -27,11 +27,96 @@ static int tls_process_change_cipher_spec(struct tlsv1_server *conn,
 					  size_t *in_len);
 
 
+static int tls_client_offers_suite(const u8 *suites, size_t num_suites,
+				   u16 suite)
+{
+	size_t i;
+
+	for (i = 0; i < num_suites; i++) {
+		if (WPA_GET_BE16(suites + 2 * i) == suite)
+			return 1;
+	}
+	return 0;
+}
+
+
+static int tls_resume_session(struct tlsv1_server *conn,
+			      const u8 *session_id, size_t session_id_len,
+			      const u8 *suites, size_t num_suites)
+{
+	struct tlsv1_server_session sess;
+	size_t i;
+	int found = 0;
+
+	if (conn->cache == NULL || conn->session_context_len == 0)
+		return 0;
+
+	/* EAP-FAST uses the SessionTicket extension for PAC-Opaque */
+	if (conn->session_ticket_ext && conn->session_ticket_cb == NULL &&
+	    tlsv1_server_cache_tickets(conn->cache)) {
+		if (conn->session_ticket_len &&
+		    tlsv1_server_cache_ticket_decrypt(
+			    conn->cache, conn->session_ticket,
+			    conn->session_ticket_len, &sess) == 0) {
+			wpa_printf(MSG_DEBUG, "TLSv1: Valid session ticket");
+			found = 1;
+		} else
+			conn->issue_ticket = 1;
+	}
+
+	if (!found && session_id_len &&
+	    tlsv1_server_cache_get(conn->cache, session_id, session_id_len,
+				   &sess) == 0) {
+		wpa_printf(MSG_DEBUG, "TLSv1: Found session in cache");
+		found = 1;
+	}
+
+	if (!found)
+		return 0;
+
+	for (i = 0; i < conn->num_cipher_suites; i++) {
+		if (conn->cipher_suites[i] == sess.cipher_suite)
+			break;
+	}
+	if (sess.context_len != conn->session_context_len ||
+	    os_memcmp(sess.context, conn->session_context,
+		      sess.context_len) != 0 ||
+	    sess.tls_version != conn->rl.tls_version ||
+	    i == conn->num_cipher_suites ||
+	    !tls_client_offers_suite(suites, num_suites, sess.cipher_suite)) {
+		wpa_printf(MSG_DEBUG, "TLSv1: Cached session does not match "
+			   "the connection - use full handshake");
+		os_memset(&sess, 0, sizeof(sess));
+		return 0;
+	}
+
+	if (tlsv1_record_set_cipher_suite(&conn->rl, sess.cipher_suite) < 0) {
+		os_memset(&sess, 0, sizeof(sess));
+		tlsv1_server_alert(conn, TLS_ALERT_LEVEL_FATAL,
+				   TLS_ALERT_INTERNAL_ERROR);
+		return -1;
+	}
+	conn->cipher_suite = sess.cipher_suite;
+	os_memcpy(conn->master_secret, sess.master_secret,
+		  TLS_MASTER_SECRET_LEN);
+	os_memset(&sess, 0, sizeof(sess));
+
+	/* With a session ticket, the session ID from the client is echoed;
+	 * RFC 5077, 3.4 */
+	os_memcpy(conn->session_id, session_id, session_id_len);
+	conn->session_id_len = session_id_len;
+	conn->session_resumed = 1;
+	conn->issue_ticket = 0;
+
+	return 0;
+}
+
+
 static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 				    const u8 *in_data, size_t *in_len)
 {
-	const u8 *pos, *end, *c;
-	size_t left, len, i, j;
+	const u8 *pos, *end, *c, *session_id, *suites;
+	size_t left, len, i, j, session_id_len, num_client_suites;
 	u16 cipher_suite;
 	u16 num_suites;
 	int compr_null_found;
@@ -119,8 +204,9 @@ static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 	if (end - pos < 1 + *pos || *pos > TLS_SESSION_ID_MAX_LEN)
 		goto decode_error;
 	wpa_hexdump(MSG_MSGDUMP, "TLSv1: client session_id", pos + 1, *pos);
+	session_id = pos + 1;
+	session_id_len = *pos;
 	pos += 1 + *pos;
-	/* TODO: add support for session resumption */
 
 	/* CipherSuite cipher_suites<2..2^16-1> */
 	if (end - pos < 2)
@@ -134,6 +220,8 @@ static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 	if (num_suites & 1)
 		goto decode_error;
 	num_suites /= 2;
+	suites = pos;
+	num_client_suites = num_suites;
 
 	cipher_suite = 0;
 	for (i = 0; !cipher_suite && i < conn->num_cipher_suites; i++) {
@@ -245,6 +333,7 @@ static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 				    "Extension data", pos, ext_len);
 
 			if (ext_type == TLS_EXT_SESSION_TICKET) {
+				conn->session_ticket_ext = 1;
 				os_free(conn->session_ticket);
 				conn->session_ticket = os_malloc(ext_len);
 				if (conn->session_ticket) {
@@ -260,6 +349,10 @@ static int tls_process_client_hello(struct tlsv1_server *conn, u8 ct,
 
 	*in_len = end - in_data;
 
+	if (tls_resume_session(conn, session_id, session_id_len, suites,
+			       num_client_suites) < 0)
+		return -1;
+
 	wpa_printf(MSG_DEBUG, "TLSv1: ClientHello OK - proceed to "
 		   "ServerHello");
 	conn->state = SERVER_HELLO;
@@ -1183,8 +1276,8 @@ static int tls_process_client_finished(struct tlsv1_server *conn, u8 ct,
 
 	*in_len = end - in_data;
 
-	if (conn->use_session_ticket) {
-		/* Abbreviated handshake using session ticket; RFC 4507 */
+	if (conn->session_resumed) {
+		/* Abbreviated handshake */
 		wpa_printf(MSG_DEBUG, "TLSv1: Abbreviated handshake completed "
 			   "successfully");
 		conn->state = ESTABLISHED;
@@ -62,11 +62,14 @@ static int tls_write_server_hello(struct tlsv1_server *conn,
 	wpa_hexdump(MSG_MSGDUMP, "TLSv1: server_random",
 		    conn->server_random, TLS_RANDOM_LEN);
 
-	conn->session_id_len = TLS_SESSION_ID_MAX_LEN;
-	if (random_get_bytes(conn->session_id, conn->session_id_len)) {
-		wpa_printf(MSG_ERROR, "TLSv1: Could not generate "
-			   "session_id");
-		return -1;
+	if (!conn->session_resumed) {
+		conn->session_id_len = TLS_SESSION_ID_MAX_LEN;
+		if (random_get_bytes(conn->session_id,
+				     conn->session_id_len)) {
+			wpa_printf(MSG_ERROR, "TLSv1: Could not generate "
+				   "session_id");
+			return -1;
+		}
 	}
 	wpa_hexdump(MSG_MSGDUMP, "TLSv1: session_id",
 		    conn->session_id, conn->session_id_len);
@@ -111,16 +114,8 @@ static int tls_write_server_hello(struct tlsv1_server *conn,
 			return -1;
 		}
 		conn->use_session_ticket = res;
-
-		if (conn->use_session_ticket) {
-			if (tlsv1_server_derive_keys(conn, NULL, 0) < 0) {
-				wpa_printf(MSG_DEBUG, "TLSv1: Failed to "
-					   "derive keys");
-				tlsv1_server_alert(conn, TLS_ALERT_LEVEL_FATAL,
-						   TLS_ALERT_INTERNAL_ERROR);
-				return -1;
-			}
-		}
+		if (conn->use_session_ticket)
+			conn->session_resumed = 1;
 
 		/*
 		 * RFC 4507 specifies that server would include an empty
@@ -134,6 +129,26 @@ static int tls_write_server_hello(struct tlsv1_server *conn,
 		 */
 	}
 
+	if (conn->issue_ticket) {
+		/* Extension server_hello_extension_list<0..2^16-1> */
+		WPA_PUT_BE16(pos, 4);
+		pos += 2;
+		/* Empty SessionTicket extension; RFC 5077, 3.2 */
+		WPA_PUT_BE16(pos, TLS_EXT_SESSION_TICKET);
+		pos += 2;
+		WPA_PUT_BE16(pos, 0);
+		pos += 2;
+	}
+
+	if (conn->session_resumed) {
+		if (tlsv1_server_derive_keys(conn, NULL, 0) < 0) {
+			wpa_printf(MSG_DEBUG, "TLSv1: Failed to derive keys");
+			tlsv1_server_alert(conn, TLS_ALERT_LEVEL_FATAL,
+					   TLS_ALERT_INTERNAL_ERROR);
+			return -1;
+		}
+	}
+
 	WPA_PUT_BE24(hs_length, pos - hs_length - 3);
 	tls_verify_hash_add(&conn->verify, hs_start, pos - hs_start);
 
@@ -661,6 +676,80 @@ static int tls_write_server_finished(struct tlsv1_server *conn,
 }
 
 
+static int tls_write_server_new_session_ticket(struct tlsv1_server *conn,
+					       u8 **msgpos, u8 *end)
+{
+	struct tlsv1_server_session sess;
+	u8 *pos, *rhdr, *hs_start, *hs_length, *ticket;
+	size_t rlen, ticket_len;
+	u32 lifetime_hint;
+
+	if (!conn->issue_ticket)
+		return 0;
+
+	tlsv1_server_get_session(conn, &sess);
+	ticket = tlsv1_server_cache_ticket_encrypt(conn->cache, &sess,
+						   &ticket_len,
+						   &lifetime_hint);
+	os_memset(&sess, 0, sizeof(sess));
+	if (ticket == NULL) {
+		/* RFC 5077 allows an empty ticket when none can be issued */
+		ticket_len = 0;
+		lifetime_hint = 0;
+	}
+
+	pos = *msgpos;
+
+	wpa_printf(MSG_DEBUG, "TLSv1: Send NewSessionTicket");
+	rhdr = pos;
+	pos += TLS_RECORD_HEADER_LEN;
+
+	/* opaque fragment[TLSPlaintext.length] */
+
+	/* Handshake */
+	hs_start = pos;
+	/* HandshakeType msg_type */
+	*pos++ = TLS_HANDSHAKE_TYPE_NEW_SESSION_TICKET;
+	/* uint24 length (to be filled) */
+	hs_length = pos;
+	pos += 3;
+	/* body - NewSessionTicket */
+	if (pos + 4 + 2 + ticket_len > end) {
+		os_free(ticket);
+		tlsv1_server_alert(conn, TLS_ALERT_LEVEL_FATAL,
+				   TLS_ALERT_INTERNAL_ERROR);
+		return -1;
+	}
+	/* uint32 ticket_lifetime_hint */
+	WPA_PUT_BE32(pos, lifetime_hint);
+	pos += 4;
+	/* opaque ticket<0..2^16-1> */
+	WPA_PUT_BE16(pos, ticket_len);
+	pos += 2;
+	if (ticket) {
+		os_memcpy(pos, ticket, ticket_len);
+		pos += ticket_len;
+		os_free(ticket);
+	}
+
+	WPA_PUT_BE24(hs_length, pos - hs_length - 3);
+	tls_verify_hash_add(&conn->verify, hs_start, pos - hs_start);
+
+	if (tlsv1_record_send(&conn->rl, TLS_CONTENT_TYPE_HANDSHAKE,
+			      rhdr, end - rhdr, hs_start, pos - hs_start,
+			      &rlen) < 0) {
+		wpa_printf(MSG_DEBUG, "TLSv1: Failed to create a record");
+		tlsv1_server_alert(conn, TLS_ALERT_LEVEL_FATAL,
+				   TLS_ALERT_INTERNAL_ERROR);
+		return -1;
+	}
+
+	*msgpos = rhdr + rlen;
+
+	return 0;
+}
+
+
 static u8 * tls_send_server_hello(struct tlsv1_server *conn, size_t *out_len)
 {
 	u8 *msg, *end, *pos;
@@ -682,8 +771,8 @@ static u8 * tls_send_server_hello(struct tlsv1_server *conn, size_t *out_len)
 		return NULL;
 	}
 
-	if (conn->use_session_ticket) {
-		/* Abbreviated handshake using session ticket; RFC 4507 */
+	if (conn->session_resumed) {
+		/* Abbreviated handshake */
 		if (tls_write_server_change_cipher_spec(conn, &pos, end) < 0 ||
 		    tls_write_server_finished(conn, &pos, end) < 0) {
 			os_free(msg);
@@ -728,7 +817,8 @@ static u8 * tls_send_change_cipher_spec(struct tlsv1_server *conn,
 	pos = msg;
 	end = msg + 1000;
 
-	if (tls_write_server_change_cipher_spec(conn, &pos, end) < 0 ||
+	if (tls_write_server_new_session_ticket(conn, &pos, end) < 0 ||
+	    tls_write_server_change_cipher_spec(conn, &pos, end) < 0 ||
 	    tls_write_server_finished(conn, &pos, end) < 0) {
 		os_free(msg);
 		return NULL;
@@ -739,6 +829,13 @@ static u8 * tls_send_change_cipher_spec(struct tlsv1_server *conn,
 	wpa_printf(MSG_DEBUG, "TLSv1: Handshake completed successfully");
 	conn->state = ESTABLISHED;
 
+	if (conn->cache && conn->session_context_len) {
+		struct tlsv1_server_session sess;
+		tlsv1_server_get_session(conn, &sess);
+		tlsv1_server_cache_add(conn->cache, &sess);
+		os_memset(&sess, 0, sizeof(sess));
+	}
+
 	return msg;
 }
 
@@ -751,7 +848,7 @@ u8 * tlsv1_server_handshake_write(struct tlsv1_server *conn, size_t *out_len)
 	case SERVER_CHANGE_CIPHER_SPEC:
 		return tls_send_change_cipher_spec(conn, out_len);
 	default:
-		if (conn->state == ESTABLISHED && conn->use_session_ticket) {
+		if (conn->state == ESTABLISHED && conn->session_resumed) {
 			/* Abbreviated handshake was already completed. */
 			return NULL;
 		}
@@ -10,9 +10,31 @@
 
 #include "common.h"
 #include "crypto/crypto.h"
+#include "crypto/sha256.h"
 #include "asn1.h"
 #include "x509v3.h"
 
+/*
+ * Most peers present the same (intermediate) CA certificates in every
+ * handshake, so parsed certificates and successfully verified signatures are
+ * cached. Entries are removed once the certificate has expired.
+ */
+#define X509_CACHE_CERTS 16
+#define X509_CACHE_SIGNATURES 64
+
+static struct x509_cert_cache_entry {
+	struct x509_certificate *cert; /* private copy owned by the cache */
+	unsigned int last_used;
+} x509_cert_cache[X509_CACHE_CERTS];
+
+static struct x509_sig_cache_entry {
+	u8 hash[SHA256_MAC_LEN]; /* issuer public key and certificate */
+	os_time_t not_after;
+	unsigned int last_used;
+} x509_sig_cache[X509_CACHE_SIGNATURES];
+
+static unsigned int x509_cache_use;
+
 
 static void x509_free_name(struct x509_name *name)
 {
@@ -76,6 +98,214 @@ void x509_certificate_chain_free(struct x509_certificate *cert)
 }
 
 
+static int x509_name_copy(struct x509_name *dst, const struct x509_name *src)
+{
+	size_t i;
+
+	for (i = 0; i < src->num_attr; i++) {
+		dst->attr[i].value = os_strdup(src->attr[i].value);
+		if (dst->attr[i].value == NULL)
+			return -1;
+	}
+	if ((src->email && (dst->email = os_strdup(src->email)) == NULL) ||
+	    (src->alt_email &&
+	     (dst->alt_email = os_strdup(src->alt_email)) == NULL) ||
+	    (src->dns && (dst->dns = os_strdup(src->dns)) == NULL) ||
+	    (src->uri && (dst->uri = os_strdup(src->uri)) == NULL))
+		return -1;
+	if (src->ip) {
+		dst->ip = os_malloc(src->ip_len);
+		if (dst->ip == NULL)
+			return -1;
+		os_memcpy(dst->ip, src->ip, src->ip_len);
+	}
+	return 0;
+}
+
+
+static struct x509_certificate *
+x509_certificate_clone(const struct x509_certificate *src)
+{
+	struct x509_certificate *cert;
+	size_t i;
+
+	cert = os_malloc(sizeof(*cert) + src->cert_len);
+	if (cert == NULL)
+		return NULL;
+	os_memcpy(cert, src, sizeof(*cert) + src->cert_len);
+	cert->next = NULL;
+	cert->cert_start = (u8 *) (cert + 1);
+	cert->tbs_cert_start = cert->cert_start +
+		(src->tbs_cert_start - src->cert_start);
+
+	/* Clear the pointers shared with src before allocating own copies */
+	for (i = 0; i < cert->issuer.num_attr; i++)
+		cert->issuer.attr[i].value = NULL;
+	for (i = 0; i < cert->subject.num_attr; i++)
+		cert->subject.attr[i].value = NULL;
+	cert->issuer.email = cert->issuer.alt_email = NULL;
+	cert->issuer.dns = cert->issuer.uri = NULL;
+	cert->issuer.ip = NULL;
+	cert->subject.email = cert->subject.alt_email = NULL;
+	cert->subject.dns = cert->subject.uri = NULL;
+	cert->subject.ip = NULL;
+	cert->public_key = NULL;
+	cert->sign_value = NULL;
+
+	if (x509_name_copy(&cert->issuer, &src->issuer) < 0 ||
+	    x509_name_copy(&cert->subject, &src->subject) < 0)
+		goto fail;
+
+	cert->public_key = os_malloc(src->public_key_len);
+	cert->sign_value = os_malloc(src->sign_value_len);
+	if (cert->public_key == NULL || cert->sign_value == NULL)
+		goto fail;
+	os_memcpy(cert->public_key, src->public_key, src->public_key_len);
+	os_memcpy(cert->sign_value, src->sign_value, src->sign_value_len);
+
+	return cert;
+
+fail:
+	x509_certificate_free(cert);
+	return NULL;
+}
+
+
+static int x509_cache_expired(os_time_t not_after)
+{
+	struct os_time now;
+
+	os_get_time(&now);
+	return (unsigned long) now.sec > (unsigned long) not_after;
+}
+
+
+static struct x509_certificate * x509_cert_cache_get(const u8 *buf,
+						     size_t len)
+{
+	struct x509_cert_cache_entry *e;
+	size_t i;
+
+	for (i = 0; i < X509_CACHE_CERTS; i++) {
+		e = &x509_cert_cache[i];
+		if (e->cert == NULL || e->cert->cert_len != len ||
+		    os_memcmp(e->cert->cert_start, buf, len) != 0)
+			continue;
+		if (x509_cache_expired(e->cert->not_after)) {
+			x509_certificate_free(e->cert);
+			e->cert = NULL;
+			return NULL;
+		}
+		e->last_used = ++x509_cache_use;
+		wpa_printf(MSG_MSGDUMP, "X509: Use cached parsed certificate");
+		return x509_certificate_clone(e->cert);
+	}
+
+	return NULL;
+}
+
+
+static void x509_cert_cache_add(const struct x509_certificate *cert)
+{
+	struct x509_cert_cache_entry *e, *victim = NULL;
+	size_t i;
+
+	if (x509_cache_expired(cert->not_after))
+		return;
+
+	for (i = 0; i < X509_CACHE_CERTS; i++) {
+		e = &x509_cert_cache[i];
+		if (e->cert && x509_cache_expired(e->cert->not_after)) {
+			x509_certificate_free(e->cert);
+			e->cert = NULL;
+		}
+		if (e->cert == NULL) {
+			victim = e;
+			break;
+		}
+		if (victim == NULL || e->last_used < victim->last_used)
+			victim = e;
+	}
+
+	x509_certificate_free(victim->cert);
+	victim->cert = x509_certificate_clone(cert);
+	victim->last_used = ++x509_cache_use;
+}
+
+
+static void x509_sig_cache_hash(const struct x509_certificate *issuer,
+				const struct x509_certificate *cert, u8 *hash)
+{
+	const u8 *addr[2];
+	size_t len[2];
+
+	addr[0] = issuer->public_key;
+	len[0] = issuer->public_key_len;
+	addr[1] = cert->cert_start;
+	len[1] = cert->cert_len;
+	sha256_vector(2, addr, len, hash);
+}
+
+
+static int x509_sig_cache_get(const u8 *hash)
+{
+	struct x509_sig_cache_entry *e;
+	size_t i;
+
+	for (i = 0; i < X509_CACHE_SIGNATURES; i++) {
+		e = &x509_sig_cache[i];
+		if (e->last_used == 0 ||
+		    os_memcmp(e->hash, hash, SHA256_MAC_LEN) != 0)
+			continue;
+		if (x509_cache_expired(e->not_after)) {
+			e->last_used = 0;
+			return 0;
+		}
+		e->last_used = ++x509_cache_use;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+static void x509_sig_cache_add(const u8 *hash, os_time_t not_after)
+{
+	struct x509_sig_cache_entry *e, *victim = NULL;
+	size_t i;
+
+	for (i = 0; i < X509_CACHE_SIGNATURES; i++) {
+		e = &x509_sig_cache[i];
+		if (e->last_used == 0 || x509_cache_expired(e->not_after)) {
+			victim = e;
+			break;
+		}
+		if (victim == NULL || e->last_used < victim->last_used)
+			victim = e;
+	}
+
+	os_memcpy(victim->hash, hash, SHA256_MAC_LEN);
+	victim->not_after = not_after;
+	victim->last_used = ++x509_cache_use;
+}
+
+
+/**
+ * x509_certificate_cache_flush - Flush cached certificates and signatures
+ */
+void x509_certificate_cache_flush(void)
+{
+	size_t i;
+
+	for (i = 0; i < X509_CACHE_CERTS; i++) {
+		x509_certificate_free(x509_cert_cache[i].cert);
+		x509_cert_cache[i].cert = NULL;
+	}
+	os_memset(x509_sig_cache, 0, sizeof(x509_sig_cache));
+	x509_cache_use = 0;
+}
+
+
 static int x509_whitespace(char c)
 {
 	return c == ' ' || c == '\t';
@@ -1478,6 +1708,10 @@ struct x509_certificate * x509_certificate_parse(const u8 *buf, size_t len)
 	const u8 *pos, *end, *hash_start;
 	struct x509_certificate *cert;
 
+	cert = x509_cert_cache_get(buf, len);
+	if (cert)
+		return cert;
+
 	cert = os_zalloc(sizeof(*cert) + len);
 	if (cert == NULL)
 		return NULL;
@@ -1567,6 +1801,8 @@ struct x509_certificate * x509_certificate_parse(const u8 *buf, size_t len)
 	wpa_hexdump(MSG_MSGDUMP, "X509: signature",
 		    cert->sign_value, cert->sign_value_len);
 
+	x509_cert_cache_add(cert);
+
 	return cert;
 }
 
@@ -1589,6 +1825,14 @@ int x509_certificate_check_signature(struct x509_certificate *issuer,
 	struct asn1_oid oid;
 	u8 hash[32];
 	size_t hash_len;
+	u8 cache_hash[SHA256_MAC_LEN];
+
+	x509_sig_cache_hash(issuer, cert, cache_hash);
+	if (x509_sig_cache_get(cache_hash)) {
+		wpa_printf(MSG_DEBUG, "X509: Certificate signature was "
+			   "already verified");
+		return 0;
+	}
 
 	if (!x509_pkcs_oid(&cert->signature.oid) ||
 	    cert->signature.oid.len != 7 ||
@@ -1787,6 +2031,11 @@ skip_digest_oid:
 	wpa_printf(MSG_DEBUG, "X509: Certificate Digest matches with "
 		   "calculated tbsCertificate hash");
 
+	x509_sig_cache_add(cache_hash,
+			   (unsigned long) issuer->not_after <
+			   (unsigned long) cert->not_after ?
+			   issuer->not_after : cert->not_after);
+
 	return 0;
 }
 
@@ -119,5 +119,6 @@ struct x509_certificate *
 x509_certificate_get_subject(struct x509_certificate *chain,
 			     struct x509_name *name);
 int x509_certificate_self_signed(struct x509_certificate *cert);
+void x509_certificate_cache_flush(void);
 
 #endif /* X509V3_H */
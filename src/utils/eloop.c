@@ -11,6 +11,7 @@
 #include "common.h"
 #include "trace.h"
 #include "list.h"
+#include "mempool.h"
 #include "eloop.h"
 
 #ifdef CONFIG_ELOOP_POLL
@@ -31,7 +32,7 @@ struct eloop_sock {
 
 struct eloop_timeout {
 	struct dl_list list;
-	struct os_time time;
+	struct os_reltime time;
 	void *eloop_data;
 	void *user_data;
 	eloop_timeout_handler handler;
@@ -40,6 +41,9 @@ struct eloop_timeout {
 	WPA_TRACE_INFO
 };
 
+static struct mempool eloop_timeout_pool =
+	MEMPOOL_INIT("eloop_timeout", sizeof(struct eloop_timeout));
+
 struct eloop_signal {
 	int sig;
 	void *user_data;
@@ -47,6 +51,12 @@ struct eloop_signal {
 	int signaled;
 };
 
+struct eloop_iteration_end {
+	eloop_iteration_end_handler handler;
+	void *eloop_data;
+	void *user_data;
+};
+
 struct eloop_sock_table {
 	int count;
 	struct eloop_sock *table;
@@ -68,6 +78,11 @@ struct eloop_data {
 	struct eloop_sock_table exceptions;
 
 	struct dl_list timeout;
+	struct os_reltime now; /* time at the start of event processing */
+	int now_valid;
+
+	int iteration_end_count;
+	struct eloop_iteration_end *iteration_end;
 
 	int signal_count;
 	struct eloop_signal *signals;
@@ -481,11 +496,18 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	struct eloop_timeout *timeout, *tmp;
 	os_time_t now_sec;
 
-	timeout = os_zalloc(sizeof(*timeout));
+	timeout = mempool_zalloc(&eloop_timeout_pool);
 	if (timeout == NULL)
 		return -1;
-	if (os_get_time(&timeout->time) < 0) {
-		os_free(timeout);
+	/*
+	 * Timeouts registered from an event handler are relative to the time
+	 * the event loop woke up for the event; this avoids reading the clock
+	 * for each registration.
+	 */
+	if (eloop.now_valid)
+		timeout->time = eloop.now;
+	else if (os_get_reltime(&timeout->time) < 0) {
+		mempool_free(&eloop_timeout_pool, timeout);
 		return -1;
 	}
 	now_sec = timeout->time.sec;
@@ -497,7 +519,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 		 */
 		wpa_printf(MSG_DEBUG, "ELOOP: Too long timeout (secs=%u) to "
 			   "ever happen - ignore it", secs);
-		os_free(timeout);
+		mempool_free(&eloop_timeout_pool, timeout);
 		return 0;
 	}
 	timeout->time.usec += usecs;
@@ -514,7 +536,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 
 	/* Maintain timeouts in order of increasing time */
 	dl_list_for_each(tmp, &eloop.timeout, struct eloop_timeout, list) {
-		if (os_time_before(&timeout->time, &tmp->time)) {
+		if (os_reltime_before(&timeout->time, &tmp->time)) {
 			dl_list_add(tmp->list.prev, &timeout->list);
 			return 0;
 		}
@@ -530,7 +552,7 @@ static void eloop_remove_timeout(struct eloop_timeout *timeout)
 	dl_list_del(&timeout->list);
 	wpa_trace_remove_ref(timeout, eloop, timeout->eloop_data);
 	wpa_trace_remove_ref(timeout, user, timeout->user_data);
-	os_free(timeout);
+	mempool_free(&eloop_timeout_pool, timeout);
 }
 
 
@@ -571,6 +593,77 @@ int eloop_is_timeout_registered(eloop_timeout_handler handler,
 	return 0;
 }
 
+int eloop_register_iteration_end(eloop_iteration_end_handler handler,
+				 void *eloop_data, void *user_data)
+{
+	struct eloop_iteration_end *tmp;
+	int i;
+
+	for (i = 0; i < eloop.iteration_end_count; i++) {
+		tmp = &eloop.iteration_end[i];
+		if (tmp->handler == handler &&
+		    tmp->eloop_data == eloop_data &&
+		    tmp->user_data == user_data)
+			return 0;
+	}
+
+	tmp = os_realloc_array(eloop.iteration_end,
+			       eloop.iteration_end_count + 1,
+			       sizeof(struct eloop_iteration_end));
+	if (tmp == NULL)
+		return -1;
+
+	tmp[eloop.iteration_end_count].handler = handler;
+	tmp[eloop.iteration_end_count].eloop_data = eloop_data;
+	tmp[eloop.iteration_end_count].user_data = user_data;
+	eloop.iteration_end_count++;
+	eloop.iteration_end = tmp;
+
+	return 0;
+}
+
+
+int eloop_cancel_iteration_end(eloop_iteration_end_handler handler,
+			       void *eloop_data, void *user_data)
+{
+	struct eloop_iteration_end *tmp;
+	int i, removed = 0;
+
+	for (i = 0; i < eloop.iteration_end_count; i++) {
+		tmp = &eloop.iteration_end[i];
+		if (tmp->handler == handler &&
+		    (tmp->eloop_data == eloop_data ||
+		     eloop_data == ELOOP_ALL_CTX) &&
+		    (tmp->user_data == user_data ||
+		     user_data == ELOOP_ALL_CTX)) {
+			eloop.iteration_end_count--;
+			os_memmove(tmp, tmp + 1,
+				   (eloop.iteration_end_count - i) *
+				   sizeof(*tmp));
+			i--;
+			removed++;
+		}
+	}
+
+	return removed;
+}
+
+
+static void eloop_process_iteration_end(void)
+{
+	struct eloop_iteration_end call;
+
+	/* Handlers may register new calls; these are processed as well */
+	while (eloop.iteration_end_count > 0) {
+		call = eloop.iteration_end[0];
+		eloop.iteration_end_count--;
+		os_memmove(eloop.iteration_end, eloop.iteration_end + 1,
+			   eloop.iteration_end_count * sizeof(call));
+		call.handler(call.eloop_data, call.user_data);
+	}
+}
+
+
 
 #ifndef CONFIG_NATIVE_WINDOWS
 static void eloop_handle_alarm(int sig)
@@ -687,7 +780,7 @@ void eloop_run(void)
 	struct timeval _tv;
 #endif /* CONFIG_ELOOP_POLL */
 	int res;
-	struct os_time tv, now;
+	struct os_reltime tv;
 
 #ifndef CONFIG_ELOOP_POLL
 	rfds = os_malloc(sizeof(*rfds));
@@ -701,12 +794,15 @@ void eloop_run(void)
 	       (!dl_list_empty(&eloop.timeout) || eloop.readers.count > 0 ||
 		eloop.writers.count > 0 || eloop.exceptions.count > 0)) {
 		struct eloop_timeout *timeout;
+
+		eloop_process_iteration_end();
+
 		timeout = dl_list_first(&eloop.timeout, struct eloop_timeout,
 					list);
 		if (timeout) {
-			os_get_time(&now);
-			if (os_time_before(&now, &timeout->time))
-				os_time_sub(&timeout->time, &now, &tv);
+			os_get_reltime(&eloop.now);
+			if (os_reltime_before(&eloop.now, &timeout->time))
+				os_reltime_sub(&timeout->time, &eloop.now, &tv);
 			else
 				tv.sec = tv.usec = 0;
 #ifdef CONFIG_ELOOP_POLL
@@ -740,14 +836,20 @@ void eloop_run(void)
 			goto out;
 		}
 #endif /* CONFIG_ELOOP_POLL */
+		/*
+		 * Read the clock once for all handlers called in this
+		 * iteration; they can get it with eloop_get_reltime().
+		 */
+		os_get_reltime(&eloop.now);
+		eloop.now_valid = 1;
+
 		eloop_process_pending_signals();
 
 		/* check if some registered timeouts have occurred */
 		timeout = dl_list_first(&eloop.timeout, struct eloop_timeout,
 					list);
 		if (timeout) {
-			os_get_time(&now);
-			if (!os_time_before(&now, &timeout->time)) {
+			if (!os_reltime_before(&eloop.now, &timeout->time)) {
 				void *eloop_data = timeout->eloop_data;
 				void *user_data = timeout->user_data;
 				eloop_timeout_handler handler =
@@ -773,6 +875,7 @@ void eloop_run(void)
 	}
 
 out:
+	eloop.now_valid = 0;
 #ifndef CONFIG_ELOOP_POLL
 	os_free(rfds);
 	os_free(wfds);
@@ -782,6 +885,15 @@ out:
 }
 
 
+void eloop_get_reltime(struct os_reltime *now)
+{
+	if (eloop.now_valid)
+		*now = eloop.now;
+	else
+		os_get_reltime(now);
+}
+
+
 void eloop_terminate(void)
 {
 	eloop.terminate = 1;
@@ -791,9 +903,9 @@ void eloop_terminate(void)
 void eloop_destroy(void)
 {
 	struct eloop_timeout *timeout, *prev;
-	struct os_time now;
+	struct os_reltime now;
 
-	os_get_time(&now);
+	os_get_reltime(&now);
 	dl_list_for_each_safe(timeout, prev, &eloop.timeout,
 			      struct eloop_timeout, list) {
 		int sec, usec;
@@ -816,6 +928,7 @@ void eloop_destroy(void)
 	eloop_sock_table_destroy(&eloop.writers);
 	eloop_sock_table_destroy(&eloop.exceptions);
 	os_free(eloop.signals);
+	os_free(eloop.iteration_end);
 
 #ifdef CONFIG_ELOOP_POLL
 	os_free(eloop.pollfds);
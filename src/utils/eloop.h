@@ -65,6 +65,13 @@ typedef void (*eloop_timeout_handler)(void *eloop_data, void *user_ctx);
  */
 typedef void (*eloop_signal_handler)(int sig, void *signal_ctx);
 
+/**
+ * eloop_iteration_end_handler - eloop end-of-iteration callback type
+ * @eloop_ctx: Registered callback context data (eloop_data)
+ * @user_ctx: Registered callback context data (user_data)
+ */
+typedef void (*eloop_iteration_end_handler)(void *eloop_data, void *user_ctx);
+
 /**
  * eloop_init() - Initialize global event loop data
  * Returns: 0 on success, -1 on failure
@@ -174,7 +181,8 @@ void eloop_unregister_event(void *event, size_t event_size);
  * Returns: 0 on success, -1 on failure
  *
  * Register a timeout that will cause the handler function to be called after
- * given time.
+ * given time. When called from an event handler, the time is counted from
+ * eloop_get_reltime(), i.e., from when the event loop woke up for the event.
  */
 int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 			   eloop_timeout_handler handler,
@@ -207,6 +215,37 @@ int eloop_cancel_timeout(eloop_timeout_handler handler,
 int eloop_is_timeout_registered(eloop_timeout_handler handler,
 				void *eloop_data, void *user_data);
 
+/**
+ * eloop_register_iteration_end - Register a call for the end of the iteration
+ * @handler: Callback function to be called
+ * @eloop_data: Callback context data (eloop_ctx)
+ * @user_data: Callback context data (user_ctx)
+ * Returns: 0 on success, -1 on failure
+ *
+ * Request the handler to be called once after the event loop has processed the
+ * events of the current iteration and before it waits for new events. This can
+ * be used to batch work, e.g., to send frames that were queued by several
+ * event handlers with a single system call. The call is not repeated unless
+ * the handler is registered again. Registering the same
+ * <handler,eloop_data,user_data> again before the call has been made has no
+ * effect.
+ */
+int eloop_register_iteration_end(eloop_iteration_end_handler handler,
+				 void *eloop_data, void *user_data);
+
+/**
+ * eloop_cancel_iteration_end - Cancel end-of-iteration calls
+ * @handler: Matching callback function
+ * @eloop_data: Matching eloop_data or %ELOOP_ALL_CTX to match all
+ * @user_data: Matching user_data or %ELOOP_ALL_CTX to match all
+ * Returns: Number of cancelled calls
+ *
+ * Cancel matching <handler,eloop_data,user_data> calls registered with
+ * eloop_register_iteration_end().
+ */
+int eloop_cancel_iteration_end(eloop_iteration_end_handler handler,
+			       void *eloop_data, void *user_data);
+
 /**
  * eloop_register_signal - Register handler for signals
  * @sig: Signal number (e.g., SIGHUP)
@@ -272,6 +311,16 @@ int eloop_register_signal_reconfig(eloop_signal_handler handler,
  */
 void eloop_run(void);
 
+/**
+ * eloop_get_reltime - Get the relative time of the current event
+ * @now: Buffer for returning the time
+ *
+ * When called from an event handler, this returns the os_get_reltime() value
+ * that was read when the event loop woke up for the event without reading the
+ * clock again. Outside the event loop, the current time is returned.
+ */
+void eloop_get_reltime(struct os_reltime *now);
+
 /**
  * eloop_terminate - Terminate event loop
  *
@@ -20,7 +20,7 @@ struct eloop_sock {
 };
 
 struct eloop_timeout {
-	struct os_time time;
+	struct os_reltime time;
 	void *eloop_data;
 	void *user_data;
 	void (*handler)(void *eloop_ctx, void *sock_ctx);
@@ -34,12 +34,21 @@ struct eloop_signal {
 	int signaled;
 };
 
+struct eloop_iteration_end {
+	eloop_iteration_end_handler handler;
+	void *eloop_data;
+	void *user_data;
+};
+
 struct eloop_data {
 	int max_sock, reader_count;
 	struct eloop_sock *readers;
 
 	struct eloop_timeout *timeout;
 
+	int iteration_end_count;
+	struct eloop_iteration_end *iteration_end;
+
 	int signal_count;
 	struct eloop_signal *signals;
 	int signaled;
@@ -118,7 +127,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	timeout = (struct eloop_timeout *) malloc(sizeof(*timeout));
 	if (timeout == NULL)
 		return -1;
-	os_get_time(&timeout->time);
+	os_get_reltime(&timeout->time);
 	timeout->time.sec += secs;
 	timeout->time.usec += usecs;
 	while (timeout->time.usec >= 1000000) {
@@ -138,7 +147,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	prev = NULL;
 	tmp = eloop.timeout;
 	while (tmp != NULL) {
-		if (os_time_before(&timeout->time, &tmp->time))
+		if (os_reltime_before(&timeout->time, &tmp->time))
 			break;
 		prev = tmp;
 		tmp = tmp->next;
@@ -207,6 +216,78 @@ int eloop_is_timeout_registered(void (*handler)(void *eloop_ctx,
 	return 0;
 }
 
+int eloop_register_iteration_end(eloop_iteration_end_handler handler,
+				 void *eloop_data, void *user_data)
+{
+	struct eloop_iteration_end *tmp;
+	int i;
+
+	for (i = 0; i < eloop.iteration_end_count; i++) {
+		tmp = &eloop.iteration_end[i];
+		if (tmp->handler == handler &&
+		    tmp->eloop_data == eloop_data &&
+		    tmp->user_data == user_data)
+			return 0;
+	}
+
+	tmp = (struct eloop_iteration_end *)
+		realloc(eloop.iteration_end,
+			(eloop.iteration_end_count + 1) *
+			sizeof(struct eloop_iteration_end));
+	if (tmp == NULL)
+		return -1;
+
+	tmp[eloop.iteration_end_count].handler = handler;
+	tmp[eloop.iteration_end_count].eloop_data = eloop_data;
+	tmp[eloop.iteration_end_count].user_data = user_data;
+	eloop.iteration_end_count++;
+	eloop.iteration_end = tmp;
+
+	return 0;
+}
+
+
+int eloop_cancel_iteration_end(eloop_iteration_end_handler handler,
+			       void *eloop_data, void *user_data)
+{
+	struct eloop_iteration_end *tmp;
+	int i, removed = 0;
+
+	for (i = 0; i < eloop.iteration_end_count; i++) {
+		tmp = &eloop.iteration_end[i];
+		if (tmp->handler == handler &&
+		    (tmp->eloop_data == eloop_data ||
+		     eloop_data == ELOOP_ALL_CTX) &&
+		    (tmp->user_data == user_data ||
+		     user_data == ELOOP_ALL_CTX)) {
+			eloop.iteration_end_count--;
+			os_memmove(tmp, tmp + 1,
+				   (eloop.iteration_end_count - i) *
+				   sizeof(*tmp));
+			i--;
+			removed++;
+		}
+	}
+
+	return removed;
+}
+
+
+static void eloop_process_iteration_end(void)
+{
+	struct eloop_iteration_end call;
+
+	/* Handlers may register new calls; these are processed as well */
+	while (eloop.iteration_end_count > 0) {
+		call = eloop.iteration_end[0];
+		eloop.iteration_end_count--;
+		os_memmove(eloop.iteration_end, eloop.iteration_end + 1,
+			   eloop.iteration_end_count * sizeof(call));
+		call.handler(call.eloop_data, call.user_data);
+	}
+}
+
+
 
 /* TODO: replace with suitable signal handler */
 #if 0
@@ -305,14 +386,16 @@ int eloop_register_signal_reconfig(void (*handler)(int sig, void *eloop_ctx,
 void eloop_run(void)
 {
 	int i;
-	struct os_time tv, now;
+	struct os_reltime tv, now;
 
 	while (!eloop.terminate &&
 		(eloop.timeout || eloop.reader_count > 0)) {
+		eloop_process_iteration_end();
+
 		if (eloop.timeout) {
-			os_get_time(&now);
-			if (os_time_before(&now, &eloop.timeout->time))
-				os_time_sub(&eloop.timeout->time, &now, &tv);
+			os_get_reltime(&now);
+			if (os_reltime_before(&now, &eloop.timeout->time))
+				os_reltime_sub(&eloop.timeout->time, &now, &tv);
 			else
 				tv.sec = tv.usec = 0;
 		}
@@ -329,8 +412,8 @@ void eloop_run(void)
 		if (eloop.timeout) {
 			struct eloop_timeout *tmp;
 
-			os_get_time(&now);
-			if (!os_time_before(&now, &eloop.timeout->time)) {
+			os_get_reltime(&now);
+			if (!os_reltime_before(&now, &eloop.timeout->time)) {
 				tmp = eloop.timeout;
 				eloop.timeout = eloop.timeout->next;
 				tmp->handler(tmp->eloop_data,
@@ -359,6 +442,12 @@ void eloop_run(void)
 }
 
 
+void eloop_get_reltime(struct os_reltime *now)
+{
+	os_get_reltime(now);
+}
+
+
 void eloop_terminate(void)
 {
 	eloop.terminate = 1;
@@ -377,6 +466,7 @@ void eloop_destroy(void)
 	}
 	free(eloop.readers);
 	free(eloop.signals);
+	free(eloop.iteration_end);
 }
 
 
@@ -29,7 +29,7 @@ struct eloop_event {
 };
 
 struct eloop_timeout {
-	struct os_time time;
+	struct os_reltime time;
 	void *eloop_data;
 	void *user_data;
 	eloop_timeout_handler handler;
@@ -43,6 +43,12 @@ struct eloop_signal {
 	int signaled;
 };
 
+struct eloop_iteration_end {
+	eloop_iteration_end_handler handler;
+	void *eloop_data;
+	void *user_data;
+};
+
 struct eloop_data {
 	int max_sock;
 	size_t reader_count;
@@ -53,6 +59,9 @@ struct eloop_data {
 
 	struct eloop_timeout *timeout;
 
+	int iteration_end_count;
+	struct eloop_iteration_end *iteration_end;
+
 	int signal_count;
 	struct eloop_signal *signals;
 	int signaled;
@@ -242,7 +251,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	timeout = os_malloc(sizeof(*timeout));
 	if (timeout == NULL)
 		return -1;
-	os_get_time(&timeout->time);
+	os_get_reltime(&timeout->time);
 	now_sec = timeout->time.sec;
 	timeout->time.sec += secs;
 	if (timeout->time.sec < now_sec) {
@@ -273,7 +282,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	prev = NULL;
 	tmp = eloop.timeout;
 	while (tmp != NULL) {
-		if (os_time_before(&timeout->time, &tmp->time))
+		if (os_reltime_before(&timeout->time, &tmp->time))
 			break;
 		prev = tmp;
 		tmp = tmp->next;
@@ -341,6 +350,77 @@ int eloop_is_timeout_registered(eloop_timeout_handler handler,
 	return 0;
 }
 
+int eloop_register_iteration_end(eloop_iteration_end_handler handler,
+				 void *eloop_data, void *user_data)
+{
+	struct eloop_iteration_end *tmp;
+	int i;
+
+	for (i = 0; i < eloop.iteration_end_count; i++) {
+		tmp = &eloop.iteration_end[i];
+		if (tmp->handler == handler &&
+		    tmp->eloop_data == eloop_data &&
+		    tmp->user_data == user_data)
+			return 0;
+	}
+
+	tmp = os_realloc_array(eloop.iteration_end,
+			       eloop.iteration_end_count + 1,
+			       sizeof(struct eloop_iteration_end));
+	if (tmp == NULL)
+		return -1;
+
+	tmp[eloop.iteration_end_count].handler = handler;
+	tmp[eloop.iteration_end_count].eloop_data = eloop_data;
+	tmp[eloop.iteration_end_count].user_data = user_data;
+	eloop.iteration_end_count++;
+	eloop.iteration_end = tmp;
+
+	return 0;
+}
+
+
+int eloop_cancel_iteration_end(eloop_iteration_end_handler handler,
+			       void *eloop_data, void *user_data)
+{
+	struct eloop_iteration_end *tmp;
+	int i, removed = 0;
+
+	for (i = 0; i < eloop.iteration_end_count; i++) {
+		tmp = &eloop.iteration_end[i];
+		if (tmp->handler == handler &&
+		    (tmp->eloop_data == eloop_data ||
+		     eloop_data == ELOOP_ALL_CTX) &&
+		    (tmp->user_data == user_data ||
+		     user_data == ELOOP_ALL_CTX)) {
+			eloop.iteration_end_count--;
+			os_memmove(tmp, tmp + 1,
+				   (eloop.iteration_end_count - i) *
+				   sizeof(*tmp));
+			i--;
+			removed++;
+		}
+	}
+
+	return removed;
+}
+
+
+static void eloop_process_iteration_end(void)
+{
+	struct eloop_iteration_end call;
+
+	/* Handlers may register new calls; these are processed as well */
+	while (eloop.iteration_end_count > 0) {
+		call = eloop.iteration_end[0];
+		eloop.iteration_end_count--;
+		os_memmove(eloop.iteration_end, eloop.iteration_end + 1,
+			   eloop.iteration_end_count * sizeof(call));
+		call.handler(call.eloop_data, call.user_data);
+	}
+}
+
+
 
 /* TODO: replace with suitable signal handler */
 #if 0
@@ -456,18 +536,20 @@ int eloop_register_signal_reconfig(eloop_signal_handler handler,
 
 void eloop_run(void)
 {
-	struct os_time tv, now;
+	struct os_reltime tv, now;
 	DWORD count, ret, timeout, err;
 	size_t i;
 
 	while (!eloop.terminate &&
 	       (eloop.timeout || eloop.reader_count > 0 ||
 		eloop.event_count > 0)) {
+		eloop_process_iteration_end();
+
 		tv.sec = tv.usec = 0;
 		if (eloop.timeout) {
-			os_get_time(&now);
-			if (os_time_before(&now, &eloop.timeout->time))
-				os_time_sub(&eloop.timeout->time, &now, &tv);
+			os_get_reltime(&now);
+			if (os_reltime_before(&now, &eloop.timeout->time))
+				os_reltime_sub(&eloop.timeout->time, &now, &tv);
 		}
 
 		count = 0;
@@ -506,8 +588,8 @@ void eloop_run(void)
 		if (eloop.timeout) {
 			struct eloop_timeout *tmp;
 
-			os_get_time(&now);
-			if (!os_time_before(&now, &eloop.timeout->time)) {
+			os_get_reltime(&now);
+			if (!os_reltime_before(&now, &eloop.timeout->time)) {
 				tmp = eloop.timeout;
 				eloop.timeout = eloop.timeout->next;
 				tmp->handler(tmp->eloop_data,
@@ -560,6 +642,12 @@ void eloop_run(void)
 }
 
 
+void eloop_get_reltime(struct os_reltime *now)
+{
+	os_get_reltime(now);
+}
+
+
 void eloop_terminate(void)
 {
 	eloop.terminate = 1;
@@ -579,6 +667,7 @@ void eloop_destroy(void)
 	}
 	os_free(eloop.readers);
 	os_free(eloop.signals);
+	os_free(eloop.iteration_end);
 	if (eloop.term_event)
 		CloseHandle(eloop.term_event);
 	os_free(eloop.handles);
@@ -0,0 +1,321 @@
+/*
+ * Memory pools for frequently allocated objects
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Fixed size objects (stations, timeouts, RADIUS messages) are allocated
+ * from slabs that each hold a number of objects. A slab is released once
+ * all of its objects have been freed, except for one empty slab per pool that
+ * is kept so that a pool hovering around a slab boundary does not allocate
+ * and free a slab for each object. In addition, a single message arena is
+ * used for short-lived buffers that are allocated and freed while
+ * processing a single received or transmitted frame.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "wpabuf.h"
+#include "mempool.h"
+
+#ifdef CONFIG_MEMPOOL
+
+#define MEMPOOL_SLAB_SIZE 4096
+#define MEMPOOL_SLAB_MIN_OBJS 4
+#define MSG_ARENA_SIZE 4096
+
+/* Object header; also guarantees alignment of the object that follows */
+union mempool_hdr {
+	struct mempool_slab *slab;
+	u64 align_u64;
+	double align_double;
+	void *align_ptr;
+};
+
+struct mempool_slab {
+	struct dl_list list;
+	union mempool_hdr *free; /* first free object; linked via the object */
+	unsigned int used;
+	unsigned int num;
+	/* followed by num * (header + object) */
+};
+
+static struct mempool *pools;
+
+static union {
+	u8 buf[MSG_ARENA_SIZE];
+	union mempool_hdr align;
+} msg_arena;
+
+static struct msg_arena_stats {
+	size_t used; /* bytes allocated from the arena */
+	size_t last; /* offset of the latest allocation */
+	unsigned int live; /* allocations not yet freed */
+	size_t peak;
+	unsigned long allocs;
+	unsigned long fallbacks; /* allocations that did not fit */
+} arena;
+
+
+static size_t mempool_stride(const struct mempool *pool)
+{
+	size_t align = sizeof(union mempool_hdr);
+	size_t size = pool->size;
+
+	/* Free objects store the free list pointer in the object itself */
+	if (size < sizeof(union mempool_hdr *))
+		size = sizeof(union mempool_hdr *);
+	return sizeof(union mempool_hdr) + (size + align - 1) / align * align;
+}
+
+
+static union mempool_hdr ** mempool_next_free(union mempool_hdr *hdr)
+{
+	return (union mempool_hdr **) (hdr + 1);
+}
+
+
+static struct mempool_slab * mempool_slab_alloc(struct mempool *pool)
+{
+	struct mempool_slab *slab;
+	size_t stride = mempool_stride(pool);
+	unsigned int num, i;
+	u8 *pos;
+
+	num = (MEMPOOL_SLAB_SIZE - sizeof(*slab)) / stride;
+	if (num < MEMPOOL_SLAB_MIN_OBJS)
+		num = MEMPOOL_SLAB_MIN_OBJS;
+
+	slab = os_malloc(sizeof(*slab) + num * stride);
+	if (slab == NULL)
+		return NULL;
+	slab->used = 0;
+	slab->num = num;
+	slab->free = NULL;
+
+	/* Link objects into the free list in address order */
+	pos = (u8 *) (slab + 1) + (num - 1) * stride;
+	for (i = 0; i < num; i++) {
+		union mempool_hdr *hdr = (union mempool_hdr *) pos;
+		hdr->slab = slab;
+		*mempool_next_free(hdr) = slab->free;
+		slab->free = hdr;
+		pos -= stride;
+	}
+
+	pool->slabs++;
+	return slab;
+}
+
+
+static void mempool_register(struct mempool *pool)
+{
+	dl_list_init(&pool->slab_list);
+	pool->next = pools;
+	pools = pool;
+	pool->registered = 1;
+}
+
+
+/**
+ * mempool_zalloc - Allocate a zeroed object from a pool
+ * @pool: Pool defined with MEMPOOL_INIT()
+ * Returns: Pointer to the object or %NULL on failure
+ */
+void * mempool_zalloc(struct mempool *pool)
+{
+	struct mempool_slab *slab;
+	union mempool_hdr *hdr;
+
+	if (!pool->registered)
+		mempool_register(pool);
+
+	slab = dl_list_first(&pool->slab_list, struct mempool_slab, list);
+	if (slab == NULL || slab->free == NULL) {
+		if (pool->spare) {
+			slab = pool->spare;
+			pool->spare = NULL;
+		} else {
+			slab = mempool_slab_alloc(pool);
+			if (slab == NULL)
+				return NULL;
+		}
+		dl_list_add(&pool->slab_list, &slab->list);
+	}
+
+	hdr = slab->free;
+	slab->free = *mempool_next_free(hdr);
+	slab->used++;
+	if (slab->free == NULL) {
+		/* Keep slabs with free objects in the beginning of the list */
+		dl_list_del(&slab->list);
+		dl_list_add_tail(&pool->slab_list, &slab->list);
+	}
+
+	pool->allocs++;
+	pool->in_use++;
+	if (pool->in_use > pool->max_in_use)
+		pool->max_in_use = pool->in_use;
+
+	hdr->slab = slab;
+	os_memset(hdr + 1, 0, pool->size);
+	return hdr + 1;
+}
+
+
+/**
+ * mempool_free - Free an object allocated with mempool_zalloc()
+ * @pool: Pool from which the object was allocated
+ * @ptr: Object to free or %NULL
+ */
+void mempool_free(struct mempool *pool, void *ptr)
+{
+	union mempool_hdr *hdr;
+	struct mempool_slab *slab;
+	int was_full;
+
+	if (ptr == NULL)
+		return;
+
+	hdr = ((union mempool_hdr *) ptr) - 1;
+	slab = hdr->slab;
+	was_full = slab->free == NULL;
+
+	*mempool_next_free(hdr) = slab->free;
+	slab->free = hdr;
+	slab->used--;
+	pool->in_use--;
+
+	if (slab->used == 0) {
+		dl_list_del(&slab->list);
+		if (pool->spare == NULL) {
+			pool->spare = slab;
+		} else {
+			os_free(slab);
+			pool->slabs--;
+		}
+	} else if (was_full) {
+		dl_list_del(&slab->list);
+		dl_list_add(&pool->slab_list, &slab->list);
+	}
+}
+
+
+/**
+ * msg_arena_zalloc - Allocate a zeroed buffer for processing a message
+ * @len: Length of the buffer
+ * Returns: Pointer to the buffer or %NULL on failure
+ *
+ * The buffer must be freed with msg_arena_free() before returning to the
+ * event loop. The arena becomes empty again once all buffers have been freed,
+ * so no heap allocations are needed for messages that fit into it.
+ */
+void * msg_arena_zalloc(size_t len)
+{
+	size_t align = sizeof(union mempool_hdr);
+	size_t start = (arena.used + align - 1) / align * align;
+	u8 *ptr;
+
+	if (len > MSG_ARENA_SIZE || start > MSG_ARENA_SIZE - len) {
+		arena.fallbacks++;
+		return os_zalloc(len);
+	}
+
+	ptr = msg_arena.buf + start;
+	arena.last = start;
+	arena.used = start + len;
+	arena.live++;
+	arena.allocs++;
+	if (arena.used > arena.peak)
+		arena.peak = arena.used;
+	os_memset(ptr, 0, len);
+	return ptr;
+}
+
+
+/**
+ * msg_arena_free - Free a buffer allocated with msg_arena_zalloc()
+ * @ptr: Buffer to free or %NULL
+ */
+void msg_arena_free(void *ptr)
+{
+	u8 *pos = ptr;
+
+	if (pos < msg_arena.buf || pos >= msg_arena.buf + MSG_ARENA_SIZE) {
+		os_free(ptr);
+		return;
+	}
+
+	arena.live--;
+	if (arena.live == 0)
+		arena.used = 0;
+	else if (pos == msg_arena.buf + arena.last)
+		arena.used = arena.last;
+}
+
+
+/**
+ * mempool_stats - Get pool statistics in text format
+ * @buf: Buffer for the statistics
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written into buf
+ */
+int mempool_stats(char *buf, size_t buflen)
+{
+	struct mempool *pool;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	for (pool = pools; pool; pool = pool->next) {
+		ret = os_snprintf(pos, end - pos,
+				  "pool=%s size=%lu in_use=%u max_in_use=%u "
+				  "slabs=%u allocs=%lu\n",
+				  pool->name, (unsigned long) pool->size,
+				  pool->in_use, pool->max_in_use, pool->slabs,
+				  pool->allocs);
+		if (ret < 0 || ret >= end - pos)
+			return pos - buf;
+		pos += ret;
+	}
+
+	ret = os_snprintf(pos, end - pos,
+			  "arena size=%u peak=%lu allocs=%lu fallbacks=%lu\n",
+			  MSG_ARENA_SIZE, (unsigned long) arena.peak,
+			  arena.allocs, arena.fallbacks);
+	if (ret < 0 || ret >= end - pos)
+		return pos - buf;
+	pos += ret;
+
+	return pos - buf;
+}
+
+#endif /* CONFIG_MEMPOOL */
+
+
+/**
+ * mempool_memstats - Get memory statistics in text format
+ * @buf: Buffer for the statistics
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written into buf
+ *
+ * This is used for the MEMSTATS control interface command. wpabuf counters
+ * are included regardless of CONFIG_MEMPOOL.
+ */
+int mempool_memstats(char *buf, size_t buflen)
+{
+	struct wpabuf_stats stats;
+	int ret;
+
+	wpabuf_get_stats(&stats);
+	ret = os_snprintf(buf, buflen,
+			  "wpabuf allocs=%lu copies=%lu copy_bytes=%lu "
+			  "slices=%lu refs=%lu\n",
+			  stats.allocs, stats.copies, stats.copy_bytes,
+			  stats.slices, stats.refs);
+	if (ret < 0 || (size_t) ret >= buflen)
+		return 0;
+
+	return ret + mempool_stats(buf + ret, buflen - ret);
+}
@@ -0,0 +1,80 @@
+/*
+ * Memory pools for frequently allocated objects
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include "list.h"
+
+struct mempool_slab;
+
+/**
+ * struct mempool - Pool of fixed size objects
+ *
+ * Pools are defined statically with MEMPOOL_INIT() next to the code that
+ * allocates the objects. With CONFIG_MEMPOOL, objects are carved out of
+ * larger slabs to reduce heap fragmentation on long-running devices.
+ * Without it, mempool_zalloc() and mempool_free() are thin wrappers for
+ * os_zalloc() and os_free().
+ */
+struct mempool {
+	const char *name;
+	size_t size; /* object size */
+	unsigned int in_use;
+	unsigned int max_in_use;
+	unsigned int slabs;
+	unsigned long allocs;
+	struct dl_list slab_list; /* slabs with free objects first */
+	struct mempool_slab *spare; /* empty slab kept for reuse */
+	struct mempool *next; /* registered pools */
+	int registered;
+};
+
+#define MEMPOOL_INIT(_name, _size) { (_name), (_size), 0, 0, 0, 0, \
+			{ NULL, NULL }, NULL, NULL, 0 }
+
+int mempool_memstats(char *buf, size_t buflen);
+
+#ifdef CONFIG_MEMPOOL
+
+void * mempool_zalloc(struct mempool *pool);
+void mempool_free(struct mempool *pool, void *ptr);
+void * msg_arena_zalloc(size_t len);
+void msg_arena_free(void *ptr);
+int mempool_stats(char *buf, size_t buflen);
+
+#else /* CONFIG_MEMPOOL */
+
+static inline void * mempool_zalloc(struct mempool *pool)
+{
+	return os_zalloc(pool->size);
+}
+
+static inline void mempool_free(struct mempool *pool, void *ptr)
+{
+	os_free(ptr);
+}
+
+static inline void * msg_arena_zalloc(size_t len)
+{
+	return os_zalloc(len);
+}
+
+static inline void msg_arena_free(void *ptr)
+{
+	os_free(ptr);
+}
+
+static inline int mempool_stats(char *buf, size_t buflen)
+{
+	return 0;
+}
+
+#endif /* CONFIG_MEMPOOL */
+
+#endif /* MEMPOOL_H */
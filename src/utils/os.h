@@ -23,6 +23,11 @@ struct os_time {
 	os_time_t usec;
 };
 
+struct os_reltime {
+	os_time_t sec;
+	os_time_t usec;
+};
+
 /**
  * os_get_time - Get current time (sec, usec)
  * @t: Pointer to buffer for the time
@@ -30,6 +35,18 @@ struct os_time {
  */
 int os_get_time(struct os_time *t);
 
+/**
+ * os_get_reltime - Get relative time (sec, usec)
+ * @t: Pointer to buffer for the time
+ * Returns: 0 on success, -1 on failure
+ *
+ * The returned time is taken from a monotonic clock where available and is
+ * not affected by changes to the system wall clock. It can only be used for
+ * measuring time differences, e.g., for timeouts and expiration, not as a
+ * calendar time.
+ */
+int os_get_reltime(struct os_reltime *t);
+
 
 /* Helper macros for handling struct os_time */
 
@@ -46,6 +63,52 @@ int os_get_time(struct os_time *t);
 	} \
 } while (0)
 
+/* Helper functions for handling struct os_reltime */
+
+static inline int os_reltime_before(const struct os_reltime *a,
+				    const struct os_reltime *b)
+{
+	return (a->sec < b->sec) ||
+		(a->sec == b->sec && a->usec < b->usec);
+}
+
+static inline void os_reltime_sub(const struct os_reltime *a,
+				  const struct os_reltime *b,
+				  struct os_reltime *res)
+{
+	res->sec = a->sec - b->sec;
+	res->usec = a->usec - b->usec;
+	if (res->usec < 0) {
+		res->sec--;
+		res->usec += 1000000;
+	}
+}
+
+static inline void os_reltime_age(const struct os_reltime *start,
+				  struct os_reltime *age)
+{
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, age);
+}
+
+static inline int os_reltime_expired(const struct os_reltime *now,
+				     const struct os_reltime *ts,
+				     os_time_t timeout_secs)
+{
+	struct os_reltime age;
+
+	os_reltime_sub(now, ts, &age);
+	return (age.sec > timeout_secs) ||
+		(age.sec == timeout_secs && age.usec > 0);
+}
+
+static inline int os_reltime_initialized(const struct os_reltime *t)
+{
+	return t->sec != 0 || t->usec != 0;
+}
+
 /**
  * os_mktime - Convert broken-down time into seconds since 1970-01-01
  * @year: Four digit year
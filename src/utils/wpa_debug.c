@@ -24,6 +24,7 @@ static int wpa_debug_syslog = 0;
 #include <stdio.h>
 
 static FILE *wpa_debug_tracing_file = NULL;
+int wpa_debug_tracing_active = 0;
 
 #define WPAS_TRACE_PFX "wpas <%d>: "
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
@@ -33,6 +34,108 @@ int wpa_debug_level = MSG_INFO;
 int wpa_debug_show_keys = 0;
 int wpa_debug_timestamp = 0;
 
+/* Per-module debug level override (-1 = use wpa_debug_level) */
+int wpa_debug_module_level[WPA_DEBUG_MODULE_COUNT] = {
+	-1, -1, -1, -1, -1
+};
+
+static const char *wpa_debug_module_names[WPA_DEBUG_MODULE_COUNT] = {
+	"default", "driver", "eapol", "radius", "wlantest"
+};
+
+
+const char * debug_level_str(int level)
+{
+	switch (level) {
+	case MSG_EXCESSIVE:
+		return "EXCESSIVE";
+	case MSG_MSGDUMP:
+		return "MSGDUMP";
+	case MSG_DEBUG:
+		return "DEBUG";
+	case MSG_INFO:
+		return "INFO";
+	case MSG_WARNING:
+		return "WARNING";
+	case MSG_ERROR:
+		return "ERROR";
+	default:
+		return "?";
+	}
+}
+
+
+int str_to_debug_level(const char *s)
+{
+	if (os_strcasecmp(s, "EXCESSIVE") == 0)
+		return MSG_EXCESSIVE;
+	if (os_strcasecmp(s, "MSGDUMP") == 0)
+		return MSG_MSGDUMP;
+	if (os_strcasecmp(s, "DEBUG") == 0)
+		return MSG_DEBUG;
+	if (os_strcasecmp(s, "INFO") == 0)
+		return MSG_INFO;
+	if (os_strcasecmp(s, "WARNING") == 0)
+		return MSG_WARNING;
+	if (os_strcasecmp(s, "ERROR") == 0)
+		return MSG_ERROR;
+	return -1;
+}
+
+
+/**
+ * wpa_debug_set_module_level - Set debug level for a single module
+ * @cmd: "<module>=<level>"; level "DEFAULT" removes the override
+ * Returns: 0 on success, -1 on failure
+ */
+int wpa_debug_set_module_level(const char *cmd)
+{
+	const char *pos;
+	size_t len;
+	int i, level;
+
+	pos = os_strchr(cmd, '=');
+	if (pos == NULL)
+		return -1;
+	len = pos - cmd;
+	pos++;
+
+	if (os_strcasecmp(pos, "DEFAULT") == 0)
+		level = -1;
+	else if ((level = str_to_debug_level(pos)) < 0)
+		return -1;
+
+	for (i = 0; i < WPA_DEBUG_MODULE_COUNT; i++) {
+		if (os_strlen(wpa_debug_module_names[i]) == len &&
+		    os_strncmp(wpa_debug_module_names[i], cmd, len) == 0) {
+			wpa_debug_module_level[i] = level;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+
+int wpa_debug_module_levels(char *buf, size_t buflen)
+{
+	char *pos = buf, *end = buf + buflen;
+	int i, ret;
+
+	for (i = 0; i < WPA_DEBUG_MODULE_COUNT; i++) {
+		if (wpa_debug_module_level[i] < 0)
+			continue;
+		ret = os_snprintf(pos, end - pos, "Module %s: %s\n",
+				  wpa_debug_module_names[i],
+				  debug_level_str(wpa_debug_module_level[i]));
+		if (ret < 0 || ret >= end - pos)
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
 
 #ifdef CONFIG_ANDROID_LOG
 
@@ -62,6 +165,305 @@ static FILE *out_file = NULL;
 #endif /* CONFIG_DEBUG_FILE */
 
 
+#ifdef CONFIG_DEBUG_RINGBUF
+
+/*
+ * In-memory debug log. Formatted debug messages are appended to a ring buffer
+ * instead of being written to stdout/debug file for each message. The buffer
+ * contents can be written to the debug file periodically with
+ * wpa_debug_flush_ringbuf() and the latest entries can be fetched on demand
+ * with wpa_debug_ringbuf_get(), e.g., for a control interface reply. Larger
+ * parts of the buffer can be fetched in pieces with wpa_debug_ringbuf_read().
+ */
+static struct {
+	char *buf;
+	size_t size;
+	u64 head; /* total number of octets written */
+	u64 flushed; /* total number of octets flushed to out_file */
+	u64 dropped; /* octets overwritten before being flushed */
+} ringbuf;
+
+
+static void ringbuf_put(const char *txt, size_t len)
+{
+	size_t pos, first;
+
+	if (len > ringbuf.size) {
+		txt += len - ringbuf.size;
+		ringbuf.head += len - ringbuf.size;
+		len = ringbuf.size;
+	}
+
+	pos = ringbuf.head % ringbuf.size;
+	first = ringbuf.size - pos;
+	if (first > len)
+		first = len;
+	os_memcpy(ringbuf.buf + pos, txt, first);
+	os_memcpy(ringbuf.buf, txt + first, len - first);
+	ringbuf.head += len;
+
+#ifdef CONFIG_DEBUG_FILE
+	if (out_file && ringbuf.head - ringbuf.flushed > ringbuf.size) {
+		ringbuf.dropped += ringbuf.head - ringbuf.size -
+			ringbuf.flushed;
+		ringbuf.flushed = ringbuf.head - ringbuf.size;
+	}
+#endif /* CONFIG_DEBUG_FILE */
+}
+
+
+#ifdef CONFIG_DEBUG_FILE
+static void ringbuf_write(FILE *f, u64 start, u64 end)
+{
+	size_t pos, len, first;
+
+	pos = start % ringbuf.size;
+	len = end - start;
+	first = ringbuf.size - pos;
+	if (first > len)
+		first = len;
+	fwrite(ringbuf.buf + pos, 1, first, f);
+	if (len > first)
+		fwrite(ringbuf.buf, 1, len - first, f);
+}
+#endif /* CONFIG_DEBUG_FILE */
+
+
+static int ringbuf_timestamp(char *buf, size_t len)
+{
+	struct os_time tv;
+	int res;
+
+	if (!wpa_debug_timestamp)
+		return 0;
+	os_get_time(&tv);
+	res = os_snprintf(buf, len, "%ld.%06u: ", (long) tv.sec,
+			  (unsigned int) tv.usec);
+	if (res < 0 || (size_t) res >= len)
+		return 0;
+	return res;
+}
+
+
+static void ringbuf_vprintf(const char *fmt, va_list ap)
+{
+	char buf[2048];
+	int len, res;
+
+	len = ringbuf_timestamp(buf, sizeof(buf));
+	res = vsnprintf(buf + len, sizeof(buf) - len - 1, fmt, ap);
+	if (res < 0)
+		return;
+	len += res;
+	if (len > (int) sizeof(buf) - 2)
+		len = sizeof(buf) - 2;
+	buf[len++] = '\n';
+	ringbuf_put(buf, len);
+}
+
+
+static void ringbuf_hexdump(const char *title, const u8 *buf, size_t len,
+			    int show, const char *type)
+{
+	char txt[3 * 128 + 1];
+	int tlen, res;
+	size_t i, chunk;
+
+	tlen = ringbuf_timestamp(txt, sizeof(txt));
+	res = os_snprintf(txt + tlen, sizeof(txt) - tlen, "%s - %s(len=%lu):",
+			  title, type, (unsigned long) len);
+	if (res < 0 || res >= (int) sizeof(txt) - tlen)
+		res = sizeof(txt) - tlen - 1;
+	ringbuf_put(txt, tlen + res);
+
+	if (buf == NULL) {
+		ringbuf_put(" [NULL]\n", 8);
+		return;
+	}
+	if (!show) {
+		ringbuf_put(" [REMOVED]\n", 11);
+		return;
+	}
+
+	while (len) {
+		chunk = len > 128 ? 128 : len;
+		for (i = 0; i < chunk; i++) {
+			txt[3 * i] = ' ';
+			txt[3 * i + 1] = "0123456789abcdef"[buf[i] >> 4];
+			txt[3 * i + 2] = "0123456789abcdef"[buf[i] & 0x0f];
+		}
+		ringbuf_put(txt, 3 * chunk);
+		buf += chunk;
+		len -= chunk;
+	}
+	ringbuf_put("\n", 1);
+}
+
+
+/**
+ * wpa_debug_open_ringbuf - Start collecting debug messages into memory
+ * @size: Size of the ring buffer in octets
+ * Returns: 0 on success, -1 on failure
+ *
+ * While the ring buffer is in use, debug messages are not written to stdout
+ * or the debug file directly. If a debug file has been opened, the buffered
+ * messages are written into it with wpa_debug_flush_ringbuf().
+ */
+int wpa_debug_open_ringbuf(size_t size)
+{
+	char *buf;
+
+	if (size == 0)
+		return -1;
+	buf = os_malloc(size);
+	if (buf == NULL)
+		return -1;
+	wpa_debug_close_ringbuf();
+	os_memset(&ringbuf, 0, sizeof(ringbuf));
+	ringbuf.buf = buf;
+	ringbuf.size = size;
+	return 0;
+}
+
+
+void wpa_debug_close_ringbuf(void)
+{
+	if (ringbuf.buf == NULL)
+		return;
+	wpa_debug_flush_ringbuf();
+	os_free(ringbuf.buf);
+	ringbuf.buf = NULL;
+}
+
+
+/**
+ * wpa_debug_flush_ringbuf - Write pending ring buffer entries to debug file
+ *
+ * This is expected to be called periodically (e.g., from an eloop timeout)
+ * to move the debug file I/O out of the code paths generating the messages.
+ */
+void wpa_debug_flush_ringbuf(void)
+{
+#ifdef CONFIG_DEBUG_FILE
+	if (ringbuf.buf == NULL || out_file == NULL ||
+	    ringbuf.flushed == ringbuf.head)
+		return;
+	ringbuf_write(out_file, ringbuf.flushed, ringbuf.head);
+	fflush(out_file);
+	ringbuf.flushed = ringbuf.head;
+#endif /* CONFIG_DEBUG_FILE */
+}
+
+
+/**
+ * wpa_debug_ringbuf_get - Get the latest ring buffer entries
+ * @buf: Buffer for the entries
+ * @buflen: Length of buf
+ * @max_len: Maximum number of octets to return or 0 for as much as fits
+ * Returns: Number of octets written into buf or -1 on failure
+ *
+ * Only complete lines are returned; the buffer is not nul terminated.
+ */
+int wpa_debug_ringbuf_get(char *buf, size_t buflen, size_t max_len)
+{
+	u64 start;
+	size_t pos, len, first;
+
+	if (ringbuf.buf == NULL)
+		return -1;
+
+	len = ringbuf.head < ringbuf.size ? ringbuf.head : ringbuf.size;
+	if (max_len && max_len < len)
+		len = max_len;
+	if (buflen < len)
+		len = buflen;
+	start = ringbuf.head - len;
+	if (start > 0) {
+		/* Skip the partial line in the beginning */
+		while (start < ringbuf.head &&
+		       ringbuf.buf[start % ringbuf.size] != '\n')
+			start++;
+		if (start < ringbuf.head)
+			start++;
+	}
+
+	pos = start % ringbuf.size;
+	len = ringbuf.head - start;
+	first = ringbuf.size - pos;
+	if (first > len)
+		first = len;
+	os_memcpy(buf, ringbuf.buf + pos, first);
+	os_memcpy(buf + first, ringbuf.buf, len - first);
+	return len;
+}
+
+
+/**
+ * wpa_debug_ringbuf_read - Read a chunk of the ring buffer
+ * @offset: Stream offset (total octets written before the chunk) to read from
+ * @max_len: Maximum number of octets to return
+ * @buf: Buffer for the chunk
+ * @buflen: Length of buf
+ * Returns: Number of octets written into buf or -1 on failure
+ *
+ * The chunk is prefixed with a line containing the offset of the first
+ * returned octet. This is later than the requested offset if that part of the
+ * log has already been overwritten. An empty chunk indicates that the end of
+ * the buffer has been reached. The buffer is not nul terminated.
+ */
+int wpa_debug_ringbuf_read(u64 offset, size_t max_len, char *buf,
+			   size_t buflen)
+{
+	u64 oldest;
+	size_t pos, len, first;
+	int res;
+
+	if (ringbuf.buf == NULL || offset > ringbuf.head)
+		return -1;
+
+	oldest = ringbuf.head > ringbuf.size ? ringbuf.head - ringbuf.size : 0;
+	if (offset < oldest)
+		offset = oldest;
+	res = os_snprintf(buf, buflen, "%llu\n", (unsigned long long) offset);
+	if (res < 0 || (size_t) res >= buflen)
+		return -1;
+
+	len = ringbuf.head - offset;
+	if (len > max_len)
+		len = max_len;
+	if (len > buflen - res)
+		len = buflen - res;
+	pos = offset % ringbuf.size;
+	first = ringbuf.size - pos;
+	if (first > len)
+		first = len;
+	os_memcpy(buf + res, ringbuf.buf + pos, first);
+	os_memcpy(buf + res + first, ringbuf.buf, len - first);
+	return res + len;
+}
+
+
+int wpa_debug_ringbuf_status(char *buf, size_t buflen)
+{
+	int res;
+
+	if (ringbuf.buf == NULL)
+		return 0;
+	res = os_snprintf(buf, buflen,
+			  "size=%lu\nwritten=%llu\nflushed=%llu\n"
+			  "dropped=%llu\n",
+			  (unsigned long) ringbuf.size,
+			  (unsigned long long) ringbuf.head,
+			  (unsigned long long) ringbuf.flushed,
+			  (unsigned long long) ringbuf.dropped);
+	if (res < 0 || (size_t) res >= buflen)
+		return 0;
+	return res;
+}
+
+#endif /* CONFIG_DEBUG_RINGBUF */
+
+
 void wpa_debug_print_timestamp(void)
 {
 #ifndef CONFIG_ANDROID_LOG
@@ -174,6 +576,7 @@ int wpa_debug_open_linux_tracing(void)
 		printf("failed to fdopen()\n");
 		return -1;
 	}
+	wpa_debug_tracing_active = 1;
 
 	return 0;
 }
@@ -185,28 +588,23 @@ void wpa_debug_close_linux_tracing(void)
 		return;
 	fclose(wpa_debug_tracing_file);
 	wpa_debug_tracing_file = NULL;
+	wpa_debug_tracing_active = 0;
 }
 
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
 
-/**
- * wpa_printf - conditional printf
- * @level: priority level (MSG_*) of the message
- * @fmt: printf format string, followed by optional arguments
- *
- * This function is used to print conditional debugging and error messages. The
- * output may be directed to stdout, stderr, and/or syslog based on
- * configuration.
- *
- * Note: New line '\n' is added to the end of the text when printing to stdout.
- */
-void wpa_printf(int level, const char *fmt, ...)
+void wpa_debug_printf(int module, int level, const char *fmt, ...)
 {
 	va_list ap;
 
 	va_start(ap, fmt);
-	if (level >= wpa_debug_level) {
+#ifdef CONFIG_DEBUG_RINGBUF
+	if (ringbuf.buf && wpa_debug_module_enabled(module, level)) {
+		ringbuf_vprintf(fmt, ap);
+	} else
+#endif /* CONFIG_DEBUG_RINGBUF */
+	if (wpa_debug_module_enabled(module, level)) {
 #ifdef CONFIG_ANDROID_LOG
 		__android_log_vprint(wpa_to_android_level(level),
 				     ANDROID_LOG_NAME, fmt, ap);
@@ -248,8 +646,8 @@ void wpa_printf(int level, const char *fmt, ...)
 }
 
 
-static void _wpa_hexdump(int level, const char *title, const u8 *buf,
-			 size_t len, int show)
+void wpa_debug_hexdump(int module, int level, const char *title,
+		       const u8 *buf, size_t len, int show)
 {
 	size_t i;
 
@@ -271,8 +669,14 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 	}
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
-	if (level < wpa_debug_level)
+	if (!wpa_debug_module_enabled(module, level))
+		return;
+#ifdef CONFIG_DEBUG_RINGBUF
+	if (ringbuf.buf) {
+		ringbuf_hexdump(title, buf, len, show, "hexdump");
 		return;
+	}
+#endif /* CONFIG_DEBUG_RINGBUF */
 #ifdef CONFIG_ANDROID_LOG
 	{
 		const char *display;
@@ -375,20 +779,8 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 #endif /* CONFIG_ANDROID_LOG */
 }
 
-void wpa_hexdump(int level, const char *title, const u8 *buf, size_t len)
-{
-	_wpa_hexdump(level, title, buf, len, 1);
-}
-
-
-void wpa_hexdump_key(int level, const char *title, const u8 *buf, size_t len)
-{
-	_wpa_hexdump(level, title, buf, len, wpa_debug_show_keys);
-}
-
-
-static void _wpa_hexdump_ascii(int level, const char *title, const u8 *buf,
-			       size_t len, int show)
+void wpa_debug_hexdump_ascii(int module, int level, const char *title,
+			     const u8 *buf, size_t len, int show)
 {
 	size_t i, llen;
 	const u8 *pos = buf;
@@ -413,10 +805,16 @@ static void _wpa_hexdump_ascii(int level, const char *title, const u8 *buf,
 	}
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
-	if (level < wpa_debug_level)
+	if (!wpa_debug_module_enabled(module, level))
+		return;
+#ifdef CONFIG_DEBUG_RINGBUF
+	if (ringbuf.buf) {
+		ringbuf_hexdump(title, buf, len, show, "hexdump_ascii");
 		return;
+	}
+#endif /* CONFIG_DEBUG_RINGBUF */
 #ifdef CONFIG_ANDROID_LOG
-	_wpa_hexdump(level, title, buf, len, show);
+	wpa_debug_hexdump(module, level, title, buf, len, show);
 #else /* CONFIG_ANDROID_LOG */
 	wpa_debug_print_timestamp();
 #ifdef CONFIG_DEBUG_FILE
@@ -495,19 +893,6 @@ static void _wpa_hexdump_ascii(int level, const char *title, const u8 *buf,
 }
 
 
-void wpa_hexdump_ascii(int level, const char *title, const u8 *buf, size_t len)
-{
-	_wpa_hexdump_ascii(level, title, buf, len, 1);
-}
-
-
-void wpa_hexdump_ascii_key(int level, const char *title, const u8 *buf,
-			   size_t len)
-{
-	_wpa_hexdump_ascii(level, title, buf, len, wpa_debug_show_keys);
-}
-
-
 #ifdef CONFIG_DEBUG_FILE
 static char *last_path = NULL;
 #endif /* CONFIG_DEBUG_FILE */
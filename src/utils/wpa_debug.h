@@ -18,6 +18,37 @@ enum {
 	MSG_EXCESSIVE, MSG_MSGDUMP, MSG_DEBUG, MSG_INFO, MSG_WARNING, MSG_ERROR
 };
 
+/*
+ * Modules for which the debug level can be changed separately from the global
+ * wpa_debug_level. A source file selects its module by defining
+ * WPA_DEBUG_MODULE before including any header files.
+ */
+enum {
+	WPA_DEBUG_MODULE_DEFAULT,
+	WPA_DEBUG_MODULE_DRIVER,
+	WPA_DEBUG_MODULE_EAPOL,
+	WPA_DEBUG_MODULE_RADIUS,
+	WPA_DEBUG_MODULE_WLANTEST,
+	WPA_DEBUG_MODULE_COUNT
+};
+
+#ifndef WPA_DEBUG_MODULE
+#define WPA_DEBUG_MODULE WPA_DEBUG_MODULE_DEFAULT
+#endif /* WPA_DEBUG_MODULE */
+
+/*
+ * Messages with lower priority than CONFIG_MSG_MIN_PRIORITY are removed from
+ * the build (0 = MSG_EXCESSIVE, ..., 5 = MSG_ERROR).
+ */
+#ifndef CONFIG_MSG_MIN_PRIORITY
+#define CONFIG_MSG_MIN_PRIORITY 0
+#endif /* CONFIG_MSG_MIN_PRIORITY */
+
+const char * debug_level_str(int level);
+int str_to_debug_level(const char *s);
+int wpa_debug_set_module_level(const char *cmd);
+int wpa_debug_module_levels(char *buf, size_t buflen);
+
 #ifdef CONFIG_NO_STDOUT_DEBUG
 
 #define wpa_debug_print_timestamp() do { } while (0)
@@ -39,6 +70,40 @@ static inline int wpa_debug_reopen_file(void)
 
 #else /* CONFIG_NO_STDOUT_DEBUG */
 
+extern int wpa_debug_level;
+extern int wpa_debug_show_keys;
+extern int wpa_debug_module_level[WPA_DEBUG_MODULE_COUNT];
+
+#ifdef CONFIG_DEBUG_LINUX_TRACING
+/* Linux tracing receives messages regardless of the debug level */
+extern int wpa_debug_tracing_active;
+#else /* CONFIG_DEBUG_LINUX_TRACING */
+#define wpa_debug_tracing_active 0
+#endif /* CONFIG_DEBUG_LINUX_TRACING */
+
+static inline int wpa_debug_module_enabled(int module, int level)
+{
+	int min = wpa_debug_module_level[module];
+	return level >= (min >= 0 ? min : wpa_debug_level);
+}
+
+/*
+ * Check whether a message with the given priority level would be shown. This
+ * is done before the call to the actual print function to avoid the function
+ * call and argument processing for messages that are not shown.
+ */
+#define wpa_debug_enabled(level) \
+	((level) >= CONFIG_MSG_MIN_PRIORITY && \
+	 (wpa_debug_tracing_active || \
+	  wpa_debug_module_enabled(WPA_DEBUG_MODULE, (level))))
+
+void wpa_debug_printf(int module, int level, const char *fmt, ...)
+PRINTF_FORMAT(3, 4);
+void wpa_debug_hexdump(int module, int level, const char *title,
+		       const u8 *buf, size_t len, int show);
+void wpa_debug_hexdump_ascii(int module, int level, const char *title,
+			     const u8 *buf, size_t len, int show);
+
 int wpa_debug_open_file(const char *path);
 int wpa_debug_reopen_file(void);
 void wpa_debug_close_file(void);
@@ -63,8 +128,12 @@ void wpa_debug_print_timestamp(void);
  *
  * Note: New line '\n' is added to the end of the text when printing to stdout.
  */
-void wpa_printf(int level, const char *fmt, ...)
-PRINTF_FORMAT(2, 3);
+#define wpa_printf(level, ...)						\
+	do {								\
+		if (wpa_debug_enabled(level))				\
+			wpa_debug_printf(WPA_DEBUG_MODULE, (level),	\
+					 __VA_ARGS__);			\
+	} while (0)
 
 /**
  * wpa_hexdump - conditional hex dump
@@ -77,7 +146,12 @@ PRINTF_FORMAT(2, 3);
  * output may be directed to stdout, stderr, and/or syslog based on
  * configuration. The contents of buf is printed out has hex dump.
  */
-void wpa_hexdump(int level, const char *title, const u8 *buf, size_t len);
+#define wpa_hexdump(level, title, buf, len)				\
+	do {								\
+		if (wpa_debug_enabled(level))				\
+			wpa_debug_hexdump(WPA_DEBUG_MODULE, (level),	\
+					  (title), (buf), (len), 1);	\
+	} while (0)
 
 static inline void wpa_hexdump_buf(int level, const char *title,
 				   const struct wpabuf *buf)
@@ -99,7 +173,13 @@ static inline void wpa_hexdump_buf(int level, const char *title,
  * like wpa_hexdump(), but by default, does not include secret keys (passwords,
  * etc.) in debug output.
  */
-void wpa_hexdump_key(int level, const char *title, const u8 *buf, size_t len);
+#define wpa_hexdump_key(level, title, buf, len)				\
+	do {								\
+		if (wpa_debug_enabled(level))				\
+			wpa_debug_hexdump(WPA_DEBUG_MODULE, (level),	\
+					  (title), (buf), (len),	\
+					  wpa_debug_show_keys);		\
+	} while (0)
 
 static inline void wpa_hexdump_buf_key(int level, const char *title,
 				       const struct wpabuf *buf)
@@ -121,8 +201,12 @@ static inline void wpa_hexdump_buf_key(int level, const char *title,
  * the hex numbers and ASCII characters (for printable range) are shown. 16
  * bytes per line will be shown.
  */
-void wpa_hexdump_ascii(int level, const char *title, const u8 *buf,
-		       size_t len);
+#define wpa_hexdump_ascii(level, title, buf, len)			\
+	do {								\
+		if (wpa_debug_enabled(level))				\
+			wpa_debug_hexdump_ascii(WPA_DEBUG_MODULE, (level), \
+						(title), (buf), (len), 1); \
+	} while (0)
 
 /**
  * wpa_hexdump_ascii_key - conditional hex dump, hide keys
@@ -138,8 +222,13 @@ void wpa_hexdump_ascii(int level, const char *title, const u8 *buf,
  * bytes per line will be shown. This works like wpa_hexdump_ascii(), but by
  * default, does not include secret keys (passwords, etc.) in debug output.
  */
-void wpa_hexdump_ascii_key(int level, const char *title, const u8 *buf,
-			   size_t len);
+#define wpa_hexdump_ascii_key(level, title, buf, len)			\
+	do {								\
+		if (wpa_debug_enabled(level))				\
+			wpa_debug_hexdump_ascii(WPA_DEBUG_MODULE, (level), \
+						(title), (buf), (len),	\
+						wpa_debug_show_keys);	\
+	} while (0)
 
 /*
  * wpa_dbg() behaves like wpa_msg(), but it can be removed from build to reduce
@@ -255,6 +344,50 @@ static inline void wpa_debug_close_syslog(void)
 
 #endif /* CONFIG_DEBUG_SYSLOG */
 
+#if defined(CONFIG_DEBUG_RINGBUF) && !defined(CONFIG_NO_STDOUT_DEBUG)
+
+int wpa_debug_open_ringbuf(size_t size);
+void wpa_debug_close_ringbuf(void);
+void wpa_debug_flush_ringbuf(void);
+int wpa_debug_ringbuf_get(char *buf, size_t buflen, size_t max_len);
+int wpa_debug_ringbuf_read(u64 offset, size_t max_len, char *buf,
+			   size_t buflen);
+int wpa_debug_ringbuf_status(char *buf, size_t buflen);
+
+#else /* CONFIG_DEBUG_RINGBUF && !CONFIG_NO_STDOUT_DEBUG */
+
+static inline int wpa_debug_open_ringbuf(size_t size)
+{
+	return -1;
+}
+
+static inline void wpa_debug_close_ringbuf(void)
+{
+}
+
+static inline void wpa_debug_flush_ringbuf(void)
+{
+}
+
+static inline int wpa_debug_ringbuf_get(char *buf, size_t buflen,
+					size_t max_len)
+{
+	return -1;
+}
+
+static inline int wpa_debug_ringbuf_read(u64 offset, size_t max_len,
+					 char *buf, size_t buflen)
+{
+	return -1;
+}
+
+static inline int wpa_debug_ringbuf_status(char *buf, size_t buflen)
+{
+	return 0;
+}
+
+#endif /* CONFIG_DEBUG_RINGBUF && !CONFIG_NO_STDOUT_DEBUG */
+
 #ifdef CONFIG_DEBUG_LINUX_TRACING
 
 int wpa_debug_open_linux_tracing(void);
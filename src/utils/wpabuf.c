@@ -26,6 +26,8 @@ static struct wpabuf_trace * wpabuf_get_trace(const struct wpabuf *buf)
 }
 #endif /* WPA_TRACE */
 
+static struct wpabuf_stats wpabuf_stats;
+
 
 static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 {
@@ -68,7 +70,23 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 
 	if (buf->used + add_len > buf->size) {
 		unsigned char *nbuf;
-		if (buf->flags & WPABUF_FLAG_EXT_DATA) {
+		if (buf->refcnt) {
+			/* Reallocation would invalidate slices of this buffer */
+			wpa_printf(MSG_ERROR, "wpabuf: Cannot resize shared "
+				   "buffer %p", buf);
+			return -1;
+		}
+		if (buf->flags & WPABUF_FLAG_SLICE) {
+			nbuf = os_malloc(buf->used + add_len);
+			if (nbuf == NULL)
+				return -1;
+			os_memcpy(nbuf, buf->buf, buf->used);
+			os_memset(nbuf + buf->used, 0, add_len);
+			wpabuf_free(buf->parent);
+			buf->parent = NULL;
+			buf->buf = nbuf;
+			buf->flags = WPABUF_FLAG_EXT_DATA;
+		} else if (buf->flags & WPABUF_FLAG_EXT_DATA) {
 			nbuf = os_realloc(buf->buf, buf->used + add_len);
 			if (nbuf == NULL)
 				return -1;
@@ -126,6 +144,7 @@ struct wpabuf * wpabuf_alloc(size_t len)
 		return NULL;
 #endif /* WPA_TRACE */
 
+	wpabuf_stats.allocs++;
 	buf->size = len;
 	buf->buf = (u8 *) (buf + 1);
 	return buf;
@@ -157,11 +176,20 @@ struct wpabuf * wpabuf_alloc_ext_data(u8 *data, size_t len)
 }
 
 
+static void wpabuf_count_copy(size_t len)
+{
+	wpabuf_stats.copies++;
+	wpabuf_stats.copy_bytes += len;
+}
+
+
 struct wpabuf * wpabuf_alloc_copy(const void *data, size_t len)
 {
 	struct wpabuf *buf = wpabuf_alloc(len);
-	if (buf)
+	if (buf) {
+		wpabuf_count_copy(len);
 		wpabuf_put_data(buf, data, len);
+	}
 	return buf;
 }
 
@@ -169,8 +197,10 @@ struct wpabuf * wpabuf_alloc_copy(const void *data, size_t len)
 struct wpabuf * wpabuf_dup(const struct wpabuf *src)
 {
 	struct wpabuf *buf = wpabuf_alloc(wpabuf_len(src));
-	if (buf)
+	if (buf) {
+		wpabuf_count_copy(wpabuf_len(src));
 		wpabuf_put_data(buf, wpabuf_head(src), wpabuf_len(src));
+	}
 	return buf;
 }
 
@@ -178,6 +208,10 @@ struct wpabuf * wpabuf_dup(const struct wpabuf *src)
 /**
  * wpabuf_free - Free a wpabuf
  * @buf: wpabuf buffer
+ *
+ * If other references to the buffer have been taken with wpabuf_ref() or
+ * wpabuf_slice(), only one reference is dropped and the buffer is freed once
+ * the last reference is gone.
  */
 void wpabuf_free(struct wpabuf *buf)
 {
@@ -192,19 +226,88 @@ void wpabuf_free(struct wpabuf *buf)
 		wpa_trace_show("wpabuf_free magic mismatch");
 		abort();
 	}
-	if (buf->flags & WPABUF_FLAG_EXT_DATA)
+	if (buf->refcnt) {
+		buf->refcnt--;
+		return;
+	}
+	if (buf->flags & WPABUF_FLAG_SLICE)
+		wpabuf_free(buf->parent);
+	else if (buf->flags & WPABUF_FLAG_EXT_DATA)
 		os_free(buf->buf);
 	os_free(trace);
 #else /* WPA_TRACE */
 	if (buf == NULL)
 		return;
-	if (buf->flags & WPABUF_FLAG_EXT_DATA)
+	if (buf->refcnt) {
+		buf->refcnt--;
+		return;
+	}
+	if (buf->flags & WPABUF_FLAG_SLICE)
+		wpabuf_free(buf->parent);
+	else if (buf->flags & WPABUF_FLAG_EXT_DATA)
 		os_free(buf->buf);
 	os_free(buf);
 #endif /* WPA_TRACE */
 }
 
 
+/**
+ * wpabuf_ref - Take a new reference to a wpabuf
+ * @buf: wpabuf buffer or %NULL
+ * Returns: buf
+ *
+ * Each reference is released with wpabuf_free(). The buffer contents are
+ * shared between all holders of a reference and the buffer cannot be
+ * resized beyond its allocated size while it is shared.
+ */
+struct wpabuf * wpabuf_ref(struct wpabuf *buf)
+{
+	if (buf) {
+		buf->refcnt++;
+		wpabuf_stats.refs++;
+	}
+	return buf;
+}
+
+
+/**
+ * wpabuf_slice - Get a part of a buffer without copying the data
+ * @buf: wpabuf buffer that has been allocated with wpabuf_alloc*()
+ * @offset: Offset of the slice from the head of buf
+ * @len: Length of the slice
+ * Returns: New wpabuf pointing to the data within buf or %NULL on failure
+ *
+ * The returned wpabuf holds a reference to buf, so buf can be freed by its
+ * owner before the slice is freed. The slice data must not be modified. If
+ * the slice is resized, its data is first copied into a buffer of its own.
+ */
+struct wpabuf * wpabuf_slice(struct wpabuf *buf, size_t offset, size_t len)
+{
+	struct wpabuf *slice;
+
+	if (buf == NULL || offset > wpabuf_len(buf) ||
+	    len > wpabuf_len(buf) - offset)
+		return NULL;
+
+	if (buf->flags & WPABUF_FLAG_SLICE) {
+		/* Refer to the owner of the data directly */
+		offset += buf->buf - buf->parent->buf;
+		buf = buf->parent;
+	}
+
+	slice = wpabuf_alloc(0);
+	if (slice == NULL)
+		return NULL;
+	wpabuf_stats.slices++;
+	slice->buf = buf->buf + offset;
+	slice->size = slice->used = len;
+	slice->flags = WPABUF_FLAG_SLICE;
+	slice->parent = wpabuf_ref(buf);
+
+	return slice;
+}
+
+
 void * wpabuf_put(struct wpabuf *buf, size_t len)
 {
 	void *tmp = wpabuf_mhead_u8(buf) + wpabuf_len(buf);
@@ -240,6 +343,7 @@ struct wpabuf * wpabuf_concat(struct wpabuf *a, struct wpabuf *b)
 
 	n = wpabuf_alloc(len);
 	if (n) {
+		wpabuf_count_copy(len);
 		if (a)
 			wpabuf_put_buf(n, a);
 		if (b)
@@ -279,6 +383,7 @@ struct wpabuf * wpabuf_zeropad(struct wpabuf *buf, size_t len)
 
 	ret = wpabuf_alloc(len);
 	if (ret) {
+		wpabuf_count_copy(blen);
 		os_memset(wpabuf_put(ret, len - blen), 0, len - blen);
 		wpabuf_put_buf(ret, buf);
 	}
@@ -301,3 +406,118 @@ void wpabuf_printf(struct wpabuf *buf, char *fmt, ...)
 		wpabuf_overflow(buf, res);
 	buf->used += res;
 }
+
+
+/**
+ * wpabuf_chain_init - Initialize an empty buffer chain
+ * @chain: Buffer chain
+ */
+void wpabuf_chain_init(struct wpabuf_chain *chain)
+{
+	os_memset(chain, 0, sizeof(*chain));
+}
+
+
+static int wpabuf_chain_check(struct wpabuf_chain *chain, struct wpabuf *buf)
+{
+	if (buf == NULL)
+		return -1;
+	if (chain->num == WPABUF_CHAIN_MAX) {
+		wpa_printf(MSG_ERROR, "wpabuf: Too many buffers in chain");
+		chain->failed = 1;
+		wpabuf_free(buf);
+		return -1;
+	}
+	chain->len += wpabuf_len(buf);
+	return 0;
+}
+
+
+/**
+ * wpabuf_chain_add - Add a buffer to the end of a chain
+ * @chain: Buffer chain
+ * @buf: Buffer to add or %NULL to add nothing; the chain takes ownership
+ */
+void wpabuf_chain_add(struct wpabuf_chain *chain, struct wpabuf *buf)
+{
+	if (wpabuf_chain_check(chain, buf) < 0)
+		return;
+	chain->buf[chain->num++] = buf;
+}
+
+
+/**
+ * wpabuf_chain_add_head - Add a buffer to the beginning of a chain
+ * @chain: Buffer chain
+ * @buf: Buffer to add or %NULL to add nothing; the chain takes ownership
+ */
+void wpabuf_chain_add_head(struct wpabuf_chain *chain, struct wpabuf *buf)
+{
+	if (wpabuf_chain_check(chain, buf) < 0)
+		return;
+	os_memmove(&chain->buf[1], &chain->buf[0],
+		   chain->num * sizeof(chain->buf[0]));
+	chain->buf[0] = buf;
+	chain->num++;
+}
+
+
+/**
+ * wpabuf_chain_flatten - Combine the buffers of a chain into one buffer
+ * @chain: Buffer chain; this will be empty after the call
+ * Returns: Buffer with the data from all buffers in the chain or %NULL if
+ * the chain was empty or on failure
+ *
+ * All data is copied at most once. If the chain has only a single buffer,
+ * that buffer is returned as-is.
+ */
+struct wpabuf * wpabuf_chain_flatten(struct wpabuf_chain *chain)
+{
+	struct wpabuf *buf;
+	size_t i;
+
+	if (chain->failed || chain->num == 0) {
+		wpabuf_chain_free(chain);
+		return NULL;
+	}
+
+	if (chain->num == 1) {
+		buf = chain->buf[0];
+		wpabuf_chain_init(chain);
+		return buf;
+	}
+
+	buf = wpabuf_alloc(chain->len);
+	if (buf) {
+		wpabuf_count_copy(chain->len);
+		for (i = 0; i < chain->num; i++)
+			wpabuf_put_buf(buf, chain->buf[i]);
+	}
+	wpabuf_chain_free(chain);
+
+	return buf;
+}
+
+
+/**
+ * wpabuf_chain_free - Free all buffers in a chain
+ * @chain: Buffer chain
+ */
+void wpabuf_chain_free(struct wpabuf_chain *chain)
+{
+	size_t i;
+
+	for (i = 0; i < chain->num; i++)
+		wpabuf_free(chain->buf[i]);
+	wpabuf_chain_init(chain);
+}
+
+
+/**
+ * wpabuf_get_stats - Get wpabuf allocation statistics
+ * @stats: Buffer for returning the counters
+ */
+void wpabuf_get_stats(struct wpabuf_stats *stats)
+{
+	os_memcpy(stats, &wpabuf_stats, sizeof(*stats));
+}
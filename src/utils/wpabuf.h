@@ -11,6 +11,8 @@
 
 /* wpabuf::buf is a pointer to external data */
 #define WPABUF_FLAG_EXT_DATA BIT(0)
+/* wpabuf::buf points to data owned by wpabuf::parent */
+#define WPABUF_FLAG_SLICE BIT(1)
 
 /*
  * Internal data structure for wpabuf. Please do not touch this directly from
@@ -22,9 +24,33 @@ struct wpabuf {
 	size_t used; /* length of data in the buffer */
 	u8 *buf; /* pointer to the head of the buffer */
 	unsigned int flags;
+	unsigned int refcnt; /* number of references in addition to owner */
+	struct wpabuf *parent; /* owner of the data for slices */
 	/* optionally followed by the allocated buffer */
 };
 
+/*
+ * Collection of buffers that are combined into a single buffer only once
+ * all parts are known. This avoids copying the already collected data again
+ * for each added part as would be done with wpabuf_concat().
+ */
+#define WPABUF_CHAIN_MAX 8
+
+struct wpabuf_chain {
+	struct wpabuf *buf[WPABUF_CHAIN_MAX];
+	size_t num;
+	size_t len;
+	int failed;
+};
+
+struct wpabuf_stats {
+	unsigned long allocs; /* buffers allocated */
+	unsigned long copies; /* buffers allocated to copy existing data */
+	unsigned long copy_bytes; /* bytes copied into those buffers */
+	unsigned long slices; /* slices created without copying data */
+	unsigned long refs; /* additional references taken */
+};
+
 
 int wpabuf_resize(struct wpabuf **buf, size_t add_len);
 struct wpabuf * wpabuf_alloc(size_t len);
@@ -36,6 +62,14 @@ void * wpabuf_put(struct wpabuf *buf, size_t len);
 struct wpabuf * wpabuf_concat(struct wpabuf *a, struct wpabuf *b);
 struct wpabuf * wpabuf_zeropad(struct wpabuf *buf, size_t len);
 void wpabuf_printf(struct wpabuf *buf, char *fmt, ...) PRINTF_FORMAT(2, 3);
+struct wpabuf * wpabuf_ref(struct wpabuf *buf);
+struct wpabuf * wpabuf_slice(struct wpabuf *buf, size_t offset, size_t len);
+void wpabuf_chain_init(struct wpabuf_chain *chain);
+void wpabuf_chain_add(struct wpabuf_chain *chain, struct wpabuf *buf);
+void wpabuf_chain_add_head(struct wpabuf_chain *chain, struct wpabuf *buf);
+struct wpabuf * wpabuf_chain_flatten(struct wpabuf_chain *chain);
+void wpabuf_chain_free(struct wpabuf_chain *chain);
+void wpabuf_get_stats(struct wpabuf_stats *stats);
 
 
 /**
@@ -152,6 +186,8 @@ static inline void wpabuf_set(struct wpabuf *buf, const void *data, size_t len)
 	buf->buf = (u8 *) data;
 	buf->flags = WPABUF_FLAG_EXT_DATA;
 	buf->size = buf->used = len;
+	buf->refcnt = 0;
+	buf->parent = NULL;
 }
 
 static inline void wpabuf_put_str(struct wpabuf *dst, const char *str)
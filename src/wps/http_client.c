@@ -190,6 +190,63 @@ struct http_client * http_client_addr(struct sockaddr_in *dst,
 }
 
 
+/**
+ * http_client_reuse - Send a new request over an existing connection
+ * @c: HTTP client that has received a complete response to its request
+ * @req: Request to send; freed by the HTTP client on success
+ * @max_response: Maximum response length
+ * @cb: Callback function for the new request
+ * @cb_ctx: Context for the callback function
+ * Returns: 0 on success or -1 if the connection cannot be reused
+ *
+ * The connection can be reused if the server did not ask for it to be closed
+ * and has not closed it. On failure, the caller still owns req and is
+ * expected to free the client and use a new connection.
+ */
+int http_client_reuse(struct http_client *c, struct wpabuf *req,
+		      size_t max_response,
+		      void (*cb)(void *ctx, struct http_client *c,
+				 enum http_client_event event),
+		      void *cb_ctx)
+{
+	char *hdr, tmp;
+	int res;
+
+	if (c->sd < 0 || c->req || c->hread == NULL)
+		return -1;
+
+	hdr = httpread_hdr_line_get(c->hread, "CONNECTION:");
+	if (hdr && os_strncasecmp(hdr, "close", 5) == 0)
+		return -1;
+
+	/* Check that the server has not closed the connection */
+	res = recv(c->sd, &tmp, 1, MSG_PEEK); /* non-blocking socket */
+	if (res >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+		return -1;
+
+	httpread_destroy(c->hread);
+	c->hread = NULL;
+	c->max_response = max_response;
+	c->cb = cb;
+	c->cb_ctx = cb_ctx;
+	c->req_pos = 0;
+
+	if (eloop_register_sock(c->sd, EVENT_TYPE_WRITE, http_client_tx_ready,
+				c, NULL))
+		return -1;
+
+	if (eloop_register_timeout(HTTP_CLIENT_TIMEOUT_SEC, 0,
+				   http_client_timeout, c, NULL)) {
+		eloop_unregister_sock(c->sd, EVENT_TYPE_WRITE);
+		return -1;
+	}
+
+	c->req = req;
+
+	return 0;
+}
+
+
 char * http_client_url_parse(const char *url, struct sockaddr_in *dst,
 			     char **ret_path)
 {
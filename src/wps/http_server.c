@@ -10,6 +10,7 @@
 #include <fcntl.h>
 
 #include "common.h"
+#include "list.h"
 #include "eloop.h"
 #include "httpread.h"
 #include "http_server.h"
@@ -19,11 +20,13 @@
 #define HTTP_SERVER_MAX_CONNECTIONS 10
 
 struct http_request {
-	struct http_request *next;
+	struct dl_list list; /* http_server::requests or http_server::busy */
 	struct http_server *srv;
 	int fd;
 	struct sockaddr_in cli;
 	struct httpread *hread;
+	struct os_reltime deadline;
+	unsigned int served; /* responses sent on this connection */
 };
 
 struct http_server {
@@ -33,11 +36,111 @@ struct http_server {
 	int fd;
 	int port;
 
-	struct http_request *requests;
+	/*
+	 * Connections waiting for (the rest of) a request, ordered by
+	 * deadline. All connections use the same timeout, so new entries are
+	 * added to the tail and a single timer for the head is sufficient.
+	 */
+	struct dl_list requests;
+	struct dl_list busy; /* requests being processed by the application */
 	unsigned int request_count;
+	unsigned int max_connections;
+	int keep_alive;
+	int accept_paused;
+	int timer_registered;
 };
 
 
+static void http_server_cb(int sd, void *eloop_ctx, void *sock_ctx);
+
+
+static void http_server_timeout(void *eloop_data, void *user_ctx)
+{
+	struct http_server *srv = eloop_data;
+	struct http_request *req;
+	struct os_reltime now, left;
+
+	srv->timer_registered = 0;
+	eloop_get_reltime(&now);
+
+	while ((req = dl_list_first(&srv->requests, struct http_request,
+				    list))) {
+		if (os_reltime_before(&now, &req->deadline))
+			break;
+		wpa_printf(MSG_DEBUG, "HTTP: Connection from %s:%d timed out",
+			   inet_ntoa(req->cli.sin_addr),
+			   ntohs(req->cli.sin_port));
+		http_request_deinit(req);
+	}
+
+	if (req == NULL)
+		return;
+	os_reltime_sub(&req->deadline, &now, &left);
+	if (eloop_register_timeout(left.sec, left.usec, http_server_timeout,
+				   srv, NULL) == 0)
+		srv->timer_registered = 1;
+}
+
+
+static void http_request_wait(struct http_server *srv,
+			      struct http_request *req)
+{
+	eloop_get_reltime(&req->deadline);
+	req->deadline.sec += HTTP_SERVER_TIMEOUT;
+	dl_list_add_tail(&srv->requests, &req->list);
+
+	/*
+	 * If the timer is already running, it is either for this deadline or
+	 * an earlier one and will be rescheduled when it expires.
+	 */
+	if (!srv->timer_registered &&
+	    eloop_register_timeout(HTTP_SERVER_TIMEOUT, 0, http_server_timeout,
+				   srv, NULL) == 0)
+		srv->timer_registered = 1;
+}
+
+
+static void http_server_pause_accept(struct http_server *srv)
+{
+	if (srv->accept_paused)
+		return;
+	wpa_printf(MSG_DEBUG, "HTTP: Connection limit (%u) reached - stop "
+		   "accepting new connections", srv->max_connections);
+	eloop_unregister_sock(srv->fd, EVENT_TYPE_READ);
+	srv->accept_paused = 1;
+}
+
+
+static void http_server_resume_accept(struct http_server *srv)
+{
+	if (!srv->accept_paused || srv->fd < 0 ||
+	    srv->request_count >= srv->max_connections)
+		return;
+	if (eloop_register_sock(srv->fd, EVENT_TYPE_READ, http_server_cb,
+				srv, NULL) == 0)
+		srv->accept_paused = 0;
+}
+
+
+/* Close the oldest kept alive connection that has not started a request */
+static int http_server_drop_idle(struct http_server *srv)
+{
+	struct http_request *req;
+
+	dl_list_for_each(req, &srv->requests, struct http_request, list) {
+		if (req->served && httpread_idle(req->hread)) {
+			wpa_printf(MSG_DEBUG, "HTTP: Close idle connection "
+				   "from %s:%d to make room",
+				   inet_ntoa(req->cli.sin_addr),
+				   ntohs(req->cli.sin_port));
+			http_request_deinit(req);
+			return 0;
+		}
+	}
+	return -1;
+}
+
+
 static void http_request_cb(struct httpread *handle, void *cookie,
 			    enum httpread_event en)
 {
@@ -48,12 +151,19 @@ static void http_request_cb(struct httpread *handle, void *cookie,
 		wpa_printf(MSG_DEBUG, "HTTP: Request from %s:%d received",
 			   inet_ntoa(req->cli.sin_addr),
 			   ntohs(req->cli.sin_port));
+		dl_list_del(&req->list);
+		dl_list_add(&srv->busy, &req->list);
 		srv->cb(srv->cb_ctx, req);
 		return;
 	}
-	wpa_printf(MSG_DEBUG, "HTTP: Request from %s:%d could not be received "
-		   "completely", inet_ntoa(req->cli.sin_addr),
-		   ntohs(req->cli.sin_port));
+	if (req->served && httpread_idle(req->hread))
+		wpa_printf(MSG_DEBUG, "HTTP: Connection from %s:%d closed",
+			   inet_ntoa(req->cli.sin_addr),
+			   ntohs(req->cli.sin_port));
+	else
+		wpa_printf(MSG_DEBUG, "HTTP: Request from %s:%d could not be "
+			   "received completely", inet_ntoa(req->cli.sin_addr),
+			   ntohs(req->cli.sin_port));
 	http_request_deinit(req);
 }
 
@@ -63,11 +173,6 @@ static struct http_request * http_request_init(struct http_server *srv, int fd,
 {
 	struct http_request *req;
 
-	if (srv->request_count >= HTTP_SERVER_MAX_CONNECTIONS) {
-		wpa_printf(MSG_DEBUG, "HTTP: Too many concurrent requests");
-		return NULL;
-	}
-
 	req = os_zalloc(sizeof(*req));
 	if (req == NULL)
 		return NULL;
@@ -76,60 +181,66 @@ static struct http_request * http_request_init(struct http_server *srv, int fd,
 	req->fd = fd;
 	req->cli = *cli;
 
+	/* Timeouts are handled by the server for all connections */
 	req->hread = httpread_create(req->fd, http_request_cb, req,
-				     HTTP_SERVER_MAX_REQ_LEN,
-				     HTTP_SERVER_TIMEOUT);
+				     HTTP_SERVER_MAX_REQ_LEN, 0);
 	if (req->hread == NULL) {
-		http_request_deinit(req);
+		os_free(req);
 		return NULL;
 	}
 
+	http_request_wait(srv, req);
+	srv->request_count++;
+
 	return req;
 }
 
 
+/* Prepare for the next request on a kept alive connection */
+static int http_request_restart(struct http_request *req)
+{
+	httpread_destroy(req->hread);
+	req->hread = httpread_create(req->fd, http_request_cb, req,
+				     HTTP_SERVER_MAX_REQ_LEN, 0);
+	if (req->hread == NULL)
+		return -1;
+
+	req->served++;
+	dl_list_del(&req->list);
+	http_request_wait(req->srv, req);
+	return 0;
+}
+
+
 void http_request_deinit(struct http_request *req)
 {
-	struct http_request *r, *p;
 	struct http_server *srv;
 
 	if (req == NULL)
 		return;
 
 	srv = req->srv;
-	p = NULL;
-	r = srv->requests;
-	while (r) {
-		if (r == req) {
-			if (p)
-				p->next = r->next;
-			else
-				srv->requests = r->next;
-			srv->request_count--;
-			break;
-		}
-		p = r;
-		r = r->next;
-	}
+	dl_list_del(&req->list);
+	srv->request_count--;
 
 	httpread_destroy(req->hread);
 	close(req->fd);
 	os_free(req);
+
+	http_server_resume_accept(srv);
 }
 
 
-static void http_request_free_all(struct http_request *req)
+static void http_request_free_all(struct dl_list *list)
 {
-	struct http_request *prev;
-	while (req) {
-		prev = req;
-		req = req->next;
-		http_request_deinit(prev);
-	}
+	struct http_request *req, *tmp;
+	dl_list_for_each_safe(req, tmp, list, struct http_request, list)
+		http_request_deinit(req);
 }
 
 
-void http_request_send(struct http_request *req, struct wpabuf *resp)
+static int http_request_send_buf(struct http_request *req,
+				 struct wpabuf *resp)
 {
 	int res;
 
@@ -146,20 +257,55 @@ void http_request_send(struct http_request *req, struct wpabuf *resp)
 		wpa_printf(MSG_DEBUG, "HTTP: Sent only %d of %lu bytes",
 			   res, (unsigned long) wpabuf_len(resp));
 		/* TODO: add eloop handler for sending rest of the data */
+		res = -1;
 	}
 
 	wpabuf_free(resp);
+	return res < 0 ? -1 : 0;
+}
+
+
+void http_request_send(struct http_request *req, struct wpabuf *resp)
+{
+	http_request_send_buf(req, resp);
 }
 
 
+/**
+ * http_request_send_and_deinit - Send response and release the request
+ * @req: Request from the server callback
+ * @resp: Response; this function frees the buffer
+ *
+ * If http_request_keep_alive() returns true for the request, the connection
+ * is kept open for the next request from the same client instead of being
+ * closed.
+ */
 void http_request_send_and_deinit(struct http_request *req,
 				  struct wpabuf *resp)
 {
-	http_request_send(req, resp);
+	int keep_alive = http_request_keep_alive(req);
+
+	if (http_request_send_buf(req, resp) == 0 && keep_alive &&
+	    http_request_restart(req) == 0)
+		return;
 	http_request_deinit(req);
 }
 
 
+/**
+ * http_request_keep_alive - Check whether the connection will be kept open
+ * @req: Request from the server callback
+ * Returns: 1 if the connection is kept open after the response, 0 if not
+ *
+ * The application uses this to decide whether to add Connection: close into
+ * the response header.
+ */
+int http_request_keep_alive(struct http_request *req)
+{
+	return req->srv->keep_alive && httpread_keep_alive(req->hread);
+}
+
+
 enum httpread_hdr_type http_request_get_type(struct http_request *req)
 {
 	return httpread_hdr_type_get(req->hread);
@@ -204,6 +350,16 @@ static void http_server_cb(int sd, void *eloop_ctx, void *sock_ctx)
 	int conn;
 	struct http_request *req;
 
+	if (srv->request_count >= srv->max_connections &&
+	    http_server_drop_idle(srv) < 0) {
+		/*
+		 * Leave the connection in the listen backlog until one of the
+		 * current ones has been closed.
+		 */
+		http_server_pause_accept(srv);
+		return;
+	}
+
 	conn = accept(srv->fd, (struct sockaddr *) &addr, &addr_len);
 	if (conn < 0) {
 		wpa_printf(MSG_DEBUG, "HTTP: Failed to accept new connection: "
@@ -218,10 +374,6 @@ static void http_server_cb(int sd, void *eloop_ctx, void *sock_ctx)
 		close(conn);
 		return;
 	}
-
-	req->next = srv->requests;
-	srv->requests = req;
-	srv->request_count++;
 }
 
 
@@ -238,6 +390,9 @@ struct http_server * http_server_init(struct in_addr *addr, int port,
 		return NULL;
 	srv->cb = cb;
 	srv->cb_ctx = cb_ctx;
+	dl_list_init(&srv->requests);
+	dl_list_init(&srv->busy);
+	srv->max_connections = HTTP_SERVER_MAX_CONNECTIONS;
 
 	srv->fd = socket(AF_INET, SOCK_STREAM, 0);
 	if (srv->fd < 0)
@@ -291,10 +446,14 @@ void http_server_deinit(struct http_server *srv)
 	if (srv == NULL)
 		return;
 	if (srv->fd >= 0) {
-		eloop_unregister_sock(srv->fd, EVENT_TYPE_READ);
+		if (!srv->accept_paused)
+			eloop_unregister_sock(srv->fd, EVENT_TYPE_READ);
 		close(srv->fd);
+		srv->fd = -1;
 	}
-	http_request_free_all(srv->requests);
+	http_request_free_all(&srv->requests);
+	http_request_free_all(&srv->busy);
+	eloop_cancel_timeout(http_server_timeout, srv, NULL);
 
 	os_free(srv);
 }
@@ -304,3 +463,34 @@ int http_server_get_port(struct http_server *srv)
 {
 	return srv->port;
 }
+
+
+/**
+ * http_server_set_max_connections - Set the maximum number of connections
+ * @srv: HTTP server from http_server_init()
+ * @max_connections: Maximum number of simultaneous connections
+ *
+ * Once the limit has been reached, the oldest idle kept alive connection is
+ * closed to make room for a new one. If there is no such connection, new
+ * connections are left in the listen backlog until a connection is closed.
+ */
+void http_server_set_max_connections(struct http_server *srv,
+				     unsigned int max_connections)
+{
+	srv->max_connections = max_connections > 0 ? max_connections : 1;
+	http_server_resume_accept(srv);
+}
+
+
+/**
+ * http_server_set_keep_alive - Allow connections to be kept open
+ * @srv: HTTP server from http_server_init()
+ * @keep_alive: Whether to keep HTTP/1.1 connections open between requests
+ *
+ * This is disabled by default. If enabled, the application must use
+ * http_request_keep_alive() to determine whether to send Connection: close.
+ */
+void http_server_set_keep_alive(struct http_server *srv, int keep_alive)
+{
+	srv->keep_alive = keep_alive;
+}
@@ -16,6 +16,7 @@ void http_request_deinit(struct http_request *req);
 void http_request_send(struct http_request *req, struct wpabuf *resp);
 void http_request_send_and_deinit(struct http_request *req,
 				  struct wpabuf *resp);
+int http_request_keep_alive(struct http_request *req);
 enum httpread_hdr_type http_request_get_type(struct http_request *req);
 char * http_request_get_uri(struct http_request *req);
 char * http_request_get_hdr(struct http_request *req);
@@ -29,5 +30,8 @@ struct http_server * http_server_init(struct in_addr *addr, int port,
 				      void *cb_ctx);
 void http_server_deinit(struct http_server *srv);
 int http_server_get_port(struct http_server *srv);
+void http_server_set_max_connections(struct http_server *srv,
+				     unsigned int max_connections);
+void http_server_set_keep_alive(struct http_server *srv, int keep_alive);
 
 #endif /* HTTP_SERVER_H */
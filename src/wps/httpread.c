@@ -19,13 +19,16 @@
  * It is assumed that the application does not expect any of the following:
  * -- transfer encoding other than chunked
  * -- trailer fields
- * It is assumed that, even if the other side requested that the connection be
- * kept open, that we will close it (thus HTTP messages sent by application
- * should have the connection closed field); this is allowed by HTTP/1.1 and
- * simplifies things for us.
+ * Each instance reads a single message. If httpread_keep_alive() indicates
+ * that the connection can be kept open, the application may create a new
+ * instance on the same socket for the next message. Pipelined requests (data
+ * received past the end of the message) are not supported; the connection is
+ * closed instead in that case.
  *
  * Other limitations:
  * -- HTTP header may not exceed a hard-coded size.
+ * -- Body (or the announced Content-Length and chunk sizes) may not exceed
+ *    the maximum size given by the application.
  *
  * Notes:
  * This code would be massively simpler without some of the new features of
@@ -80,6 +83,7 @@ struct httpread {
 	int got_content_length; /* true if we know content length for sure */
 	int content_length;     /* body length,  iff got_content_length */
 	int chunked;            /* nonzero for chunked data */
+	int conn_close;         /* nonzero for Connection: close */
 	char *uri;
 
 	int got_body;           /* nonzero when body is finalized */
@@ -88,6 +92,8 @@ struct httpread {
 	int body_alloc_nbytes;  /* amount allocated */
 
 	int got_file;           /* here when we are done */
+	int got_eof;            /* connection closed by the other side */
+	int extra_nbytes;       /* data read past the end of the message */
 
 	/* The following apply if data is chunked: */
 	int in_chunk_data;      /* 0=in/at header, 1=in the data or tail*/
@@ -142,6 +148,24 @@ static int hex_value(int c)
 }
 
 
+/* Find the empty line terminating the header.
+ * Returns pointer to the first byte following the header or NULL if the
+ * header is not yet complete.
+ */
+static char * httpread_hdr_end(char *pos, char *end)
+{
+	while (end - pos >= 4) {
+		pos = memchr(pos, '\r', end - pos - 3);
+		if (pos == NULL)
+			return NULL;
+		if (pos[1] == '\n' && pos[2] == '\r' && pos[3] == '\n')
+			return pos + 4;
+		pos++;
+	}
+	return NULL;
+}
+
+
 static void httpread_timeout_handler(void *eloop_data, void *user_ctx);
 
 /* httpread_destroy -- if h is non-NULL, clean up
@@ -190,16 +214,29 @@ static int httpread_hdr_option_analyze(
 	)
 {
 	if (word_eq(hbp, "CONTENT-LENGTH:")) {
+		unsigned long len;
 		while (isgraph(*hbp))
 			hbp++;
 		while (*hbp == ' ' || *hbp == '\t')
 			hbp++;
 		if (!isdigit(*hbp))
 			return -1;
-		h->content_length = atol(hbp);
+		len = strtoul(hbp, NULL, 10);
+		if (len > 0x7fffffff)
+			return -1;
+		h->content_length = len;
 		h->got_content_length = 1;
 		return 0;
 	}
+	if (word_eq(hbp, "CONNECTION:")) {
+		while (isgraph(*hbp))
+			hbp++;
+		while (*hbp == ' ' || *hbp == '\t')
+			hbp++;
+		if (word_eq(hbp, "CLOSE"))
+			h->conn_close = 1;
+		return 0;
+	}
 	if (word_eq(hbp, "TRANSFER_ENCODING:") ||
 	    word_eq(hbp, "TRANSFER-ENCODING:")) {
 		while (isgraph(*hbp))
@@ -388,9 +425,9 @@ bad:
 
 /* httpread_read_handler -- called when socket ready to read
  *
- * Note: any extra data we read past end of transmitted file is ignored;
- * if we were to support keeping connections open for multiple files then
- * this would have to be addressed.
+ * Note: any extra data we read past end of transmitted file is ignored,
+ * but counted so that httpread_keep_alive() will not allow the connection
+ * to be reused for a pipelined request.
  */
 static void httpread_read_handler(int sd, void *eloop_ctx, void *sock_ctx)
 {
@@ -434,8 +471,9 @@ static void httpread_read_handler(int sd, void *eloop_ctx, void *sock_ctx)
 		 */
 		if (httpread_debug >= 10)
 			wpa_printf(MSG_DEBUG, "httpread ok eof(%p)", h);
-			h->got_body = 1;
-			goto got_file;
+		h->got_eof = 1;
+		h->got_body = 1;
+		goto got_file;
 	}
 	rbp = readbuf;
 
@@ -443,31 +481,34 @@ static void httpread_read_handler(int sd, void *eloop_ctx, void *sock_ctx)
 	 * and an empty line (CR LF only).
 	 */
 	if (!h->got_hdr) {
-		hbp = h->hdr + h->hdr_nbytes;
-		/* add to headers until:
-		 *      -- we run out of data in read buffer
-		 *      -- or, we run out of header buffer room
-		 *      -- or, we get double CRLF in headers
+		int ncopy, start;
+
+		/* add to headers as much as fits and search for double CRLF,
+		 * starting a few bytes before the new data in case the
+		 * terminator was split between reads
 		 */
-		for (;;) {
-			if (nread == 0)
-				goto get_more;
-			if (h->hdr_nbytes == HTTPREAD_HEADER_MAX_SIZE) {
+		if (h->hdr_nbytes == HTTPREAD_HEADER_MAX_SIZE)
+			goto bad;
+		ncopy = HTTPREAD_HEADER_MAX_SIZE - h->hdr_nbytes;
+		if (ncopy > nread)
+			ncopy = nread;
+		start = h->hdr_nbytes > 3 ? h->hdr_nbytes - 3 : 0;
+		os_memcpy(h->hdr + h->hdr_nbytes, rbp, ncopy);
+		h->hdr_nbytes += ncopy;
+		hbp = httpread_hdr_end(h->hdr + start,
+				       h->hdr + h->hdr_nbytes);
+		if (hbp == NULL) {
+			if (h->hdr_nbytes == HTTPREAD_HEADER_MAX_SIZE)
 				goto bad;
-			}
-			*hbp++ = *rbp++;
-			nread--;
-			h->hdr_nbytes++;
-			if (h->hdr_nbytes >= 4 &&
-			    hbp[-1] == '\n' &&
-			    hbp[-2] == '\r' &&
-			    hbp[-3] == '\n' &&
-			    hbp[-4] == '\r' ) {
-				h->got_hdr = 1;
-				*hbp = 0;       /* null terminate */
-				break;
-			}
+			goto get_more;
 		}
+		/* leave data following the header in the read buffer */
+		ncopy -= h->hdr_nbytes - (hbp - h->hdr);
+		rbp += ncopy;
+		nread -= ncopy;
+		h->hdr_nbytes = hbp - h->hdr;
+		h->got_hdr = 1;
+		*hbp = 0;       /* null terminate */
 		/* here we've just finished reading the header */
 		if (httpread_hdr_analyze(h)) {
 			wpa_printf(MSG_DEBUG, "httpread bad hdr(%p)", h);
@@ -486,6 +527,13 @@ static void httpread_read_handler(int sd, void *eloop_ctx, void *sock_ctx)
 					   h);
 			goto got_file;
 		}
+		if (h->got_content_length &&
+		    h->content_length > h->max_bytes) {
+			wpa_printf(MSG_DEBUG, "httpread content length %d "
+				   "exceeds limit %d (%p)", h->content_length,
+				   h->max_bytes, h);
+			goto bad;
+		}
 	}
 
 	/* Certain types of requests never have data and so
@@ -551,9 +599,15 @@ static void httpread_read_handler(int sd, void *eloop_ctx, void *sock_ctx)
 					/* hdr line consists solely
 					 * of a hex numeral and CFLF
 					 */
+					unsigned long size;
 					if (!isxdigit(*cbp))
 						goto bad;
-					h->chunk_size = strtoul(cbp, NULL, 16);
+					size = strtoul(cbp, NULL, 16);
+					if (size > (unsigned long) h->max_bytes
+					    || (int) size >
+					    h->max_bytes - h->chunk_start)
+						goto bad;
+					h->chunk_size = size;
 					/* throw away chunk header
 					 * so we have only real data
 					 */
@@ -611,11 +665,9 @@ static void httpread_read_handler(int sd, void *eloop_ctx, void *sock_ctx)
 				ncopy = (h->chunk_start + h->chunk_size + 2) -
 					h->body_nbytes;
 			} else if (h->chunked) {
-				/*in chunk header -- don't optimize */
-				*bbp++ = *rbp++;
-				nread--;
-				h->body_nbytes++;
-				continue;
+				/* in chunk header -- copy up to end of line */
+				char *lf = memchr(rbp, '\n', nread);
+				ncopy = lf ? lf - rbp + 1 : nread;
 			} else if (h->got_content_length) {
 				ncopy = h->content_length - h->body_nbytes;
 			} else {
@@ -699,8 +751,10 @@ got_file:
 	if (h->body)
 		h->body[h->body_nbytes] = 0; /* null terminate */
 	h->got_file = 1;
-	/* Assume that we do NOT support keeping connection alive,
-	 * and just in case somehow we don't get destroyed right away,
+	h->extra_nbytes = nread;
+	/* This instance reads only a single message; if the connection is
+	 * kept alive, the application creates a new instance for the next
+	 * one. Just in case somehow we don't get destroyed right away,
 	 * unregister now.
 	 */
 	if (h->sd_registered)
@@ -774,6 +828,25 @@ fail:
 }
 
 
+/* httpread_keep_alive -- When file is ready, returns nonzero if the
+ * connection can be used for another message: HTTP/1.1 was used without
+ * Connection: close, the end of the message was determined without the
+ * other side closing the connection, and no further data was received.
+ */
+int httpread_keep_alive(struct httpread *h)
+{
+	return h->got_file && h->version == 1 && !h->conn_close &&
+		!h->got_eof && h->extra_nbytes == 0;
+}
+
+
+/* httpread_idle -- Returns nonzero if no data has been received yet */
+int httpread_idle(struct httpread *h)
+{
+	return h->hdr_nbytes == 0;
+}
+
+
 /* httpread_hdr_type_get -- When file is ready, returns header type. */
 enum httpread_hdr_type httpread_hdr_type_get(struct httpread *h)
 {
@@ -75,6 +75,14 @@ struct httpread * httpread_create(
 	int timeout_seconds     /* 0; or total duration timeout period */
 	);
 
+/* httpread_keep_alive -- When file is ready, returns nonzero if the
+ * connection can be kept open for another message.
+ */
+int httpread_keep_alive(struct httpread *h);
+
+/* httpread_idle -- Returns nonzero if no data has been received yet */
+int httpread_idle(struct httpread *h);
+
 /* httpread_hdr_type_get -- When file is ready, returns header type.
  */
 enum httpread_hdr_type httpread_hdr_type_get(struct httpread *h);
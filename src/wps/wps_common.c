@@ -9,6 +9,7 @@
 #include "includes.h"
 
 #include "common.h"
+#include "eloop.h"
 #include "crypto/aes_wrap.h"
 #include "crypto/crypto.h"
 #include "crypto/dh_group5.h"
@@ -56,6 +57,115 @@ void wps_kdf(const u8 *key, const u8 *label_prefix, size_t label_prefix_len,
 }
 
 
+/*
+ * Pool of precomputed DH group 5 keypairs. Generating a keypair takes a
+ * 1536-bit modular exponentiation, so this is done in the background from
+ * the event loop instead of when building M1 or M2.
+ */
+#define WPS_DH_POOL_SIZE 2
+#define WPS_DH_POOL_FILL_DELAY 1
+
+static struct wps_dh_pool {
+	struct wpabuf *priv[WPS_DH_POOL_SIZE];
+	struct wpabuf *pub[WPS_DH_POOL_SIZE];
+	unsigned int count;
+	unsigned int users;
+} wps_dh_pool;
+
+
+static void wps_dh_pool_fill(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpabuf *priv = NULL, *pub = NULL;
+	void *dh_ctx;
+
+	if (wps_dh_pool.users == 0 || wps_dh_pool.count == WPS_DH_POOL_SIZE)
+		return;
+
+	if (!random_pool_ready()) {
+		/* Do not store keys generated before there is enough entropy */
+		eloop_register_timeout(WPS_DH_POOL_FILL_DELAY, 0,
+				       wps_dh_pool_fill, NULL, NULL);
+		return;
+	}
+
+	/* Generate one keypair at a time to avoid blocking the event loop */
+	dh_ctx = dh5_init(&priv, &pub);
+	dh5_free(dh_ctx);
+	if (dh_ctx == NULL || priv == NULL || pub == NULL) {
+		wpa_printf(MSG_DEBUG, "WPS: Failed to precompute DH keys");
+		wpabuf_free(priv);
+		wpabuf_free(pub);
+		return;
+	}
+	wps_dh_pool.priv[wps_dh_pool.count] = priv;
+	wps_dh_pool.pub[wps_dh_pool.count] = pub;
+	wps_dh_pool.count++;
+
+	if (wps_dh_pool.count < WPS_DH_POOL_SIZE)
+		eloop_register_timeout(WPS_DH_POOL_FILL_DELAY, 0,
+				       wps_dh_pool_fill, NULL, NULL);
+}
+
+
+/**
+ * wps_dh_pool_init - Start filling the DH keypair pool
+ *
+ * Each call must be matched with a call to wps_dh_pool_deinit().
+ */
+void wps_dh_pool_init(void)
+{
+	if (wps_dh_pool.users++ == 0)
+		eloop_register_timeout(0, 0, wps_dh_pool_fill, NULL, NULL);
+}
+
+
+/**
+ * wps_dh_pool_deinit - Release the DH keypair pool
+ */
+void wps_dh_pool_deinit(void)
+{
+	if (wps_dh_pool.users == 0 || --wps_dh_pool.users > 0)
+		return;
+
+	eloop_cancel_timeout(wps_dh_pool_fill, NULL, NULL);
+	while (wps_dh_pool.count > 0) {
+		wps_dh_pool.count--;
+		wpabuf_free(wps_dh_pool.priv[wps_dh_pool.count]);
+		wpabuf_free(wps_dh_pool.pub[wps_dh_pool.count]);
+	}
+}
+
+
+/**
+ * wps_dh_pool_get - Get a precomputed DH keypair
+ * @priv: Buffer for returning the private key
+ * @pub: Buffer for returning the public key
+ * Returns: 0 on success or -1 if no precomputed keypair is available
+ *
+ * The keypair is removed from the pool and the caller is responsible for
+ * freeing the returned buffers. The pool is refilled later from the event
+ * loop.
+ */
+int wps_dh_pool_get(struct wpabuf **priv, struct wpabuf **pub)
+{
+	if (wps_dh_pool.count == 0)
+		return -1;
+
+	wps_dh_pool.count--;
+	*priv = wps_dh_pool.priv[wps_dh_pool.count];
+	*pub = wps_dh_pool.pub[wps_dh_pool.count];
+	wps_dh_pool.priv[wps_dh_pool.count] = NULL;
+	wps_dh_pool.pub[wps_dh_pool.count] = NULL;
+
+	/* Refill only after the ongoing exchange has had time to proceed */
+	eloop_cancel_timeout(wps_dh_pool_fill, NULL, NULL);
+	eloop_register_timeout(WPS_DH_POOL_FILL_DELAY, 0, wps_dh_pool_fill,
+			       NULL, NULL);
+
+	return 0;
+}
+
+
 int wps_derive_keys(struct wps_data *wps)
 {
 	struct wpabuf *pubkey, *dh_shared;
@@ -460,10 +460,10 @@ struct wpabuf * wps_enrollee_get_msg(struct wps_data *wps,
 	}
 
 	if (*op_code == WSC_MSG && msg) {
-		/* Save a copy of the last message for Authenticator derivation
-		 */
+		/* Keep a reference to the last message for Authenticator
+		 * derivation; the message is not modified after this. */
 		wpabuf_free(wps->last_msg);
-		wps->last_msg = wpabuf_dup(msg);
+		wps->last_msg = wpabuf_ref(msg);
 	}
 
 	return msg;
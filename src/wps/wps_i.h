@@ -125,6 +125,9 @@ struct wps_data {
 /* wps_common.c */
 void wps_kdf(const u8 *key, const u8 *label_prefix, size_t label_prefix_len,
 	     const char *label, u8 *res, size_t res_len);
+void wps_dh_pool_init(void);
+void wps_dh_pool_deinit(void);
+int wps_dh_pool_get(struct wpabuf **priv, struct wpabuf **pub);
 int wps_derive_keys(struct wps_data *wps);
 void wps_derive_psk(struct wps_data *wps, const u8 *dev_passwd,
 		    size_t dev_passwd_len);
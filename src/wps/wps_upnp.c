@@ -477,19 +477,14 @@ static void upnp_wps_device_send_event(struct upnp_wps_device_sm *sm)
 	struct wpabuf *buf; /* holds event message */
 	int buf_size = 0;
 	struct subscription *s, *tmp;
-	/* Actually, utf-8 is the default, but it doesn't hurt to specify it */
-	const char *format_head =
-		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
-		"<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n";
-	const char *format_tail = "</e:propertyset>\n";
-	struct os_time now;
+	struct os_reltime now;
 
 	if (dl_list_empty(&sm->subscriptions)) {
 		/* optimize */
 		return;
 	}
 
-	if (os_get_time(&now) == 0) {
+	if (os_get_reltime(&now) == 0) {
 		if (now.sec != sm->last_event_sec) {
 			sm->last_event_sec = now.sec;
 			sm->num_events_in_sec = 1;
@@ -505,28 +500,31 @@ static void upnp_wps_device_send_event(struct upnp_wps_device_sm *sm)
 			if (sm->num_events_in_sec > MAX_EVENTS_PER_SEC &&
 			    sm->wlanevent_type ==
 			    UPNP_WPS_WLANEVENT_TYPE_PROBE) {
+				sm->probe_events_throttled++;
 				wpa_printf(MSG_DEBUG, "WPS UPnP: Throttle "
 					   "event notifications (%u seen "
-					   "during one second)",
-					   sm->num_events_in_sec);
+					   "during one second; %u throttled "
+					   "in total)",
+					   sm->num_events_in_sec,
+					   sm->probe_events_throttled);
 				return;
 			}
 		}
 	}
 
-	/* Determine buffer size needed first */
-	buf_size += os_strlen(format_head);
+	/*
+	 * Only the properties are queued; the propertyset wrapper is added
+	 * when the event message is built so that queued Probe Request events
+	 * can be coalesced into a single message.
+	 */
 	buf_size += 50 + 2 * os_strlen("WLANEvent");
 	if (sm->wlanevent)
 		buf_size += os_strlen(sm->wlanevent);
-	buf_size += os_strlen(format_tail);
 
 	buf = wpabuf_alloc(buf_size);
 	if (buf == NULL)
 		return;
-	wpabuf_put_str(buf, format_head);
 	wpabuf_put_property(buf, "WLANEvent", sm->wlanevent);
-	wpabuf_put_str(buf, format_tail);
 
 	wpa_printf(MSG_MSGDUMP, "WPS UPnP: WLANEvent message:\n%s",
 		   (char *) wpabuf_head(buf));
@@ -636,10 +634,6 @@ static int subscription_first_event(struct subscription *s)
 	char *wlan_event;
 	struct wpabuf *buf;
 	int ap_status = 1;      /* TODO: add 0x10 if access point is locked */
-	const char *head =
-		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
-		"<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n";
-	const char *tail = "</e:propertyset>\n";
 	char txt[10];
 	int ret;
 
@@ -675,13 +669,11 @@ static int subscription_first_event(struct subscription *s)
 	if (buf == NULL)
 		return -1;
 
-	wpabuf_put_str(buf, head);
 	wpabuf_put_property(buf, "STAStatus", "1");
 	os_snprintf(txt, sizeof(txt), "%d", ap_status);
 	wpabuf_put_property(buf, "APStatus", txt);
 	if (*wlan_event)
 		wpabuf_put_property(buf, "WLANEvent", wlan_event);
-	wpabuf_put_str(buf, tail);
 
 	ret = event_add(s, buf, 0);
 	if (ret) {
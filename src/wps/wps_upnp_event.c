@@ -32,6 +32,8 @@
 
 #define MAX_EVENTS_QUEUED 20   /* How far behind queued events */
 #define MAX_FAILURES 10 /* Drop subscription after this many failures */
+#define MAX_EVENTS_COALESCED 8 /* Probe Request events per NOTIFY */
+#define EVENT_CONN_IDLE_TIMEOUT 10 /* Close idle connection after (sec) */
 
 /* How long to wait before sending event */
 #define EVENT_DELAY_SECONDS 0
@@ -44,6 +46,10 @@
  * retried at a different address (if more than one is available).
  *
  * TODO: As an optimization we could share data between subscribers.
+ *
+ * Probe Request events that are queued behind each other are coalesced into a
+ * single NOTIFY with multiple properties. EAP message events are always sent
+ * separately since the ER has to process each of them.
  */
 struct wps_event_ {
 	struct dl_list list;
@@ -51,11 +57,55 @@ struct wps_event_ {
 	unsigned subscriber_sequence;   /* which event for this subscription*/
 	unsigned int retry;             /* which retry */
 	struct subscr_addr *addr;       /* address to connect to */
-	struct wpabuf *data;            /* event data to send */
+	struct wpabuf *data;            /* event properties to send */
 	struct http_client *http_event;
+	int probereq;                   /* only Probe Request events */
+	unsigned int num_events;        /* number of coalesced events */
+	int reused;                     /* sent over a kept-alive connection */
 };
 
 
+static void event_conn_idle_timeout(void *eloop_data, void *user_ctx);
+
+
+/* event_conn_close -- close the idle connection of a subscription */
+static void event_conn_close(struct subscription *s)
+{
+	if (s->conn == NULL)
+		return;
+	eloop_cancel_timeout(event_conn_idle_timeout, s, NULL);
+	http_client_free(s->conn);
+	s->conn = NULL;
+	s->conn_addr = NULL;
+}
+
+
+static void event_conn_idle_timeout(void *eloop_data, void *user_ctx)
+{
+	struct subscription *s = eloop_data;
+
+	wpa_printf(MSG_DEBUG, "WPS UPnP: Close idle event connection for "
+		   "subscription %p", s);
+	event_conn_close(s);
+}
+
+
+/* event_conn_keep -- keep the connection of a delivered event for reuse */
+static void event_conn_keep(struct wps_event_ *e)
+{
+	struct subscription *s = e->s;
+
+	event_conn_close(s);
+	if (e->http_event == NULL)
+		return;
+	s->conn = e->http_event;
+	s->conn_addr = e->addr;
+	e->http_event = NULL;
+	eloop_register_timeout(EVENT_CONN_IDLE_TIMEOUT, 0,
+			       event_conn_idle_timeout, s, NULL);
+}
+
+
 /* event_clean -- clean sockets etc. of event
  * Leaves data, retry count etc. alone.
  */
@@ -106,6 +156,11 @@ void event_delete_all(struct subscription *s)
 		event_delete(s->current_event);
 		/* will set: s->current_event = NULL;  */
 	}
+	event_conn_close(s);
+	if (s->probe_events_dropped)
+		wpa_printf(MSG_DEBUG, "WPS UPnP: %u Probe Request events were "
+			   "dropped for subscription %p",
+			   s->probe_events_dropped, s);
 }
 
 
@@ -146,6 +201,11 @@ static struct wpabuf * event_build_message(struct wps_event_ *e)
 {
 	struct wpabuf *buf;
 	char *b;
+	/* Actually, utf-8 is the default, but it doesn't hurt to specify it */
+	const char *head =
+		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+		"<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">\n";
+	const char *tail = "</e:propertyset>\n";
 
 	buf = wpabuf_alloc(1000 + wpabuf_len(e->data));
 	if (buf == NULL)
@@ -163,9 +223,12 @@ static struct wpabuf * event_build_message(struct wps_event_ *e)
 	wpabuf_put_str(buf, "\r\n");
 	wpabuf_printf(buf, "SEQ: %u\r\n", e->subscriber_sequence);
 	wpabuf_printf(buf, "CONTENT-LENGTH: %d\r\n",
-		      (int) wpabuf_len(e->data));
+		      (int) (os_strlen(head) + wpabuf_len(e->data) +
+			     os_strlen(tail)));
 	wpabuf_put_str(buf, "\r\n"); /* terminating empty line */
+	wpabuf_put_str(buf, head);
 	wpabuf_put_buf(buf, e->data);
+	wpabuf_put_str(buf, tail);
 	return buf;
 }
 
@@ -217,6 +280,19 @@ static void event_http_cb(void *ctx, struct http_client *c,
 
 	wpa_printf(MSG_DEBUG, "WPS UPnP: HTTP client callback: e=%p c=%p "
 		   "event=%d", e, c, event);
+	if (event != HTTP_CLIENT_OK && e->reused) {
+		/*
+		 * The subscriber may have closed the kept-alive connection;
+		 * try again with a new connection before counting this as a
+		 * failure.
+		 */
+		wpa_printf(MSG_DEBUG, "WPS UPnP: Event send over reused "
+			   "connection failed - reconnect");
+		e->reused = 0;
+		event_retry(e, 0);
+		return;
+	}
+
 	switch (event) {
 	case HTTP_CLIENT_OK:
 		wpa_printf(MSG_DEBUG,
@@ -224,6 +300,7 @@ static void event_http_cb(void *ctx, struct http_client *c,
 			   e, e->addr->domain_and_port);
 		e->addr->num_failures = 0;
 		s->last_event_failed = 0;
+		event_conn_keep(e);
 		event_delete(e);
 
 		/* Schedule sending more if there is more to send */
@@ -299,6 +376,19 @@ static int event_send_start(struct subscription *s)
 		return -1;
 	}
 
+	if (s->conn && s->conn_addr == e->addr &&
+	    http_client_reuse(s->conn, buf, 0, event_http_cb, e) == 0) {
+		wpa_printf(MSG_DEBUG, "WPS UPnP: Reuse connection to %s for "
+			   "event %p", e->addr->domain_and_port, e);
+		eloop_cancel_timeout(event_conn_idle_timeout, s, NULL);
+		e->http_event = s->conn;
+		e->reused = 1;
+		s->conn = NULL;
+		s->conn_addr = NULL;
+		return 0;
+	}
+	event_conn_close(s);
+
 	e->http_event = http_client_addr(&e->addr->saddr, buf, 0,
 					 event_http_cb, e);
 	if (e->http_event == NULL) {
@@ -368,7 +458,7 @@ void event_send_stop_all(struct upnp_wps_device_sm *sm)
 /**
  * event_add - Add a new event to a queue
  * @s: Subscription
- * @data: Event data (is copied; caller retains ownership)
+ * @data: Event properties (is copied; caller retains ownership)
  * @probereq: Whether this is a Probe Request event
  * Returns: 0 on success, -1 on error, 1 on max event queue limit reached
  */
@@ -378,16 +468,35 @@ int event_add(struct subscription *s, const struct wpabuf *data, int probereq)
 	unsigned int len;
 
 	len = dl_list_len(&s->event_queue);
+
+	if (probereq && len > 0) {
+		/* Coalesce with a Probe Request event waiting in the queue */
+		e = dl_list_last(&s->event_queue, struct wps_event_, list);
+		if (e && e->probereq && e->num_events < MAX_EVENTS_COALESCED &&
+		    wpabuf_resize(&e->data, wpabuf_len(data)) == 0) {
+			wpabuf_put_buf(e->data, data);
+			e->num_events++;
+			wpa_printf(MSG_DEBUG, "WPS UPnP: Coalesce event into %p "
+				   "for subscriber %p (%u events)",
+				   e, s, e->num_events);
+			return 0;
+		}
+	}
+
 	if (len >= MAX_EVENTS_QUEUED) {
 		wpa_printf(MSG_DEBUG, "WPS UPnP: Too many events queued for "
 			   "subscriber %p", s);
-		if (probereq)
+		if (probereq) {
+			s->probe_events_dropped++;
 			return 1;
+		}
 
 		/* Drop oldest entry to allow EAP event to be stored. */
 		e = event_dequeue(s);
 		if (!e)
 			return 1;
+		if (e->probereq)
+			s->probe_events_dropped += e->num_events;
 		event_delete(e);
 	}
 
@@ -399,6 +508,7 @@ int event_add(struct subscription *s, const struct wpabuf *data, int probereq)
 		wpa_printf(MSG_DEBUG, "WPS UPnP: Do not queue more Probe "
 			   "Request frames for subscription %p since last "
 			   "delivery failed", s);
+		s->probe_events_dropped++;
 		return -1;
 	}
 
@@ -412,6 +522,8 @@ int event_add(struct subscription *s, const struct wpabuf *data, int probereq)
 		os_free(e);
 		return -1;
 	}
+	e->probereq = probereq;
+	e->num_events = 1;
 	e->subscriber_sequence = s->next_subscriber_sequence++;
 	if (s->next_subscriber_sequence == 0)
 		s->next_subscriber_sequence++;
@@ -93,6 +93,10 @@ struct subscription {
 	struct wps_event_ *current_event; /* non-NULL if being sent (not in q)
 					   */
 	int last_event_failed; /* Whether delivery of last event failed */
+	unsigned int probe_events_dropped; /* Probe Request events not sent */
+	/* Connection kept alive after the last delivered event */
+	struct http_client *conn;
+	struct subscr_addr *conn_addr; /* address of conn */
 
 	/* Information from SetSelectedRegistrar action */
 	u8 selected_registrar;
@@ -146,6 +150,7 @@ struct upnp_wps_device_sm {
 	enum upnp_wps_wlanevent_type wlanevent_type;
 	os_time_t last_event_sec;
 	unsigned int num_events_in_sec;
+	unsigned int probe_events_throttled; /* dropped due to rate limit */
 };
 
 /* wps_upnp.c */
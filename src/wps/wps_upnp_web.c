@@ -27,7 +27,7 @@
 
 #define WEB_CONNECTION_TIMEOUT_SEC 30   /* Drop web connection after t.o. */
 #define WEB_CONNECTION_MAX_READ 8000    /* Max we'll read for TCP request */
-#define MAX_WEB_CONNECTIONS 10          /* max simultaneous web connects */
+#define MAX_WEB_CONNECTIONS 32          /* max simultaneous web connects */
 
 
 static const char *urn_wfawlanconfig =
@@ -274,11 +274,21 @@ static void http_put_date(struct wpabuf *buf)
 }
 
 
-static void http_put_empty(struct wpabuf *buf, enum http_reply_code code)
+/* Responses include Content-Length, so the connection can be kept open if
+ * the client allows that */
+static void http_put_connection(struct wpabuf *buf, struct http_request *req)
+{
+	if (!http_request_keep_alive(req))
+		wpabuf_put_str(buf, http_connection_close);
+}
+
+
+static void http_put_empty(struct wpabuf *buf, struct http_request *req,
+			   enum http_reply_code code)
 {
 	http_put_reply_code(buf, code);
 	wpabuf_put_str(buf, http_server_hdr);
-	wpabuf_put_str(buf, http_connection_close);
+	http_put_connection(buf, req);
 	wpabuf_put_str(buf, "Content-Length: 0\r\n"
 		       "\r\n");
 }
@@ -299,8 +309,8 @@ static void http_put_empty(struct wpabuf *buf, enum http_reply_code code)
  * Date: <rfc1123-date>
  *
  * Header lines must end with \r\n
- * Per RFC 2616, content-length: is not required but connection:close
- * would appear to be required (given that we will be closing it!).
+ * Connection: close is left out if the connection is kept alive (HTTP/1.1
+ * client did not ask for the connection to be closed).
  */
 static void web_connection_parse_get(struct upnp_wps_device_sm *sm,
 				     struct http_request *hreq, char *filename)
@@ -353,9 +363,9 @@ static void web_connection_parse_get(struct upnp_wps_device_sm *sm,
 			http_request_deinit(hreq);
 			return;
 		}
-		wpabuf_put_str(buf,
-			       "HTTP/1.1 404 Not Found\r\n"
-			       "Connection: close\r\n");
+		wpabuf_put_str(buf, "HTTP/1.1 404 Not Found\r\n");
+		http_put_connection(buf, hreq);
+		wpabuf_put_str(buf, "Content-Length: 0\r\n");
 
 		http_put_date(buf);
 
@@ -375,7 +385,7 @@ static void web_connection_parse_get(struct upnp_wps_device_sm *sm,
 		       "HTTP/1.1 200 OK\r\n"
 		       "Content-Type: text/xml; charset=\"utf-8\"\r\n");
 	wpabuf_put_str(buf, "Server: Unspecified, UPnP/1.0, Unspecified\r\n");
-	wpabuf_put_str(buf, "Connection: close\r\n");
+	http_put_connection(buf, hreq);
 	wpabuf_put_str(buf, "Content-Length: ");
 	/*
 	 * We will paste the length in later, leaving some extra whitespace.
@@ -715,8 +725,7 @@ static void web_connection_send_reply(struct http_request *req,
 
 	/*
 	 * Assuming we will be successful, put in the output header first.
-	 * Note: we do not keep connections alive (and httpread does
-	 * not support it)... therefore we must have Connection: close.
+	 * Connection: close is needed unless the connection is kept alive.
 	 */
 	if (ret == HTTP_OK) {
 		wpabuf_put_str(buf,
@@ -726,7 +735,7 @@ static void web_connection_send_reply(struct http_request *req,
 	} else {
 		wpabuf_printf(buf, "HTTP/1.1 %d Error\r\n", ret);
 	}
-	wpabuf_put_str(buf, http_connection_close);
+	http_put_connection(buf, req);
 
 	wpabuf_put_str(buf, "Content-Length: ");
 	/*
@@ -840,8 +849,8 @@ static const char * web_get_action(struct http_request *req,
  * Date: <rfc1123-date>
  *
  * Header lines must end with \r\n
- * Per RFC 2616, content-length: is not required but connection:close
- * would appear to be required (given that we will be closing it!).
+ * Connection: close is left out if the connection is kept alive (HTTP/1.1
+ * client did not ask for the connection to be closed).
  */
 static void web_connection_parse_post(struct upnp_wps_device_sm *sm,
 				      struct sockaddr_in *cli,
@@ -905,8 +914,8 @@ bad:
  * Date: xxxx
  *
  * Header lines must end with \r\n
- * Per RFC 2616, content-length: is not required but connection:close
- * would appear to be required (given that we will be closing it!).
+ * Connection: close is left out if the connection is kept alive (HTTP/1.1
+ * client did not ask for the connection to be closed).
  */
 static void web_connection_parse_subscribe(struct upnp_wps_device_sm *sm,
 					   struct http_request *req,
@@ -1068,7 +1077,7 @@ static void web_connection_parse_subscribe(struct upnp_wps_device_sm *sm,
 	/* success */
 	http_put_reply_code(buf, HTTP_OK);
 	wpabuf_put_str(buf, http_server_hdr);
-	wpabuf_put_str(buf, http_connection_close);
+	http_put_connection(buf, req);
 	wpabuf_put_str(buf, "Content-Length: 0\r\n");
 	wpabuf_put_str(buf, "SID: uuid:");
 	/* subscription id */
@@ -1109,7 +1118,7 @@ error:
 	*   599 Too many subscriptions (not a standard HTTP error)
 	*/
 	wpa_printf(MSG_DEBUG, "WPS UPnP: SUBSCRIBE failed - return %d", ret);
-	http_put_empty(buf, ret);
+	http_put_empty(buf, req, ret);
 	http_request_send_and_deinit(req, buf);
 	os_free(callback_urls);
 }
@@ -1127,8 +1136,8 @@ error:
  * Content-Length: 0
  *
  * Header lines must end with \r\n
- * Per RFC 2616, content-length: is not required but connection:close
- * would appear to be required (given that we will be closing it!).
+ * Connection: close is left out if the connection is kept alive (HTTP/1.1
+ * client did not ask for the connection to be closed).
  */
 static void web_connection_parse_unsubscribe(struct upnp_wps_device_sm *sm,
 					     struct http_request *req,
@@ -1227,7 +1236,7 @@ send_msg:
 		http_request_deinit(req);
 		return;
 	}
-	http_put_empty(buf, ret);
+	http_put_empty(buf, req, ret);
 	http_request_send_and_deinit(req, buf);
 }
 
@@ -1241,7 +1250,7 @@ static void web_connection_unimplemented(struct http_request *req)
 		http_request_deinit(req);
 		return;
 	}
-	http_put_empty(buf, HTTP_UNIMPLEMENTED);
+	http_put_empty(buf, req, HTTP_UNIMPLEMENTED);
 	http_request_send_and_deinit(req, buf);
 }
 
@@ -1319,6 +1328,8 @@ int web_listener_start(struct upnp_wps_device_sm *sm)
 		return -1;
 	}
 	sm->web_port = http_server_get_port(sm->web_srv);
+	http_server_set_max_connections(sm->web_srv, MAX_WEB_CONNECTIONS);
+	http_server_set_keep_alive(sm->web_srv, 1);
 
 	return 0;
 }
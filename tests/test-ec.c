@@ -0,0 +1,324 @@
+/*
+ * Test program for elliptic curve operations
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "crypto/crypto.h"
+
+#define EC_BENCH_ROUNDS 50
+
+struct ec_generator {
+	int group;
+	const char *x;
+	const char *y;
+} generators[] = {
+	{
+		19,
+		"6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0"
+		"f4a13945d898c296",
+		"4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ece"
+		"cbb6406837bf51f5"
+	},
+	{
+		20,
+		"aa87ca22be8b05378eb1c71ef320ad746e1d3b628ba79b98"
+		"59f741e082542a385502f25dbf55296c3a545e3872760ab7",
+		"3617de4a96262c6f5d9e98bf9292dc29f8f41dbd289a147c"
+		"e9da3113b5f0b8c00a60b1ce1d7e819d7a431d7c90ea0e5f"
+	},
+};
+
+/* k * G; the last two scalars are random values */
+struct ec_mul_test {
+	int group;
+	const char *k;
+	const char *x;
+	const char *y;
+} mul_tests[] = {
+	{
+		19,
+		"000000000000000000000000000000000000000000000000"
+		"0000000000000002",
+		"7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35"
+		"a60b48fc47669978",
+		"07775510db8ed040293d9ac69f7430dbba7dade63ce98229"
+		"9e04b79d227873d1"
+	},
+	{
+		19,
+		"ffffffff00000000ffffffffffffffffbce6faada7179e84"
+		"f3b9cac2fc632550",
+		"6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0"
+		"f4a13945d898c296",
+		"b01cbd1c01e58065711814b583f061e9d431cca994cea131"
+		"3449bf97c840ae0a"
+	},
+	{
+		19,
+		"56e03250e68ed9a1ce11399a66dbc205db44a7fc0d49c430"
+		"d40b358c6cd86da8",
+		"f9a910380a13b8040264e7182f6229c20fee17ea9b019ffb"
+		"51464a1dd94c1072",
+		"66a70c4627ef5029f93178042ab937990844a674f02009e9"
+		"a2d1190d700d4eb7"
+	},
+	{
+		19,
+		"c48827aa68db6d5d731fde5083538df99222f5db6382c7b6"
+		"d71f34b5c174433b",
+		"73ef383a13616a751e8c8d0983b43fccf809b2c04e6e76d3"
+		"256908a2aa72dddf",
+		"2b33632276ba02f9fcf87d413fd99247641f88a1dc69f9b4"
+		"170924e84c4719f8"
+	},
+	{
+		20,
+		"000000000000000000000000000000000000000000000000"
+		"000000000000000000000000000000000000000000000002",
+		"08d999057ba3d2d969260045c55b97f089025959a6f434d6"
+		"51d207d19fb96e9e4fe0e86ebe0e64f85b96a9c75295df61",
+		"8e80f1fa5b1b3cedb7bfe8dffd6dba74b275d875bc6cc43e"
+		"904e505f256ab4255ffd43e94d39e22d61501e700a940e80"
+	},
+	{
+		20,
+		"ffffffffffffffffffffffffffffffffffffffffffffffff"
+		"c7634d81f4372ddf581a0db248b0a77aecec196accc52972",
+		"aa87ca22be8b05378eb1c71ef320ad746e1d3b628ba79b98"
+		"59f741e082542a385502f25dbf55296c3a545e3872760ab7",
+		"c9e821b569d9d390a26167406d6d23d6070be242d765eb83"
+		"1625ceec4a0f473ef59f4e30e2817e6285bce2846f15f1a0"
+	},
+	{
+		20,
+		"5102595364cf0d771bfd7b510e37414ea80adf1fe600b495"
+		"44cae091c4175e8ff29da33d90b116d9bf3396ef8dda4ba1",
+		"0957278ce00c1acaa3c66d87ce7e78133fb3b8e0ad5db1b0"
+		"dcf905d1ea2a45301f3c395ea8f41ff33ceb8d58d13c7dc7",
+		"3bee3afa48da1a7044dffc20284b4472558df8920bdf7a4f"
+		"87cb14f3b16b7a577942df565c2307f33975a6525503cfe6"
+	},
+	{
+		20,
+		"4efa2e43b278343be307ed1ff1d1dd43238577b18ec195ba"
+		"774cd14ab36afa873e586e13d334eeb4c4e9e6ee14be21c3",
+		"dd59d01fb639ca4faeb53ae4335093c55361444fc3bd803d"
+		"7cc915ff043185c118b30410469e6a477736ee22205a73ce",
+		"57478aaa742aa6559219fec737cbed01e654b1e860ce421a"
+		"3fcbf948fd9898a6f454869c3444d2758cc724a599065c87"
+	},
+};
+
+
+static struct crypto_ec_point * ec_point_hex(struct crypto_ec *e,
+					     const char *x, const char *y)
+{
+	u8 buf[2 * 48];
+	size_t len = crypto_ec_prime_len(e);
+
+	if (os_strlen(x) != 2 * len || os_strlen(y) != 2 * len ||
+	    hexstr2bin(x, buf, len) < 0 || hexstr2bin(y, buf + len, len) < 0)
+		return NULL;
+	return crypto_ec_point_from_bin(e, buf);
+}
+
+
+static int ec_point_eq(struct crypto_ec *e, struct crypto_ec_point *a,
+		       struct crypto_ec_point *b)
+{
+	u8 abuf[2 * 48], bbuf[2 * 48];
+	size_t len = crypto_ec_prime_len(e);
+
+	return crypto_ec_point_to_bin(e, a, abuf, abuf + len) == 0 &&
+		crypto_ec_point_to_bin(e, b, bbuf, bbuf + len) == 0 &&
+		os_memcmp(abuf, bbuf, 2 * len) == 0;
+}
+
+
+static int test_ec_mul(struct crypto_ec *e, struct crypto_ec_point *g,
+		       struct ec_mul_test *t)
+{
+	struct crypto_ec_point *expected, *res, *dbl, *tmp;
+	struct crypto_bignum *k, *two;
+	u8 buf[48], y[48], two_bin = 2;
+	size_t len = crypto_ec_prime_len(e);
+	int ok;
+
+	if (hexstr2bin(t->k, buf, len) < 0)
+		return -1;
+	k = crypto_bignum_init_set(buf, len);
+	two = crypto_bignum_init_set(&two_bin, 1);
+	expected = ec_point_hex(e, t->x, t->y);
+	res = crypto_ec_point_init(e);
+	dbl = crypto_ec_point_init(e);
+	tmp = crypto_ec_point_init(e);
+	if (k == NULL || two == NULL || expected == NULL || res == NULL ||
+	    dbl == NULL || tmp == NULL) {
+		ok = 0;
+		goto done;
+	}
+
+	ok = crypto_ec_point_is_on_curve(e, expected) &&
+		crypto_ec_point_mul(e, g, k, res) == 0 &&
+		ec_point_eq(e, res, expected);
+
+	/* Point doubling through addition: 2 * (k * G) = k * (2 * G) */
+	ok = ok &&
+		crypto_ec_point_add(e, res, res, dbl) == 0 &&
+		crypto_ec_point_mul(e, g, two, tmp) == 0 &&
+		crypto_ec_point_mul(e, tmp, k, tmp) == 0 &&
+		ec_point_eq(e, dbl, tmp);
+
+	/* k * G + (-k * G) is the point at infinity and adding it does not
+	 * change a point */
+	ok = ok &&
+		crypto_ec_point_mul(e, g, k, tmp) == 0 &&
+		crypto_ec_point_invert(e, tmp) == 0 &&
+		crypto_ec_point_add(e, res, tmp, tmp) == 0 &&
+		crypto_ec_point_is_at_infinity(e, tmp) &&
+		crypto_ec_point_add(e, res, tmp, tmp) == 0 &&
+		ec_point_eq(e, res, tmp);
+
+	/* Recover the point from the x coordinate and the y-bit */
+	crypto_bignum_deinit(k, 1);
+	k = NULL;
+	ok = ok &&
+		crypto_ec_point_to_bin(e, res, buf, y) == 0 &&
+		(k = crypto_bignum_init_set(buf, len)) != NULL &&
+		crypto_ec_point_solve_y_coord(e, tmp, k, y[len - 1] & 1) == 0 &&
+		ec_point_eq(e, res, tmp);
+
+done:
+	crypto_bignum_deinit(k, 1);
+	crypto_bignum_deinit(two, 0);
+	crypto_ec_point_deinit(expected, 0);
+	crypto_ec_point_deinit(res, 1);
+	crypto_ec_point_deinit(dbl, 1);
+	crypto_ec_point_deinit(tmp, 1);
+	return ok ? 0 : -1;
+}
+
+
+/* Scalars that are not smaller than the group order */
+static int test_ec_reduce(struct crypto_ec *e, struct crypto_ec_point *g)
+{
+	struct crypto_bignum *one, *k, *r;
+	struct crypto_ec_point *p1, *p2;
+	u8 buf[48 + 1], one_bin = 1;
+	size_t len = crypto_ec_prime_len(e);
+	int ok;
+
+	/* 2^(8 * len) is longer than the prime */
+	os_memset(buf, 0, sizeof(buf));
+	buf[0] = 1;
+	one = crypto_bignum_init_set(&one_bin, 1);
+	k = crypto_bignum_init();
+	r = crypto_bignum_init_set(buf, len + 1);
+	p1 = crypto_ec_point_init(e);
+	p2 = crypto_ec_point_init(e);
+
+	/* (order + 1) * G = G */
+	ok = one && k && r && p1 && p2 &&
+		crypto_bignum_add(crypto_ec_get_order(e), one, k) == 0 &&
+		crypto_ec_point_mul(e, g, k, p1) == 0 &&
+		ec_point_eq(e, p1, g);
+
+	/* k * G = (k mod order) * G */
+	ok = ok &&
+		crypto_ec_point_mul(e, g, r, p1) == 0 &&
+		crypto_bignum_mod(r, crypto_ec_get_order(e), k) == 0 &&
+		crypto_ec_point_mul(e, g, k, p2) == 0 &&
+		ec_point_eq(e, p1, p2);
+
+	crypto_bignum_deinit(one, 0);
+	crypto_bignum_deinit(k, 1);
+	crypto_bignum_deinit(r, 1);
+	crypto_ec_point_deinit(p1, 1);
+	crypto_ec_point_deinit(p2, 1);
+	return ok ? 0 : -1;
+}
+
+
+static int test_ec_group(struct ec_generator *gen)
+{
+	struct crypto_ec *e;
+	struct crypto_ec_point *g, *res;
+	struct os_reltime start, end, diff;
+	unsigned int i;
+	int errors = 0;
+
+	e = crypto_ec_init(gen->group);
+	if (e == NULL) {
+		printf("EC group %d: not supported\n", gen->group);
+		return 1;
+	}
+
+	g = ec_point_hex(e, gen->x, gen->y);
+	res = crypto_ec_point_init(e);
+	if (g == NULL || res == NULL || !crypto_ec_point_is_on_curve(e, g)) {
+		printf("EC group %d: invalid generator\n", gen->group);
+		errors++;
+		goto done;
+	}
+
+	for (i = 0; i < sizeof(mul_tests) / sizeof(mul_tests[0]); i++) {
+		if (mul_tests[i].group != gen->group)
+			continue;
+		printf("EC group %d test case %u:", gen->group, i + 1);
+		if (test_ec_mul(e, g, &mul_tests[i]) < 0) {
+			printf(" FAIL\n");
+			errors++;
+		} else
+			printf(" OK\n");
+	}
+
+	/* order * G is the point at infinity */
+	if (crypto_ec_point_mul(e, g, crypto_ec_get_order(e), res) < 0 ||
+	    !crypto_ec_point_is_at_infinity(e, res)) {
+		printf("EC group %d: order * G not at infinity\n", gen->group);
+		errors++;
+	}
+	if (test_ec_reduce(e, g) < 0) {
+		printf("EC group %d: scalar reduction failed\n", gen->group);
+		errors++;
+	}
+
+	os_get_reltime(&start);
+	for (i = 0; i < EC_BENCH_ROUNDS; i++) {
+		if (crypto_ec_point_mul(e, g, crypto_ec_get_prime(e), res) < 0)
+			errors++;
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("EC group %d: %.3f ms per point multiplication\n", gen->group,
+	       (diff.sec * 1000.0 + diff.usec / 1000.0) / EC_BENCH_ROUNDS);
+
+done:
+	crypto_ec_point_deinit(g, 0);
+	crypto_ec_point_deinit(res, 0);
+	crypto_ec_deinit(e);
+	return errors;
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int errors = 0;
+
+	for (i = 0; i < sizeof(generators) / sizeof(generators[0]); i++)
+		errors += test_ec_group(&generators[i]);
+
+	if (errors) {
+		printf("%d test(s) failed\n", errors);
+		return -1;
+	}
+
+	return 0;
+}
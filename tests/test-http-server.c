@@ -0,0 +1,302 @@
+/*
+ * HTTP server benchmark using WPS UPnP SOAP requests
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Client processes send SOAP POST requests of the kind an External Registrar
+ * sends to the WPS UPnP control URL and the server answers them through the
+ * same http_server/httpread path that is used for web_connection_parse_post().
+ */
+
+#include "utils/includes.h"
+#include <sys/wait.h>
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "wps/httpread.h"
+#include "wps/http_server.h"
+
+
+static const char *soap_request =
+"<?xml version=\"1.0\"?>\n"
+"<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+"s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">\n"
+"<s:Body>\n"
+"<u:PutMessage xmlns:u=\"urn:schemas-wifialliance-org:service:"
+"WFAWLANConfig:1\">\n"
+"<NewInMessage>EEoAARAQIgABBBBHABB4cDjJ/mmt7ykhjIxFyuQQEAAGAAEBBhBAAGAAU"
+"RcikgEMGhgEtUMzAVDhHq53EQsQzVVsc7ubyQ8Nu7H5KqN2xM4Ga5ymX8IR0Wn26i1IDZ2"
+"X6WBbIQkOBQXn5gwJX5qAQ2I63MYBRDSKgwXXBfeqvcPlEYmdoEUsQEAJAAIQEhAADAAIA"
+"BBAIAAIAhBBUAAgQEBAQAAIAAxAIAAIQAQIEAAIAAQg=</NewInMessage>\n"
+"</u:PutMessage>\n"
+"</s:Body>\n"
+"</s:Envelope>\n";
+
+static const char *soap_response =
+"<?xml version=\"1.0\"?>\n"
+"<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+"s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">\n"
+"<s:Body>\n"
+"<u:PutMessageResponse xmlns:u=\"urn:schemas-wifialliance-org:service:"
+"WFAWLANConfig:1\">\n"
+"<NewOutMessage>EEoAARAQIgABBRA5ABB4cDjJ/mmt7ykhjIxFyuQQEAAG</NewOutMessage>\n"
+"</u:PutMessageResponse>\n"
+"</s:Body>\n"
+"</s:Envelope>\n";
+
+struct bench {
+	unsigned long requests;
+	unsigned long errors;
+	int clients;
+};
+
+
+static void bench_http_req(void *ctx, struct http_request *req)
+{
+	struct bench *b = ctx;
+	char *action = http_request_get_hdr_line(req, "SOAPACTION:");
+	char *data = http_request_get_data(req);
+	struct wpabuf *buf;
+	int ok;
+
+	ok = http_request_get_type(req) == HTTPREAD_HDR_TYPE_POST &&
+		action && os_strstr(action, "#PutMessage") &&
+		os_strstr(data, "<NewInMessage>");
+	if (ok)
+		b->requests++;
+	else
+		b->errors++;
+
+	buf = wpabuf_alloc(500 + os_strlen(soap_response));
+	if (buf == NULL) {
+		http_request_deinit(req);
+		return;
+	}
+	wpabuf_printf(buf, "HTTP/1.1 %s\r\n"
+		      "Content-Type: text/xml; charset=\"utf-8\"\r\n"
+		      "%s"
+		      "Content-Length: %d\r\n"
+		      "\r\n",
+		      ok ? "200 OK" : "401 Error",
+		      http_request_keep_alive(req) ? "" :
+		      "Connection: close\r\n",
+		      ok ? (int) os_strlen(soap_response) : 0);
+	if (ok)
+		wpabuf_put_str(buf, soap_response);
+	http_request_send_and_deinit(req, buf);
+}
+
+
+static int client_connect(int port)
+{
+	struct sockaddr_in addr;
+	int s;
+
+	s = socket(AF_INET, SOCK_STREAM, 0);
+	if (s < 0)
+		return -1;
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if (connect(s, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		close(s);
+		return -1;
+	}
+	return s;
+}
+
+
+/* Read one response; returns 1 if the server keeps the connection open */
+static int client_read_response(int s)
+{
+	char buf[2048], *hdr_end, *pos;
+	int len = 0, res, content_length = 0;
+
+	for (;;) {
+		res = recv(s, buf + len, sizeof(buf) - 1 - len, 0);
+		if (res <= 0)
+			return -1;
+		len += res;
+		buf[len] = '\0';
+		hdr_end = os_strstr(buf, "\r\n\r\n");
+		if (hdr_end == NULL) {
+			if (len == sizeof(buf) - 1)
+				return -1;
+			continue;
+		}
+		pos = os_strstr(buf, "Content-Length:");
+		if (pos && pos < hdr_end)
+			content_length = atoi(pos + 15);
+		if (hdr_end + 4 + content_length <= buf + len)
+			break;
+		if (len == sizeof(buf) - 1)
+			return -1;
+	}
+
+	if (os_strncmp(buf, "HTTP/1.1 200 ", 13) != 0)
+		return -1;
+	pos = os_strstr(buf, "Connection: close");
+	return pos == NULL || pos > hdr_end;
+}
+
+
+static int client_run(int port, int requests, int keep_alive)
+{
+	char req[2000];
+	int s = -1, i, len, res, reused = 0;
+
+	len = os_snprintf(req, sizeof(req),
+			  "POST /wps_control HTTP/1.1\r\n"
+			  "Host: 127.0.0.1:%d\r\n"
+			  "Content-Type: text/xml; charset=\"utf-8\"\r\n"
+			  "SOAPACTION: \"urn:schemas-wifialliance-org:"
+			  "service:WFAWLANConfig:1#PutMessage\"\r\n"
+			  "%s"
+			  "Content-Length: %d\r\n"
+			  "\r\n%s",
+			  port, keep_alive ? "" : "Connection: close\r\n",
+			  (int) os_strlen(soap_request), soap_request);
+	if (len < 0 || len >= (int) sizeof(req))
+		return -1;
+
+	for (i = 0; i < requests; i++) {
+		if (s < 0) {
+			s = client_connect(port);
+			if (s < 0)
+				return -1;
+			reused = 0;
+		}
+		res = send(s, req, len, 0) == len ? client_read_response(s) :
+			-1;
+		if (res < 0 && reused) {
+			/* Server may close an idle connection at any time;
+			 * retry the request on a new connection */
+			close(s);
+			s = -1;
+			i--;
+			continue;
+		}
+		if (res < 0)
+			return -1;
+		if (res == 0) {
+			close(s);
+			s = -1;
+		} else
+			reused = 1;
+	}
+
+	if (s >= 0)
+		close(s);
+	return 0;
+}
+
+
+static void bench_child_exited(int sig, void *signal_ctx)
+{
+	struct bench *b = signal_ctx;
+	int status;
+
+	while (waitpid(-1, &status, WNOHANG) > 0) {
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			b->errors++;
+		if (--b->clients == 0)
+			eloop_terminate();
+	}
+}
+
+
+static void usage(void)
+{
+	printf("usage: test-http-server [-c<clients>] [-n<requests>] "
+	       "[-m<max connections>] [-k]\n"
+	       "  -c = number of concurrent clients (default 10)\n"
+	       "  -n = number of requests per client (default 1000)\n"
+	       "  -m = server connection limit (default 10)\n"
+	       "  -k = close connection after each request\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct http_server *srv;
+	struct in_addr addr;
+	struct bench b;
+	struct os_reltime start, end, diff;
+	int clients = 10, requests = 1000, max_conn = 10, keep_alive = 1;
+	int c, i, port;
+	double secs;
+
+	for (;;) {
+		c = getopt(argc, argv, "c:hkm:n:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'c':
+			clients = atoi(optarg);
+			break;
+		case 'k':
+			keep_alive = 0;
+			break;
+		case 'm':
+			max_conn = atoi(optarg);
+			break;
+		case 'n':
+			requests = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+	if (clients <= 0 || requests <= 0 || max_conn <= 0) {
+		usage();
+		return -1;
+	}
+
+	if (eloop_init())
+		return -1;
+
+	os_memset(&b, 0, sizeof(b));
+	addr.s_addr = htonl(INADDR_LOOPBACK);
+	srv = http_server_init(&addr, -1, bench_http_req, &b);
+	if (srv == NULL) {
+		eloop_destroy();
+		return -1;
+	}
+	http_server_set_max_connections(srv, max_conn);
+	http_server_set_keep_alive(srv, 1);
+	port = http_server_get_port(srv);
+
+	eloop_register_signal(SIGCHLD, bench_child_exited, &b);
+	os_get_reltime(&start);
+	for (i = 0; i < clients; i++) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			break;
+		}
+		if (pid == 0)
+			exit(client_run(port, requests, keep_alive) < 0);
+		b.clients++;
+	}
+
+	if (b.clients)
+		eloop_run();
+	os_get_reltime(&end);
+
+	http_server_deinit(srv);
+	eloop_destroy();
+
+	os_reltime_sub(&end, &start, &diff);
+	secs = diff.sec + diff.usec / 1000000.0;
+	printf("%lu requests (%lu errors) from %d clients in %.3f s: "
+	       "%.0f requests/s (%s)\n",
+	       b.requests, b.errors, clients, secs,
+	       secs > 0 ? b.requests / secs : 0.0,
+	       keep_alive ? "keep-alive" : "connection per request");
+
+	return b.errors ? -1 : 0;
+}
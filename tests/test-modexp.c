@@ -0,0 +1,230 @@
+/*
+ * Modular exponentiation benchmark for the internal bignum implementation
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Measures the operations that dominate EAP-TLS server and WPS latency when
+ * the internal crypto implementation is used: DH group 5 key generation and
+ * shared secret derivation and, if a key is given, RSA private and public
+ * key operations. An RSA key can be generated with
+ * openssl genrsa 2048 | openssl rsa -outform DER -out rsa2048.der
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "crypto/crypto.h"
+#include "crypto/dh_groups.h"
+#include "tls/rsa.h"
+
+#define BENCH_MIN_TIME 2
+
+
+struct bench_dh {
+	const struct dh_group *dh;
+	struct wpabuf *peer;
+};
+
+struct bench_rsa {
+	struct crypto_rsa_key *key;
+	u8 in[512], out[512];
+	size_t len;
+};
+
+
+static int bench_dh_init(void *ctx)
+{
+	struct bench_dh *b = ctx;
+	struct wpabuf *priv = NULL, *pub;
+
+	pub = dh_init(b->dh, &priv);
+	wpabuf_free(pub);
+	wpabuf_free(priv);
+	return pub ? 0 : -1;
+}
+
+
+static int bench_dh_derive(void *ctx)
+{
+	struct bench_dh *b = ctx;
+	struct wpabuf *priv = NULL, *pub, *shared;
+
+	/* dh_init() is needed for a fresh private key; subtract the result of
+	 * the dh_init benchmark to get the cost of the derivation alone */
+	pub = dh_init(b->dh, &priv);
+	if (pub == NULL)
+		return -1;
+	shared = dh_derive_shared(b->peer, priv, b->dh);
+	wpabuf_free(pub);
+	wpabuf_free(priv);
+	if (shared == NULL)
+		return -1;
+	wpabuf_free(shared);
+	return 0;
+}
+
+
+static int bench_rsa_private(void *ctx)
+{
+	struct bench_rsa *b = ctx;
+	size_t outlen = sizeof(b->out);
+
+	return crypto_rsa_exptmod(b->in, b->len, b->out, &outlen, b->key, 1);
+}
+
+
+static int bench_rsa_public(void *ctx)
+{
+	struct bench_rsa *b = ctx;
+	size_t outlen = sizeof(b->out);
+
+	return crypto_rsa_exptmod(b->in, b->len, b->out, &outlen, b->key, 0);
+}
+
+
+static int bench_rsa_check(struct bench_rsa *b)
+{
+	u8 tmp[512];
+	size_t tmplen = sizeof(tmp), outlen = sizeof(b->out);
+
+	if (crypto_rsa_exptmod(b->in, b->len, tmp, &tmplen, b->key, 1) < 0 ||
+	    crypto_rsa_exptmod(tmp, tmplen, b->out, &outlen, b->key, 0) < 0 ||
+	    outlen != b->len || os_memcmp(b->in, b->out, b->len) != 0) {
+		printf("RSA private/public key operation mismatch\n");
+		return -1;
+	}
+	return 0;
+}
+
+
+static int bench_run(const char *name, int (*op)(void *ctx), void *ctx)
+{
+	struct os_reltime start, now, diff;
+	unsigned int count = 0;
+	double secs;
+
+	os_get_reltime(&start);
+	do {
+		if (op(ctx) < 0) {
+			printf("%s: operation failed\n", name);
+			return -1;
+		}
+		count++;
+		os_get_reltime(&now);
+		os_reltime_sub(&now, &start, &diff);
+	} while (diff.sec < BENCH_MIN_TIME);
+
+	secs = diff.sec + diff.usec / 1000000.0;
+	printf("%-16s %6u ops in %.3f s: %9.2f ops/s %9.3f ms/op\n",
+	       name, count, secs, count / secs, secs * 1000.0 / count);
+	return 0;
+}
+
+
+static int bench_rsa(const char *fname)
+{
+	struct bench_rsa b;
+	char *buf;
+	size_t len, modlen;
+	int ret = -1;
+
+	buf = os_readfile(fname, &len);
+	if (buf == NULL) {
+		printf("Could not read '%s'\n", fname);
+		return -1;
+	}
+	os_memset(&b, 0, sizeof(b));
+	b.key = crypto_rsa_import_private_key((u8 *) buf, len);
+	os_free(buf);
+	if (b.key == NULL) {
+		printf("Could not parse RSA private key (PKCS #1 DER) from "
+		       "'%s'\n", fname);
+		return -1;
+	}
+
+	modlen = crypto_rsa_get_modulus_len(b.key);
+	if (modlen > sizeof(b.in) || modlen < 2) {
+		crypto_rsa_free(b.key);
+		return -1;
+	}
+	b.len = modlen;
+	/* Input value needs to be smaller than the modulus */
+	if (os_get_random(b.in + 1, modlen - 1) == 0 &&
+	    bench_rsa_check(&b) == 0) {
+		printf("RSA-%u\n", (unsigned int) modlen * 8);
+		if (bench_run("rsa private", bench_rsa_private, &b) == 0 &&
+		    bench_run("rsa public", bench_rsa_public, &b) == 0)
+			ret = 0;
+	}
+
+	crypto_rsa_free(b.key);
+	return ret;
+}
+
+
+static int bench_dh(int group)
+{
+	struct bench_dh b;
+	struct wpabuf *priv = NULL;
+	int ret = -1;
+
+	b.dh = dh_groups_get(group);
+	if (b.dh == NULL) {
+		printf("DH group %d not supported\n", group);
+		return -1;
+	}
+	b.peer = dh_init(b.dh, &priv);
+	wpabuf_free(priv);
+	if (b.peer == NULL)
+		return -1;
+
+	printf("DH group %d (%u-bit prime)\n", group,
+	       (unsigned int) b.dh->prime_len * 8);
+	if (bench_run("dh init", bench_dh_init, &b) == 0 &&
+	    bench_run("dh init+derive", bench_dh_derive, &b) == 0)
+		ret = 0;
+
+	wpabuf_free(b.peer);
+	return ret;
+}
+
+
+static void usage(void)
+{
+	printf("usage: test-modexp [-g<DH group>] [-k<RSA private key DER "
+	       "file>]\n"
+	       "  -g = DH group to benchmark (default 5)\n"
+	       "  -k = also benchmark RSA operations with the given key\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	const char *key = NULL;
+	int group = 5, c, ret;
+
+	for (;;) {
+		c = getopt(argc, argv, "g:hk:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'g':
+			group = atoi(optarg);
+			break;
+		case 'k':
+			key = optarg;
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	ret = bench_dh(group);
+	if (key && bench_rsa(key) < 0)
+		ret = -1;
+
+	return ret;
+}
@@ -0,0 +1,147 @@
+/*
+ * Test program for the TLSv1 server session cache
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "tls/tlsv1_server_cache.h"
+
+#define CACHE_FILE "test-tls-cache.tmp"
+
+static int errors;
+
+
+static void check(int ok, const char *name)
+{
+	printf("%s: %s\n", name, ok ? "OK" : "FAIL");
+	if (!ok)
+		errors++;
+}
+
+
+static void test_session(struct tlsv1_server_session *sess, u8 id)
+{
+	os_memset(sess, 0, sizeof(*sess));
+	os_memset(sess->session_id, id, 32);
+	sess->session_id_len = 32;
+	os_memset(sess->master_secret, id ^ 0x5a, TLS_MASTER_SECRET_LEN);
+	sess->tls_version = 0x0301;
+	sess->cipher_suite = 0x002f;
+	os_memcpy(sess->context, "test", 4);
+	sess->context_len = 4;
+}
+
+
+static int session_eq(const struct tlsv1_server_session *a,
+		      const struct tlsv1_server_session *b)
+{
+	return os_memcmp(a->master_secret, b->master_secret,
+			 TLS_MASTER_SECRET_LEN) == 0 &&
+		a->tls_version == b->tls_version &&
+		a->cipher_suite == b->cipher_suite &&
+		a->context_len == b->context_len &&
+		os_memcmp(a->context, b->context, a->context_len) == 0;
+}
+
+
+static int ticket_ok(struct tlsv1_server_cache *cache, const u8 *ticket,
+		     size_t ticket_len, const struct tlsv1_server_session *sess)
+{
+	struct tlsv1_server_session res;
+
+	return tlsv1_server_cache_ticket_decrypt(cache, ticket, ticket_len,
+						 &res) == 0 &&
+		session_eq(&res, sess);
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct tlsv1_server_cache *cache;
+	struct tlsv1_server_session sess1, sess2, res;
+	u8 *ticket, *tampered;
+	size_t ticket_len, i;
+	u32 hint;
+
+	if (eloop_init())
+		return -1;
+	unlink(CACHE_FILE);
+
+	/* Lifetime of one second so that expiration can be tested */
+	cache = tlsv1_server_cache_init(16, 1, 1, CACHE_FILE);
+	if (cache == NULL) {
+		printf("Failed to initialize session cache\n");
+		return -1;
+	}
+
+	test_session(&sess1, 1);
+	test_session(&sess2, 2);
+	tlsv1_server_cache_add(cache, &sess1);
+	tlsv1_server_cache_add(cache, &sess2);
+	check(tlsv1_server_cache_get(cache, sess1.session_id,
+				     sess1.session_id_len, &res) == 0 &&
+	      session_eq(&res, &sess1), "session ID lookup");
+
+	ticket = tlsv1_server_cache_ticket_encrypt(cache, &sess2, &ticket_len,
+						   &hint);
+	check(ticket != NULL && hint == 1 &&
+	      ticket_ok(cache, ticket, ticket_len, &sess2),
+	      "ticket round trip");
+	if (ticket == NULL)
+		return -1;
+
+	/* Any modification of the ticket must be detected */
+	tampered = os_malloc(ticket_len);
+	if (tampered == NULL)
+		return -1;
+	for (i = 0; i < ticket_len; i += 7) {
+		os_memcpy(tampered, ticket, ticket_len);
+		tampered[i] ^= 0x01;
+		if (ticket_ok(cache, tampered, ticket_len, &sess2))
+			break;
+	}
+	check(i >= ticket_len &&
+	      !ticket_ok(cache, ticket, ticket_len - 1, &sess2),
+	      "tampered ticket rejected");
+	os_free(tampered);
+
+	/* Sessions and ticket keys are saved when the cache is deinitialized
+	 * and restored from the file */
+	tlsv1_server_cache_deinit(cache);
+	cache = tlsv1_server_cache_init(16, 1, 1, CACHE_FILE);
+	check(cache &&
+	      tlsv1_server_cache_get(cache, sess1.session_id,
+				     sess1.session_id_len, &res) == 0 &&
+	      session_eq(&res, &sess1) &&
+	      tlsv1_server_cache_get(cache, sess2.session_id,
+				     sess2.session_id_len, &res) == 0 &&
+	      session_eq(&res, &sess2), "sessions restored from file");
+	check(cache && ticket_ok(cache, ticket, ticket_len, &sess2),
+	      "ticket accepted after restart");
+
+	os_sleep(2, 0);
+	check(cache && !ticket_ok(cache, ticket, ticket_len, &sess2),
+	      "expired ticket rejected");
+	check(cache &&
+	      tlsv1_server_cache_get(cache, sess1.session_id,
+				     sess1.session_id_len, &res) < 0,
+	      "expired session rejected");
+
+	os_free(ticket);
+	tlsv1_server_cache_deinit(cache);
+	eloop_destroy();
+	unlink(CACHE_FILE);
+
+	if (errors) {
+		printf("%d test(s) failed\n", errors);
+		return -1;
+	}
+
+	return 0;
+}
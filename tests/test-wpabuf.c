@@ -0,0 +1,160 @@
+/*
+ * Dynamic data buffer - test program
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/wpabuf.h"
+
+
+static int test_slice(void)
+{
+	struct wpabuf *buf, *slice, *slice2;
+	struct wpabuf_stats before, after;
+	int ret = 0;
+
+	buf = wpabuf_alloc_copy("0123456789", 10);
+	if (buf == NULL)
+		return -1;
+
+	wpabuf_get_stats(&before);
+	slice = wpabuf_slice(buf, 2, 6);
+	slice2 = wpabuf_slice(slice, 1, 3);
+	wpabuf_get_stats(&after);
+	if (slice == NULL || slice2 == NULL ||
+	    after.copies != before.copies) {
+		printf("slice: unexpected copy\n");
+		ret = -1;
+		goto out;
+	}
+
+	if (wpabuf_slice(buf, 8, 3) != NULL) {
+		printf("slice: out of range slice accepted\n");
+		ret = -1;
+	}
+
+	/* Slices remain valid after the owner has dropped its reference */
+	wpabuf_free(buf);
+	buf = NULL;
+	if (wpabuf_len(slice) != 6 ||
+	    os_memcmp(wpabuf_head(slice), "234567", 6) != 0 ||
+	    wpabuf_len(slice2) != 3 ||
+	    os_memcmp(wpabuf_head(slice2), "345", 3) != 0) {
+		printf("slice: data mismatch\n");
+		ret = -1;
+	}
+
+	/* Resizing a slice gives it a copy of its own */
+	if (wpabuf_resize(&slice, 2) < 0) {
+		printf("slice: resize failed\n");
+		ret = -1;
+		goto out;
+	}
+	wpabuf_put_data(slice, "ab", 2);
+	if (os_memcmp(wpabuf_head(slice), "234567ab", 8) != 0 ||
+	    os_memcmp(wpabuf_head(slice2), "345", 3) != 0) {
+		printf("slice: resize mismatch\n");
+		ret = -1;
+	}
+
+out:
+	wpabuf_free(slice2);
+	wpabuf_free(slice);
+	wpabuf_free(buf);
+	return ret;
+}
+
+
+static int test_ref(void)
+{
+	struct wpabuf *buf, *ref;
+	int ret = 0;
+
+	buf = wpabuf_alloc(4);
+	if (buf == NULL)
+		return -1;
+	wpabuf_put_data(buf, "abcd", 4);
+	ref = wpabuf_ref(buf);
+
+	if (wpabuf_resize(&buf, 10) == 0) {
+		printf("ref: shared buffer resized\n");
+		ret = -1;
+	}
+
+	wpabuf_free(buf);
+	if (os_memcmp(wpabuf_head(ref), "abcd", 4) != 0) {
+		printf("ref: data mismatch\n");
+		ret = -1;
+	}
+	wpabuf_free(ref);
+
+	return ret;
+}
+
+
+static int test_chain(void)
+{
+	struct wpabuf_chain chain;
+	struct wpabuf *buf;
+	struct wpabuf_stats before, after;
+	int ret = 0;
+
+	wpabuf_chain_init(&chain);
+	wpabuf_chain_add(&chain, wpabuf_alloc_copy("cd", 2));
+	wpabuf_chain_add(&chain, NULL);
+	wpabuf_chain_add(&chain, wpabuf_alloc_copy("ef", 2));
+	wpabuf_chain_add_head(&chain, wpabuf_alloc_copy("ab", 2));
+
+	wpabuf_get_stats(&before);
+	buf = wpabuf_chain_flatten(&chain);
+	wpabuf_get_stats(&after);
+	if (buf == NULL || wpabuf_len(buf) != 6 ||
+	    os_memcmp(wpabuf_head(buf), "abcdef", 6) != 0) {
+		printf("chain: data mismatch\n");
+		ret = -1;
+	}
+	if (after.copies != before.copies + 1 ||
+	    after.copy_bytes != before.copy_bytes + 6) {
+		printf("chain: data copied more than once\n");
+		ret = -1;
+	}
+	wpabuf_free(buf);
+
+	wpabuf_chain_add(&chain, wpabuf_alloc_copy("x", 1));
+	buf = wpabuf_chain_flatten(&chain);
+	if (buf == NULL || wpabuf_len(buf) != 1) {
+		printf("chain: single buffer mismatch\n");
+		ret = -1;
+	}
+	wpabuf_free(buf);
+
+	if (wpabuf_chain_flatten(&chain) != NULL) {
+		printf("chain: empty chain returned data\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (test_slice() < 0)
+		ret = -1;
+	if (test_ref() < 0)
+		ret = -1;
+	if (test_chain() < 0)
+		ret = -1;
+
+	if (ret == 0)
+		printf("wpabuf tests passed\n");
+
+	return ret;
+}
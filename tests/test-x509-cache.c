@@ -0,0 +1,158 @@
+/*
+ * Test program for the X.509v3 certificate and signature caches
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "tls/x509v3.h"
+
+static int errors;
+
+/* Self-signed RSA/SHA-256 certificate "CN=x509 cache test", valid until the
+ * end of 2049 */
+static const u8 test_cert[] = {
+	0x30, 0x82, 0x01, 0xdc, 0x30, 0x82, 0x01, 0x45, 0xa0, 0x03, 0x02, 0x01,
+	0x02, 0x02, 0x01, 0x01, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86,
+	0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x30, 0x1a, 0x31, 0x18, 0x30,
+	0x16, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x0f, 0x78, 0x35, 0x30, 0x39,
+	0x20, 0x63, 0x61, 0x63, 0x68, 0x65, 0x20, 0x74, 0x65, 0x73, 0x74, 0x30,
+	0x1e, 0x17, 0x0d, 0x31, 0x33, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30, 0x30,
+	0x30, 0x30, 0x30, 0x5a, 0x17, 0x0d, 0x34, 0x39, 0x31, 0x32, 0x33, 0x31,
+	0x32, 0x33, 0x35, 0x39, 0x35, 0x39, 0x5a, 0x30, 0x1a, 0x31, 0x18, 0x30,
+	0x16, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x0f, 0x78, 0x35, 0x30, 0x39,
+	0x20, 0x63, 0x61, 0x63, 0x68, 0x65, 0x20, 0x74, 0x65, 0x73, 0x74, 0x30,
+	0x81, 0x9f, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d,
+	0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x81, 0x8d, 0x00, 0x30, 0x81, 0x89,
+	0x02, 0x81, 0x81, 0x00, 0x98, 0x61, 0x86, 0xce, 0x5e, 0x28, 0x8c, 0xd5,
+	0x4e, 0xde, 0xc3, 0x85, 0xeb, 0xa8, 0xe8, 0x47, 0x87, 0x94, 0x53, 0x95,
+	0x0d, 0xa1, 0x08, 0x7a, 0x72, 0xb8, 0x25, 0x7f, 0x1a, 0xc2, 0x0d, 0xa2,
+	0xd0, 0x3e, 0xdc, 0xc4, 0x41, 0x6c, 0xf7, 0x66, 0x57, 0x67, 0x3b, 0xc2,
+	0xe6, 0xc5, 0x6c, 0xa0, 0x8b, 0x65, 0xd1, 0xd4, 0xed, 0xa4, 0xe8, 0xd2,
+	0x59, 0xa3, 0xbb, 0x95, 0x44, 0x8d, 0x47, 0x77, 0x9e, 0x07, 0xd3, 0x69,
+	0x38, 0xd6, 0x96, 0x3f, 0x75, 0xb3, 0xb1, 0x2e, 0xd2, 0xbb, 0xa8, 0x8a,
+	0x7b, 0xe3, 0x3e, 0x61, 0x95, 0x97, 0xc9, 0x02, 0xb2, 0xdc, 0xd1, 0xb7,
+	0xca, 0x0f, 0xc4, 0x10, 0x74, 0xa7, 0xb6, 0xe5, 0xc7, 0xf0, 0x59, 0x84,
+	0xb4, 0xad, 0x68, 0x3f, 0x58, 0x6f, 0x5f, 0x6d, 0xcd, 0x9d, 0xc1, 0x72,
+	0xee, 0xd8, 0x7a, 0x7c, 0xeb, 0x12, 0x31, 0x33, 0x0a, 0x1d, 0x21, 0xb9,
+	0x02, 0x03, 0x01, 0x00, 0x01, 0xa3, 0x32, 0x30, 0x30, 0x30, 0x0f, 0x06,
+	0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff, 0x04, 0x05, 0x30, 0x03, 0x01,
+	0x01, 0xff, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04,
+	0x14, 0xd1, 0x13, 0xfa, 0x25, 0x9e, 0x55, 0x76, 0xa3, 0xd8, 0xbc, 0x6f,
+	0xa8, 0xd5, 0x91, 0x69, 0xdd, 0x1d, 0x41, 0xaa, 0x63, 0x30, 0x0d, 0x06,
+	0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00,
+	0x03, 0x81, 0x81, 0x00, 0x21, 0x39, 0x60, 0xfc, 0x4c, 0xd0, 0xfe, 0x56,
+	0x6f, 0xe1, 0x56, 0x01, 0x23, 0x87, 0x61, 0x3b, 0xcf, 0x90, 0x03, 0x86,
+	0x01, 0xfd, 0x8d, 0xdf, 0xf8, 0xcc, 0xbf, 0x62, 0x62, 0x27, 0x9e, 0xa6,
+	0x5f, 0xaa, 0x44, 0xfc, 0x60, 0x38, 0x6b, 0x64, 0xe9, 0xfd, 0x58, 0x87,
+	0x7a, 0x23, 0x8a, 0xa9, 0x5c, 0xf5, 0xc9, 0x22, 0x33, 0x07, 0x45, 0xc8,
+	0xc6, 0xf5, 0x45, 0xcd, 0xb6, 0xde, 0x4f, 0x0f, 0xb2, 0x80, 0xf4, 0x96,
+	0xff, 0x4f, 0xb8, 0xbb, 0x6d, 0x50, 0x00, 0xb2, 0xfb, 0x37, 0xfb, 0xa8,
+	0x4c, 0x6f, 0xf7, 0xd9, 0x9e, 0x78, 0x33, 0x80, 0x3d, 0x92, 0xf0, 0xd7,
+	0x31, 0x00, 0xd4, 0x36, 0x52, 0xc9, 0x8f, 0x7a, 0x56, 0x59, 0x69, 0xd9,
+	0x79, 0x62, 0x4d, 0x5b, 0x38, 0x8b, 0xd2, 0x4e, 0xc0, 0xf1, 0x33, 0xb1,
+	0x6a, 0xaa, 0x4c, 0x79, 0x92, 0x08, 0xfe, 0x29, 0x45, 0xe0, 0xa9, 0xd8,
+};
+
+
+static void check(int ok, const char *name)
+{
+	printf("%s: %s\n", name, ok ? "OK" : "FAIL");
+	if (!ok)
+		errors++;
+}
+
+
+static int cert_eq(struct x509_certificate *a, struct x509_certificate *b)
+{
+	return a->version == b->version &&
+		a->serial_number == b->serial_number &&
+		os_memcmp(&a->signature, &b->signature,
+			  sizeof(a->signature)) == 0 &&
+		x509_name_compare(&a->issuer, &b->issuer) == 0 &&
+		x509_name_compare(&a->subject, &b->subject) == 0 &&
+		a->not_before == b->not_before &&
+		a->not_after == b->not_after &&
+		os_memcmp(&a->public_key_alg, &b->public_key_alg,
+			  sizeof(a->public_key_alg)) == 0 &&
+		a->public_key_len == b->public_key_len &&
+		os_memcmp(a->public_key, b->public_key,
+			  a->public_key_len) == 0 &&
+		os_memcmp(&a->signature_alg, &b->signature_alg,
+			  sizeof(a->signature_alg)) == 0 &&
+		a->sign_value_len == b->sign_value_len &&
+		os_memcmp(a->sign_value, b->sign_value,
+			  a->sign_value_len) == 0 &&
+		a->extensions_present == b->extensions_present &&
+		a->ca == b->ca &&
+		a->path_len_constraint == b->path_len_constraint &&
+		a->key_usage == b->key_usage &&
+		a->cert_len == b->cert_len &&
+		os_memcmp(a->cert_start, b->cert_start, a->cert_len) == 0 &&
+		a->tbs_cert_start - a->cert_start ==
+		b->tbs_cert_start - b->cert_start &&
+		a->tbs_cert_len == b->tbs_cert_len;
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct x509_certificate *first, *cached, *fresh, *modified;
+	u8 buf[sizeof(test_cert)];
+	size_t i;
+
+	x509_certificate_cache_flush();
+	first = x509_certificate_parse(test_cert, sizeof(test_cert));
+	cached = x509_certificate_parse(test_cert, sizeof(test_cert));
+	check(first && cached && first != cached && cert_eq(first, cached),
+	      "cached parse matches first parse");
+	if (first == NULL || cached == NULL)
+		return -1;
+
+	/* The cached copy must not share any data with the first instance */
+	x509_certificate_free(first);
+	x509_certificate_cache_flush();
+	fresh = x509_certificate_parse(test_cert, sizeof(test_cert));
+	check(fresh && cert_eq(cached, fresh),
+	      "cached parse matches fresh parse");
+	if (fresh == NULL)
+		return -1;
+
+	check(x509_certificate_check_signature(fresh, cached) == 0,
+	      "signature verified");
+	check(x509_certificate_check_signature(fresh, cached) == 0,
+	      "cached signature verification");
+
+	/* Change one octet in the subject name; the last occurrence of the
+	 * name in the certificate is the subject, the first the issuer */
+	os_memcpy(buf, test_cert, sizeof(buf));
+	for (i = sizeof(buf) - 5; i > 0; i--) {
+		if (os_memcmp(buf + i, "x509 ", 5) == 0)
+			break;
+	}
+	buf[i] = 'y';
+	modified = x509_certificate_parse(buf, sizeof(buf));
+	check(modified &&
+	      x509_name_compare(&modified->subject, &fresh->subject) != 0 &&
+	      os_memcmp(modified->cert_start, buf, sizeof(buf)) == 0,
+	      "modified certificate not taken from the cache");
+	check(modified &&
+	      x509_certificate_check_signature(fresh, modified) < 0,
+	      "modified certificate signature rejected");
+
+	x509_certificate_free(modified);
+	x509_certificate_free(fresh);
+	x509_certificate_free(cached);
+	x509_certificate_cache_flush();
+
+	if (errors) {
+		printf("%d test(s) failed\n", errors);
+		return -1;
+	}
+
+	return 0;
+}
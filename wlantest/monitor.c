@@ -12,23 +12,37 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "drivers/linux_packet_ring.h"
 #include "wlantest.h"
 
 
+static void monitor_frame(void *ctx, u8 *buf, size_t len)
+{
+	struct wlantest *wt = ctx;
+
+	write_pcap_captured(wt, buf, len);
+	wlantest_process(wt, buf, len);
+}
+
+
 static void monitor_read(int sock, void *eloop_ctx, void *sock_ctx)
 {
 	struct wlantest *wt = eloop_ctx;
 	u8 buf[3000];
 	int len;
 
+	if (wt->monitor_ring) {
+		linux_packet_ring_read(wt->monitor_ring, monitor_frame, wt);
+		return;
+	}
+
 	len = recv(sock, buf, sizeof(buf), 0);
 	if (len < 0) {
 		wpa_printf(MSG_INFO, "recv(PACKET): %s", strerror(errno));
 		return;
 	}
 
-	write_pcap_captured(wt, buf, len);
-	wlantest_process(wt, buf, len);
+	monitor_frame(wt, buf, len);
 }
 
 
@@ -75,10 +89,14 @@ int monitor_init(struct wlantest *wt, const char *ifname)
 		return -1;
 	}
 
+	wt->monitor_ring = linux_packet_ring_init(wt->monitor_sock);
+
 	if (eloop_register_read_sock(wt->monitor_sock, monitor_read, wt, NULL))
 	{
 		wpa_printf(MSG_ERROR, "Could not register monitor read "
 			   "socket");
+		linux_packet_ring_deinit(wt->monitor_ring);
+		wt->monitor_ring = NULL;
 		close(wt->monitor_sock);
 		wt->monitor_sock = -1;
 		return -1;
@@ -132,6 +150,8 @@ void monitor_deinit(struct wlantest *wt)
 {
 	if (wt->monitor_sock >= 0) {
 		eloop_unregister_read_sock(wt->monitor_sock);
+		linux_packet_ring_deinit(wt->monitor_ring);
+		wt->monitor_ring = NULL;
 		close(wt->monitor_sock);
 		wt->monitor_sock = -1;
 	}
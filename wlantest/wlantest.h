@@ -17,6 +17,7 @@ struct ieee802_11_elems;
 struct radius_msg;
 struct ieee80211_hdr;
 struct wlantest_bss;
+struct linux_packet_ring;
 
 #define MAX_RADIUS_SECRET_LEN 128
 
@@ -151,6 +152,7 @@ struct wlantest_radius {
 
 struct wlantest {
 	int monitor_sock;
+	struct linux_packet_ring *monitor_ring;
 	int monitor_wired;
 
 	int ctrl_sock;
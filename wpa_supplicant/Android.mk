@@ -81,6 +81,7 @@ OBJS += eap_register.c
 OBJS += src/utils/common.c
 OBJS += src/utils/wpa_debug.c
 OBJS += src/utils/wpabuf.c
+OBJS += src/utils/mempool.c
 OBJS_p = wpa_passphrase.c
 OBJS_p += src/utils/common.c
 OBJS_p += src/utils/wpa_debug.c
@@ -184,6 +185,7 @@ L_CFLAGS += -DCONFIG_SAE
 OBJS += src/common/sae.c
 NEED_ECC=y
 NEED_DH_GROUPS=y
+NEED_MODEXP=y
 endif
 
 ifdef CONFIG_TDLS
@@ -974,6 +976,9 @@ OBJS += src/crypto/crypto_internal.c
 OBJS_p += src/crypto/crypto_internal.c
 NEED_AES_ENC=y
 L_CFLAGS += -DCONFIG_CRYPTO_INTERNAL
+ifdef NEED_ECC
+OBJS += src/crypto/crypto_internal-ec.c
+endif
 ifdef CONFIG_INTERNAL_LIBTOMMATH
 L_CFLAGS += -DCONFIG_INTERNAL_LIBTOMMATH
 ifdef CONFIG_INTERNAL_LIBTOMMATH_FAST
@@ -238,7 +238,7 @@ static void wpa_bss_copy_res(struct wpa_bss *dst, struct wpa_scan_res *src)
 	dst->level = src->level;
 	dst->tsf = src->tsf;
 
-	os_get_time(&dst->last_update);
+	os_get_reltime(&dst->last_update);
 	dst->last_update.sec -= src->age / 1000;
 	usec = (src->age % 1000) * 1000;
 	if (dst->last_update.usec < usec) {
@@ -544,6 +544,7 @@ void wpa_bss_update_start(struct wpa_supplicant *wpa_s)
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Start scan result update %u",
 		wpa_s->bss_update_idx);
 	wpa_s->last_scan_res_used = 0;
+	wpas_notify_bss_update_start(wpa_s);
 }
 
 
@@ -683,9 +684,12 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 	struct wpa_bss *bss, *n;
 
 	wpa_s->last_scan_full = 0;
-	os_get_time(&wpa_s->last_scan);
-	if (!new_scan)
-		return; /* do not expire entries without new scan */
+	os_get_reltime(&wpa_s->last_scan);
+	if (!new_scan) {
+		/* do not expire entries without new scan */
+		wpas_notify_bss_update_end(wpa_s);
+		return;
+	}
 
 	if (info && !info->aborted && !info->freqs) {
 		size_t i;
@@ -719,6 +723,9 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 		   "last_scan_full=%d",
 		   wpa_s->last_scan_res_used, wpa_s->last_scan_res_size,
 		   wpa_s->last_scan_full);
+
+	/* Send the property changes of all updated BSSs at once */
+	wpas_notify_bss_update_end(wpa_s);
 }
 
 
@@ -732,19 +739,19 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 void wpa_bss_flush_by_age(struct wpa_supplicant *wpa_s, int age)
 {
 	struct wpa_bss *bss, *n;
-	struct os_time t;
+	struct os_reltime t;
 
 	if (dl_list_empty(&wpa_s->bss))
 		return;
 
-	os_get_time(&t);
+	os_get_reltime(&t);
 	t.sec -= age;
 
 	dl_list_for_each_safe(bss, n, &wpa_s->bss, struct wpa_bss, list) {
 		if (wpa_bss_in_use(wpa_s, bss))
 			continue;
 
-		if (os_time_before(&bss->last_update, &t)) {
+		if (os_reltime_before(&bss->last_update, &t)) {
 			wpa_bss_remove(wpa_s, bss, __func__);
 		} else
 			break;
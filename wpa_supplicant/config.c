@@ -1806,6 +1806,8 @@ void wpa_config_free(struct wpa_config *config)
 	wpabuf_free(config->wps_nfc_dh_privkey);
 	wpabuf_free(config->wps_nfc_dev_pw);
 	os_free(config->ext_password_backend);
+	os_free(config->pmksa_cache_file);
+	os_free(config->pmksa_cache_key);
 	os_free(config->sae_groups);
 	os_free(config);
 }
@@ -2997,6 +2999,8 @@ static const struct global_parse_data global_fields[] = {
 	{ INT(p2p_go_max_inactivity), 0 },
 	{ INT_RANGE(auto_interworking, 0, 1), 0 },
 	{ INT(okc), 0 },
+	{ STR(pmksa_cache_file), 0 },
+	{ STR(pmksa_cache_key), 0 },
 	{ INT(pmf), 0 },
 	{ FUNC(sae_groups), 0 },
 };
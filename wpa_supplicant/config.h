@@ -800,6 +800,20 @@ struct wpa_config {
 	 */
 	int okc;
 
+	/**
+	 * pmksa_cache_file - File for saving PMKSA cache entries or %NULL
+	 *
+	 * PMKSA cache entries for IEEE 802.1X networks are saved into this
+	 * file so that they can be used after wpa_supplicant is restarted.
+	 * This requires pmksa_cache_key to be set.
+	 */
+	char *pmksa_cache_file;
+
+	/**
+	 * pmksa_cache_key - AES-SIV key (64 hex digits) for pmksa_cache_file
+	 */
+	char *pmksa_cache_key;
+
 	/**
 	 * pmf - Whether to enable/require PMF by default
 	 *
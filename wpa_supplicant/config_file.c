@@ -968,6 +968,10 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 			config->auto_interworking);
 	if (config->okc)
 		fprintf(f, "okc=%d\n", config->okc);
+	if (config->pmksa_cache_file)
+		fprintf(f, "pmksa_cache_file=%s\n", config->pmksa_cache_file);
+	if (config->pmksa_cache_key)
+		fprintf(f, "pmksa_cache_key=%s\n", config->pmksa_cache_key);
 	if (config->pmf)
 		fprintf(f, "pmf=%d\n", config->pmf);
 
@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/mempool.h"
 #include "common/version.h"
 #include "common/ieee802_11_defs.h"
 #include "common/ieee802_11_common.h"
@@ -1399,11 +1400,21 @@ static int wpa_supplicant_ctrl_iface_status(struct wpa_supplicant *wpa_s,
 
 #ifdef CONFIG_P2P
 	if (wpa_s->global->p2p) {
+		size_t peers, max_peers;
+
 		ret = os_snprintf(pos, end - pos, "p2p_device_address=" MACSTR
 				  "\n", MAC2STR(wpa_s->global->p2p_dev_addr));
 		if (ret < 0 || ret >= end - pos)
 			return pos - buf;
 		pos += ret;
+
+		peers = p2p_get_peer_count(wpa_s->global->p2p, &max_peers);
+		ret = os_snprintf(pos, end - pos, "p2p_peers=%u/%u\n",
+				  (unsigned int) peers,
+				  (unsigned int) max_peers);
+		if (ret < 0 || ret >= end - pos)
+			return pos - buf;
+		pos += ret;
 	}
 #endif /* CONFIG_P2P */
 
@@ -1570,45 +1581,6 @@ static int wpa_supplicant_ctrl_iface_blacklist(struct wpa_supplicant *wpa_s,
 extern int wpa_debug_level;
 extern int wpa_debug_timestamp;
 
-static const char * debug_level_str(int level)
-{
-	switch (level) {
-	case MSG_EXCESSIVE:
-		return "EXCESSIVE";
-	case MSG_MSGDUMP:
-		return "MSGDUMP";
-	case MSG_DEBUG:
-		return "DEBUG";
-	case MSG_INFO:
-		return "INFO";
-	case MSG_WARNING:
-		return "WARNING";
-	case MSG_ERROR:
-		return "ERROR";
-	default:
-		return "?";
-	}
-}
-
-
-static int str_to_debug_level(const char *s)
-{
-	if (os_strcasecmp(s, "EXCESSIVE") == 0)
-		return MSG_EXCESSIVE;
-	if (os_strcasecmp(s, "MSGDUMP") == 0)
-		return MSG_MSGDUMP;
-	if (os_strcasecmp(s, "DEBUG") == 0)
-		return MSG_DEBUG;
-	if (os_strcasecmp(s, "INFO") == 0)
-		return MSG_INFO;
-	if (os_strcasecmp(s, "WARNING") == 0)
-		return MSG_WARNING;
-	if (os_strcasecmp(s, "ERROR") == 0)
-		return MSG_ERROR;
-	return -1;
-}
-
-
 static int wpa_supplicant_ctrl_iface_log_level(struct wpa_supplicant *wpa_s,
 					       char *cmd, char *buf,
 					       size_t buflen)
@@ -1620,7 +1592,7 @@ static int wpa_supplicant_ctrl_iface_log_level(struct wpa_supplicant *wpa_s,
 		return -1;
 	}
 
-	/* cmd: "LOG_LEVEL [<level>]" */
+	/* cmd: "LOG_LEVEL [<level>]" or "LOG_LEVEL <module>=<level>" */
 	if (*cmd == '\0') {
 		pos = buf;
 		end = buf + buflen;
@@ -1629,14 +1601,23 @@ static int wpa_supplicant_ctrl_iface_log_level(struct wpa_supplicant *wpa_s,
 				  debug_level_str(wpa_debug_level),
 				  wpa_debug_timestamp);
 		if (ret < 0 || ret >= end - pos)
-			ret = 0;
+			return 0;
+		pos += ret;
+		pos += wpa_debug_module_levels(pos, end - pos);
 
-		return ret;
+		return pos - buf;
 	}
 
 	while (*cmd == ' ')
 		cmd++;
 
+	if (os_strchr(cmd, '=')) {
+		if (wpa_debug_set_module_level(cmd) < 0)
+			return -1;
+		os_memcpy(buf, "OK\n", 3);
+		return 3;
+	}
+
 	stamp = os_strchr(cmd, ' ');
 	if (stamp) {
 		*stamp++ = '\0';
@@ -2980,9 +2961,9 @@ static int print_bss_info(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	}
 
 	if (mask & WPA_BSS_MASK_AGE) {
-		struct os_time now;
+		struct os_reltime now;
 
-		os_get_time(&now);
+		os_get_reltime(&now);
 		ret = os_snprintf(pos, end - pos, "age=%d\n",
 				  (int) (now.sec - bss->last_update.sec));
 		if (ret < 0 || ret >= end - pos)
@@ -4657,6 +4638,33 @@ static int wpa_supplicant_ctrl_iface_sta_autoconnect(
 }
 
 
+static int wpa_supplicant_ctrl_iface_debug_ringbuf_dump(char *cmd,
+							char *buf,
+							size_t buflen)
+{
+	char *pos;
+	int len;
+
+	/* cmd: "" or "<max octets>" or "<offset> <max octets>" */
+	while (*cmd == ' ')
+		cmd++;
+
+	pos = os_strchr(cmd, ' ');
+	if (pos == NULL) {
+		len = atoi(cmd);
+		if (len < 0)
+			return -1;
+		return wpa_debug_ringbuf_get(buf, buflen, len);
+	}
+
+	len = atoi(pos + 1);
+	if (len <= 0)
+		return -1;
+	return wpa_debug_ringbuf_read(strtoull(cmd, NULL, 10), len, buf,
+				      buflen);
+}
+
+
 #ifdef CONFIG_AUTOSCAN
 
 static int wpa_supplicant_ctrl_iface_autoscan(struct wpa_supplicant *wpa_s,
@@ -4822,6 +4830,16 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
+	} else if (os_strcmp(buf, "DEBUG_RINGBUF") == 0) {
+		reply_len = wpa_debug_ringbuf_status(reply, reply_size);
+		if (reply_len == 0)
+			reply_len = -1;
+	} else if (os_strncmp(buf, "DEBUG_RINGBUF_DUMP", 18) == 0 &&
+		   (buf[18] == '\0' || buf[18] == ' ')) {
+		reply_len = wpa_supplicant_ctrl_iface_debug_ringbuf_dump(
+			buf + 18, reply, reply_size);
+	} else if (os_strcmp(buf, "MEMSTATS") == 0) {
+		reply_len = mempool_memstats(reply, reply_size);
 	} else if (os_strcmp(buf, "MIB") == 0) {
 		reply_len = wpa_sm_get_mib(wpa_s->wpa, reply, reply_size);
 		if (reply_len >= 0) {
@@ -319,6 +319,9 @@ struct wpas_dbus_priv * wpas_dbus_init(struct wpa_global *global)
 	if (priv == NULL)
 		return NULL;
 	priv->global = global;
+#ifdef CONFIG_CTRL_IFACE_DBUS_NEW
+	dl_list_init(&priv->prop_changed_batch);
+#endif /* CONFIG_CTRL_IFACE_DBUS_NEW */
 
 	if (wpas_dbus_init_common(priv) < 0) {
 		wpas_dbus_deinit(priv);
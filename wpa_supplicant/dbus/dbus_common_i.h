@@ -13,6 +13,8 @@
 
 #include <dbus/dbus.h>
 
+#include "utils/list.h"
+
 struct wpas_dbus_priv {
 	DBusConnection *con;
 	int should_dispatch;
@@ -20,6 +22,12 @@ struct wpas_dbus_priv {
 	u32 next_objid;
 	int dbus_new_initialized;
 
+#ifdef CONFIG_CTRL_IFACE_DBUS_NEW
+	/* Objects with changed properties to be sent at the end of a batch */
+	struct dl_list prop_changed_batch;
+	unsigned int prop_changed_batch_depth;
+#endif /* CONFIG_CTRL_IFACE_DBUS_NEW */
+
 #if defined(CONFIG_CTRL_IFACE_DBUS_NEW) && defined(CONFIG_AP)
 	int dbus_noc_refcnt;
 #endif /* CONFIG_CTRL_IFACE_DBUS_NEW && CONFIG_AP */
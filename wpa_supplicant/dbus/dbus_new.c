@@ -1826,6 +1826,29 @@ void wpas_dbus_bss_signal_prop_changed(struct wpa_supplicant *wpa_s,
 }
 
 
+/**
+ * wpas_dbus_bss_update_start - Start collecting BSS property changes
+ * @wpa_s: %wpa_supplicant network interface data
+ *
+ * BSS property changes are sent once wpas_dbus_bss_update_end() is called at
+ * the end of the BSS table update from scan results.
+ */
+void wpas_dbus_bss_update_start(struct wpa_supplicant *wpa_s)
+{
+	wpa_dbus_prop_changed_batch_start(wpa_s->global->dbus);
+}
+
+
+/**
+ * wpas_dbus_bss_update_end - Send BSS property changes
+ * @wpa_s: %wpa_supplicant network interface data
+ */
+void wpas_dbus_bss_update_end(struct wpa_supplicant *wpa_s)
+{
+	wpa_dbus_prop_changed_batch_end(wpa_s->global->dbus);
+}
+
+
 /**
  * wpas_dbus_signal_debug_level_changed - Signals change of debug param
  * @global: wpa_global structure
@@ -135,6 +135,8 @@ void wpas_dbus_signal_prop_changed(struct wpa_supplicant *wpa_s,
 void wpas_dbus_bss_signal_prop_changed(struct wpa_supplicant *wpa_s,
 				       enum wpas_dbus_bss_prop property,
 				       unsigned int id);
+void wpas_dbus_bss_update_start(struct wpa_supplicant *wpa_s);
+void wpas_dbus_bss_update_end(struct wpa_supplicant *wpa_s);
 void wpas_dbus_signal_network_enabled_changed(struct wpa_supplicant *wpa_s,
 					      struct wpa_ssid *ssid);
 void wpas_dbus_signal_network_selected(struct wpa_supplicant *wpa_s, int id);
@@ -248,6 +250,14 @@ static inline void wpas_dbus_bss_signal_prop_changed(
 {
 }
 
+static inline void wpas_dbus_bss_update_start(struct wpa_supplicant *wpa_s)
+{
+}
+
+static inline void wpas_dbus_bss_update_end(struct wpa_supplicant *wpa_s)
+{
+}
+
 static inline void wpas_dbus_signal_network_enabled_changed(
 	struct wpa_supplicant *wpa_s, struct wpa_ssid *ssid)
 {
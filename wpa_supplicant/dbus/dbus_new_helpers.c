@@ -441,6 +441,9 @@ void free_dbus_object_desc(struct wpa_dbus_object_desc *obj_dsc)
 	if (obj_dsc->user_data_free_func)
 		obj_dsc->user_data_free_func(obj_dsc->user_data);
 
+	if (obj_dsc->batch_list.next)
+		dl_list_del(&obj_dsc->batch_list);
+
 	os_free(obj_dsc->path);
 	os_free(obj_dsc->prop_changed_flags);
 	os_free(obj_dsc);
@@ -655,13 +658,84 @@ static dbus_bool_t put_changed_properties(
 }
 
 
-static void do_send_prop_changed_signal(
+/* Append a copy of the value at the current position of a read iterator */
+static dbus_bool_t copy_iter_value(DBusMessageIter *from, DBusMessageIter *to)
+{
+	DBusMessageIter sub_from, sub_to;
+	int type, elem;
+	char *sig = NULL;
+	const char *contained = NULL;
+	dbus_bool_t ret = FALSE;
+
+	type = dbus_message_iter_get_arg_type(from);
+	if (dbus_type_is_basic(type)) {
+		union {
+			dbus_uint64_t u64;
+			double d;
+			const char *str;
+		} val;
+
+		dbus_message_iter_get_basic(from, &val);
+		return dbus_message_iter_append_basic(to, type, &val);
+	}
+
+	dbus_message_iter_recurse(from, &sub_from);
+
+	if (type == DBUS_TYPE_ARRAY) {
+		elem = dbus_message_iter_get_element_type(from);
+		if (dbus_type_is_fixed(elem)) {
+			/* e.g., IEs - copy the whole array at once */
+			char elem_sig[2] = { elem, '\0' };
+			const void *data;
+			int len;
+
+			dbus_message_iter_get_fixed_array(&sub_from, &data,
+							  &len);
+			return dbus_message_iter_open_container(
+				to, type, elem_sig, &sub_to) &&
+				dbus_message_iter_append_fixed_array(
+					&sub_to, elem, &data, len) &&
+				dbus_message_iter_close_container(to, &sub_to);
+		}
+		sig = dbus_message_iter_get_signature(from);
+		if (sig == NULL)
+			return FALSE;
+		contained = sig + 1; /* skip 'a' */
+	} else if (type == DBUS_TYPE_VARIANT) {
+		sig = dbus_message_iter_get_signature(&sub_from);
+		if (sig == NULL)
+			return FALSE;
+		contained = sig;
+	}
+
+	if (!dbus_message_iter_open_container(to, type, contained, &sub_to))
+		goto out;
+	while (dbus_message_iter_get_arg_type(&sub_from) !=
+	       DBUS_TYPE_INVALID) {
+		if (!copy_iter_value(&sub_from, &sub_to))
+			goto out;
+		dbus_message_iter_next(&sub_from);
+	}
+	ret = dbus_message_iter_close_container(to, &sub_to);
+
+out:
+	dbus_free(sig);
+	return ret;
+}
+
+
+static void send_prop_changed_signal(
 	DBusConnection *con, const char *path, const char *interface,
 	const struct wpa_dbus_object_desc *obj_dsc)
 {
-	DBusMessage *msg;
+	DBusMessage *msg, *msg2 = NULL;
 	DBusMessageIter signal_iter, dict_iter;
 
+	/*
+	 * Property change notification on the standardized
+	 * org.freedesktop.DBus.Properties interface. The getters are called
+	 * only here and the property change bits are cleared.
+	 */
 	msg = dbus_message_new_signal(path, DBUS_INTERFACE_PROPERTIES,
 				      "PropertiesChanged");
 	if (msg == NULL)
@@ -678,7 +752,7 @@ static void do_send_prop_changed_signal(
 					      "{sv}", &dict_iter))
 		goto err;
 
-	if (!put_changed_properties(obj_dsc, interface, &dict_iter, 0))
+	if (!put_changed_properties(obj_dsc, interface, &dict_iter, 1))
 		goto err;
 
 	if (!dbus_message_iter_close_container(&signal_iter, &dict_iter))
@@ -692,45 +766,27 @@ static void do_send_prop_changed_signal(
 	if (!dbus_message_iter_close_container(&signal_iter, &dict_iter))
 		goto err;
 
-	dbus_connection_send(con, msg, NULL);
-
-out:
-	dbus_message_unref(msg);
-	return;
-
-err:
-	wpa_printf(MSG_DEBUG, "dbus: %s: Failed to construct signal",
-		   __func__);
-	goto out;
-}
-
-
-static void do_send_deprecated_prop_changed_signal(
-	DBusConnection *con, const char *path, const char *interface,
-	const struct wpa_dbus_object_desc *obj_dsc)
-{
-	DBusMessage *msg;
-	DBusMessageIter signal_iter, dict_iter;
-
-	msg = dbus_message_new_signal(path, interface, "PropertiesChanged");
-	if (msg == NULL)
-		return;
-
-	dbus_message_iter_init_append(msg, &signal_iter);
-
-	if (!dbus_message_iter_open_container(&signal_iter, DBUS_TYPE_ARRAY,
-					      "{sv}", &dict_iter))
+	/*
+	 * PropertiesChanged on our own interface for backwards compatibility.
+	 * This is deprecated and will be removed in a future release. The
+	 * dict encoded above is copied to avoid calling the getters again.
+	 */
+	msg2 = dbus_message_new_signal(path, interface, "PropertiesChanged");
+	if (msg2 == NULL)
 		goto err;
 
-	if (!put_changed_properties(obj_dsc, interface, &dict_iter, 1))
-		goto err;
-
-	if (!dbus_message_iter_close_container(&signal_iter, &dict_iter))
+	dbus_message_iter_init(msg, &dict_iter);
+	dbus_message_iter_next(&dict_iter);
+	dbus_message_iter_init_append(msg2, &signal_iter);
+	if (!copy_iter_value(&dict_iter, &signal_iter))
 		goto err;
 
 	dbus_connection_send(con, msg, NULL);
+	dbus_connection_send(con, msg2, NULL);
 
 out:
+	if (msg2)
+		dbus_message_unref(msg2);
 	dbus_message_unref(msg);
 	return;
 
@@ -741,29 +797,6 @@ err:
 }
 
 
-static void send_prop_changed_signal(
-	DBusConnection *con, const char *path, const char *interface,
-	const struct wpa_dbus_object_desc *obj_dsc)
-{
-	/*
-	 * First, send property change notification on the standardized
-	 * org.freedesktop.DBus.Properties interface. This call will not
-	 * clear the property change bits, so that they are preserved for
-	 * the call that follows.
-	 */
-	do_send_prop_changed_signal(con, path, interface, obj_dsc);
-
-	/*
-	 * Now send PropertiesChanged on our own interface for backwards
-	 * compatibility. This is deprecated and will be removed in a future
-	 * release.
-	 */
-	do_send_deprecated_prop_changed_signal(con, path, interface, obj_dsc);
-
-	/* Property change bits have now been cleared. */
-}
-
-
 static void flush_object_timeout_handler(void *eloop_ctx, void *timeout_ctx)
 {
 	DBusConnection *con = eloop_ctx;
@@ -901,8 +934,16 @@ void wpa_dbus_mark_property_changed(struct wpas_dbus_priv *iface,
 		return;
 	}
 
+	if (iface->prop_changed_batch_depth) {
+		/* Sent once the batch ends */
+		if (obj_desc->batch_list.next == NULL)
+			dl_list_add_tail(&iface->prop_changed_batch,
+					 &obj_desc->batch_list);
+		return;
+	}
+
 	if (!eloop_is_timeout_registered(flush_object_timeout_handler,
-					 iface->con, obj_desc->path)) {
+					 iface->con, obj_desc)) {
 		eloop_register_timeout(0, WPA_DBUS_SEND_PROP_CHANGED_TIMEOUT,
 				       flush_object_timeout_handler,
 				       iface->con, obj_desc);
@@ -910,6 +951,51 @@ void wpa_dbus_mark_property_changed(struct wpas_dbus_priv *iface,
 }
 
 
+/**
+ * wpa_dbus_prop_changed_batch_start - Start collecting property changes
+ * @iface: dbus priv struct
+ *
+ * Properties marked changed with wpa_dbus_mark_property_changed() after this
+ * call are not sent on a per-object timeout, but all at once when
+ * wpa_dbus_prop_changed_batch_end() is called. This is used to send a single
+ * PropertiesChanged signal per object for the changes resulting from a full
+ * pass over scan results. Calls can be nested.
+ */
+void wpa_dbus_prop_changed_batch_start(struct wpas_dbus_priv *iface)
+{
+	if (iface)
+		iface->prop_changed_batch_depth++;
+}
+
+
+/**
+ * wpa_dbus_prop_changed_batch_end - Send property changes collected in batch
+ * @iface: dbus priv struct
+ */
+void wpa_dbus_prop_changed_batch_end(struct wpas_dbus_priv *iface)
+{
+	struct wpa_dbus_object_desc *obj_desc;
+	unsigned int count = 0;
+
+	if (iface == NULL || iface->prop_changed_batch_depth == 0 ||
+	    --iface->prop_changed_batch_depth > 0)
+		return;
+
+	while ((obj_desc = dl_list_first(&iface->prop_changed_batch,
+					 struct wpa_dbus_object_desc,
+					 batch_list))) {
+		dl_list_del(&obj_desc->batch_list);
+		wpa_dbus_flush_object_changed_properties(iface->con,
+							 obj_desc->path);
+		count++;
+	}
+
+	if (count)
+		wpa_printf(MSG_DEBUG, "dbus: Sent property changes of %u "
+			   "objects", count);
+}
+
+
 /**
  * wpa_dbus_get_object_properties - Put object's properties into dictionary
  * @iface: dbus priv struct
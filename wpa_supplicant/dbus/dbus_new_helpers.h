@@ -12,6 +12,8 @@
 
 #include <dbus/dbus.h>
 
+#include "utils/list.h"
+
 typedef DBusMessage * (* WPADBusMethodHandler)(DBusMessage *message,
 					       void *user_data);
 typedef void (* WPADBusArgumentFreeFunction)(void *handler_arg);
@@ -31,6 +33,8 @@ struct wpa_dbus_object_desc {
 
 	/* property changed flags */
 	u8 *prop_changed_flags;
+	/* entry in wpas_dbus_priv::prop_changed_batch while batching */
+	struct dl_list batch_list;
 
 	/* argument for method handlers and properties
 	 * getter and setter functions */
@@ -134,6 +138,10 @@ void wpa_dbus_mark_property_changed(struct wpas_dbus_priv *iface,
 				    const char *path, const char *interface,
 				    const char *property);
 
+void wpa_dbus_prop_changed_batch_start(struct wpas_dbus_priv *iface);
+
+void wpa_dbus_prop_changed_batch_end(struct wpas_dbus_priv *iface);
+
 DBusMessage * wpa_dbus_introspect(DBusMessage *message,
 				  struct wpa_dbus_object_desc *obj_dsc);
 
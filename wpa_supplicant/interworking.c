@@ -55,8 +55,8 @@ static void interworking_reconnect(struct wpa_supplicant *wpa_s)
 	wpa_s->reassociate = 1;
 
 	if (wpa_s->last_scan_res_used > 0) {
-		struct os_time now;
-		os_get_time(&now);
+		struct os_reltime now;
+		os_get_reltime(&now);
 		if (now.sec - wpa_s->last_scan.sec <= 5) {
 			wpa_printf(MSG_DEBUG, "Interworking: Old scan results "
 				   "are fresh - connect without new scan");
@@ -29,7 +29,8 @@ static void usage(void)
 	       "[-p<driver_param>] \\\n"
 	       "        [-b<br_ifname>] [-f<debug file>] [-e<entropy file>] "
 	       "\\\n"
-	       "        [-o<override driver>] [-O<override ctrl>] \\\n"
+	       "        [-o<override driver>] [-O<override ctrl>] "
+	       "[-r<ring buffer size>] \\\n"
 	       "        [-N -i<ifname> -c<conf> [-C<ctrl>] "
 	       "[-D<driver>] \\\n"
 	       "        [-p<driver_param>] [-b<br_ifname>] ...]\n"
@@ -58,6 +59,10 @@ static void usage(void)
 #endif /* CONFIG_DEBUG_FILE */
 	printf("  -g = global ctrl_interface\n"
 	       "  -K = include keys (passwords, etc.) in debug output\n");
+#ifdef CONFIG_DEBUG_RINGBUF
+	printf("  -r = collect debug messages into a ring buffer of the "
+	       "given size (kB)\n");
+#endif /* CONFIG_DEBUG_RINGBUF */
 #ifdef CONFIG_DEBUG_SYSLOG
 	printf("  -s = log output to syslog instead of stdout\n");
 #endif /* CONFIG_DEBUG_SYSLOG */
@@ -155,7 +160,7 @@ int main(int argc, char *argv[])
 
 	for (;;) {
 		c = getopt(argc, argv,
-			   "b:Bc:C:D:de:f:g:hi:KLNo:O:p:P:qsTtuvW");
+			   "b:Bc:C:D:de:f:g:hi:KLNo:O:p:P:qr:sTtuvW");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -225,6 +230,11 @@ int main(int argc, char *argv[])
 		case 'q':
 			params.wpa_debug_level++;
 			break;
+#ifdef CONFIG_DEBUG_RINGBUF
+		case 'r':
+			params.wpa_debug_ringbuf_size = atoi(optarg);
+			break;
+#endif /* CONFIG_DEBUG_RINGBUF */
 #ifdef CONFIG_DEBUG_SYSLOG
 		case 's':
 			params.wpa_debug_syslog++;
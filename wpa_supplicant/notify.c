@@ -343,6 +343,18 @@ void wpas_notify_bss_rates_changed(struct wpa_supplicant *wpa_s,
 }
 
 
+void wpas_notify_bss_update_start(struct wpa_supplicant *wpa_s)
+{
+	wpas_dbus_bss_update_start(wpa_s);
+}
+
+
+void wpas_notify_bss_update_end(struct wpa_supplicant *wpa_s)
+{
+	wpas_dbus_bss_update_end(wpa_s);
+}
+
+
 void wpas_notify_blob_added(struct wpa_supplicant *wpa_s, const char *name)
 {
 	wpas_dbus_signal_blob_added(wpa_s, name);
@@ -0,0 +1,547 @@
+/*
+ * wpa_supplicant - Persistent PMKSA cache
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * PMKSA cache entries for IEEE 802.1X networks are saved into a file so that
+ * PMKSA caching can be used after wpa_supplicant has been restarted. The
+ * file starts with a version header and is followed by a log of add/remove
+ * records that are appended whenever the PMKSA cache changes. Each record is
+ * encrypted and authenticated with AES-SIV using the key from
+ * pmksa_cache_key. The file is read (and compacted) only when the first
+ * connection is started and it is rewritten whenever the log has grown
+ * considerably larger than the number of live entries.
+ */
+
+#include "includes.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "crypto/aes_siv.h"
+#include "rsn_supp/wpa.h"
+#include "rsn_supp/pmksa_cache.h"
+#include "common/wpa_common.h"
+#include "config.h"
+#include "wpa_supplicant_i.h"
+#include "pmksa_store.h"
+
+
+#define PMKSA_STORE_MAGIC "WPAPMKSA"
+#define PMKSA_STORE_VERSION 1
+#define PMKSA_STORE_HDR_LEN 16
+#define PMKSA_STORE_KEY_LEN 32
+#define PMKSA_STORE_SIV_LEN 16
+
+#define PMKSA_STORE_REC_ADD 1
+#define PMKSA_STORE_REC_REMOVE 2
+
+/* type, pmk_len, ssid_len, reserved, akmp, expiration, reauth_time, aa,
+ * pmkid, pmk, ssid */
+#define PMKSA_STORE_REC_LEN (4 + 4 + 8 + 8 + ETH_ALEN + PMKID_LEN + PMK_LEN + \
+			     MAX_SSID_LEN)
+
+/* Rewrite the file when it has this many more records than live entries */
+#define PMKSA_STORE_COMPACT_SLACK 32
+
+struct wpas_pmksa_store {
+	char *fname;
+	u8 key[PMKSA_STORE_KEY_LEN];
+	int loaded;
+	int loading;
+	unsigned int records;
+};
+
+struct pmksa_store_rec {
+	u8 type;
+	u8 pmk_len;
+	u8 ssid_len;
+	int akmp;
+	os_time_t expiration;
+	os_time_t reauth_time;
+	u8 aa[ETH_ALEN];
+	u8 pmkid[PMKID_LEN];
+	u8 pmk[PMK_LEN];
+	u8 ssid[MAX_SSID_LEN];
+};
+
+
+static FILE * pmksa_store_fopen(const char *fname, int append)
+{
+	int fd;
+	FILE *f;
+
+	fd = open(fname, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC),
+		  S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return NULL;
+	f = fdopen(fd, append ? "ab" : "wb");
+	if (f == NULL)
+		close(fd);
+	return f;
+}
+
+
+static void pmksa_store_hdr(u8 *hdr)
+{
+	os_memset(hdr, 0, PMKSA_STORE_HDR_LEN);
+	os_memcpy(hdr, PMKSA_STORE_MAGIC, 8);
+	hdr[8] = PMKSA_STORE_VERSION;
+}
+
+
+static void pmksa_store_rec_encode(const struct pmksa_store_rec *rec, u8 *buf)
+{
+	u8 *pos = buf;
+
+	*pos++ = rec->type;
+	*pos++ = rec->pmk_len;
+	*pos++ = rec->ssid_len;
+	*pos++ = 0;
+	WPA_PUT_BE32(pos, rec->akmp);
+	pos += 4;
+	WPA_PUT_BE32(pos, (u32) ((u64) rec->expiration >> 32));
+	WPA_PUT_BE32(pos + 4, (u32) rec->expiration);
+	pos += 8;
+	WPA_PUT_BE32(pos, (u32) ((u64) rec->reauth_time >> 32));
+	WPA_PUT_BE32(pos + 4, (u32) rec->reauth_time);
+	pos += 8;
+	os_memcpy(pos, rec->aa, ETH_ALEN);
+	pos += ETH_ALEN;
+	os_memcpy(pos, rec->pmkid, PMKID_LEN);
+	pos += PMKID_LEN;
+	os_memcpy(pos, rec->pmk, PMK_LEN);
+	pos += PMK_LEN;
+	os_memcpy(pos, rec->ssid, MAX_SSID_LEN);
+}
+
+
+static int pmksa_store_rec_decode(struct pmksa_store_rec *rec, const u8 *buf)
+{
+	const u8 *pos = buf;
+
+	rec->type = *pos++;
+	rec->pmk_len = *pos++;
+	rec->ssid_len = *pos++;
+	pos++;
+	rec->akmp = WPA_GET_BE32(pos);
+	pos += 4;
+	rec->expiration = (os_time_t) (((u64) WPA_GET_BE32(pos) << 32) |
+				       WPA_GET_BE32(pos + 4));
+	pos += 8;
+	rec->reauth_time = (os_time_t) (((u64) WPA_GET_BE32(pos) << 32) |
+					WPA_GET_BE32(pos + 4));
+	pos += 8;
+	os_memcpy(rec->aa, pos, ETH_ALEN);
+	pos += ETH_ALEN;
+	os_memcpy(rec->pmkid, pos, PMKID_LEN);
+	pos += PMKID_LEN;
+	os_memcpy(rec->pmk, pos, PMK_LEN);
+	pos += PMK_LEN;
+	os_memcpy(rec->ssid, pos, MAX_SSID_LEN);
+
+	if ((rec->type != PMKSA_STORE_REC_ADD &&
+	     rec->type != PMKSA_STORE_REC_REMOVE) ||
+	    rec->pmk_len > PMK_LEN || rec->ssid_len > MAX_SSID_LEN)
+		return -1;
+	return 0;
+}
+
+
+static int pmksa_store_write_rec(struct wpas_pmksa_store *store, FILE *f,
+				 const struct pmksa_store_rec *rec)
+{
+	u8 hdr[PMKSA_STORE_HDR_LEN], plain[PMKSA_STORE_REC_LEN];
+	u8 out[2 + PMKSA_STORE_SIV_LEN + PMKSA_STORE_REC_LEN];
+	const u8 *addr[1];
+	size_t len[1];
+	int ret = 0;
+
+	pmksa_store_hdr(hdr);
+	addr[0] = hdr;
+	len[0] = sizeof(hdr);
+	pmksa_store_rec_encode(rec, plain);
+	WPA_PUT_BE16(out, PMKSA_STORE_SIV_LEN + PMKSA_STORE_REC_LEN);
+	if (aes_siv_encrypt(store->key, plain, sizeof(plain), 1, addr, len,
+			    out + 2) < 0 ||
+	    fwrite(out, 1, sizeof(out), f) != sizeof(out))
+		ret = -1;
+	os_memset(plain, 0, sizeof(plain));
+	return ret;
+}
+
+
+/*
+ * PMKSA cache entries use relative time that starts again from zero on each
+ * boot, so the file stores wall clock time instead.
+ */
+static os_time_t pmksa_store_wall_offset(void)
+{
+	struct os_time now;
+	struct os_reltime rel;
+
+	os_get_time(&now);
+	os_get_reltime(&rel);
+	return now.sec - rel.sec;
+}
+
+
+static int pmksa_store_entry_rec(struct rsn_pmksa_cache_entry *entry,
+				 struct pmksa_store_rec *rec)
+{
+	os_time_t offset = pmksa_store_wall_offset();
+
+	struct wpa_ssid *ssid = entry->network_ctx;
+
+	if (ssid == NULL || !wpa_key_mgmt_wpa_ieee8021x(entry->akmp) ||
+	    ssid->ssid_len > MAX_SSID_LEN || entry->pmk_len > PMK_LEN)
+		return -1;
+
+	os_memset(rec, 0, sizeof(*rec));
+	rec->type = PMKSA_STORE_REC_ADD;
+	rec->pmk_len = entry->pmk_len;
+	rec->ssid_len = ssid->ssid_len;
+	rec->akmp = entry->akmp;
+	rec->expiration = entry->expiration + offset;
+	rec->reauth_time = entry->reauth_time + offset;
+	os_memcpy(rec->aa, entry->aa, ETH_ALEN);
+	os_memcpy(rec->pmkid, entry->pmkid, PMKID_LEN);
+	os_memcpy(rec->pmk, entry->pmk, entry->pmk_len);
+	os_memcpy(rec->ssid, ssid->ssid, ssid->ssid_len);
+	return 0;
+}
+
+
+/* Write all current PMKSA cache entries into a new file */
+static void pmksa_store_rewrite(struct wpa_supplicant *wpa_s)
+{
+	struct wpas_pmksa_store *store = wpa_s->pmksa_store;
+	struct rsn_pmksa_cache_entry *entry;
+	struct pmksa_store_rec rec;
+	u8 hdr[PMKSA_STORE_HDR_LEN];
+	char *tmp;
+	size_t len;
+	FILE *f;
+	int err = 0;
+	unsigned int count = 0;
+
+	len = os_strlen(store->fname) + 5;
+	tmp = os_malloc(len);
+	if (tmp == NULL)
+		return;
+	os_snprintf(tmp, len, "%s.tmp", store->fname);
+
+	f = pmksa_store_fopen(tmp, 0);
+	if (f == NULL) {
+		wpa_printf(MSG_INFO, "PMKSA store: Could not open '%s'", tmp);
+		os_free(tmp);
+		return;
+	}
+
+	pmksa_store_hdr(hdr);
+	if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr))
+		err = 1;
+	for (entry = wpa_sm_pmksa_cache_head(wpa_s->wpa); entry && !err;
+	     entry = entry->next) {
+		if (pmksa_store_entry_rec(entry, &rec) < 0)
+			continue;
+		if (pmksa_store_write_rec(store, f, &rec) < 0)
+			err = 1;
+		count++;
+	}
+	os_memset(&rec, 0, sizeof(rec));
+
+	if (fclose(f) != 0 || err || rename(tmp, store->fname) < 0) {
+		wpa_printf(MSG_INFO, "PMKSA store: Failed to write '%s'",
+			   store->fname);
+		unlink(tmp);
+	} else {
+		store->records = count;
+		wpa_printf(MSG_DEBUG, "PMKSA store: Wrote %u entries to '%s'",
+			   count, store->fname);
+	}
+	os_free(tmp);
+}
+
+
+static void pmksa_store_append(struct wpa_supplicant *wpa_s,
+			       const struct pmksa_store_rec *rec)
+{
+	struct wpas_pmksa_store *store = wpa_s->pmksa_store;
+	struct rsn_pmksa_cache_entry *entry;
+	unsigned int live = 0;
+	FILE *f;
+
+	f = pmksa_store_fopen(store->fname, 1);
+	if (f == NULL) {
+		wpa_printf(MSG_INFO, "PMKSA store: Could not open '%s'",
+			   store->fname);
+		return;
+	}
+
+	if (fseek(f, 0, SEEK_END) == 0 && ftell(f) == 0) {
+		u8 hdr[PMKSA_STORE_HDR_LEN];
+		pmksa_store_hdr(hdr);
+		if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) {
+			fclose(f);
+			return;
+		}
+		store->records = 0;
+	}
+
+	if (pmksa_store_write_rec(store, f, rec) == 0)
+		store->records++;
+	fclose(f);
+
+	for (entry = wpa_sm_pmksa_cache_head(wpa_s->wpa); entry;
+	     entry = entry->next)
+		live++;
+	if (store->loaded &&
+	    store->records > 2 * live + PMKSA_STORE_COMPACT_SLACK)
+		pmksa_store_rewrite(wpa_s);
+}
+
+
+/**
+ * wpas_pmksa_store_added - Save a new PMKSA cache entry
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @aa: Authenticator address
+ * @pmkid: PMKID of the new entry
+ */
+void wpas_pmksa_store_added(struct wpa_supplicant *wpa_s, const u8 *aa,
+			    const u8 *pmkid)
+{
+	struct wpas_pmksa_store *store = wpa_s->pmksa_store;
+	struct rsn_pmksa_cache_entry *entry;
+	struct pmksa_store_rec rec;
+
+	if (store == NULL || store->loading)
+		return;
+
+	entry = wpa_sm_pmksa_cache_get(wpa_s->wpa, aa, pmkid, NULL);
+	if (entry == NULL || pmksa_store_entry_rec(entry, &rec) < 0)
+		return;
+
+	pmksa_store_append(wpa_s, &rec);
+	os_memset(&rec, 0, sizeof(rec));
+}
+
+
+/**
+ * wpas_pmksa_store_removed - Note removal of a PMKSA cache entry
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @aa: Authenticator address
+ * @pmkid: PMKID of the removed entry
+ */
+void wpas_pmksa_store_removed(struct wpa_supplicant *wpa_s, const u8 *aa,
+			      const u8 *pmkid)
+{
+	struct wpas_pmksa_store *store = wpa_s->pmksa_store;
+	struct pmksa_store_rec rec;
+
+	if (store == NULL || store->loading)
+		return;
+
+	os_memset(&rec, 0, sizeof(rec));
+	rec.type = PMKSA_STORE_REC_REMOVE;
+	os_memcpy(rec.aa, aa, ETH_ALEN);
+	os_memcpy(rec.pmkid, pmkid, PMKID_LEN);
+	pmksa_store_append(wpa_s, &rec);
+}
+
+
+static struct wpa_ssid * pmksa_store_find_ssid(struct wpa_supplicant *wpa_s,
+					       const struct pmksa_store_rec *rec)
+{
+	struct wpa_ssid *ssid;
+
+	for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
+		if (ssid->ssid_len == rec->ssid_len &&
+		    os_memcmp(ssid->ssid, rec->ssid, rec->ssid_len) == 0 &&
+		    (ssid->key_mgmt & rec->akmp))
+			return ssid;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * wpas_pmksa_store_load - Load saved PMKSA cache entries
+ * @wpa_s: Pointer to wpa_supplicant data
+ *
+ * This is called before starting a connection. The file is read only on the
+ * first call after wpas_pmksa_store_init().
+ */
+void wpas_pmksa_store_load(struct wpa_supplicant *wpa_s)
+{
+	struct wpas_pmksa_store *store = wpa_s->pmksa_store;
+	struct pmksa_store_rec *recs = NULL, *tmp, rec;
+	size_t num = 0, i, len, rlen;
+	u8 hdr[PMKSA_STORE_HDR_LEN], plain[PMKSA_STORE_REC_LEN];
+	const u8 *addr[1];
+	size_t alen[1];
+	char *buf;
+	const u8 *pos, *end;
+	unsigned int records = 0, restored = 0;
+	int corrupted = 0;
+	os_time_t offset;
+
+	if (store == NULL || store->loaded)
+		return;
+	store->loaded = 1;
+
+	buf = os_readfile(store->fname, &len);
+	if (buf == NULL) {
+		wpa_printf(MSG_DEBUG, "PMKSA store: No saved entries in '%s'",
+			   store->fname);
+		return;
+	}
+
+	pmksa_store_hdr(hdr);
+	if (len < sizeof(hdr) || os_memcmp(buf, hdr, sizeof(hdr)) != 0) {
+		wpa_printf(MSG_INFO, "PMKSA store: Unsupported file format "
+			   "in '%s'", store->fname);
+		os_free(buf);
+		pmksa_store_rewrite(wpa_s);
+		return;
+	}
+
+	addr[0] = hdr;
+	alen[0] = sizeof(hdr);
+	pos = (const u8 *) buf + sizeof(hdr);
+	end = (const u8 *) buf + len;
+	while (end - pos >= 2) {
+		rlen = WPA_GET_BE16(pos);
+		pos += 2;
+		if (rlen != PMKSA_STORE_SIV_LEN + PMKSA_STORE_REC_LEN ||
+		    (size_t) (end - pos) < rlen ||
+		    aes_siv_decrypt(store->key, pos, rlen, 1, addr, alen,
+				    plain) < 0 ||
+		    pmksa_store_rec_decode(&rec, plain) < 0) {
+			corrupted = 1;
+			break;
+		}
+		pos += rlen;
+		records++;
+
+		/* Replay the log: one entry per Authenticator */
+		for (i = 0; i < num; i++) {
+			if (os_memcmp(recs[i].aa, rec.aa, ETH_ALEN) == 0)
+				break;
+		}
+		if (rec.type == PMKSA_STORE_REC_REMOVE) {
+			if (i < num &&
+			    os_memcmp(recs[i].pmkid, rec.pmkid, PMKID_LEN) == 0)
+				recs[i] = recs[--num];
+			continue;
+		}
+		if (i == num) {
+			tmp = os_realloc_array(recs, num + 1, sizeof(*recs));
+			if (tmp == NULL)
+				break;
+			recs = tmp;
+			num++;
+		}
+		recs[i] = rec;
+	}
+	if (pos != end)
+		corrupted = 1;
+	os_memset(plain, 0, sizeof(plain));
+	os_memset(&rec, 0, sizeof(rec));
+	os_memset(buf, 0, len);
+	os_free(buf);
+
+	if (corrupted)
+		wpa_printf(MSG_INFO, "PMKSA store: Ignored invalid data in '%s'",
+			   store->fname);
+
+	offset = pmksa_store_wall_offset();
+	store->loading = 1;
+	for (i = 0; i < num; i++) {
+		struct wpa_ssid *ssid = pmksa_store_find_ssid(wpa_s, &recs[i]);
+		if (ssid == NULL)
+			continue;
+		if (wpa_sm_pmksa_cache_restore(wpa_s->wpa, recs[i].pmk,
+					       recs[i].pmk_len, recs[i].aa,
+					       ssid, recs[i].akmp,
+					       recs[i].expiration - offset,
+					       recs[i].reauth_time - offset) == 0)
+			restored++;
+	}
+	store->loading = 0;
+	if (recs) {
+		os_memset(recs, 0, num * sizeof(*recs));
+		os_free(recs);
+	}
+
+	wpa_printf(MSG_DEBUG, "PMKSA store: Restored %u PMKSA cache entries "
+		   "(%u records) from '%s'", restored, records, store->fname);
+
+	/* Drop removed, expired, and unknown entries from the file */
+	if (corrupted || records != restored)
+		pmksa_store_rewrite(wpa_s);
+	else
+		store->records = records;
+}
+
+
+/**
+ * wpas_pmksa_store_init - Initialize persistent PMKSA cache
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: 0 on success (or if not configured), -1 on failure
+ */
+int wpas_pmksa_store_init(struct wpa_supplicant *wpa_s)
+{
+	struct wpas_pmksa_store *store;
+	const char *key = wpa_s->conf->pmksa_cache_key;
+
+	wpas_pmksa_store_deinit(wpa_s);
+	if (wpa_s->conf->pmksa_cache_file == NULL)
+		return 0;
+
+	if (key == NULL || os_strlen(key) != 2 * PMKSA_STORE_KEY_LEN) {
+		wpa_printf(MSG_ERROR, "PMKSA store: pmksa_cache_key (%d hex "
+			   "digits) is required with pmksa_cache_file",
+			   2 * PMKSA_STORE_KEY_LEN);
+		return -1;
+	}
+
+	store = os_zalloc(sizeof(*store));
+	if (store == NULL)
+		return -1;
+	store->fname = os_strdup(wpa_s->conf->pmksa_cache_file);
+	if (store->fname == NULL ||
+	    hexstr2bin(key, store->key, PMKSA_STORE_KEY_LEN) < 0) {
+		wpa_printf(MSG_ERROR, "PMKSA store: Invalid pmksa_cache_key");
+		os_free(store->fname);
+		os_free(store);
+		return -1;
+	}
+
+	wpa_s->pmksa_store = store;
+	return 0;
+}
+
+
+/**
+ * wpas_pmksa_store_deinit - Stop saving PMKSA cache entries
+ * @wpa_s: Pointer to wpa_supplicant data
+ *
+ * The saved entries are left in the file. This needs to be called before
+ * the PMKSA cache is flushed for reasons other than the entries becoming
+ * invalid (e.g., interface removal or configuration reload).
+ */
+void wpas_pmksa_store_deinit(struct wpa_supplicant *wpa_s)
+{
+	struct wpas_pmksa_store *store = wpa_s->pmksa_store;
+
+	if (store == NULL)
+		return;
+	wpa_s->pmksa_store = NULL;
+	os_free(store->fname);
+	os_memset(store, 0, sizeof(*store));
+	os_free(store);
+}
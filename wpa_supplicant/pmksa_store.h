@@ -0,0 +1,49 @@
+/*
+ * wpa_supplicant - Persistent PMKSA cache
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef PMKSA_STORE_H
+#define PMKSA_STORE_H
+
+#ifdef CONFIG_PMKSA_CACHE_FILE
+
+int wpas_pmksa_store_init(struct wpa_supplicant *wpa_s);
+void wpas_pmksa_store_deinit(struct wpa_supplicant *wpa_s);
+void wpas_pmksa_store_load(struct wpa_supplicant *wpa_s);
+void wpas_pmksa_store_added(struct wpa_supplicant *wpa_s, const u8 *aa,
+			    const u8 *pmkid);
+void wpas_pmksa_store_removed(struct wpa_supplicant *wpa_s, const u8 *aa,
+			      const u8 *pmkid);
+
+#else /* CONFIG_PMKSA_CACHE_FILE */
+
+static inline int wpas_pmksa_store_init(struct wpa_supplicant *wpa_s)
+{
+	return 0;
+}
+
+static inline void wpas_pmksa_store_deinit(struct wpa_supplicant *wpa_s)
+{
+}
+
+static inline void wpas_pmksa_store_load(struct wpa_supplicant *wpa_s)
+{
+}
+
+static inline void wpas_pmksa_store_added(struct wpa_supplicant *wpa_s,
+					  const u8 *aa, const u8 *pmkid)
+{
+}
+
+static inline void wpas_pmksa_store_removed(struct wpa_supplicant *wpa_s,
+					    const u8 *aa, const u8 *pmkid)
+{
+}
+
+#endif /* CONFIG_PMKSA_CACHE_FILE */
+
+#endif /* PMKSA_STORE_H */
@@ -520,6 +520,105 @@ static int wpa_cli_cmd_mib(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int wpa_cli_cmd_debug_ringbuf(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "DEBUG_RINGBUF");
+}
+
+
+static int wpa_cli_ringbuf_request(struct wpa_ctrl *ctrl, const char *cmd,
+				   char *buf, size_t buflen)
+{
+	size_t len;
+	int ret;
+
+	len = buflen - 1;
+	ret = wpa_ctrl_request(ctrl, cmd, os_strlen(cmd), buf, &len,
+			       wpa_cli_msg_cb);
+	if (ret == -2) {
+		printf("'%s' command timed out.\n", cmd);
+		return -1;
+	} else if (ret < 0 || (len >= 4 && os_memcmp(buf, "FAIL", 4) == 0)) {
+		printf("'%s' command failed.\n", cmd);
+		return -1;
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+
+static int wpa_cli_cmd_debug_ringbuf_dump(struct wpa_ctrl *ctrl, int argc,
+					  char *argv[])
+{
+	char cmd[64], buf[4096], *data, *pos, *end;
+	unsigned long long size, head, offset, start, max_len;
+	int len, first = 1;
+
+	if (argc > 1) {
+		printf("Invalid DEBUG_RINGBUF_DUMP command: needs at most one "
+		       "argument (maximum length)\n");
+		return -1;
+	}
+	if (ctrl_conn == NULL) {
+		printf("Not connected to wpa_supplicant - command dropped.\n");
+		return -1;
+	}
+
+	/*
+	 * A single reply is limited by the control interface message size, so
+	 * fetch the buffer in chunks. Only the entries present when starting
+	 * are shown since each command adds new debug messages to the buffer.
+	 */
+	if (wpa_cli_ringbuf_request(ctrl, "DEBUG_RINGBUF", buf,
+				    sizeof(buf)) < 0)
+		return -1;
+	pos = os_strstr(buf, "size=");
+	size = pos ? strtoull(pos + 5, NULL, 10) : 0;
+	pos = os_strstr(buf, "written=");
+	head = pos ? strtoull(pos + 8, NULL, 10) : 0;
+	max_len = argc > 0 ? strtoull(argv[0], NULL, 10) : 0;
+	if (max_len > 0 && max_len < size)
+		size = max_len;
+	offset = head > size ? head - size : 0;
+
+	while (offset < head) {
+		os_snprintf(cmd, sizeof(cmd), "DEBUG_RINGBUF_DUMP %llu %d",
+			    offset, (int) sizeof(buf) - 32);
+		len = wpa_cli_ringbuf_request(ctrl, cmd, buf, sizeof(buf));
+		if (len < 0)
+			return -1;
+		data = os_strchr(buf, '\n');
+		if (data == NULL)
+			return -1;
+		data++;
+		end = buf + len;
+		if (data == end)
+			break;
+		start = strtoull(buf, NULL, 10);
+
+		pos = data;
+		if (first && start > 0) {
+			/* Skip the partial line in the beginning */
+			while (pos < end && *pos++ != '\n')
+				;
+		} else if (start > offset)
+			printf("[%llu octets overwritten]\n", start - offset);
+		first = 0;
+		fwrite(pos, 1, end - pos, stdout);
+		offset = start + (end - data);
+	}
+
+	return 0;
+}
+
+
+static int wpa_cli_cmd_memstats(struct wpa_ctrl *ctrl, int argc, char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "MEMSTATS");
+}
+
+
 static int wpa_cli_cmd_pmksa(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	return wpa_ctrl_command(ctrl, "PMKSA");
@@ -2297,6 +2396,15 @@ static struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "mib", wpa_cli_cmd_mib, NULL,
 	  cli_cmd_flag_none,
 	  "= get MIB variables (dot1x, dot11)" },
+	{ "debug_ringbuf", wpa_cli_cmd_debug_ringbuf, NULL,
+	  cli_cmd_flag_none,
+	  "= show debug ring buffer status" },
+	{ "debug_ringbuf_dump", wpa_cli_cmd_debug_ringbuf_dump, NULL,
+	  cli_cmd_flag_none,
+	  "[max len] = show debug ring buffer entries" },
+	{ "memstats", wpa_cli_cmd_memstats, NULL,
+	  cli_cmd_flag_none,
+	  "= show memory pool and buffer statistics" },
 	{ "help", wpa_cli_cmd_help, wpa_cli_complete_help,
 	  cli_cmd_flag_none,
 	  "[command] = show usage help" },
@@ -2365,6 +2473,7 @@ static struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "log_level", wpa_cli_cmd_log_level, NULL,
 	  cli_cmd_flag_none,
 	  "<level> [<timestamp>] = update the log level/timestamp\n"
+	  "log_level <module>=<level> = update the log level of a module\n"
 	  "log_level = display the current log level and log options" },
 	{ "list_networks", wpa_cli_cmd_list_networks, NULL,
 	  cli_cmd_flag_none,
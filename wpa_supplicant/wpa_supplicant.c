@@ -50,6 +50,7 @@
 #include "offchannel.h"
 #include "hs20_supplicant.h"
 #include "mesh.h"
+#include "pmksa_store.h"
 
 const char *wpa_supplicant_version =
 "wpa_supplicant v" VERSION_STR "\n"
@@ -387,6 +388,8 @@ void free_hw_features(struct wpa_supplicant *wpa_s)
 
 static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 {
+	/* Keep the saved entries; the PMKSA cache is flushed below */
+	wpas_pmksa_store_deinit(wpa_s);
 	bgscan_deinit(wpa_s);
 	autoscan_deinit(wpa_s);
 	scard_deinit(wpa_s->scard);
@@ -809,6 +812,7 @@ int wpa_supplicant_reload_configuration(struct wpa_supplicant *wpa_s)
 	}
 	eapol_sm_notify_config(wpa_s->eapol, NULL, NULL);
 	wpa_sm_set_config(wpa_s->wpa, NULL);
+	wpas_pmksa_store_deinit(wpa_s);
 	wpa_sm_pmksa_cache_flush(wpa_s->wpa, NULL);
 	wpa_sm_set_fast_reauth(wpa_s->wpa, wpa_s->conf->fast_reauth);
 	rsn_preauth_deinit(wpa_s->wpa);
@@ -818,6 +822,7 @@ int wpa_supplicant_reload_configuration(struct wpa_supplicant *wpa_s)
 	wpa_s->conf = conf;
 	if (old_ap_scan != wpa_s->conf->ap_scan)
 		wpas_notify_ap_scan_changed(wpa_s);
+	wpas_pmksa_store_init(wpa_s);
 
 	if (reconf_ctrl)
 		wpa_s->ctrl_iface = wpa_supplicant_ctrl_iface_init(wpa_s);
@@ -1250,6 +1255,9 @@ void wpa_supplicant_associate(struct wpa_supplicant *wpa_s,
 	wpa_s->ibss_rsn = NULL;
 #endif /* CONFIG_IBSS_RSN */
 
+	/* Saved PMKSA cache entries are needed from the first connection */
+	wpas_pmksa_store_load(wpa_s);
+
 	if (ssid->mode == WPAS_MODE_AP || ssid->mode == WPAS_MODE_P2P_GO ||
 	    ssid->mode == WPAS_MODE_P2P_GROUP_FORMATION) {
 #ifdef CONFIG_AP
@@ -2234,7 +2242,7 @@ void wpa_supplicant_rx_eapol(void *ctx, const u8 *src_addr,
 		wpabuf_free(wpa_s->pending_eapol_rx);
 		wpa_s->pending_eapol_rx = wpabuf_alloc_copy(buf, len);
 		if (wpa_s->pending_eapol_rx) {
-			os_get_time(&wpa_s->pending_eapol_rx_time);
+			os_get_reltime(&wpa_s->pending_eapol_rx_time);
 			os_memcpy(wpa_s->pending_eapol_rx_src, src_addr,
 				  ETH_ALEN);
 		}
@@ -2853,6 +2861,7 @@ next_driver:
 			  wpa_s->bridge_ifname[0] ? wpa_s->bridge_ifname :
 			  NULL);
 	wpa_sm_set_fast_reauth(wpa_s->wpa, wpa_s->conf->fast_reauth);
+	wpas_pmksa_store_init(wpa_s);
 
 	if (wpa_s->conf->dot11RSNAConfigPMKLifetime &&
 	    wpa_sm_set_param(wpa_s->wpa, RSNA_PMK_LIFETIME,
@@ -3177,6 +3186,17 @@ static const char * wpa_supplicant_msg_ifname_cb(void *ctx)
  * initialization, the returned data pointer can be used to add and remove
  * network interfaces, and eventually, to deinitialize %wpa_supplicant.
  */
+#if defined(CONFIG_DEBUG_RINGBUF) && defined(CONFIG_DEBUG_FILE)
+static void wpa_supplicant_debug_ringbuf_flush(void *eloop_ctx,
+					       void *timeout_ctx)
+{
+	wpa_debug_flush_ringbuf();
+	eloop_register_timeout(1, 0, wpa_supplicant_debug_ringbuf_flush, NULL,
+			       NULL);
+}
+#endif /* CONFIG_DEBUG_RINGBUF && CONFIG_DEBUG_FILE */
+
+
 struct wpa_global * wpa_supplicant_init(struct wpa_params *params)
 {
 	struct wpa_global *global;
@@ -3197,6 +3217,10 @@ struct wpa_global * wpa_supplicant_init(struct wpa_params *params)
 #endif /* CONFIG_NO_WPA_MSG */
 
 	wpa_debug_open_file(params->wpa_debug_file_path);
+	if (params->wpa_debug_ringbuf_size > 0 &&
+	    wpa_debug_open_ringbuf((size_t) params->wpa_debug_ringbuf_size *
+				   1024) < 0)
+		wpa_printf(MSG_ERROR, "Failed to set up debug ring buffer");
 	if (params->wpa_debug_syslog)
 		wpa_debug_open_syslog();
 	if (params->wpa_debug_tracing) {
@@ -3253,6 +3277,14 @@ struct wpa_global * wpa_supplicant_init(struct wpa_params *params)
 
 	random_init(params->entropy_file);
 
+#if defined(CONFIG_DEBUG_RINGBUF) && defined(CONFIG_DEBUG_FILE)
+	/* Without a debug file, messages stay in the ring buffer until they
+	 * are fetched with DEBUG_RINGBUF_DUMP */
+	if (params->wpa_debug_ringbuf_size > 0 && params->wpa_debug_file_path)
+		eloop_register_timeout(1, 0, wpa_supplicant_debug_ringbuf_flush,
+				       NULL, NULL);
+#endif /* CONFIG_DEBUG_RINGBUF && CONFIG_DEBUG_FILE */
+
 	global->ctrl_iface = wpa_supplicant_global_ctrl_iface_init(global);
 	if (global->ctrl_iface == NULL) {
 		wpa_supplicant_deinit(global);
@@ -3379,6 +3411,7 @@ void wpa_supplicant_deinit(struct wpa_global *global)
 
 	os_free(global);
 	wpa_debug_close_syslog();
+	wpa_debug_close_ringbuf();
 	wpa_debug_close_file();
 	wpa_debug_close_linux_tracing();
 }
@@ -3682,7 +3715,7 @@ void wpas_auth_failed(struct wpa_supplicant *wpa_s)
 {
 	struct wpa_ssid *ssid = wpa_s->current_ssid;
 	int dur;
-	struct os_time now;
+	struct os_reltime now;
 
 	if (ssid == NULL) {
 		wpa_printf(MSG_DEBUG, "Authentication failure but no known "
@@ -3707,7 +3740,7 @@ void wpas_auth_failed(struct wpa_supplicant *wpa_s)
 	else
 		dur = 10;
 
-	os_get_time(&now);
+	os_get_reltime(&now);
 	if (now.sec + dur <= ssid->disabled_until.sec)
 		return;
 
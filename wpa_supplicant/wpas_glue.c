@@ -26,6 +26,7 @@
 #include "bss.h"
 #include "scan.h"
 #include "notify.h"
+#include "pmksa_store.h"
 
 
 #ifndef CONFIG_NO_CONFIG_BLOBS
@@ -454,6 +455,7 @@ static int wpa_supplicant_mlme_setprotection(void *wpa_s, const u8 *addr,
 static int wpa_supplicant_add_pmkid(void *wpa_s,
 				    const u8 *bssid, const u8 *pmkid)
 {
+	wpas_pmksa_store_added(wpa_s, bssid, pmkid);
 	return wpa_drv_add_pmkid(wpa_s, bssid, pmkid);
 }
 
@@ -461,6 +463,7 @@ static int wpa_supplicant_add_pmkid(void *wpa_s,
 static int wpa_supplicant_remove_pmkid(void *wpa_s,
 				       const u8 *bssid, const u8 *pmkid)
 {
+	wpas_pmksa_store_removed(wpa_s, bssid, pmkid);
 	return wpa_drv_remove_pmkid(wpa_s, bssid, pmkid);
 }
 